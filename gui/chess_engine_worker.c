@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "obj_trace.h"
+#include "chess_engine_worker.h"
+
+/* ------------------------------------------------------------------
+   Stato del worker (uno per processo, come le texture della GUI)
+   ------------------------------------------------------------------ */
+
+typedef struct EngineWorkerState_s {
+    ChessGameEngine *engine;      /* motore condiviso con la GUI (sola lettura) */
+    SDL_Thread      *thread;      /* thread della ricerca */
+    SDL_mutex       *lock;        /* protegge i campi qui sotto */
+    SDL_cond        *wakeup;      /* sveglia il worker quando c'è una richiesta */
+
+    bitboard_state_t pending_state; /* posizione della richiesta in attesa */
+    bool             has_request;   /* una richiesta aspetta il worker */
+    bool             searching;     /* il worker sta cercando */
+    bool             quitting;      /* il worker deve terminare */
+
+    volatile int     stop_flag;     /* letto da get_best_move_stoppable */
+} EngineWorkerState;
+
+static EngineWorkerState s_worker = { NULL, NULL, NULL, NULL,
+                                      {0}, false, false, false, 0 };
+
+static Uint32 s_event_type = (Uint32)-1;
+
+Uint32 ChessEngineWorker_EventType(void)
+{
+    if (s_event_type == (Uint32)-1) {
+        s_event_type = SDL_RegisterEvents(1);
+        if (s_event_type == (Uint32)-1) {
+            TRACE_ERROR(&stdtrace, "SDL_RegisterEvents fallita: %s", SDL_GetError());
+        }
+    }
+    return s_event_type;
+}
+
+/* ------------------------------------------------------------------
+   Pubblicazione del risultato verso il loop eventi
+   ------------------------------------------------------------------ */
+
+static void pushResultEvent(Sint32 code, void *move)
+{
+    SDL_Event ev;
+    SDL_zero(ev);
+    ev.type = ChessEngineWorker_EventType();
+    ev.user.code = code;
+    ev.user.data1 = move;   /* chess_move_t*, proprietà del ricevente */
+    ev.user.data2 = NULL;
+
+    if (SDL_PushEvent(&ev) < 0) {
+        /* Coda piena o SDL in chiusura: la mossa va liberata qui,
+           altrimenti nessuno lo farà mai */
+        TRACE_ERROR(&stdtrace, "SDL_PushEvent fallita: %s", SDL_GetError());
+        if (move && s_worker.engine) {
+            s_worker.engine->gd->free_move(move);
+        }
+    }
+}
+
+/* ------------------------------------------------------------------
+   Streaming del progresso verso il loop eventi
+   ------------------------------------------------------------------ */
+
+/**
+ * @brief Scrive una mossa in notazione da coordinate ("e2e4", "e7e8q").
+ *
+ * @return Numero di caratteri scritti (4 o 5).
+ */
+static int formatMove(const chess_move_t *move, char *buf)
+{
+    static const char promo_letters[] = { '\0', 'n', 'b', 'r', 'q' };
+    int n = 0;
+
+    buf[n++] = (char)('a' + (move->from % 8));
+    buf[n++] = (char)('1' + (move->from / 8));
+    buf[n++] = (char)('a' + (move->to % 8));
+    buf[n++] = (char)('1' + (move->to / 8));
+    if (move->promotion >= 1 && move->promotion <= 4) {
+        buf[n++] = promo_letters[move->promotion];
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+/*
+ * Callback di progresso registrata sul thread del worker: trasforma la
+ * fotografia dell'iterazione (i puntatori della PV valgono solo durante la
+ * chiamata) in un ChessEngineProgress autosufficiente e lo pubblica come
+ * evento utente. Il ricevente lo libera con free().
+ */
+static void workerProgressCallback(const search_progress_t *progress, void *user_data)
+{
+    (void)user_data;
+
+    ChessEngineProgress *snap = (ChessEngineProgress*) malloc(sizeof(*snap));
+    if (!snap) {
+        return;
+    }
+
+    snap->depth = progress->depth;
+    snap->score = progress->value;
+    snap->nodes = progress->nodes;
+    snap->elapsed_ms = progress->elapsed_ms;
+    snap->nps = progress->nps;
+
+    size_t used = 0;
+    snap->pv_text[0] = '\0';
+    for (int i = 0; i < progress->pv_length; i++) {
+        char move_buf[8];
+        int len = formatMove((const chess_move_t*)progress->pv_moves[i], move_buf);
+        if (used + (size_t)len + 2 >= sizeof(snap->pv_text)) {
+            break;
+        }
+        if (used > 0) {
+            snap->pv_text[used++] = ' ';
+        }
+        memcpy(&snap->pv_text[used], move_buf, (size_t)len + 1);
+        used += (size_t)len;
+    }
+
+    SDL_Event ev;
+    SDL_zero(ev);
+    ev.type = ChessEngineWorker_EventType();
+    ev.user.code = CHESS_ENGINE_SEARCH_PROGRESS;
+    ev.user.data1 = snap;
+    ev.user.data2 = NULL;
+    if (SDL_PushEvent(&ev) < 0) {
+        /* Coda piena: il progresso è un'informazione volatile, si scarta */
+        free(snap);
+    }
+}
+
+void ChessEngineWorker_FormatProgress(const ChessEngineProgress *progress,
+                                      char *buf, size_t buf_size)
+{
+    if (!buf || buf_size == 0) {
+        return;
+    }
+    if (!progress) {
+        buf[0] = '\0';
+        return;
+    }
+
+    /* Punteggio in pedoni; oltre la soglia dei matti mostriamo "mate" */
+    if (progress->score > 90000 || progress->score < -90000) {
+        snprintf(buf, buf_size, "/bprof %d/r  %smate  %lu nodi  %.0f kN/s  %s",
+                 progress->depth,
+                 (progress->score > 0) ? "+" : "-",
+                 progress->nodes,
+                 progress->nps / 1000.0,
+                 progress->pv_text);
+    } else {
+        snprintf(buf, buf_size, "/bprof %d/r  %+.2f  %lu nodi  %.0f kN/s  %s",
+                 progress->depth,
+                 (double)progress->score / 100.0,
+                 progress->nodes,
+                 progress->nps / 1000.0,
+                 progress->pv_text);
+    }
+}
+
+/* ------------------------------------------------------------------
+   Thread del worker: attende richieste, cerca, pubblica eventi
+   ------------------------------------------------------------------ */
+
+static int engineWorkerMain(void *arg)
+{
+    (void)arg;
+    TRACE_INFO(&stdtrace, "Engine worker avviato");
+
+    /* La registrazione è thread-local: va fatta QUI, sul thread che cerca */
+    minimax_set_progress_callback(workerProgressCallback, NULL);
+
+    SDL_LockMutex(s_worker.lock);
+    for (;;) {
+        while (!s_worker.has_request && !s_worker.quitting) {
+            SDL_CondWait(s_worker.wakeup, s_worker.lock);
+        }
+        if (s_worker.quitting) {
+            break;
+        }
+
+        /* Preleva la richiesta e cerca FUORI dal lock: la GUI deve poter
+           interrogare IsSearching e chiedere Cancel mentre il motore gira */
+        bitboard_state_t root = s_worker.pending_state;
+        s_worker.has_request = false;
+        s_worker.searching = true;
+        s_worker.stop_flag = 0;
+        SDL_UnlockMutex(s_worker.lock);
+
+        void *move = get_best_move_stoppable(s_worker.engine->gd,
+                                             &root,
+                                             s_worker.engine->depth,
+                                             &s_worker.stop_flag,
+                                             s_worker.engine->my_cache);
+
+        bool cancelled = (s_worker.stop_flag != 0);
+        pushResultEvent(cancelled ? CHESS_ENGINE_SEARCH_CANCELLED
+                                  : CHESS_ENGINE_MOVE_READY,
+                        move);
+
+        SDL_LockMutex(s_worker.lock);
+        s_worker.searching = false;
+    }
+    SDL_UnlockMutex(s_worker.lock);
+
+    minimax_set_progress_callback(NULL, NULL);
+    TRACE_INFO(&stdtrace, "Engine worker terminato");
+    return 0;
+}
+
+/* ------------------------------------------------------------------
+   API chiamate dal thread della GUI
+   ------------------------------------------------------------------ */
+
+bool ChessEngineWorker_Start(ChessGameEngine *engine)
+{
+    if (!engine || !engine->gd) {
+        TRACE_ERROR(&stdtrace, "ChessEngineWorker_Start: engine non valido");
+        return false;
+    }
+    if (s_worker.thread) {
+        TRACE_ERROR(&stdtrace, "ChessEngineWorker_Start: worker già avviato");
+        return false;
+    }
+    if (ChessEngineWorker_EventType() == (Uint32)-1) {
+        return false;
+    }
+
+    s_worker.engine = engine;
+    s_worker.has_request = false;
+    s_worker.searching = false;
+    s_worker.quitting = false;
+    s_worker.stop_flag = 0;
+
+    s_worker.lock = SDL_CreateMutex();
+    s_worker.wakeup = SDL_CreateCond();
+    if (!s_worker.lock || !s_worker.wakeup) {
+        TRACE_ERROR(&stdtrace, "ChessEngineWorker_Start: %s", SDL_GetError());
+        if (s_worker.lock) SDL_DestroyMutex(s_worker.lock);
+        if (s_worker.wakeup) SDL_DestroyCond(s_worker.wakeup);
+        s_worker.lock = NULL;
+        s_worker.wakeup = NULL;
+        return false;
+    }
+
+    s_worker.thread = SDL_CreateThread(engineWorkerMain, "chess-engine", NULL);
+    if (!s_worker.thread) {
+        TRACE_ERROR(&stdtrace, "SDL_CreateThread fallita: %s", SDL_GetError());
+        SDL_DestroyMutex(s_worker.lock);
+        SDL_DestroyCond(s_worker.wakeup);
+        s_worker.lock = NULL;
+        s_worker.wakeup = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool ChessEngineWorker_RequestSearch(const bitboard_state_t *state)
+{
+    if (!state || !s_worker.thread) {
+        return false;
+    }
+
+    bool accepted = false;
+    SDL_LockMutex(s_worker.lock);
+    if (!s_worker.searching && !s_worker.has_request && !s_worker.quitting) {
+        s_worker.pending_state = *state;
+        s_worker.has_request = true;
+        accepted = true;
+        SDL_CondSignal(s_worker.wakeup);
+    }
+    SDL_UnlockMutex(s_worker.lock);
+
+    if (!accepted) {
+        TRACE_WARN(&stdtrace, "ChessEngineWorker_RequestSearch: worker occupato");
+    }
+    return accepted;
+}
+
+bool ChessEngineWorker_IsSearching(void)
+{
+    if (!s_worker.thread) {
+        return false;
+    }
+    SDL_LockMutex(s_worker.lock);
+    bool busy = s_worker.searching || s_worker.has_request;
+    SDL_UnlockMutex(s_worker.lock);
+    return busy;
+}
+
+void ChessEngineWorker_CancelSearch(void)
+{
+    if (!s_worker.thread) {
+        return;
+    }
+    SDL_LockMutex(s_worker.lock);
+    if (s_worker.searching) {
+        s_worker.stop_flag = 1;  /* minimax lo legge ogni TIME_CHECK_INTERVAL nodi */
+    }
+    s_worker.has_request = false; /* scarta anche una richiesta non ancora presa */
+    SDL_UnlockMutex(s_worker.lock);
+}
+
+void ChessEngineWorker_Shutdown(void)
+{
+    if (!s_worker.thread) {
+        return;
+    }
+
+    SDL_LockMutex(s_worker.lock);
+    s_worker.quitting = true;
+    s_worker.has_request = false;
+    s_worker.stop_flag = 1;      /* sblocca anche una ricerca in corso */
+    SDL_CondSignal(s_worker.wakeup);
+    SDL_UnlockMutex(s_worker.lock);
+
+    SDL_WaitThread(s_worker.thread, NULL);
+    s_worker.thread = NULL;
+
+    SDL_DestroyMutex(s_worker.lock);
+    SDL_DestroyCond(s_worker.wakeup);
+    s_worker.lock = NULL;
+    s_worker.wakeup = NULL;
+    s_worker.engine = NULL;
+}
@@ -0,0 +1,174 @@
+#ifndef CHESS_ENGINE_WORKER_H
+#define CHESS_ENGINE_WORKER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "obj_cache.h"
+#include "minimax.h"
+#include "chess_state.h"
+#include "chess_to_gui_interface.h"
+
+/**
+ * @file chess_engine_worker.h
+ * @brief Thread worker che disaccoppia il motore dal loop eventi SDL.
+ *
+ * Finché get_best_move gira sul thread della GUI la finestra è congelata:
+ * niente eventi, niente rendering, dialogo "non risponde" del sistema dopo
+ * pochi secondi a profondità 5+. Questo modulo sposta la ricerca su un
+ * thread SDL dedicato: la GUI INVIA una richiesta e torna subito a pompare
+ * eventi a pieno frame rate; quando il motore ha scelto, il worker pubblica
+ * un evento utente SDL (\ref ChessEngineWorker_EventType) che il loop
+ * eventi riceve come qualunque altro input.
+ *
+ * L'annullamento è agganciato al controllo di interruzione della ricerca
+ * (\ref get_best_move_stoppable): \ref ChessEngineWorker_CancelSearch alza
+ * un flag che minimax legge ogni TIME_CHECK_INTERVAL nodi, quindi la
+ * ricerca rientra in pochi millisecondi — serve per l'abbandono della
+ * partita, la chiusura della finestra o il "muovi subito".
+ *
+ * Uso tipico nel loop eventi:
+ * @code
+ *   ChessEngineWorker_Start(engine);
+ *   ...
+ *   // turno del motore: invia e NON bloccare
+ *   ChessEngineWorker_RequestSearch(engine->current_state);
+ *   ...
+ *   while (SDL_PollEvent(&ev)) {
+ *       if (ev.type == ChessEngineWorker_EventType()) {
+ *           if (ev.user.code == CHESS_ENGINE_SEARCH_PROGRESS) {
+ *               ChessEngineProgress *p = (ChessEngineProgress*)ev.user.data1;
+ *               char line[256];
+ *               ChessEngineWorker_FormatProgress(p, line, sizeof(line));
+ *               ChessGui_showUserMessage(renderer, line);  // pannello analisi
+ *               free(p);
+ *           } else {
+ *               chess_move_t *move = (chess_move_t*)ev.user.data1;
+ *               if (ev.user.code == CHESS_ENGINE_MOVE_READY && move) {
+ *                   // applica la mossa, aggiorna board/history
+ *               }
+ *               if (move) engine->gd->free_move(move);
+ *           }
+ *       }
+ *       ...
+ *   }
+ *   ...
+ *   ChessEngineWorker_Shutdown();
+ * @endcode
+ */
+
+/**
+ * @brief Codici dell'evento utente pubblicato dal worker (campo user.code).
+ */
+enum {
+    CHESS_ENGINE_MOVE_READY = 0,      /**< Ricerca completata: user.data1 è la
+                                           mossa scelta (chess_move_t*, da
+                                           liberare con gd->free_move). */
+    CHESS_ENGINE_SEARCH_CANCELLED = 1, /**< Ricerca annullata dal chiamante:
+                                           user.data1 è la miglior mossa
+                                           trovata fino a quel momento (può
+                                           essere NULL), da liberare comunque. */
+    CHESS_ENGINE_SEARCH_PROGRESS = 2  /**< Iterazione completata: user.data1 è
+                                           un ChessEngineProgress* (da liberare
+                                           con free). */
+};
+
+/**
+ * @struct ChessEngineProgress
+ * @brief Avanzamento della ricerca, pubblicato a ogni iterazione completata.
+ *
+ * Istantanea autosufficiente (la PV è già formattata in testo) così il
+ * worker può pubblicarla nel loop eventi senza condividere memoria con la
+ * ricerca. Oltre al pannello di analisi, il campo \c nps in diretta serve a
+ * riconoscere host rallentati (throttling termico, scheduling sbagliato)
+ * mentre il motore sta ancora pensando.
+ */
+typedef struct ChessEngineProgress_s {
+    int           depth;       /**< Profondità dell'iterazione completata. */
+    int           score;       /**< Punteggio (positivo = bianco avanti). */
+    unsigned long nodes;       /**< Nodi visitati finora. */
+    long          elapsed_ms;  /**< Millisecondi dall'avvio della ricerca. */
+    double        nps;         /**< Nodi al secondo finora. */
+    char          pv_text[128];/**< Linea principale in notazione "e2e4 e7e5 ...". */
+} ChessEngineProgress;
+
+/**
+ * @brief Formatta un ChessEngineProgress in una riga per il pannello di analisi.
+ *
+ * Esempio di output: "/bprof 7/r  +0.42  123456 nodi  890 kN/s  e2e4 e7e5 g1f3"
+ * (con i marcatori /b e /r per ChessGuiFont_DrawText).
+ *
+ * @param[in]  progress Avanzamento ricevuto con l'evento.
+ * @param[out] buf      Buffer di destinazione.
+ * @param[in]  buf_size Dimensione del buffer.
+ */
+void ChessEngineWorker_FormatProgress(const ChessEngineProgress *progress,
+                                      char *buf, size_t buf_size);
+
+/**
+ * @brief Tipo dell'evento utente SDL pubblicato dal worker.
+ *
+ * Registrato con SDL_RegisterEvents alla prima chiamata (o da
+ * \ref ChessEngineWorker_Start). Confrontare con event.type nel loop eventi.
+ *
+ * @return Il tipo registrato, o (Uint32)-1 se la registrazione è fallita.
+ */
+Uint32 ChessEngineWorker_EventType(void);
+
+/**
+ * @brief Avvia il thread worker del motore.
+ *
+ * Il worker resta in attesa (su condition variable, zero CPU) finché non
+ * arriva una richiesta. \p engine deve restare valido fino a
+ * \ref ChessEngineWorker_Shutdown; la cache del motore viene usata dal solo
+ * thread worker, quindi non serve la modalità thread-safe.
+ *
+ * @param[in] engine Motore inizializzato da ChessGui_init_game_engine.
+ * @return true se il thread è partito, false in caso di errore.
+ */
+bool ChessEngineWorker_Start(ChessGameEngine *engine);
+
+/**
+ * @brief Invia una richiesta di ricerca per \p state.
+ *
+ * Copia lo stato (il chiamante può continuare a modificare il suo) e
+ * sveglia il worker; il risultato arriverà come evento utente SDL. Una sola
+ * ricerca alla volta: se il worker è già occupato la richiesta è rifiutata.
+ *
+ * @param[in] state Posizione da cercare.
+ * @return true se la richiesta è stata accettata, false se il worker è
+ *         occupato o non avviato.
+ */
+bool ChessEngineWorker_RequestSearch(const bitboard_state_t *state);
+
+/**
+ * @brief Indica se una ricerca è in corso.
+ *
+ * Utile alla GUI per mostrare lo stato "sto pensando..." e per disabilitare
+ * l'input della scacchiera durante il turno del motore.
+ *
+ * @return true se il worker sta cercando, false altrimenti.
+ */
+bool ChessEngineWorker_IsSearching(void);
+
+/**
+ * @brief Annulla la ricerca in corso (non blocca).
+ *
+ * Alza il flag di stop letto dalla ricerca ogni TIME_CHECK_INTERVAL nodi:
+ * il worker pubblica entro pochi millisecondi un evento
+ * \ref CHESS_ENGINE_SEARCH_CANCELLED con la miglior mossa trovata fin lì.
+ * Senza ricerca in corso è un no-op.
+ */
+void ChessEngineWorker_CancelSearch(void);
+
+/**
+ * @brief Ferma il worker e attende la terminazione del thread.
+ *
+ * Annulla l'eventuale ricerca in corso (il join quindi è questione di
+ * millisecondi, non di minuti). L'eventuale evento già in coda resta al
+ * loop eventi, che deve liberarne la mossa come sempre.
+ */
+void ChessEngineWorker_Shutdown(void);
+
+#endif /* CHESS_ENGINE_WORKER_H */
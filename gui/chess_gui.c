@@ -34,6 +34,20 @@ static SDL_Texture* loadTexture(SDL_Renderer* renderer, const char* filePath)
 PiecesTexture_t PiecesTextures; // definizione della variabile globale
 SDL_Texture* BoardTexture = NULL; // definizione e inizializzazione a NULL
 
+/* ------------------------------------------------------------------
+   Atlas dei pezzi
+   ------------------------------------------------------------------
+   Una sola texture con tutti gli sprite già scalati alle due risoluzioni
+   usate (CELL_SIZE per la scacchiera, DEAD_PIECE_SIZE per i tray): il
+   disegno di un frame diventa una serie di SDL_RenderCopy dalla STESSA
+   texture, senza cambi di binding sulla GPU. Se la costruzione fallisce
+   (renderer senza render target) si continua con le texture singole.
+   ------------------------------------------------------------------ */
+
+static SDL_Texture* PieceAtlasTexture = NULL;
+static SDL_Rect PieceAtlasCell[CHESS_GUI_PIECE_COUNT]; // sorgente a CELL_SIZE
+static SDL_Rect PieceAtlasDead[CHESS_GUI_PIECE_COUNT]; // sorgente a DEAD_PIECE_SIZE
+
 // Definizione delle variabili globali per i colori
 static GuiColor LightColor = {222, 184, 135, 220};
 static GuiColor DarkColor  = {160,  82,  45, 220};
@@ -139,6 +153,84 @@ bool ChessGui_LoadAllTextures(SDL_Renderer* renderer)
 }
 
 
+/* ------------------------------------------------------------------
+   ChessGui_BuildPieceAtlas, ChessGui_DestroyPieceAtlas
+   ------------------------------------------------------------------ */
+
+void ChessGui_DestroyPieceAtlas(void)
+{
+    if (PieceAtlasTexture) {
+        SDL_DestroyTexture(PieceAtlasTexture);
+        PieceAtlasTexture = NULL;
+    }
+}
+
+bool ChessGui_BuildPieceAtlas(SDL_Renderer* renderer)
+{
+    ChessGui_DestroyPieceAtlas();
+
+    // Una colonna per pezzo (1..12); riga 0 a CELL_SIZE, riga 1 a DEAD_PIECE_SIZE
+    int atlas_w = (CHESS_GUI_PIECE_COUNT - 1) * CELL_SIZE;
+    int atlas_h = CELL_SIZE + DEAD_PIECE_SIZE;
+
+    PieceAtlasTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                          SDL_TEXTUREACCESS_TARGET,
+                                          atlas_w, atlas_h);
+    if (!PieceAtlasTexture) {
+        TRACE_ERROR(&stdtrace, "Impossibile creare l'atlas dei pezzi (%dx%d): %s",
+                    atlas_w, atlas_h, SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(PieceAtlasTexture, SDL_BLENDMODE_BLEND);
+
+    SDL_Texture* prevTarget = SDL_GetRenderTarget(renderer);
+    if (SDL_SetRenderTarget(renderer, PieceAtlasTexture) != 0) {
+        TRACE_ERROR(&stdtrace, "Render target non supportato: %s", SDL_GetError());
+        ChessGui_DestroyPieceAtlas();
+        return false;
+    }
+
+    // Sfondo trasparente
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    bool success = true;
+    for (int e = 1; e < CHESS_GUI_PIECE_COUNT; e++) {
+        SDL_Texture* tex = PiecesTextures.textures[e];
+        if (!tex) {
+            TRACE_ERROR(&stdtrace, "Atlas: texture mancante per il pezzo e=%d", e);
+            success = false;
+            continue;
+        }
+
+        int slot = e - 1;
+        PieceAtlasCell[e].x = slot * CELL_SIZE;
+        PieceAtlasCell[e].y = 0;
+        PieceAtlasCell[e].w = CELL_SIZE;
+        PieceAtlasCell[e].h = CELL_SIZE;
+
+        PieceAtlasDead[e].x = slot * CELL_SIZE;
+        PieceAtlasDead[e].y = CELL_SIZE;
+        PieceAtlasDead[e].w = DEAD_PIECE_SIZE;
+        PieceAtlasDead[e].h = DEAD_PIECE_SIZE;
+
+        // Lo sprite viene scalato UNA volta qui, non ad ogni frame
+        SDL_RenderCopy(renderer, tex, NULL, &PieceAtlasCell[e]);
+        SDL_RenderCopy(renderer, tex, NULL, &PieceAtlasDead[e]);
+    }
+
+    SDL_SetRenderTarget(renderer, prevTarget);
+
+    if (!success) {
+        ChessGui_DestroyPieceAtlas();
+        return false;
+    }
+
+    TRACE_DEBUG(&stdtrace, "Atlas dei pezzi costruito (%dx%d)", atlas_w, atlas_h);
+    return true;
+}
+
+
 /* ------------------------------------------------------------------
    getTextureByName, getBoardTexture
    ------------------------------------------------------------------ */
@@ -199,6 +291,8 @@ bool initMainWindow(SDL_Window** window, SDL_Renderer** renderer) {
 }
 
 void closeSDL(SDL_Window* window, SDL_Renderer* renderer) {
+    // L'atlas va distrutto prima del renderer a cui appartiene
+    ChessGui_DestroyPieceAtlas();
     if (renderer) {
         SDL_DestroyRenderer(renderer);
     }
@@ -246,19 +340,25 @@ void drawSinglePiece(SDL_Renderer* renderer, ChessGuiPieces_t chessPiece, int ro
         return;
     }
 
-    // Otteniamo la texture del pezzo
-    SDL_Texture* tex = getTextureByName(chessPiece);
-    if (!tex) {
-        // Nessuna texture caricata? Non disegna
-        return;
-    }
-
     SDL_Rect dst;
     dst.x = BOARD_X + OFFSET + col * CELL_SIZE;
     dst.y = BOARD_Y + OFFSET + row * CELL_SIZE;
     dst.w = CELL_SIZE;
     dst.h = CELL_SIZE;
 
+    // Percorso veloce: sprite già scalato dentro l'atlas (nessun cambio di texture)
+    if (PieceAtlasTexture) {
+        SDL_RenderCopy(renderer, PieceAtlasTexture, &PieceAtlasCell[chessPiece], &dst);
+        return;
+    }
+
+    // Fallback: texture singola del pezzo
+    SDL_Texture* tex = getTextureByName(chessPiece);
+    if (!tex) {
+        // Nessuna texture caricata? Non disegna
+        return;
+    }
+
     SDL_RenderCopy(renderer, tex, NULL, &dst);
 }
 
@@ -274,6 +374,34 @@ void drawPieces(SDL_Renderer* renderer, const ChessGuiBoard_t board)
     }
 }
 
+void drawDirtySquares(SDL_Renderer* renderer, const ChessGuiBoard_t board,
+                      const ChessGuiDirtySquares_t *dirty,
+                      GuiColor lightColor, GuiColor darkColor)
+{
+    if (!dirty) {
+        return;
+    }
+
+    for (int i = 0; i < dirty->count; i++) {
+        int row = dirty->row[i];
+        int col = dirty->col[i];
+
+        // 1) Ripristino il colore della casella (stessa parità di drawBoardEmpty)
+        bool isDark = ((row + col) % 2 == 0);
+        GuiColor c = isDark ? darkColor : lightColor;
+
+        SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+
+        int x = BOARD_X + OFFSET + col * CELL_SIZE;
+        int y = BOARD_Y + OFFSET + row * CELL_SIZE;
+        SDL_Rect squareRect = { x, y, CELL_SIZE, CELL_SIZE };
+        SDL_RenderFillRect(renderer, &squareRect);
+
+        // 2) Ridisegno l'eventuale pezzo sulla casella
+        drawSinglePiece(renderer, board[row][col], row, col);
+    }
+}
+
 void drawDeadPiecesTray(SDL_Renderer* renderer, const ChessGuiDeadPieces_t *dp)
 {
     // Esempio di aree orizzontali per bianchi e neri
@@ -292,15 +420,20 @@ void drawDeadPiecesTray(SDL_Renderer* renderer, const ChessGuiDeadPieces_t *dp)
     for (int i = 0; i < GUI_MAX_DEAD_PIECES; i++) {
         ChessGuiPieces_t piece = dp->dead[GUI_WHITE_PLAYER][i];
         if (piece != CHESS_GUI_EMPTY) {
-            SDL_Texture* tex = getTextureByName(piece);
-            if (tex) {
-                SDL_Rect dst = {
-                    DEAD_WHITE_X + i * DEAD_PIECE_SIZE,
-                    DEAD_WHITE_Y,
-                    DEAD_PIECE_SIZE,
-                    DEAD_PIECE_SIZE
-                };
-                SDL_RenderCopy(renderer, tex, NULL, &dst);
+            SDL_Rect dst = {
+                DEAD_WHITE_X + i * DEAD_PIECE_SIZE,
+                DEAD_WHITE_Y,
+                DEAD_PIECE_SIZE,
+                DEAD_PIECE_SIZE
+            };
+            if (PieceAtlasTexture) {
+                // Sprite già alla risoluzione DEAD_PIECE_SIZE dentro l'atlas
+                SDL_RenderCopy(renderer, PieceAtlasTexture, &PieceAtlasDead[piece], &dst);
+            } else {
+                SDL_Texture* tex = getTextureByName(piece);
+                if (tex) {
+                    SDL_RenderCopy(renderer, tex, NULL, &dst);
+                }
             }
         }
     }
@@ -309,15 +442,19 @@ void drawDeadPiecesTray(SDL_Renderer* renderer, const ChessGuiDeadPieces_t *dp)
     for (int i = 0; i < GUI_MAX_DEAD_PIECES; i++) {
         ChessGuiPieces_t piece = dp->dead[GUI_BLACK_PLAYER][i];
         if (piece != CHESS_GUI_EMPTY) {
-            SDL_Texture* tex = getTextureByName(piece);
-            if (tex) {
-                SDL_Rect dst = {
-                    DEAD_BLACK_X + i * DEAD_PIECE_SIZE,
-                    DEAD_BLACK_Y,
-                    DEAD_PIECE_SIZE,
-                    DEAD_PIECE_SIZE
-                };
-                SDL_RenderCopy(renderer, tex, NULL, &dst);
+            SDL_Rect dst = {
+                DEAD_BLACK_X + i * DEAD_PIECE_SIZE,
+                DEAD_BLACK_Y,
+                DEAD_PIECE_SIZE,
+                DEAD_PIECE_SIZE
+            };
+            if (PieceAtlasTexture) {
+                SDL_RenderCopy(renderer, PieceAtlasTexture, &PieceAtlasDead[piece], &dst);
+            } else {
+                SDL_Texture* tex = getTextureByName(piece);
+                if (tex) {
+                    SDL_RenderCopy(renderer, tex, NULL, &dst);
+                }
             }
         }
     }
@@ -167,6 +167,35 @@ extern SDL_Texture* BoardTexture;
 bool ChessGui_LoadAllTextures(SDL_Renderer* renderer);
 
 
+/**
+ * @brief Costruisce l'atlas dei pezzi a partire dalle texture già caricate.
+ *
+ * Renderizza tutti gli sprite (1..CHESS_GUI_PIECE_COUNT-1) in UNA texture,
+ * già scalati alle due risoluzioni usate a runtime (\c CELL_SIZE per la
+ * scacchiera, \c DEAD_PIECE_SIZE per i tray dei pezzi morti). Da quel
+ * momento `drawSinglePiece` e `drawDeadPiecesTray` disegnano con
+ * SDL_RenderCopy dalla stessa texture: niente cambi di binding né scaling
+ * per-frame sulla GPU.
+ *
+ * Da chiamare dopo \ref ChessGui_LoadAllTextures. Se fallisce (es. il
+ * renderer non supporta i render target) le funzioni di disegno continuano
+ * a usare le texture singole.
+ *
+ * @param renderer Il renderer SDL (deve supportare SDL_TEXTUREACCESS_TARGET).
+ * @return \c true se l'atlas è pronto, \c false in caso di errore.
+ */
+bool ChessGui_BuildPieceAtlas(SDL_Renderer* renderer);
+
+
+/**
+ * @brief Distrugge l'atlas dei pezzi (se costruito).
+ *
+ * Invocata automaticamente da \ref closeSDL prima di distruggere il
+ * renderer; può essere chiamata per tornare al percorso a texture singole.
+ */
+void ChessGui_DestroyPieceAtlas(void);
+
+
 /**
  * @brief Restituisce la texture associata al pezzo indicato.
  *
@@ -262,6 +291,25 @@ void drawSinglePiece(SDL_Renderer* renderer, ChessGuiPieces_t chessPiece, int ro
 void drawPieces(SDL_Renderer* renderer, const ChessGuiBoard_t board);
 
 
+/**
+ * @brief Ridisegna le sole caselle toccate dall'ultima mossa.
+ *
+ * Per ogni casella della lista \p dirty (riempita da
+ * `ChessGuiBoard_ApplyMoveDiff`) ripristina il colore della casella e
+ * ridisegna l'eventuale pezzo: al massimo 4 caselle invece delle 64 di
+ * `drawBoardEmpty` + `drawPieces`.
+ *
+ * @param renderer    Il renderer SDL.
+ * @param board       La matrice 8x8 GIÀ aggiornata dopo la mossa.
+ * @param dirty       La lista delle caselle cambiate.
+ * @param lightColor  Colore delle caselle “chiare”.
+ * @param darkColor   Colore delle caselle “scure”.
+ */
+void drawDirtySquares(SDL_Renderer* renderer, const ChessGuiBoard_t board,
+                      const ChessGuiDirtySquares_t *dirty,
+                      GuiColor lightColor, GuiColor darkColor);
+
+
 /**
  * @brief Disegna i dead pieces (bianchi e neri) contenuti in una struttura 2xN.
  *
@@ -6,67 +6,245 @@
 static const char* gRegularFontPath = "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf";
 static const char* gBoldFontPath    = "/usr/share/fonts/truetype/liberation/LiberationSans-Bold.ttf";
 
+/* ------------------------------------------------------------------
+   Cache dei font aperti
+   ------------------------------------------------------------------
+   TTF_OpenFont legge e parsa il .ttf da disco: farlo ad ogni chiamata di
+   ChessGuiFont_DrawText (fino a 7 volte per riga di history) domina il
+   costo del frame. Teniamo aperta una coppia regular/bold per ogni
+   dimensione usata; la GUI ne usa due (TEXT_FONT_SIZE e
+   HISTORY_FONT_SIZE), 8 slot sono abbondanti.
+   ------------------------------------------------------------------ */
+
+#define FONT_CACHE_SIZE 8
+
+typedef struct CachedFontPair_s {
+    int       size;   /**< Dimensione in pixel (0 = slot libero). */
+    TTF_Font* reg;    /**< Font regular aperto a quella dimensione. */
+    TTF_Font* bold;   /**< Font bold aperto a quella dimensione. */
+} CachedFontPair;
+
+static CachedFontPair s_fonts[FONT_CACHE_SIZE];
+
 /**
- * @brief Inizializza SDL_ttf se non già avviato.
+ * @brief Restituisce la coppia regular/bold per \p fontSize, aprendola
+ *        (e mettendola in cache) alla prima richiesta.
+ *
+ * @return Puntatore alla coppia, o NULL se i font non si aprono.
  */
-void ChessGuiFont_Init(void)
+static CachedFontPair* getFontPair(int fontSize)
 {
-    if (TTF_WasInit() == 0) {
-        if (TTF_Init() == -1) {
-            printf("Errore TTF_Init: %s\n", TTF_GetError());
-            // In un programma reale potresti decidere di uscire o gestire l'errore diversamente
+    int free_slot = -1;
+
+    for (int i = 0; i < FONT_CACHE_SIZE; i++) {
+        if (s_fonts[i].size == fontSize) {
+            return &s_fonts[i];
+        }
+        if (s_fonts[i].size == 0 && free_slot < 0) {
+            free_slot = i;
         }
     }
+
+    // Cache piena: rimpiazziamo lo slot 0 (non succede con 2 dimensioni in uso)
+    if (free_slot < 0) {
+        free_slot = 0;
+        if (s_fonts[0].reg)  TTF_CloseFont(s_fonts[0].reg);
+        if (s_fonts[0].bold) TTF_CloseFont(s_fonts[0].bold);
+        memset(&s_fonts[0], 0, sizeof(s_fonts[0]));
+    }
+
+    TTF_Font* reg  = TTF_OpenFont(gRegularFontPath, fontSize);
+    TTF_Font* bold = TTF_OpenFont(gBoldFontPath,    fontSize);
+    if (!reg || !bold) {
+        printf("Impossibile caricare i font reg/bold dimensione %d\n", fontSize);
+        if (reg)  TTF_CloseFont(reg);
+        if (bold) TTF_CloseFont(bold);
+        return NULL;
+    }
+
+    s_fonts[free_slot].size = fontSize;
+    s_fonts[free_slot].reg  = reg;
+    s_fonts[free_slot].bold = bold;
+    return &s_fonts[free_slot];
 }
 
+/* ------------------------------------------------------------------
+   Cache delle stringhe renderizzate
+   ------------------------------------------------------------------
+   TTF_RenderUTF8_Blended + SDL_CreateTextureFromSurface creano (e
+   distruggevano) una texture per OGNI chunk ad ogni frame. Il pannello
+   history ridisegna sempre le stesse stringhe: le teniamo in una piccola
+   cache a rimpiazzo LRU, così il frame diventa una serie di
+   SDL_RenderCopy di texture già pronte.
+   ------------------------------------------------------------------ */
+
+#define TEXT_CACHE_SIZE    128
+#define TEXT_CACHE_MAX_LEN 64
+
+typedef struct CachedString_s {
+    char          text[TEXT_CACHE_MAX_LEN]; /**< Testo renderizzato ("" = slot libero). */
+    int           fontSize;                 /**< Dimensione del font. */
+    bool          bold;                     /**< true se renderizzato in bold. */
+    SDL_Texture*  tex;                      /**< Texture pronta per RenderCopy. */
+    int           w, h;                     /**< Dimensioni in pixel della texture. */
+    unsigned long stamp;                    /**< Contatore d'uso per l'LRU. */
+} CachedString;
+
+static CachedString  s_strings[TEXT_CACHE_SIZE];
+static unsigned long s_stamp = 0;
+static SDL_Renderer* s_cache_renderer = NULL;
+
 /**
- * @brief Chiude SDL_ttf se risulta avviato.
+ * @brief Svuota la cache delle stringhe, distruggendo le texture.
  */
-void ChessGuiFont_Quit(void)
+static void flushStringCache(void)
 {
-    if (TTF_WasInit() != 0) {
-        TTF_Quit();
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        if (s_strings[i].tex) {
+            SDL_DestroyTexture(s_strings[i].tex);
+        }
     }
+    memset(s_strings, 0, sizeof(s_strings));
+    s_cache_renderer = NULL;
 }
 
 /**
- * @brief Funzione di supporto per disegnare un pezzo di testo con un TTF_Font* 
- *        e restituire la larghezza in pixel.
+ * @brief Renderizza \p chunk in una nuova texture (non in cache).
+ *
+ * @return La texture (da distruggere o mettere in cache a carico del
+ *         chiamante), o NULL in caso di errore; \p w_out / \p h_out
+ *         ricevono le dimensioni.
  */
-static int drawChunk(SDL_Renderer* renderer, TTF_Font* font,
-                     const char* chunk, int x, int y)
+static SDL_Texture* renderChunkTexture(SDL_Renderer* renderer, TTF_Font* font,
+                                       const char* chunk, int* w_out, int* h_out)
 {
-    if (!chunk || !*chunk) {
-        return 0;
-    }
-
     // Colore bianco
     SDL_Color white = {255, 255, 255, 255};
 
-    // Crea surface
     SDL_Surface* surf = TTF_RenderUTF8_Blended(font, chunk, white);
     if (!surf) {
         printf("Errore TTF_RenderUTF8_Blended: %s\n", TTF_GetError());
-        return 0;
+        return NULL;
     }
 
-    // Crea texture
     SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surf);
     if (!tex) {
         printf("Errore SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
         SDL_FreeSurface(surf);
-        return 0;
+        return NULL;
     }
 
-    int w = surf->w;
-    int h = surf->h;
+    *w_out = surf->w;
+    *h_out = surf->h;
     SDL_FreeSurface(surf);
+    return tex;
+}
+
+/**
+ * @brief Funzione di supporto per disegnare un pezzo di testo e
+ *        restituire la larghezza in pixel.
+ *
+ * Passa dalla cache delle stringhe quando il chunk ci sta
+ * (< TEXT_CACHE_MAX_LEN caratteri); i chunk più lunghi vengono
+ * renderizzati e distrutti al volo come una volta.
+ */
+static int drawChunk(SDL_Renderer* renderer, TTF_Font* font,
+                     const char* chunk, int x, int y, int fontSize, bool isBold)
+{
+    if (!chunk || !*chunk) {
+        return 0;
+    }
+
+    // Le texture appartengono a un renderer: se cambia, ripartiamo da zero
+    if (s_cache_renderer != renderer) {
+        flushStringCache();
+        s_cache_renderer = renderer;
+    }
+
+    s_stamp++;
 
+    if (strlen(chunk) < TEXT_CACHE_MAX_LEN) {
+        // 1) Cerca in cache, tenendo traccia dello slot LRU per l'eventuale miss
+        int lru = 0;
+        for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+            CachedString* cs = &s_strings[i];
+            if (cs->tex && cs->fontSize == fontSize && cs->bold == isBold &&
+                strcmp(cs->text, chunk) == 0) {
+                cs->stamp = s_stamp;
+                SDL_Rect dst = { x, y, cs->w, cs->h };
+                SDL_RenderCopy(renderer, cs->tex, NULL, &dst);
+                return cs->w;
+            }
+            if (cs->stamp < s_strings[lru].stamp) {
+                lru = i;
+            }
+        }
+
+        // 2) Miss: renderizza e rimpiazza lo slot usato meno di recente
+        int w = 0, h = 0;
+        SDL_Texture* tex = renderChunkTexture(renderer, font, chunk, &w, &h);
+        if (!tex) {
+            return 0;
+        }
+
+        CachedString* cs = &s_strings[lru];
+        if (cs->tex) {
+            SDL_DestroyTexture(cs->tex);
+        }
+        strcpy(cs->text, chunk);
+        cs->fontSize = fontSize;
+        cs->bold     = isBold;
+        cs->tex      = tex;
+        cs->w        = w;
+        cs->h        = h;
+        cs->stamp    = s_stamp;
+
+        SDL_Rect dst = { x, y, w, h };
+        SDL_RenderCopy(renderer, tex, NULL, &dst);
+        return w;
+    }
+
+    // Chunk troppo lungo per la cache: percorso non cachato
+    int w = 0, h = 0;
+    SDL_Texture* tex = renderChunkTexture(renderer, font, chunk, &w, &h);
+    if (!tex) {
+        return 0;
+    }
     SDL_Rect dst = { x, y, w, h };
     SDL_RenderCopy(renderer, tex, NULL, &dst);
-
     SDL_DestroyTexture(tex);
-    return w; // larghezza orizzontale effettiva
+    return w;
+}
+
+/**
+ * @brief Inizializza SDL_ttf se non già avviato.
+ */
+void ChessGuiFont_Init(void)
+{
+    if (TTF_WasInit() == 0) {
+        if (TTF_Init() == -1) {
+            printf("Errore TTF_Init: %s\n", TTF_GetError());
+            // In un programma reale potresti decidere di uscire o gestire l'errore diversamente
+        }
+    }
+}
+
+/**
+ * @brief Chiude SDL_ttf se risulta avviato, liberando font e texture in cache.
+ */
+void ChessGuiFont_Quit(void)
+{
+    flushStringCache();
+
+    for (int i = 0; i < FONT_CACHE_SIZE; i++) {
+        if (s_fonts[i].reg)  TTF_CloseFont(s_fonts[i].reg);
+        if (s_fonts[i].bold) TTF_CloseFont(s_fonts[i].bold);
+    }
+    memset(s_fonts, 0, sizeof(s_fonts));
+
+    if (TTF_WasInit() != 0) {
+        TTF_Quit();
+    }
 }
 
 /**
@@ -79,18 +257,14 @@ int ChessGuiFont_DrawText(SDL_Renderer* renderer, const char* text,
         return 0;
     }
 
-    // Carichiamo i due font (regular e bold) nella dimensione richiesta
-    TTF_Font* fontReg = TTF_OpenFont(gRegularFontPath, fontSize);
-    TTF_Font* fontBold= TTF_OpenFont(gBoldFontPath,    fontSize);
-    if (!fontReg || !fontBold) {
-        printf("Impossibile caricare i font reg/bold dimensione %d\n", fontSize);
-        if (fontReg)  TTF_CloseFont(fontReg);
-        if (fontBold) TTF_CloseFont(fontBold);
+    // Coppia regular/bold dalla cache (aperta alla prima richiesta)
+    CachedFontPair* pair = getFontPair(fontSize);
+    if (!pair) {
         return 0;
-    }  
+    }
 
     // Partiamo con font regular è il font senza /b o /r
-    TTF_Font* currentFont = fontReg;
+    bool isBold = false;
 
     char chunk[1024];
     memset(chunk, 0, sizeof(chunk));
@@ -103,16 +277,13 @@ int ChessGuiFont_DrawText(SDL_Renderer* renderer, const char* text,
         if (*p == '/' && (*(p+1) == 'b' || *(p+1) == 'r')) {
             // Disegniamo ciò che abbiamo accumulato finora
             if (chunk[0] != '\0') {
-                int w = drawChunk(renderer, currentFont, chunk, outX, y);
+                int w = drawChunk(renderer, isBold ? pair->bold : pair->reg,
+                                  chunk, outX, y, fontSize, isBold);
                 outX += w;
                 memset(chunk, 0, sizeof(chunk));
             }
             // Cambiamo font
-            if (*(p+1) == 'b') {
-                currentFont = fontBold;
-            } else {
-                currentFont = fontReg;
-            }
+            isBold = (*(p+1) == 'b');
             // Saltiamo /b o /r
             p += 2;
         }
@@ -129,33 +300,24 @@ int ChessGuiFont_DrawText(SDL_Renderer* renderer, const char* text,
 
     // Disegna eventuale chunk rimasto
     if (chunk[0] != '\0') {
-        int w = drawChunk(renderer, currentFont, chunk, outX, y);
+        int w = drawChunk(renderer, isBold ? pair->bold : pair->reg,
+                          chunk, outX, y, fontSize, isBold);
         outX += w;
     }
 
-    // Chiudiamo i font
-    TTF_CloseFont(fontReg);
-    TTF_CloseFont(fontBold);
-
     return outX - x; // larghezza orizzontale disegnata
 }
 
 
 int ChessGuiFont_GetLineHeight(int fontSize)
 {
-    // Carichiamo i font regular e bold, uno dei due è sufficiente per calcolare l'altezza
-    // (oppure solo regular)
-    static const char* regFontPath = "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf";
-    TTF_Font* font = TTF_OpenFont(regFontPath, fontSize);
-    if (!font) {
+    // Usa il font regular in cache (aperto alla prima richiesta)
+    CachedFontPair* pair = getFontPair(fontSize);
+    if (!pair) {
         // fallback
         return fontSize;
     }
 
     // Chiediamo a SDL_ttf l'altezza
-    int height = TTF_FontHeight(font);
-
-    TTF_CloseFont(font);
-    return height;
+    return TTF_FontHeight(pair->reg);
 }
-
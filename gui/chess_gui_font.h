@@ -15,7 +15,9 @@ void ChessGuiFont_Init(void);
 /**
  * @brief Chiude il modulo di gestione font, arrestando SDL_ttf (se avviato).
  *
- * Da chiamare al termine del programma, se non viene gestito altrove.
+ * Libera anche i font tenuti aperti e le texture di testo in cache, quindi
+ * va chiamata PRIMA di distruggere il renderer. Da chiamare al termine del
+ * programma, se non viene gestito altrove.
  */
 void ChessGuiFont_Quit(void);
 
@@ -27,11 +29,16 @@ void ChessGuiFont_Quit(void);
  * @param text      Stringa (può contenere /b e /r per switchare i font).
  * @param x         Coordinata X di partenza.
  * @param y         Coordinata Y di partenza.
- * @param fontSize  Dimensione (in pixel) dei font. 
- *                  Verranno caricati LiberationSans-Regular/Bold in questa dimensione.
+ * @param fontSize  Dimensione (in pixel) dei font.
+ *                  LiberationSans-Regular/Bold vengono aperti alla prima
+ *                  richiesta di questa dimensione e poi tenuti in cache.
  *
  * @return Larghezza (in pixel) complessiva di quanto disegnato.
  *
+ * Le stringhe renderizzate vengono tenute in una piccola cache LRU di
+ * texture, così ridisegnare lo stesso testo (es. il pannello history) non
+ * rasterizza nulla. La cache viene svuotata da ChessGuiFont_Quit().
+ *
  * Esempio:
  * \code
  *   ChessGuiFont_DrawText(renderer, "Ciao /bMondo/r!", 50, 100, 14);
@@ -173,5 +173,117 @@ bool game_history_get_move(int index, move_record_t* outRecord)
     return true;
 }
 
+// ----------------------------------------------------------------------
+// Conversione bitboard -> matrice GUI e aggiornamento incrementale
+// ----------------------------------------------------------------------
+
+/**
+ * @brief Converte una casella del motore (0=a1 .. 63=h8) in riga GUI [0..7].
+ *
+ * La GUI ha la riga 0 in alto (ottava traversa), il motore la casella 0
+ * in basso a sinistra (a1).
+ */
+static inline int gui_row_from_square(int sq) { return 7 - (sq / 8); }
+
+/** @brief Colonna GUI [0..7] di una casella del motore. */
+static inline int gui_col_from_square(int sq) { return sq % 8; }
+
+ChessGuiPieces_t ChessGui_PieceAt(const bitboard_state_t *state, int row, int col)
+{
+    if (!state) return CHESS_GUI_EMPTY;
+    if (row < 0 || row > 7 || col < 0 || col > 7) return CHESS_GUI_EMPTY;
+
+    uint64_t mask = 1ULL << ((7 - row) * 8 + col);
+
+    if (state->white_pawns   & mask) return CHESS_GUI_PAWN_WHITE;
+    if (state->white_rooks   & mask) return CHESS_GUI_ROOK_WHITE;
+    if (state->white_knights & mask) return CHESS_GUI_KNIGHT_WHITE;
+    if (state->white_bishops & mask) return CHESS_GUI_BISHOP_WHITE;
+    if (state->white_queens  & mask) return CHESS_GUI_QUEEN_WHITE;
+    if (state->white_kings   & mask) return CHESS_GUI_KING_WHITE;
+    if (state->black_pawns   & mask) return CHESS_GUI_PAWN_BLACK;
+    if (state->black_rooks   & mask) return CHESS_GUI_ROOK_BLACK;
+    if (state->black_knights & mask) return CHESS_GUI_KNIGHT_BLACK;
+    if (state->black_bishops & mask) return CHESS_GUI_BISHOP_BLACK;
+    if (state->black_queens  & mask) return CHESS_GUI_QUEEN_BLACK;
+    if (state->black_kings   & mask) return CHESS_GUI_KING_BLACK;
+
+    return CHESS_GUI_EMPTY;
+}
+
+void ChessGuiBoard_FromBitboards(const bitboard_state_t *state, ChessGuiBoard_t board)
+{
+    for (int r = 0; r < 8; r++) {
+        for (int c = 0; c < 8; c++) {
+            board[r][c] = ChessGui_PieceAt(state, r, c);
+        }
+    }
+}
+
+/**
+ * @brief Aggiunge la casella del motore \p sq alla lista dirty (se c'è spazio).
+ */
+static void dirty_add_square(ChessGuiDirtySquares_t *dirty, int sq)
+{
+    if (dirty->count >= GUI_MAX_DIRTY_SQUARES) return;
+    dirty->row[dirty->count] = gui_row_from_square(sq);
+    dirty->col[dirty->count] = gui_col_from_square(sq);
+    dirty->count++;
+}
+
+void ChessGuiBoard_ApplyMoveDiff(ChessGuiBoard_t board,
+                                 const bitboard_state_t *state_after,
+                                 const chess_move_t *move,
+                                 ChessGuiDirtySquares_t *dirty,
+                                 ChessGuiPieces_t *captured_out)
+{
+    ChessGuiPieces_t captured = CHESS_GUI_EMPTY;
+
+    dirty->count = 0;
+    if (!state_after || !move) {
+        if (captured_out) *captured_out = CHESS_GUI_EMPTY;
+        return;
+    }
+
+    dirty_add_square(dirty, move->from);
+    dirty_add_square(dirty, move->to);
+
+    if (move->is_castling) {
+        // La torre: con il re su e1/e8, arrocco corto => h->f, lungo => a->d
+        // (stessa traversa del re).
+        int rank_base = (move->from / 8) * 8;
+        if (move->to > move->from) {
+            dirty_add_square(dirty, rank_base + 7);   // torre da h1/h8
+            dirty_add_square(dirty, rank_base + 5);   // torre su f1/f8
+        } else {
+            dirty_add_square(dirty, rank_base + 0);   // torre da a1/a8
+            dirty_add_square(dirty, rank_base + 3);   // torre su d1/d8
+        }
+    } else if (move->is_en_passant) {
+        // Il pedone catturato sta sulla colonna di arrivo e sulla traversa
+        // di partenza del pedone che cattura.
+        dirty_add_square(dirty, (move->from / 8) * 8 + (move->to % 8));
+    }
+
+    // Pezzo catturato: letto dalla matrice PRIMA di riallinearla. Per l'en
+    // passant la casella di arrivo è vuota, il pedone è sull'ultima casella
+    // aggiunta alla lista.
+    if (move->is_en_passant) {
+        int idx = dirty->count - 1;
+        captured = board[dirty->row[idx]][dirty->col[idx]];
+    } else if (!move->is_castling) {
+        captured = board[gui_row_from_square(move->to)][gui_col_from_square(move->to)];
+    }
+
+    // Riallineamento: ogni casella toccata viene riletta dai bitboard dello
+    // stato DOPO la mossa, così promozioni e flag particolari sono sempre
+    // coerenti con il motore.
+    for (int i = 0; i < dirty->count; i++) {
+        board[dirty->row[i]][dirty->col[i]] =
+            ChessGui_PieceAt(state_after, dirty->row[i], dirty->col[i]);
+    }
+
+    if (captured_out) *captured_out = captured;
+}
 
 
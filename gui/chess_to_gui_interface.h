@@ -6,6 +6,10 @@
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 
+#include "minimax.h"       // game_descriptor_t (e obj_cache.h per la cache)
+#include "chess_state.h"   // bitboard_state_t
+#include "chess_moves.h"   // chess_move_t
+
 
 /**
  * @enum ChessGuiPieces_t
@@ -127,6 +131,77 @@ typedef ChessGuiPieces_t ChessGuiBoard_t[8][8];
 void ChessGuiBoard_InitStandardArrangement(ChessGuiBoard_t board);
 
 
+/**
+ * @brief Numero massimo di caselle toccate da una singola mossa.
+ *
+ * Caso peggiore: arrocco (re da, re a, torre da, torre a). L'en passant ne
+ * tocca 3, una mossa ordinaria 2.
+ */
+#define GUI_MAX_DIRTY_SQUARES 4
+
+/**
+ * @struct ChessGuiDirtySquares_t
+ * @brief Lista delle caselle cambiate dall'ultima mossa ("dirty squares").
+ *
+ * Riempita da \ref ChessGuiBoard_ApplyMoveDiff: il renderer ridisegna solo
+ * queste caselle invece dell'intera scacchiera (O(mossa) invece di
+ * O(scacchiera)), e la contabilità di pezzi morti/history usa il pezzo
+ * catturato riportato dalla stessa chiamata.
+ */
+typedef struct ChessGuiDirtySquares_s {
+    int count;                        /**< Numero di caselle valide (0..4). */
+    int row[GUI_MAX_DIRTY_SQUARES];   /**< Riga [0..7] di ogni casella.     */
+    int col[GUI_MAX_DIRTY_SQUARES];   /**< Colonna [0..7] di ogni casella.  */
+} ChessGuiDirtySquares_t;
+
+/**
+ * @brief Pezzo GUI presente su (row, col) secondo i bitboard del motore.
+ *
+ * Convenzione della GUI: riga 0 in alto = ottava traversa, colonna 0 = 'a';
+ * il motore numera le case da 0 = a1 a 63 = h8.
+ *
+ * @param state Stato del motore.
+ * @param row   Riga GUI [0..7] (0 = in alto).
+ * @param col   Colonna GUI [0..7] (0 = colonna 'a').
+ * @return Il ChessGuiPieces_t sulla casella, o CHESS_GUI_EMPTY.
+ */
+ChessGuiPieces_t ChessGui_PieceAt(const bitboard_state_t *state, int row, int col);
+
+/**
+ * @brief Ricostruisce l'intera matrice GUI 8×8 dai 12 bitboard del motore.
+ *
+ * Percorso "lento" (O(scacchiera)): da usare all'avvio della partita e come
+ * riallineamento di sicurezza; per la mossa singola usare
+ * \ref ChessGuiBoard_ApplyMoveDiff.
+ *
+ * @param state Stato del motore.
+ * @param board Matrice GUI da riempire.
+ */
+void ChessGuiBoard_FromBitboards(const bitboard_state_t *state, ChessGuiBoard_t board);
+
+/**
+ * @brief Aggiorna la matrice GUI per differenza dopo una mossa.
+ *
+ * Deduce dalla chess_move_t le sole caselle toccate (partenza, arrivo, più
+ * la torre per l'arrocco o il pedone catturato per l'en passant), le
+ * riallinea leggendo i bitboard di \p state_after e riempie \p dirty con la
+ * lista per il ridisegno parziale. In \p captured_out (se non NULL) viene
+ * riportato il pezzo catturato com'era sulla matrice PRIMA
+ * dell'aggiornamento, pronto per ChessGuiDeadPieces_SetPiece e per la
+ * move_record_t della history.
+ *
+ * @param board        Matrice GUI da aggiornare (stato prima della mossa).
+ * @param state_after  Stato del motore DOPO la mossa applicata.
+ * @param move         Mossa applicata.
+ * @param dirty        Lista delle caselle cambiate (sempre riempita).
+ * @param captured_out Pezzo catturato o CHESS_GUI_EMPTY (può essere NULL).
+ */
+void ChessGuiBoard_ApplyMoveDiff(ChessGuiBoard_t board,
+                                 const bitboard_state_t *state_after,
+                                 const chess_move_t *move,
+                                 ChessGuiDirtySquares_t *dirty,
+                                 ChessGuiPieces_t *captured_out);
+
 /**
  * @struct ChessGuiDeadPieces_t
  * @brief Struttura che contiene i pezzi "morti" per i due colori (white, black).
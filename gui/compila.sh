@@ -1 +1 @@
-gcc -I../lib esempio.c ../lib/obj_trace.c chess_gui_font.c chess_to_gui_interface.c chess_gui.c -o esempio `sdl2-config --cflags --libs` -lSDL2_ttf -lSDL2_image
+gcc -I../lib esempio.c ../lib/obj_trace.c chess_gui_font.c chess_to_gui_interface.c chess_gui.c chess_engine_worker.c ../lib/obj_ver.c ../lib/obj_mem.c ../lib/obj_cache.c ../lib/obj_dynamic_vector.c ../lib/minimax.c ../lib/minimax_tt.c ../lib/chess_state.c ../lib/chess_magic.c ../lib/chess_moves.c ../lib/chess_moves_pawn.c ../lib/chess_moves_knight.c ../lib/chess_moves_bishop.c ../lib/chess_moves_rook.c ../lib/chess_moves_queen.c ../lib/chess_moves_king.c ../lib/chess_hash.c ../lib/chess_eval.c ../lib/chess_book.c ../lib/chess_bitbase.c ../lib/chess_game_descriptor.c ../lib/chess_game_dynamics.c -o esempio `sdl2-config --cflags --libs` -lSDL2_ttf -lSDL2_image -pthread
@@ -84,6 +84,13 @@ int main(int argc, char* argv[])
     }
     TRACE_DEBUG(&stdtrace, "Board + pezzi caricati correttamente");
 
+    // 3b) Costruiamo l'atlas dei pezzi (se fallisce si usano le texture singole)
+    if (ChessGui_BuildPieceAtlas(renderer)) {
+        TRACE_DEBUG(&stdtrace, "Atlas dei pezzi costruito");
+    } else {
+        TRACE_ERROR(&stdtrace, "Atlas non disponibile, uso le texture singole");
+    }
+
     // 4) Inizializziamo la logica scacchi (board, dead pieces e history)
     ChessGuiBoard_t boardData;
     ChessGuiBoard_InitStandardArrangement(boardData);
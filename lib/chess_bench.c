@@ -0,0 +1,282 @@
+/**
+ * ##VERSION## "chess_bench.c 1.1"
+*/
+
+/******************************************************************************
+ * File: chess_bench.c
+ *
+ * Benchmark canonico della RICERCA (l'equivalente di perft_bench per il
+ * minimax): carica un corpus fisso di posizioni, le cerca a profondità fissa
+ * (o con un budget di nodi) e riporta per ciascuna nodi, tempo, NPS e hit
+ * rate della transposition table, più una riga TOTALE. L'output termina con
+ * record CSV (o JSON) confrontabili tra commit: è il numero su cui si
+ * verificano le ottimizzazioni prima di un rilascio, al posto di cronometrare
+ * a occhio test_chess_c_vs_c.
+ *
+ * Uso:
+ *   make build TARGET=chess_bench
+ *   ./chess_bench [depth] [csv|json] [nodes=N]
+ *
+ *   depth    profondità fissa di ricerca (default: 7)
+ *   csv|json formato dei record macchina (default: csv)
+ *   nodes=N  budget di nodi per posizione: la ricerca usa iterative
+ *            deepening e si ferma alla prima iterazione completata oltre il
+ *            budget (la granularità è l'iterazione, non il singolo nodo)
+ *
+ * Compilando con CFLAGS="... -DTRACE_SPANS_ON" il run termina con il report
+ * degli span temporizzati (movegen / eval / make_move / TT, vedi obj_trace.h)
+ * su stderr: attribuisce il tempo di ricerca alle singole fasi della
+ * pipeline senza profiler esterno. I record CSV su stdout restano puliti.
+ *
+ * A parità di profondità e di versione del motore i conteggi di nodi sono
+ * stabili (si osserva un rumore sotto lo 0,1% nei nodi di quiescenza): se
+ * cambiano oltre quel rumore senza una modifica voluta alla ricerca, è una
+ * regressione funzionale; se i tempi peggiorano a nodi invariati, è una
+ * regressione di throughput.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "chess_state.h"
+#include "chess_moves.h"
+#include "chess_fen.h"
+#include "chess_hash.h"
+#include "chess_game_dynamics.h"
+#include "chess_game_descriptor.h"
+#include "minimax.h"
+#include "minimax_tt.h"
+#include "obj_trace.h"
+
+/* Dimensione della transposition table, ricreata per ogni posizione così
+ * che ogni misura parta dallo stesso stato (numeri confrontabili tra run) */
+#define BENCH_TT_MB 64
+
+/* --------------------------------------------------------------------------
+ * CORPUS DI POSIZIONI
+ *
+ * Mix fisso di aperture, mediogioco tattico e finali: le prime tre vengono
+ * dalla suite perft (Kiwipete esclusa: manda in esplosione la quiescenza e
+ * da sola domina il tempo del run), le cinque "BK" dal test di Bratko-Kopec,
+ * le ultime due sono finali classici.
+ * Il corpus NON va modificato: i numeri sono confrontabili tra commit solo
+ * finché le posizioni restano le stesse.
+ * -------------------------------------------------------------------------- */
+
+typedef struct {
+    const char *id;   /* etichetta stabile per i record macchina */
+    const char *fen;  /* NULL = posizione iniziale */
+} bench_position_t;
+
+static const bench_position_t corpus[] = {
+    { "startpos", NULL },
+    { "perft5",   "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8" },
+    { "rook_end", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -" },
+    { "bk01",     "1k1r4/pp1b1R2/3q2pp/4p3/2B5/4Q3/PPP2B2/2K5 b - -" },
+    { "bk02",     "3r1k2/4npp1/1ppr3p/p6P/P2PPPP1/1NR5/5K2/2R5 w - -" },
+    { "bk03",     "2r3k1/pppR1pp1/4p3/4P1P1/5P2/1P4K1/P1P5/8 w - -" },
+    { "bk04",     "rnbqkb1r/p3pppp/1p6/2ppP3/3N4/2P5/PPP1QPPP/R1B1KB1R w KQkq -" },
+    { "bk05",     "r1b2rk1/2q1b1pp/p2ppn2/1p6/3QP3/1BN1B3/PPP3PP/R4RK1 w - -" },
+    { "fine70",   "8/k7/3p4/p2P1p2/P2P1P2/8/8/K7 w - -" },
+    { "krk",      "8/8/8/4k3/8/8/4K3/4R3 w - -" },
+};
+
+#define CORPUS_SIZE ((int)(sizeof(corpus) / sizeof(corpus[0])))
+
+/* Risultato di una posizione, per la stampa dei record macchina a fine run */
+typedef struct {
+    const char   *id;
+    int           depth;       /* profondità raggiunta (ultima iterazione) */
+    int           value;       /* punteggio dell'ultima iterazione */
+    unsigned long nodes;       /* nodi minimax + quiescenza */
+    long          elapsed_ms;
+    double        nps;
+    double        tt_hit_rate; /* hit / (hit + miss), 0..1 */
+} bench_result_t;
+
+/* --------------------------------------------------------------------------
+ * Budget di nodi: la callback di progresso alza il flag di stop alla prima
+ * iterazione completata oltre il budget (vedi minimax_set_progress_callback).
+ * -------------------------------------------------------------------------- */
+
+static unsigned long node_budget = 0;   /* 0 = modalità profondità fissa */
+static volatile int  budget_stop = 0;
+static int           budget_depth = 0;  /* ultima profondità completata */
+static int           budget_value = 0;
+
+static void budget_progress(const search_progress_t *progress, void *user_data) {
+    (void)user_data;
+    budget_depth = progress->depth;
+    budget_value = progress->value;
+    if (node_budget != 0 && progress->nodes >= node_budget) {
+        budget_stop = 1;
+    }
+}
+
+static long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/*
+ * Cerca una posizione del corpus e riempie il suo bench_result_t.
+ * Ritorna 0 se la FEN non è interpretabile o la ricerca non produce mossa.
+ */
+static int run_position(const game_descriptor_t *gd,
+                        const bench_position_t *pos,
+                        int depth,
+                        bench_result_t *out) {
+    bitboard_state_t state;
+
+    if (pos->fen == NULL) {
+        initialize_board(&state);
+    } else if (!chess_fen_parse(pos->fen, &state)) {
+        printf("FEN non interpretabile per '%s'\n", pos->id);
+        return 0;
+    }
+
+    /* Ogni posizione parte dallo stesso stato: TT nuova, storia vuota */
+    minimax_tt_t *tt = minimax_tt_create(BENCH_TT_MB);
+    if (tt == NULL) {
+        printf("Allocazione TT (%d MiB) fallita\n", BENCH_TT_MB);
+        return 0;
+    }
+    minimax_set_ttable(tt);
+    chess_repetition_reset();
+    chess_repetition_push(chess_hash_state(&state));
+
+    budget_stop = 0;
+    budget_depth = 0;
+    budget_value = 0;
+
+    long t0 = monotonic_ms();
+    void *move;
+    if (node_budget != 0) {
+        /* Budget di nodi: iterative deepening fermato dalla callback */
+        move = get_best_move_stoppable(gd, &state, 0, &budget_stop, NULL);
+    } else {
+        move = get_best_move_id_pv(gd, &state, depth, NULL, NULL);
+    }
+    long elapsed = monotonic_ms() - t0;
+
+    search_stats_t stats = minimax_get_search_stats();
+
+    minimax_set_ttable(NULL);
+    minimax_tt_destroy(tt);
+
+    if (move == NULL) {
+        printf("Nessuna mossa per '%s'\n", pos->id);
+        return 0;
+    }
+    gd->free_move(move);
+
+    unsigned long lookups = stats.cache_hits + stats.cache_misses;
+
+    out->id = pos->id;
+    out->depth = budget_depth;  /* ultima iterazione completata */
+    out->value = budget_value;
+    out->nodes = stats.nodes + stats.qnodes;
+    out->elapsed_ms = elapsed;
+    out->nps = stats.nps;
+    out->tt_hit_rate = (lookups > 0) ? (double)stats.cache_hits / (double)lookups : 0.0;
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    int depth = 7;
+    int json = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "json") == 0) {
+            json = 1;
+        } else if (strcmp(argv[i], "csv") == 0) {
+            json = 0;
+        } else if (strncmp(argv[i], "nodes=", 6) == 0) {
+            node_budget = strtoul(argv[i] + 6, NULL, 10);
+        } else if (atoi(argv[i]) > 0) {
+            depth = atoi(argv[i]);
+        } else {
+            printf("Uso: %s [depth] [csv|json] [nodes=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Il benchmark misura la ricerca: niente trace di debug nel ciclo caldo */
+    trace_set_channel_level(&stdtrace, TRACE_LEVEL_ERROR);
+
+    game_descriptor_t *gd = initialize_chess_game_descriptor();
+    if (gd == NULL) {
+        printf("Inizializzazione del descrittore fallita\n");
+        return 1;
+    }
+
+    /* La callback serve sia al budget di nodi sia a registrare la
+     * profondità raggiunta; è per-thread e resta attiva per tutto il run */
+    minimax_set_progress_callback(budget_progress, NULL);
+
+    if (node_budget != 0) {
+        printf("=== chess_bench: %d posizioni, budget %lu nodi ===\n\n",
+               CORPUS_SIZE, node_budget);
+    } else {
+        printf("=== chess_bench: %d posizioni a profondità %d ===\n\n",
+               CORPUS_SIZE, depth);
+    }
+
+    bench_result_t results[CORPUS_SIZE];
+    unsigned long total_nodes = 0;
+    long total_ms = 0;
+
+    for (int i = 0; i < CORPUS_SIZE; i++) {
+        if (!run_position(gd, &corpus[i], depth, &results[i])) {
+            free(gd);
+            return 1;
+        }
+        printf("%-10s prof=%2d  val=%6d  %10lu nodi  %6ld ms  %10.0f nodi/s  TT %5.1f%%\n",
+               results[i].id, results[i].depth, results[i].value, results[i].nodes,
+               results[i].elapsed_ms, results[i].nps,
+               results[i].tt_hit_rate * 100.0);
+        total_nodes += results[i].nodes;
+        total_ms += results[i].elapsed_ms;
+    }
+
+    double total_nps = (total_ms > 0)
+                     ? (double)total_nodes * 1000.0 / (double)total_ms
+                     : (double)total_nodes * 1000.0;
+    printf("\nTOTALE     %14lu nodi  %6ld ms  %10.0f nodi/s\n\n",
+           total_nodes, total_ms, total_nps);
+
+    /* ----------------------------------------------------------------------
+     * Record macchina: una riga per posizione più la riga "total".
+     * Formato stabile: i run di commit diversi si confrontano con un diff.
+     * ---------------------------------------------------------------------- */
+    if (json) {
+        printf("[\n");
+        for (int i = 0; i < CORPUS_SIZE; i++) {
+            printf("  {\"id\": \"%s\", \"depth\": %d, \"value\": %d, \"nodes\": %lu, "
+                   "\"ms\": %ld, \"nps\": %.0f, \"tt_hit_rate\": %.4f},\n",
+                   results[i].id, results[i].depth, results[i].value, results[i].nodes,
+                   results[i].elapsed_ms, results[i].nps, results[i].tt_hit_rate);
+        }
+        printf("  {\"id\": \"total\", \"nodes\": %lu, \"ms\": %ld, \"nps\": %.0f}\n]\n",
+               total_nodes, total_ms, total_nps);
+    } else {
+        printf("id,depth,value,nodes,ms,nps,tt_hit_rate\n");
+        for (int i = 0; i < CORPUS_SIZE; i++) {
+            printf("%s,%d,%d,%lu,%ld,%.0f,%.4f\n",
+                   results[i].id, results[i].depth, results[i].value, results[i].nodes,
+                   results[i].elapsed_ms, results[i].nps, results[i].tt_hit_rate);
+        }
+        printf("total,,,%lu,%ld,%.0f,\n", total_nodes, total_ms, total_nps);
+    }
+
+    /* Con -DTRACE_SPANS_ON scarica su stderr il profilo della pipeline;
+       senza spans compilati non stampa nulla */
+    trace_span_report(&stdtrace);
+
+    minimax_set_progress_callback(NULL, NULL);
+    free(gd);
+    return 0;
+}
@@ -0,0 +1,320 @@
+/**
+ * ##VERSION## "chess_bitbase.c 1.0"
+ */
+
+#include "chess_bitbase.h"
+#include "chess_eval.h"
+#include "chess_moves.h"
+#include "chess_game_dynamics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Intestazione del file: magic + numero di configurazioni materiali */
+#define CHESS_BITBASE_MAGIC "CBB1"
+
+/* Configurazioni, nell'ordine delle sezioni del file */
+enum { BB_KQK = 0, BB_KRK = 1, BB_NUM_CONFIGS = 2 };
+
+/* 2 tratti x re bianco x pezzo x re nero; un bit a posizione (1 = vinta) */
+#define BB_POSITIONS (2 * 64 * 64 * 64)
+#define BB_BYTES     (BB_POSITIONS / 8)
+
+typedef struct {
+    char     magic[4];   /* CHESS_BITBASE_MAGIC */
+    uint32_t count;      /* BB_NUM_CONFIGS sezioni da BB_BYTES che seguono */
+} chess_bitbase_header_t;
+
+/*
+ * Bitbase aperta: come per il libro di aperture, una per processo e in sola
+ * lettura dopo l'open.
+ */
+static void          *bitbase_map = NULL;
+static size_t         bitbase_map_size = 0;
+static const uint8_t *bitbase_bits = NULL;
+
+/* Indice di una posizione: tratto (0 = bianco), re bianco, pezzo, re nero */
+static int bb_index(int stm, int wk, int pc, int bk)
+{
+    return (((stm << 6 | wk) << 6 | pc) << 6) | bk;
+}
+
+/*
+ * Stato minimo per una posizione della bitbase. Hash e valutazione restano
+ * non seminati (il generatore di mosse non li usa); arrocco ed en passant
+ * sono irrilevanti con questi materiali e restano spenti anche in
+ * generazione, così il grafo esplorato coincide con quello sondato.
+ */
+static void bb_setup_state(bitboard_state_t *st, int config,
+                           int stm, int wk, int pc, int bk)
+{
+    memset(st, 0, sizeof(*st));
+    st->white_kings = 1ULL << wk;
+    st->black_kings = 1ULL << bk;
+    if (config == BB_KQK) {
+        st->white_queens = 1ULL << pc;
+    } else {
+        st->white_rooks = 1ULL << pc;
+    }
+    st->current_player = stm ? -1 : 1;
+    st->en_passant = 255;
+    st->fullmove_number = 1;
+    chess_refresh_occupancy(st);
+}
+
+/* Valori intermedi della generazione (in memoria, mai su file) */
+enum { BB_UNKNOWN = 0, BB_DRAW = 1, BB_WIN = 2, BB_ILLEGAL = 3 };
+
+/*
+ * Valore teorico di tutte le posizioni di una configurazione per iterazione
+ * a punto fisso: i nodi terminali (matto, stallo) seminano i valori, ogni
+ * passata propaga all'indietro sul grafo delle mosse legali del motore, e
+ * ciò che a convergenza resta irrisolto è patta per ciclo (nessun matto
+ * forzabile). La cattura del pezzo forte porta a KK, patta per definizione.
+ */
+static void bb_solve_config(int config, uint8_t *val)
+{
+    bitboard_state_t st;
+    chess_move_t moves[64];
+
+    /* Semina: illegalità e nodi terminali */
+    for (int stm = 0; stm < 2; stm++) {
+        for (int wk = 0; wk < 64; wk++) {
+            for (int pc = 0; pc < 64; pc++) {
+                for (int bk = 0; bk < 64; bk++) {
+                    int idx = bb_index(stm, wk, pc, bk);
+                    if (wk == pc || wk == bk || pc == bk) {
+                        val[idx] = BB_ILLEGAL;
+                        continue;
+                    }
+                    bb_setup_state(&st, config, stm, wk, pc, bk);
+                    /* Chi NON ha il tratto non può essere sotto scacco */
+                    if (is_king_in_check(&st, stm ? 1 : -1)) {
+                        val[idx] = BB_ILLEGAL;
+                        continue;
+                    }
+                    int n = chess_generate_moves(&st, moves, 64);
+                    if (n == 0) {
+                        /* Matto al nero = vinta; ogni altro blocco = patta */
+                        val[idx] = (stm == 1 && is_king_in_check(&st, -1))
+                                   ? BB_WIN : BB_DRAW;
+                    } else {
+                        val[idx] = BB_UNKNOWN;
+                    }
+                }
+            }
+        }
+    }
+
+    /* Propagazione all'indietro fino a convergenza */
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int stm = 0; stm < 2; stm++) {
+            for (int wk = 0; wk < 64; wk++) {
+                for (int pc = 0; pc < 64; pc++) {
+                    for (int bk = 0; bk < 64; bk++) {
+                        int idx = bb_index(stm, wk, pc, bk);
+                        if (val[idx] != BB_UNKNOWN) {
+                            continue;
+                        }
+                        bb_setup_state(&st, config, stm, wk, pc, bk);
+                        int n = chess_generate_moves(&st, moves, 64);
+                        int all_win = 1, all_draw = 1;
+                        int any_win = 0, any_draw = 0;
+                        for (int i = 0; i < n; i++) {
+                            int succ;
+                            if (stm == 0) {
+                                /* Mossa del bianco: re o pezzo forte */
+                                succ = (moves[i].from == wk)
+                                     ? bb_index(1, moves[i].to, pc, bk)
+                                     : bb_index(1, wk, moves[i].to, bk);
+                            } else if (moves[i].to == pc) {
+                                /* Il nero cattura il pezzo: KK, patta */
+                                any_draw = 1; all_win = 0; all_draw = 0;
+                                continue;
+                            } else {
+                                succ = bb_index(0, wk, pc, moves[i].to);
+                            }
+                            if (val[succ] == BB_WIN)       { any_win = 1;  all_draw = 0; }
+                            else if (val[succ] == BB_DRAW) { any_draw = 1; all_win = 0; }
+                            else                           { all_win = 0;  all_draw = 0; }
+                        }
+                        if (stm == 0) {
+                            /* Il bianco sceglie: basta una via vinta */
+                            if (any_win)       { val[idx] = BB_WIN;  changed = 1; }
+                            else if (all_draw) { val[idx] = BB_DRAW; changed = 1; }
+                        } else {
+                            /* Il nero scappa: basta una via patta */
+                            if (any_draw)      { val[idx] = BB_DRAW; changed = 1; }
+                            else if (all_win)  { val[idx] = BB_WIN;  changed = 1; }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /* Irrisolte a convergenza: nessun matto forzabile, quindi patte */
+    for (int idx = 0; idx < BB_POSITIONS; idx++) {
+        if (val[idx] == BB_UNKNOWN) {
+            val[idx] = BB_DRAW;
+        }
+    }
+}
+
+int chess_bitbase_generate(const char *path)
+{
+    if (!path) {
+        return 0;
+    }
+
+    uint8_t *val = (uint8_t *)malloc(BB_POSITIONS);
+    uint8_t *bits = (uint8_t *)calloc(BB_NUM_CONFIGS, BB_BYTES);
+    if (!val || !bits) {
+        free(val);
+        free(bits);
+        return 0;
+    }
+
+    for (int config = 0; config < BB_NUM_CONFIGS; config++) {
+        bb_solve_config(config, val);
+        uint8_t *section = bits + (size_t)config * BB_BYTES;
+        for (int idx = 0; idx < BB_POSITIONS; idx++) {
+            if (val[idx] == BB_WIN) {
+                section[idx >> 3] |= (uint8_t)(1u << (idx & 7));
+            }
+        }
+    }
+    free(val);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        free(bits);
+        return 0;
+    }
+    chess_bitbase_header_t hdr;
+    memcpy(hdr.magic, CHESS_BITBASE_MAGIC, 4);
+    hdr.count = BB_NUM_CONFIGS;
+    int ok = (fwrite(&hdr, sizeof(hdr), 1, f) == 1) &&
+             (fwrite(bits, BB_BYTES, BB_NUM_CONFIGS, f) == BB_NUM_CONFIGS);
+    if (fclose(f) != 0) {
+        ok = 0;
+    }
+    free(bits);
+    return ok;
+}
+
+int chess_bitbase_open(const char *path)
+{
+    if (!path) {
+        return 0;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat st;
+    size_t expected = sizeof(chess_bitbase_header_t) +
+                      (size_t)BB_NUM_CONFIGS * BB_BYTES;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != expected) {
+        close(fd);
+        return 0;
+    }
+
+    void *map = mmap(NULL, expected, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* la mappa sopravvive alla chiusura del descrittore */
+    if (map == MAP_FAILED) {
+        return 0;
+    }
+
+    const chess_bitbase_header_t *hdr = (const chess_bitbase_header_t *)map;
+    if (memcmp(hdr->magic, CHESS_BITBASE_MAGIC, 4) != 0 ||
+        hdr->count != BB_NUM_CONFIGS) {
+        munmap(map, expected);
+        return 0;
+    }
+
+    chess_bitbase_close();
+    bitbase_map = map;
+    bitbase_map_size = expected;
+    bitbase_bits = (const uint8_t *)map + sizeof(*hdr);
+    return 1;
+}
+
+void chess_bitbase_close(void)
+{
+    if (bitbase_map) {
+        munmap(bitbase_map, bitbase_map_size);
+    }
+    bitbase_map = NULL;
+    bitbase_map_size = 0;
+    bitbase_bits = NULL;
+}
+
+int chess_bitbase_probe(const void *state, int *score)
+{
+    if (!bitbase_bits || !state) {
+        return 0;
+    }
+    const bitboard_state_t *bs = (const bitboard_state_t *)state;
+
+    /* Materiale elementare: esattamente i due re più donna o torre */
+    if (bs->white_pawns | bs->white_knights | bs->white_bishops |
+        bs->black_pawns | bs->black_knights | bs->black_bishops) {
+        return 0;
+    }
+    if (__builtin_popcountll(bs->occupied_all) != 3 ||
+        __builtin_popcountll(bs->white_kings) != 1 ||
+        __builtin_popcountll(bs->black_kings) != 1) {
+        return 0;
+    }
+
+    int config, white_strong;
+    uint64_t piece_bb;
+    if (bs->white_queens && !(bs->white_rooks | bs->black_queens | bs->black_rooks)) {
+        config = BB_KQK; white_strong = 1; piece_bb = bs->white_queens;
+    } else if (bs->white_rooks && !(bs->white_queens | bs->black_queens | bs->black_rooks)) {
+        config = BB_KRK; white_strong = 1; piece_bb = bs->white_rooks;
+    } else if (bs->black_queens && !(bs->white_queens | bs->white_rooks | bs->black_rooks)) {
+        config = BB_KQK; white_strong = 0; piece_bb = bs->black_queens;
+    } else if (bs->black_rooks && !(bs->white_queens | bs->white_rooks | bs->black_queens)) {
+        config = BB_KRK; white_strong = 0; piece_bb = bs->black_rooks;
+    } else {
+        return 0;
+    }
+
+    /* Lato forte nero: specchia verticalmente e scambia i colori, la
+     * tabella memorizza solo il lato forte bianco */
+    int wk, pc, bk, stm;
+    if (white_strong) {
+        wk = __builtin_ctzll(bs->white_kings);
+        bk = __builtin_ctzll(bs->black_kings);
+        pc = __builtin_ctzll(piece_bb);
+        stm = (bs->current_player == 1) ? 0 : 1;
+    } else {
+        wk = __builtin_ctzll(bs->black_kings) ^ 56;
+        bk = __builtin_ctzll(bs->white_kings) ^ 56;
+        pc = __builtin_ctzll(piece_bb) ^ 56;
+        stm = (bs->current_player == -1) ? 0 : 1;
+    }
+
+    int idx = bb_index(stm, wk, pc, bk);
+    const uint8_t *section = bitbase_bits + (size_t)config * BB_BYTES;
+    int win = (section[idx >> 3] >> (idx & 7)) & 1;
+
+    if (!win) {
+        *score = 0; /* patta teorica */
+    } else if (white_strong) {
+        *score =  CHESS_BITBASE_WIN + chess_eval_position(bs);
+    } else {
+        *score = -CHESS_BITBASE_WIN + chess_eval_position(bs);
+    }
+    return 1;
+}
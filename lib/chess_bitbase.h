@@ -0,0 +1,89 @@
+/**
+ * ##VERSION## "chess_bitbase.h 1.0"
+ *
+ * @file chess_bitbase.h
+ * @brief Bitbase compatta (vinta/patta) per i finali elementari KQK e KRK.
+ *
+ * A profondità fissa i matti elementari (re+donna o re+torre contro re
+ * solo) restano spesso oltre l'orizzonte: la ricerca macina sottoalberi
+ * interi senza "vedere" il matto e la partita si trascina per decine di
+ * mosse. La bitbase risolve il problema alla radice: per OGNI posizione di
+ * quei due materiali il valore teorico (vince il lato forte / patta) è
+ * precalcolato per analisi retrograda a punto fisso e immagazzinato come un
+ * bit in un array compatto — 64 KiB per configurazione — caricato con mmap.
+ *
+ * `chess_evaluate` sonda la bitbase quando il materiale corrisponde: la
+ * sonda costa una manciata di confronti e una lettura di bit, e restituisce
+ * un verdetto esatto che chiude il sottoalbero al primo nodo foglia invece
+ * che dopo una ricerca full-width. I finali a colori invertiti (re solo
+ * bianco) sono gestiti per specularità, senza tabelle aggiuntive.
+ *
+ * Come per il libro di aperture (chess_book.h) la bitbase aperta è una per
+ * processo, in sola lettura: sonde concorrenti sicure, open/close senza
+ * ricerche in corso. Il file si produce una tantum con
+ * \ref chess_bitbase_generate.
+ */
+
+#ifndef CHESS_BITBASE_H
+#define CHESS_BITBASE_H
+
+#include "chess_state.h"
+
+/**
+ * @brief Punteggio base di una posizione vinta secondo la bitbase.
+ *
+ * Sopra qualunque vantaggio materiale/posizionale (il materiale in tavola
+ * vale al più qualche migliaio di centesimi) ma sotto il punteggio di matto
+ * (±99999 in chess_evaluate): la ricerca preferisce sempre il matto vero
+ * quando entra nell'orizzonte. La sonda somma al punteggio base la
+ * valutazione statica, così tra due foglie entrambe vinte resta un
+ * gradiente che spinge il re avversario verso il bordo.
+ */
+#define CHESS_BITBASE_WIN 50000
+
+/**
+ * @brief Genera il file della bitbase (builder offline, una tantum).
+ *
+ * Enumera tutte le posizioni KQK e KRK (lato forte bianco: 2 tratti x 64^3
+ * case = 524288 posizioni per materiale) e ne calcola il valore teorico per
+ * iterazione a punto fisso sul grafo delle mosse legali del motore stesso:
+ * matti e stalli seminano i valori, poi ogni passata propaga all'indietro
+ * ("il bianco vince se una mossa porta a vinta; il nero patta se una mossa
+ * porta a patta, inclusa la cattura del pezzo") finché nulla cambia; ciò
+ * che resta irrisolto è patta per ciclo. Richiede qualche secondo.
+ *
+ * @param[in] path File di destinazione.
+ * @return 1 se il file è stato generato e scritto, 0 in caso di errore.
+ */
+int chess_bitbase_generate(const char *path);
+
+/**
+ * @brief Apre (mmappa) una bitbase; sostituisce quella eventualmente aperta.
+ *
+ * @param[in] path File prodotto da \ref chess_bitbase_generate.
+ * @return 1 se la bitbase è stata mappata e validata, 0 in caso di errore.
+ */
+int chess_bitbase_open(const char *path);
+
+/**
+ * @brief Chiude la bitbase aperta (no-op se non ce n'è una).
+ */
+void chess_bitbase_close(void);
+
+/**
+ * @brief Sonda la bitbase per la posizione, se il materiale corrisponde.
+ *
+ * Hit solo con bitbase aperta e materiale esattamente KQK o KRK (lato
+ * forte qualunque: il colore invertito è risolto per specularità). Su hit
+ * scrive in \p score il verdetto dal punto di vista del Bianco:
+ * ±(\ref CHESS_BITBASE_WIN + valutazione statica) per posizione vinta,
+ * 0 per patta teorica.
+ *
+ * @param[in]  state Stato di gioco (`bitboard_state_t*`).
+ * @param[out] score Verdetto, scritto solo su hit.
+ * @return 1 su hit, 0 se la bitbase non è aperta o il materiale non è
+ *         elementare.
+ */
+int chess_bitbase_probe(const void *state, int *score);
+
+#endif /* CHESS_BITBASE_H */
@@ -0,0 +1,203 @@
+/**
+ * ##VERSION## "chess_book.c 1.0"
+ */
+
+#include "chess_book.h"
+#include "chess_hash.h"
+#include "chess_moves.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Intestazione del file: magic + numero di record che seguono */
+#define CHESS_BOOK_MAGIC "CBK1"
+
+typedef struct {
+    char     magic[4];   /* CHESS_BOOK_MAGIC */
+    uint32_t count;      /* numero di chess_book_entry_t che seguono */
+} chess_book_header_t;
+
+/*
+ * Libro aperto: la mappa mmappata e la vista sull'array di record. Un solo
+ * libro per processo, in sola lettura dopo l'open (le sonde concorrenti
+ * leggono soltanto).
+ */
+static void                     *book_map = NULL;
+static size_t                    book_map_size = 0;
+static const chess_book_entry_t *book_entries = NULL;
+static uint32_t                  book_count = 0;
+
+/* Ordinamento del builder: chiave crescente, a pari chiave peso decrescente
+ * (così la sonda scorre le alternative dalla preferita in giù). */
+static int entry_cmp(const void *a, const void *b)
+{
+    const chess_book_entry_t *ea = (const chess_book_entry_t *)a;
+    const chess_book_entry_t *eb = (const chess_book_entry_t *)b;
+    if (ea->key != eb->key) return (ea->key < eb->key) ? -1 : 1;
+    if (ea->weight != eb->weight) return (ea->weight > eb->weight) ? -1 : 1;
+    return 0;
+}
+
+int chess_book_write(const char *path, const chess_book_entry_t *entries, int n)
+{
+    if (!path || n < 0 || (n > 0 && !entries)) {
+        return 0;
+    }
+
+    chess_book_entry_t *sorted = NULL;
+    if (n > 0) {
+        sorted = (chess_book_entry_t *)malloc((size_t)n * sizeof(*sorted));
+        if (!sorted) {
+            return 0;
+        }
+        memcpy(sorted, entries, (size_t)n * sizeof(*sorted));
+        qsort(sorted, (size_t)n, sizeof(*sorted), entry_cmp);
+    }
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        free(sorted);
+        return 0;
+    }
+
+    chess_book_header_t hdr;
+    memcpy(hdr.magic, CHESS_BOOK_MAGIC, 4);
+    hdr.count = (uint32_t)n;
+
+    int ok = (fwrite(&hdr, sizeof(hdr), 1, f) == 1);
+    if (ok && n > 0) {
+        ok = (fwrite(sorted, sizeof(*sorted), (size_t)n, f) == (size_t)n);
+    }
+    if (fclose(f) != 0) {
+        ok = 0;
+    }
+    free(sorted);
+    return ok;
+}
+
+int chess_book_open(const char *path)
+{
+    if (!path) {
+        return 0;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(chess_book_header_t)) {
+        close(fd);
+        return 0;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* la mappa sopravvive alla chiusura del descrittore */
+    if (map == MAP_FAILED) {
+        return 0;
+    }
+
+    const chess_book_header_t *hdr = (const chess_book_header_t *)map;
+    size_t expected = sizeof(*hdr) + (size_t)hdr->count * sizeof(chess_book_entry_t);
+    if (memcmp(hdr->magic, CHESS_BOOK_MAGIC, 4) != 0 ||
+        expected != (size_t)st.st_size) {
+        munmap(map, (size_t)st.st_size);
+        return 0;
+    }
+
+    chess_book_close();
+    book_map = map;
+    book_map_size = (size_t)st.st_size;
+    book_entries = (const chess_book_entry_t *)((const char *)map + sizeof(*hdr));
+    book_count = hdr->count;
+    return 1;
+}
+
+void chess_book_close(void)
+{
+    if (book_map) {
+        munmap(book_map, book_map_size);
+    }
+    book_map = NULL;
+    book_map_size = 0;
+    book_entries = NULL;
+    book_count = 0;
+}
+
+const chess_book_entry_t* chess_book_probe(uint64_t key, int *num)
+{
+    if (num) {
+        *num = 0;
+    }
+    if (!book_entries || book_count == 0) {
+        return NULL;
+    }
+
+    /* Ricerca binaria del primo record con chiave >= key (lower bound) */
+    uint32_t lo = 0, hi = book_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (book_entries[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo >= book_count || book_entries[lo].key != key) {
+        return NULL;
+    }
+
+    if (num) {
+        uint32_t end = lo;
+        while (end < book_count && book_entries[end].key == key) {
+            end++;
+        }
+        *num = (int)(end - lo);
+    }
+    return &book_entries[lo];
+}
+
+void* chess_book_move(const void *state)
+{
+    if (!state || !book_entries) {
+        return NULL;
+    }
+
+    int num = 0;
+    const chess_book_entry_t *hit = chess_book_probe(chess_hash_state(state), &num);
+    if (!hit) {
+        return NULL;
+    }
+
+    /*
+     * Le alternative arrivano già in ordine di peso decrescente: la prima
+     * che il generatore conferma legale vince. La copia restituita è quella
+     * della lista legale, così arrocco/en passant hanno i flag giusti anche
+     * se il libro conosce solo la terna from/to/promotion.
+     */
+    dynamic_vector_t *moves = chess_get_moves(state);
+    if (!moves) {
+        return NULL;
+    }
+    int n_moves = chess_get_num_moves(moves);
+
+    void *found = NULL;
+    for (int e = 0; e < num && !found; e++) {
+        for (int i = 0; i < n_moves; i++) {
+            const chess_move_t *mv = (const chess_move_t *)chess_get_move_at(moves, i);
+            if (mv->from == hit[e].from && mv->to == hit[e].to &&
+                mv->promotion == hit[e].promotion) {
+                found = chess_copy_move(mv);
+                break;
+            }
+        }
+    }
+
+    chess_free_moves(moves);
+    return found;
+}
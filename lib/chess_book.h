@@ -0,0 +1,103 @@
+/**
+ * ##VERSION## "chess_book.h 1.0"
+ *
+ * @file chess_book.h
+ * @brief Libro di aperture binario, mmappato e indicizzato per hash Zobrist.
+ *
+ * Le prime mosse di ogni partita rifacevano da zero la teoria nota con
+ * ricerche complete. Il libro è un file binario costruito offline: un array
+ * di record a dimensione fissa ordinato per chiave Zobrist, mmappato in sola
+ * lettura all'avvio e interrogato con una ricerca binaria — nessun parsing,
+ * nessuna struttura in RAM oltre alle pagine toccate. La sonda avviene nei
+ * driver get_best_move* PRIMA di lanciare qualunque ricerca, tramite la
+ * callback opzionale `get_book_move` del descrittore: su hit la mossa torna
+ * in microsecondi.
+ *
+ * Una posizione può avere più mosse di libro (record consecutivi con la
+ * stessa chiave); il builder le ordina per peso decrescente e la sonda
+ * restituisce la prima che risulta legale nella posizione corrente, così un
+ * libro costruito con una versione diversa del motore non può mai iniettare
+ * una mossa illegale.
+ *
+ * Il libro aperto è uno per processo, in sola lettura: le sonde concorrenti
+ * sono sicure, open/close vanno chiamate senza ricerche in corso.
+ */
+
+#ifndef CHESS_BOOK_H
+#define CHESS_BOOK_H
+
+#include "chess_state.h"
+
+/**
+ * @brief Record del libro: una mossa consigliata per una posizione.
+ *
+ * `key` è l'hash Zobrist della posizione (vedi chess_hash_state); la mossa
+ * è identificata da partenza, destinazione ed eventuale pezzo di promozione
+ * (la stessa terna di chess_move_t: flag come arrocco ed en passant vengono
+ * ricostruiti dal generatore al momento della sonda). `weight` ordina le
+ * alternative della stessa posizione (più alto = preferita).
+ */
+typedef struct {
+    uint64_t key;        /**< hash Zobrist della posizione */
+    uint8_t  from;       /**< casella di partenza (0-63) */
+    uint8_t  to;         /**< casella di destinazione (0-63) */
+    uint8_t  promotion;  /**< pezzo di promozione (0 se nessuna) */
+    uint8_t  weight;     /**< preferenza relativa tra le mosse della chiave */
+    uint32_t reserved;   /**< riserva, sempre a zero */
+} chess_book_entry_t;
+
+/**
+ * @brief Scrive un libro su file (builder offline).
+ *
+ * Ordina una copia dei record per chiave crescente e peso decrescente e li
+ * scrive preceduti dall'intestazione. I record in ingresso possono arrivare
+ * in qualunque ordine.
+ *
+ * @param[in] path    File di destinazione.
+ * @param[in] entries Record da scrivere.
+ * @param[in] n       Numero di record.
+ * @return 1 se il file è stato scritto, 0 in caso di errore.
+ */
+int chess_book_write(const char *path, const chess_book_entry_t *entries, int n);
+
+/**
+ * @brief Apre (mmappa) un libro; sostituisce quello eventualmente aperto.
+ *
+ * @param[in] path File del libro prodotto da \ref chess_book_write.
+ * @return 1 se il libro è stato mappato e validato, 0 in caso di errore
+ *         (il libro precedente, se c'era, resta chiuso).
+ */
+int chess_book_open(const char *path);
+
+/**
+ * @brief Chiude il libro aperto (no-op se non ce n'è uno).
+ */
+void chess_book_close(void);
+
+/**
+ * @brief Cerca i record di una chiave nel libro aperto.
+ *
+ * @param[in]  key Hash Zobrist della posizione.
+ * @param[out] num Numero di record consecutivi con quella chiave (>= 1 su
+ *                 hit); può essere NULL.
+ * @return Puntatore al primo record della chiave (dentro la mappa, in sola
+ *         lettura), oppure NULL se la chiave non è nel libro o il libro non
+ *         è aperto.
+ */
+const chess_book_entry_t* chess_book_probe(uint64_t key, int *num);
+
+/**
+ * @brief Mossa di libro per la posizione, se presente e legale.
+ *
+ * Firma compatibile con la callback opzionale `get_book_move` di
+ * `game_descriptor_t`: interroga il libro con l'hash della posizione e
+ * restituisce una copia (da liberare con `free_move`) della prima mossa
+ * consigliata che il generatore conferma legale, oppure NULL (nessun libro,
+ * nessuna chiave, nessuna mossa legale).
+ *
+ * @param[in] state Stato di gioco (`bitboard_state_t*`).
+ * @return Mossa allocata (`chess_move_t*`) o NULL.
+ */
+void* chess_book_move(const void *state);
+
+#endif /* CHESS_BOOK_H */
@@ -0,0 +1,585 @@
+/**
+ * ##VERSION## "chess_epd.c 1.0"
+*/
+
+/******************************************************************************
+ * File: chess_epd.c
+ *
+ * Runner di suite tattiche EPD: la seconda gamba del cancello di regressione
+ * accanto a chess_bench. I nodi al secondo da soli non dicono se una modifica
+ * alla ricerca aiuta: una potatura più aggressiva può alzare gli NPS e
+ * insieme far sparire le mosse giuste. Questo runner carica una o più suite
+ * EPD (posizioni con le mosse migliori note negli opcode `bm`, da evitare in
+ * `am`), risolve ogni posizione con un tetto di tempo o di nodi su tutti i
+ * core in parallelo, e riporta per suite quante posizioni sono risolte e i
+ * percentili del tempo-alla-soluzione.
+ *
+ * Uso:
+ *   make build TARGET=chess_epd
+ *   ./chess_epd [time=MS] [nodes=N] [depth=N] [jobs=N] suite.epd [altra.epd ...]
+ *
+ *   time=MS   tetto di tempo per posizione in ms (default: 1000)
+ *   nodes=N   tetto di nodi per posizione (sostituisce il tetto di tempo)
+ *   depth=N   profondità massima (default: MAX_DEPTH)
+ *   jobs=N    posizioni risolte in parallelo (default: numero di core)
+ *
+ * Il tempo-alla-soluzione di una posizione è il momento in cui la mossa
+ * attesa è diventata la scelta del motore SENZA più cambiare fino alla fine
+ * della ricerca (misurato a fine iterazione, via callback di progresso): una
+ * mossa giusta trovata e poi abbandonata non conta.
+ *
+ * Come nel torneo, ogni posizione gira in un processo figlio dedicato
+ * (transposition table e configurazione sono globali di processo) e riporta
+ * l'esito al padre con una riga su una pipe.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "chess_state.h"
+#include "chess_moves.h"
+#include "chess_fen.h"
+#include "chess_hash.h"
+#include "chess_game_dynamics.h"
+#include "chess_game_descriptor.h"
+#include "minimax.h"
+#include "minimax_tt.h"
+#include "obj_trace.h"
+
+/* Transposition table del figlio che risolve una posizione */
+#define EPD_TT_MB 32
+
+/* Limiti della suite: posizioni per file, soluzioni per posizione */
+#define MAX_POSITIONS 1024
+#define MAX_SOLUTIONS 8
+#define MAX_LEGAL     256
+
+typedef struct {
+    bitboard_state_t state;
+    chess_move_t     bm[MAX_SOLUTIONS]; /* mosse attese (opcode bm) */
+    int              n_bm;
+    chess_move_t     am[MAX_SOLUTIONS]; /* mosse da evitare (opcode am) */
+    int              n_am;
+    char             id[64];            /* opcode id, o "riga_N" */
+} epd_pos_t;
+
+/* Tetti di ricerca: impostati dal padre, ereditati dai figli col fork */
+static long          s_time_ms = 1000;
+static unsigned long s_node_cap = 0;
+static int           s_depth = 0;     /* <= 0: MAX_DEPTH */
+
+/* --------------------------------------------------------------------------
+ * RICONOSCIMENTO DELLE MOSSE SAN DEGLI OPCODE
+ *
+ * Il percorso inverso di un esportatore PGN: dal token SAN alla mossa del
+ * generatore. Si interpreta il token (pezzo, disambiguazione, casa di
+ * arrivo, promozione) e lo si confronta con le mosse legali: nessuna
+ * generazione di SAN, e l'ambiguità si smaschera da sola se più mosse
+ * combaciano.
+ * -------------------------------------------------------------------------- */
+
+static char piece_letter_at(const bitboard_state_t *state, int square) {
+    uint64_t bit = 1ULL << square;
+    if ((state->white_pawns | state->black_pawns) & bit)     return 'P';
+    if ((state->white_knights | state->black_knights) & bit) return 'N';
+    if ((state->white_bishops | state->black_bishops) & bit) return 'B';
+    if ((state->white_rooks | state->black_rooks) & bit)     return 'R';
+    if ((state->white_queens | state->black_queens) & bit)   return 'Q';
+    if ((state->white_kings | state->black_kings) & bit)     return 'K';
+    return '\0';
+}
+
+/*
+ * Cerca tra le mosse legali quella descritta dal token SAN (o in notazione
+ * coordinata "e2e4q"). Ritorna 1 e riempie *out solo se il token individua
+ * ESATTAMENTE una mossa; 0 su token sconosciuto o ambiguo.
+ */
+static int san_find_move(const bitboard_state_t *state, const char *token,
+                         const chess_move_t *legal, int n, chess_move_t *out) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%s", token);
+
+    /* Decorazioni in coda (scacco, matto, giudizi) non cambiano la mossa */
+    size_t len = strlen(buf);
+    while (len > 0 && strchr("+#!?", buf[len - 1])) {
+        buf[--len] = '\0';
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    /* Arrocco */
+    if (strcmp(buf, "O-O") == 0 || strcmp(buf, "0-0") == 0 ||
+        strcmp(buf, "O-O-O") == 0 || strcmp(buf, "0-0-0") == 0) {
+        int long_side = (buf[3] != '\0');
+        for (int i = 0; i < n; i++) {
+            if (legal[i].is_castling &&
+                ((legal[i].to < legal[i].from) == long_side)) {
+                *out = legal[i];
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    char piece = 'P';
+    const char *p = buf;
+    if (strchr("KQRBN", *p)) {
+        piece = *p++;
+    }
+
+    /* Promozione: "=Q" in coda (EPD standard) */
+    int promotion = 0;
+    if (len >= 2 && buf[len - 2] == '=') {
+        switch (buf[len - 1]) {
+            case 'N': promotion = 1; break;
+            case 'B': promotion = 2; break;
+            case 'R': promotion = 3; break;
+            case 'Q': promotion = 4; break;
+            default:  return 0;
+        }
+        buf[len - 2] = '\0';
+    }
+
+    /* Colonne e traverse: le ultime viste sono la casa di arrivo, le
+       precedenti la disambiguazione di partenza ("exd5", "Rad1", "R1a3",
+       "Qh4e1") */
+    int dst_file = -1, dst_rank = -1, dis_file = -1, dis_rank = -1;
+    for (; *p != '\0'; p++) {
+        if (*p >= 'a' && *p <= 'h') {
+            if (dst_file >= 0) dis_file = dst_file;
+            dst_file = *p - 'a';
+        } else if (*p >= '1' && *p <= '8') {
+            if (dst_rank >= 0) dis_rank = dst_rank;
+            dst_rank = *p - '1';
+        } else if (*p != 'x') {
+            return 0;
+        }
+    }
+    if (dst_file < 0 || dst_rank < 0) {
+        return 0;
+    }
+    int dst = dst_rank * 8 + dst_file;
+
+    /* Notazione coordinata: due case complete, la prima è la partenza */
+    int coord_from = -1;
+    if (piece == 'P' && dis_file >= 0 && dis_rank >= 0) {
+        coord_from = dis_rank * 8 + dis_file;
+    }
+
+    int matches = 0;
+    for (int i = 0; i < n; i++) {
+        if (legal[i].to != dst || legal[i].promotion != promotion) {
+            continue;
+        }
+        if (coord_from >= 0) {
+            if (legal[i].from != coord_from) continue;
+        } else {
+            if (piece_letter_at(state, legal[i].from) != piece) continue;
+            if (dis_file >= 0 && legal[i].from % 8 != dis_file) continue;
+            if (dis_rank >= 0 && legal[i].from / 8 != dis_rank) continue;
+        }
+        *out = legal[i];
+        matches++;
+    }
+    return (matches == 1);
+}
+
+/* --------------------------------------------------------------------------
+ * CARICAMENTO DELLE SUITE
+ * -------------------------------------------------------------------------- */
+
+/*
+ * Carica una suite EPD: una posizione per riga ('#' commenta), opcode bm/am
+ * risolti subito contro il generatore di mosse legali (meglio un errore qui
+ * che un run buttato). Ritorna il numero di posizioni caricate, 0 su errore.
+ */
+static int load_suite(const char *path, epd_pos_t *out, int max) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        printf("Impossibile aprire la suite '%s'\n", path);
+        return 0;
+    }
+
+    char line[512];
+    int count = 0;
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f) && count < max) {
+        lineno++;
+        line[strcspn(line, "\r\n")] = '\0';
+        char *s = line;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '\0' || *s == '#') {
+            continue;
+        }
+
+        epd_pos_t *pos = &out[count];
+        memset(pos, 0, sizeof(*pos));
+        const char *ops = NULL;
+        if (!chess_epd_parse(s, &pos->state, &ops)) {
+            printf("Riga EPD non interpretabile a riga %d di '%s'\n",
+                   lineno, path);
+            fclose(f);
+            return 0;
+        }
+        snprintf(pos->id, sizeof(pos->id), "riga_%d", lineno);
+
+        chess_move_t legal[MAX_LEGAL];
+        int n_legal = chess_generate_moves(&pos->state, legal, MAX_LEGAL);
+        if (n_legal <= 0) {
+            printf("Posizione senza mosse legali a riga %d di '%s'\n",
+                   lineno, path);
+            fclose(f);
+            return 0;
+        }
+
+        /* Opcode separati da ';': interessano bm, am e id */
+        char opbuf[384];
+        snprintf(opbuf, sizeof(opbuf), "%s", ops ? ops : "");
+        for (char *op = strtok(opbuf, ";"); op != NULL; op = strtok(NULL, ";")) {
+            while (*op == ' ' || *op == '\t') op++;
+            if (strncmp(op, "bm ", 3) == 0 || strncmp(op, "am ", 3) == 0) {
+                int is_bm = (op[0] == 'b');
+                char *save = NULL;
+                for (char *tok = strtok_r(op + 3, " \t", &save); tok != NULL;
+                     tok = strtok_r(NULL, " \t", &save)) {
+                    chess_move_t move;
+                    if (!san_find_move(&pos->state, tok, legal, n_legal, &move)) {
+                        printf("Mossa '%s' non riconosciuta a riga %d di '%s'\n",
+                               tok, lineno, path);
+                        fclose(f);
+                        return 0;
+                    }
+                    if (is_bm && pos->n_bm < MAX_SOLUTIONS) {
+                        pos->bm[pos->n_bm++] = move;
+                    } else if (!is_bm && pos->n_am < MAX_SOLUTIONS) {
+                        pos->am[pos->n_am++] = move;
+                    }
+                }
+            } else if (strncmp(op, "id ", 3) == 0) {
+                const char *q1 = strchr(op + 3, '"');
+                const char *q2 = q1 ? strchr(q1 + 1, '"') : NULL;
+                if (q1 && q2 && q2 > q1) {
+                    int idlen = (int)(q2 - q1 - 1);
+                    if (idlen >= (int)sizeof(pos->id)) {
+                        idlen = (int)sizeof(pos->id) - 1;
+                    }
+                    memcpy(pos->id, q1 + 1, (size_t)idlen);
+                    pos->id[idlen] = '\0';
+                }
+            }
+        }
+
+        if (pos->n_bm == 0 && pos->n_am == 0) {
+            printf("Nessun opcode bm/am a riga %d di '%s': la posizione "
+                   "non è verificabile\n", lineno, path);
+            fclose(f);
+            return 0;
+        }
+        count++;
+    }
+    fclose(f);
+
+    if (count == 0) {
+        printf("Nessuna posizione in '%s'\n", path);
+    }
+    return count;
+}
+
+/* --------------------------------------------------------------------------
+ * LATO FIGLIO: una posizione
+ * -------------------------------------------------------------------------- */
+
+/* Stato della callback di progresso del figlio (un processo per posizione:
+ * gli statici non si pestano) */
+static const epd_pos_t *s_cur = NULL;
+static long             s_sol_ms = -1;   /* quando la soluzione si è stabilita */
+static int              s_sol_depth = 0;
+static int              s_last_iter_depth = 0;
+static volatile int     s_stop = 0;
+
+static int move_is_solution(const epd_pos_t *pos, const chess_move_t *move) {
+    for (int i = 0; i < pos->n_am; i++) {
+        if (pos->am[i].from == move->from && pos->am[i].to == move->to &&
+            pos->am[i].promotion == move->promotion) {
+            return 0;
+        }
+    }
+    if (pos->n_bm == 0) {
+        return 1; /* solo am: basta evitare le mosse proibite */
+    }
+    for (int i = 0; i < pos->n_bm; i++) {
+        if (pos->bm[i].from == move->from && pos->bm[i].to == move->to &&
+            pos->bm[i].promotion == move->promotion) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void epd_progress(const search_progress_t *progress, void *user_data) {
+    (void) user_data;
+    s_last_iter_depth = progress->depth;
+    if (progress->pv_length > 0) {
+        chess_move_t best = *(const chess_move_t*)progress->pv_moves[0];
+        if (move_is_solution(s_cur, &best)) {
+            if (s_sol_ms < 0) {
+                s_sol_ms = progress->elapsed_ms;
+                s_sol_depth = progress->depth;
+            }
+        } else {
+            s_sol_ms = -1; /* ripensamento: la soluzione non si è stabilita */
+        }
+    }
+    if (s_node_cap > 0 && progress->nodes >= s_node_cap) {
+        s_stop = 1;
+    }
+}
+
+/*
+ * Risolve una posizione con i tetti correnti e scrive la riga d'esito sul
+ * descrittore della pipe: "idx solved tts_ms depth nodes ms".
+ */
+static void solve_position(const game_descriptor_t *gd, const epd_pos_t *pos,
+                           int idx, int fd) {
+    minimax_tt_t *tt = minimax_tt_create(EPD_TT_MB);
+    if (tt) {
+        minimax_set_ttable(tt);
+    }
+
+    chess_repetition_reset();
+    chess_repetition_push(chess_hash_state(&pos->state));
+
+    s_cur = pos;
+    minimax_set_progress_callback(epd_progress, NULL);
+
+    void *move;
+    if (s_node_cap > 0) {
+        move = get_best_move_stoppable(gd, &pos->state, s_depth, &s_stop, NULL);
+    } else {
+        move = get_best_move_timed(gd, &pos->state, s_depth,
+                                   s_time_ms, s_time_ms, NULL);
+    }
+    search_stats_t stats = minimax_get_search_stats();
+    minimax_set_progress_callback(NULL, NULL);
+
+    int solved = 0;
+    long tts = -1;
+    if (move) {
+        solved = move_is_solution(pos, (const chess_move_t*)move);
+        gd->free_move(move);
+    }
+    if (solved) {
+        /* La prima iterazione completa prima di ogni callback e i driver
+           scartano le iterazioni abortite: se la mossa finale è giusta la
+           callback l'ha vista stabilirsi */
+        tts = (s_sol_ms >= 0) ? s_sol_ms : stats.elapsed_ms;
+    }
+
+    char line[160];
+    int len = snprintf(line, sizeof(line), "%d %d %ld %d %lu %ld\n",
+                       idx, solved, tts,
+                       solved ? s_sol_depth : s_last_iter_depth,
+                       stats.nodes + stats.qnodes, stats.elapsed_ms);
+    if (write(fd, line, (size_t)len) != len) {
+        _exit(1);
+    }
+
+    minimax_set_ttable(NULL);
+    if (tt) {
+        minimax_tt_destroy(tt);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * LATO PADRE: scheduling e aggregazione per suite
+ * -------------------------------------------------------------------------- */
+
+static int cmp_long(const void *a, const void *b) {
+    long la = *(const long*)a, lb = *(const long*)b;
+    return (la > lb) - (la < lb);
+}
+
+/* Percentile k (0..100) di un array ORDINATO di n elementi */
+static long percentile(const long *sorted, int n, int k) {
+    return sorted[(n - 1) * k / 100];
+}
+
+/*
+ * Esegue una suite: al più 'jobs' figli vivi, una posizione per figlio.
+ * Stampa il report leggibile e appende la riga CSV. Ritorna 0 su errore.
+ */
+static int run_suite(const game_descriptor_t *gd, const char *path, int jobs) {
+    static epd_pos_t positions[MAX_POSITIONS];
+    int total = load_suite(path, positions, MAX_POSITIONS);
+    if (total == 0) {
+        return 0;
+    }
+    if (jobs > total) {
+        jobs = total;
+    }
+
+    int pipe_fd[2];
+    if (pipe(pipe_fd) != 0) {
+        perror("pipe");
+        return 0;
+    }
+    FILE *results_in = fdopen(pipe_fd[0], "r");
+    if (!results_in) {
+        perror("fdopen");
+        return 0;
+    }
+
+    printf("=== %s: %d posizioni, %d in parallelo ===\n", path, total, jobs);
+
+    int launched = 0, finished = 0, active = 0;
+    int solved_count = 0;
+    unsigned long total_nodes = 0;
+    long total_ms = 0;
+    static long tts[MAX_POSITIONS];
+
+    while (finished < total) {
+        while (active < jobs && launched < total) {
+            int idx = launched++;
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                launched--;
+                break; /* si riprova quando un figlio termina */
+            }
+            if (pid == 0) {
+                close(pipe_fd[0]);
+                solve_position(gd, &positions[idx], idx, pipe_fd[1]);
+                _exit(0);
+            }
+            active++;
+        }
+
+        if (active == 0) {
+            printf("Nessun figlio avviabile, interrompo\n");
+            break;
+        }
+
+        int status = 0;
+        if (waitpid(-1, &status, 0) < 0) {
+            perror("waitpid");
+            break;
+        }
+        active--;
+
+        char line[160];
+        if (!fgets(line, sizeof(line), results_in)) {
+            printf("Esito mancante da un figlio, interrompo\n");
+            break;
+        }
+        int idx = -1, solved = 0, depth = 0;
+        long pos_tts = -1, ms = 0;
+        unsigned long nodes = 0;
+        if (sscanf(line, "%d %d %ld %d %lu %ld",
+                   &idx, &solved, &pos_tts, &depth, &nodes, &ms) != 6 ||
+            idx < 0 || idx >= total) {
+            printf("Esito non interpretabile: %s", line);
+            break;
+        }
+        finished++;
+        total_nodes += nodes;
+        total_ms += ms;
+
+        if (solved) {
+            tts[solved_count++] = pos_tts;
+            printf("[%3d/%d] %-16s risolta  a %5ld ms (prof. %d, %lu nodi)\n",
+                   finished, total, positions[idx].id, pos_tts, depth, nodes);
+        } else {
+            printf("[%3d/%d] %-16s MANCATA  (prof. %d, %lu nodi, %ld ms)\n",
+                   finished, total, positions[idx].id, depth, nodes, ms);
+        }
+    }
+    close(pipe_fd[1]);
+    fclose(results_in);
+    if (finished < total) {
+        return 0;
+    }
+
+    printf("\n=== %s: risolte %d/%d", path, solved_count, total);
+    if (solved_count > 0) {
+        qsort(tts, (size_t)solved_count, sizeof(long), cmp_long);
+        printf("  tempo-alla-soluzione p50=%ld ms p90=%ld ms max=%ld ms",
+               percentile(tts, solved_count, 50),
+               percentile(tts, solved_count, 90),
+               percentile(tts, solved_count, 100));
+    }
+    printf(" ===\n\n");
+
+    /* Record macchina, nello stile di chess_bench: una riga per suite */
+    printf("suite,posizioni,risolte,p50_ms,p90_ms,max_ms,nodi,ms\n");
+    printf("%s,%d,%d,%ld,%ld,%ld,%lu,%ld\n\n",
+           path, total, solved_count,
+           (solved_count > 0) ? percentile(tts, solved_count, 50) : -1L,
+           (solved_count > 0) ? percentile(tts, solved_count, 90) : -1L,
+           (solved_count > 0) ? percentile(tts, solved_count, 100) : -1L,
+           total_nodes, total_ms);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    int jobs = 0; /* 0 = default: numero di core */
+    const char *suites[64];
+    int n_suites = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "time=", 5) == 0) {
+            s_time_ms = atol(argv[i] + 5);
+        } else if (strncmp(argv[i], "nodes=", 6) == 0) {
+            s_node_cap = strtoul(argv[i] + 6, NULL, 10);
+        } else if (strncmp(argv[i], "depth=", 6) == 0) {
+            s_depth = atoi(argv[i] + 6);
+        } else if (strncmp(argv[i], "jobs=", 5) == 0) {
+            jobs = atoi(argv[i] + 5);
+        } else if (n_suites < (int)(sizeof(suites) / sizeof(suites[0]))) {
+            suites[n_suites++] = argv[i];
+        }
+    }
+    if (n_suites == 0) {
+        printf("Uso: %s [time=MS] [nodes=N] [depth=N] [jobs=N] "
+               "suite.epd [altra.epd ...]\n", argv[0]);
+        return 1;
+    }
+    if (s_node_cap == 0 && s_time_ms < 1) {
+        printf("Parametri non validi (time >= 1 oppure nodes > 0)\n");
+        return 1;
+    }
+
+    if (jobs <= 0) {
+        jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (jobs < 1) jobs = 1;
+
+    /* Il runner misura la ricerca: niente trace di debug nel ciclo caldo */
+    trace_set_channel_level(&stdtrace, TRACE_LEVEL_ERROR);
+
+    game_descriptor_t *gd = initialize_chess_game_descriptor();
+    if (gd == NULL) {
+        printf("Inizializzazione del descrittore fallita\n");
+        return 1;
+    }
+
+    if (s_node_cap > 0) {
+        printf("Tetto per posizione: %lu nodi\n\n", s_node_cap);
+    } else {
+        printf("Tetto per posizione: %ld ms\n\n", s_time_ms);
+    }
+
+    int failures = 0;
+    for (int i = 0; i < n_suites; i++) {
+        if (!run_suite(gd, suites[i], jobs)) {
+            failures++;
+        }
+    }
+
+    free(gd);
+    return (failures > 0) ? 1 : 0;
+}
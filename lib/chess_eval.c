@@ -0,0 +1,345 @@
+/**
+ * ##VERSION## "chess_eval.c 1.1"
+ */
+
+#include "chess_eval.h"
+
+/* --------------------------------------------------------------------------
+ * TABELLE PIECE-SQUARE E VALORI MATERIALI
+ * --------------------------------------------------------------------------
+ * Tabelle classiche ("simplified evaluation function"), scritte come si
+ * legge una scacchiera dal lato del Nero: la PRIMA riga è l'ottava traversa.
+ * L'indice di casella del motore ha invece a1 = 0, quindi il Bianco legge
+ * la tabella con il rango specchiato (sq ^ 56) e il Nero direttamente.
+ *
+ * Cavallo, alfiere, torre e regina usano la stessa tabella nelle due fasi;
+ * pedone e re cambiano davvero pelle tra mediogioco e finale: il pedone
+ * avanzato domina il finale, il re passa da "nascosto dietro i pedoni" a
+ * "attivo al centro".
+ */
+
+static const int material_value[6] = { 100, 320, 330, 500, 900, 0 };
+
+static const int pst_pawn_mg[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+static const int pst_pawn_eg[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    80, 80, 80, 80, 80, 80, 80, 80,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    30, 30, 30, 30, 30, 30, 30, 30,
+    20, 20, 20, 20, 20, 20, 20, 20,
+    10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+static const int pst_knight[64] = {
+   -50,-40,-30,-30,-30,-30,-40,-50,
+   -40,-20,  0,  0,  0,  0,-20,-40,
+   -30,  0, 10, 15, 15, 10,  0,-30,
+   -30,  5, 15, 20, 20, 15,  5,-30,
+   -30,  0, 15, 20, 20, 15,  0,-30,
+   -30,  5, 10, 15, 15, 10,  5,-30,
+   -40,-20,  0,  5,  5,  0,-20,-40,
+   -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+static const int pst_bishop[64] = {
+   -20,-10,-10,-10,-10,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5, 10, 10,  5,  0,-10,
+   -10,  5,  5, 10, 10,  5,  5,-10,
+   -10,  0, 10, 10, 10, 10,  0,-10,
+   -10, 10, 10, 10, 10, 10, 10,-10,
+   -10,  5,  0,  0,  0,  0,  5,-10,
+   -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+static const int pst_rook[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     5, 10, 10, 10, 10, 10, 10,  5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+     0,  0,  0,  5,  5,  0,  0,  0
+};
+
+static const int pst_queen[64] = {
+   -20,-10,-10, -5, -5,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5,  5,  5,  5,  0,-10,
+    -5,  0,  5,  5,  5,  5,  0, -5,
+     0,  0,  5,  5,  5,  5,  0, -5,
+   -10,  5,  5,  5,  5,  5,  0,-10,
+   -10,  0,  5,  0,  0,  0,  0,-10,
+   -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+static const int pst_king_mg[64] = {
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -20,-30,-30,-40,-40,-30,-30,-20,
+   -10,-20,-20,-20,-20,-20,-20,-10,
+    20, 20,  0,  0,  0,  0, 20, 20,
+    20, 30, 10,  0,  0, 10, 30, 20
+};
+
+static const int pst_king_eg[64] = {
+   -50,-40,-30,-20,-20,-30,-40,-50,
+   -30,-20,-10,  0,  0,-10,-20,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-30,  0,  0,  0,  0,-30,-30,
+   -50,-30,-30,-30,-30,-30,-30,-50
+};
+
+/* Indirizzamento uniforme per tipo di pezzo (0=P 1=N 2=B 3=R 4=Q 5=K) */
+static const int *pst_mg[6] = {
+    pst_pawn_mg, pst_knight, pst_bishop, pst_rook, pst_queen, pst_king_mg
+};
+static const int *pst_eg[6] = {
+    pst_pawn_eg, pst_knight, pst_bishop, pst_rook, pst_queen, pst_king_eg
+};
+
+/*
+ * Peso di fase per tipo di pezzo: la fase della partita è la somma dei pesi
+ * dei pezzi non-pedone sul tavoliere, 24 a inizio partita (4 minori + 4
+ * torri + 2 regine per parte), 0 nel finale puro di re e pedoni. La
+ * valutazione fonde i totali mg/eg in proporzione.
+ */
+static const int phase_weight[6] = { 0, 1, 1, 2, 4, 0 };
+
+#define PHASE_MAX 24
+
+/*
+ * Contributo di un singolo pezzo: materiale + PST nelle due fasi.
+ * `sq` è l'indice del motore (a1 = 0); il Bianco specchia il rango perché
+ * le tabelle sono scritte con l'ottava traversa in testa.
+ */
+static inline int piece_mg(int piece, int sq, int is_white) {
+    int idx = is_white ? (sq ^ 56) : sq;
+    return material_value[piece] + pst_mg[piece][idx];
+}
+
+static inline int piece_eg(int piece, int sq, int is_white) {
+    int idx = is_white ? (sq ^ 56) : sq;
+    return material_value[piece] + pst_eg[piece][idx];
+}
+
+/*
+ * Ricalcolo completo di riferimento delle tre somme (mg, eg, fase) dai 12
+ * bitboard: usato per seminare lo stato e come ripiego per gli stati
+ * costruiti a mano mai seminati.
+ */
+static void compute_full_eval(const bitboard_state_t *state,
+                              int *mg_out, int *eg_out, int *phase_out) {
+    const uint64_t white_pieces[6] = {
+        state->white_pawns, state->white_knights, state->white_bishops,
+        state->white_rooks, state->white_queens, state->white_kings
+    };
+    const uint64_t black_pieces[6] = {
+        state->black_pawns, state->black_knights, state->black_bishops,
+        state->black_rooks, state->black_queens, state->black_kings
+    };
+
+    int mg = 0, eg = 0, phase = 0;
+    for (int piece = 0; piece < 6; piece++) {
+        uint64_t bb = white_pieces[piece];
+        while (bb) {
+            int sq = __builtin_ctzll(bb);
+            mg += piece_mg(piece, sq, 1);
+            eg += piece_eg(piece, sq, 1);
+            phase += phase_weight[piece];
+            bb &= bb - 1;
+        }
+        bb = black_pieces[piece];
+        while (bb) {
+            int sq = __builtin_ctzll(bb);
+            mg -= piece_mg(piece, sq, 0);
+            eg -= piece_eg(piece, sq, 0);
+            phase += phase_weight[piece];
+            bb &= bb - 1;
+        }
+    }
+
+    *mg_out = mg;
+    *eg_out = eg;
+    *phase_out = phase;
+}
+
+void chess_refresh_eval(bitboard_state_t *state) {
+    if (!state) return;
+    int mg, eg, phase;
+    compute_full_eval(state, &mg, &eg, &phase);
+    state->eval_mg = mg;
+    state->eval_eg = eg;
+    state->eval_phase = phase;
+    state->eval_ok = 1;
+}
+
+void chess_eval_update(const bitboard_state_t *before, bitboard_state_t *after) {
+    if (!before || !after) return;
+    if (!before->eval_ok) {
+        after->eval_ok = 0; /* mai seminato: si resta sul calcolo completo */
+        return;
+    }
+
+    const uint64_t before_white[6] = {
+        before->white_pawns, before->white_knights, before->white_bishops,
+        before->white_rooks, before->white_queens, before->white_kings
+    };
+    const uint64_t after_white[6] = {
+        after->white_pawns, after->white_knights, after->white_bishops,
+        after->white_rooks, after->white_queens, after->white_kings
+    };
+    const uint64_t before_black[6] = {
+        before->black_pawns, before->black_knights, before->black_bishops,
+        before->black_rooks, before->black_queens, before->black_kings
+    };
+    const uint64_t after_black[6] = {
+        after->black_pawns, after->black_knights, after->black_bishops,
+        after->black_rooks, after->black_queens, after->black_kings
+    };
+
+    int mg = before->eval_mg;
+    int eg = before->eval_eg;
+    int phase = before->eval_phase;
+
+    for (int piece = 0; piece < 6; piece++) {
+        /* Bianco: bit tolti (catture, partenze) e bit aggiunti (arrivi) */
+        uint64_t removed = before_white[piece] & ~after_white[piece];
+        uint64_t added   = after_white[piece] & ~before_white[piece];
+        while (removed) {
+            int sq = __builtin_ctzll(removed);
+            mg -= piece_mg(piece, sq, 1);
+            eg -= piece_eg(piece, sq, 1);
+            phase -= phase_weight[piece];
+            removed &= removed - 1;
+        }
+        while (added) {
+            int sq = __builtin_ctzll(added);
+            mg += piece_mg(piece, sq, 1);
+            eg += piece_eg(piece, sq, 1);
+            phase += phase_weight[piece];
+            added &= added - 1;
+        }
+
+        /* Nero: segni invertiti sulle somme, stessa fase */
+        removed = before_black[piece] & ~after_black[piece];
+        added   = after_black[piece] & ~before_black[piece];
+        while (removed) {
+            int sq = __builtin_ctzll(removed);
+            mg += piece_mg(piece, sq, 0);
+            eg += piece_eg(piece, sq, 0);
+            phase -= phase_weight[piece];
+            removed &= removed - 1;
+        }
+        while (added) {
+            int sq = __builtin_ctzll(added);
+            mg -= piece_mg(piece, sq, 0);
+            eg -= piece_eg(piece, sq, 0);
+            phase += phase_weight[piece];
+            added &= added - 1;
+        }
+    }
+
+    after->eval_mg = mg;
+    after->eval_eg = eg;
+    after->eval_phase = phase;
+    after->eval_ok = 1;
+}
+
+/*
+ * Fusione mg/eg comune al percorso singolo e a quello batch: fase bloccata
+ * al massimo (le promozioni possono superarlo) e bonus coppia di alfieri.
+ */
+static inline int blend_score(int mg, int eg, int phase, int bonus) {
+    if (phase > PHASE_MAX) {
+        phase = PHASE_MAX;
+    }
+    return (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX + bonus;
+}
+
+int chess_eval_position(const bitboard_state_t *state) {
+    if (!state) return 0;
+
+    int mg, eg, phase;
+    if (state->eval_ok) {
+        mg = state->eval_mg;
+        eg = state->eval_eg;
+        phase = state->eval_phase;
+    } else {
+        compute_full_eval(state, &mg, &eg, &phase);
+    }
+
+    /* Bonus per la coppia di alfieri (ereditato dalla vecchia valutazione) */
+    int bonus = 0;
+    if (__builtin_popcountll(state->white_bishops) >= 2) bonus += 30;
+    if (__builtin_popcountll(state->black_bishops) >= 2) bonus -= 30;
+
+    return blend_score(mg, eg, phase, bonus);
+}
+
+void chess_evaluate_batch(const bitboard_state_t *states, int n, int *out)
+{
+    if (!states || !out || n <= 0) {
+        return;
+    }
+
+    /*
+     * Lavoro a blocchi in due passate: la prima raccoglie le somme (lettura
+     * di campo per gli stati seminati, ricalcolo completo per gli altri) e
+     * il bonus coppia di alfieri; la seconda è aritmetica pura su array
+     * locali, senza rami né accessi indiretti, e il compilatore la
+     * vettorizza da solo con l'ISA dei flag di build (SSE/AVX2). Il blocco
+     * tiene i quattro array dentro una manciata di linee di cache.
+     */
+    enum { EVAL_BATCH_BLOCK = 32 };
+    int32_t mg[EVAL_BATCH_BLOCK], eg[EVAL_BATCH_BLOCK];
+    int32_t phase[EVAL_BATCH_BLOCK], bonus[EVAL_BATCH_BLOCK];
+
+    for (int base = 0; base < n; base += EVAL_BATCH_BLOCK) {
+        int m = n - base;
+        if (m > EVAL_BATCH_BLOCK) {
+            m = EVAL_BATCH_BLOCK;
+        }
+
+        for (int i = 0; i < m; i++) {
+            const bitboard_state_t *s = &states[base + i];
+            if (s->eval_ok) {
+                mg[i] = s->eval_mg;
+                eg[i] = s->eval_eg;
+                phase[i] = s->eval_phase;
+            } else {
+                int fmg, feg, fphase;
+                compute_full_eval(s, &fmg, &feg, &fphase);
+                mg[i] = fmg;
+                eg[i] = feg;
+                phase[i] = fphase;
+            }
+            int b = 0;
+            if (__builtin_popcountll(s->white_bishops) >= 2) b += 30;
+            if (__builtin_popcountll(s->black_bishops) >= 2) b -= 30;
+            bonus[i] = b;
+        }
+
+        for (int i = 0; i < m; i++) {
+            out[base + i] = blend_score(mg[i], eg[i], phase[i], bonus[i]);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file chess_eval.h
+ * @brief Valutazione materiale + piece-square table con fusione
+ *        midgame/endgame, mantenuta in modo incrementale nello stato.
+ *
+ * ##VERSION## "chess_eval.h 1.1"
+ *
+ * La vecchia valutazione ricontava il materiale da zero a ogni foglia e non
+ * aveva alcuna conoscenza posizionale. Questo modulo assegna a ogni coppia
+ * pezzo-casella un punteggio di apertura/mediogioco e uno di finale
+ * (tabelle classiche: pedoni avanzati che valgono di più nel finale, re al
+ * sicuro in apertura e attivo nel finale, cavalli centralizzati, ...) e
+ * fonde i due totali in proporzione alla fase della partita, stimata dal
+ * materiale pesante rimasto ("tapered evaluation").
+ *
+ * Le tre somme necessarie (totale midgame, totale endgame, fase) vivono
+ * nello stato (`eval_mg`/`eval_eg`/`eval_phase`) e vengono mantenute da
+ * `chess_make_move` per differenza rispetto allo snapshot di undo, come
+ * l'hash Zobrist incrementale: alla foglia la valutazione è una manciata
+ * di letture e una combinazione lineare, non una scansione dei bitboard.
+ *
+ * Uso:
+ *   - `initialize_board` semina le somme (via \ref chess_refresh_eval);
+ *     chi costruisce uno stato a mano che verrà valutato fa lo stesso.
+ *   - `chess_make_move` chiama \ref chess_eval_update dopo ogni mossa.
+ *   - `chess_evaluate` (chess_game_dynamics.c) usa \ref chess_eval_position
+ *     per le posizioni non terminali.
+ */
+
+#ifndef CHESS_EVAL_H
+#define CHESS_EVAL_H
+
+#include "chess_state.h"
+
+/**
+ * @brief Semina (o riallinea) le somme incrementali di valutazione.
+ *
+ * Ricalcola da zero `eval_mg`, `eval_eg` ed `eval_phase` dai 12 bitboard e
+ * marca lo stato come seminato (`eval_ok`). Da chiamare a chiusura del
+ * setup di uno stato costruito a mano che verrà valutato; da quel momento
+ * le somme viaggiano con lo stato e `chess_make_move` le mantiene.
+ *
+ * @param[in,out] state Stato di gioco da seminare.
+ */
+void chess_refresh_eval(bitboard_state_t *state);
+
+/**
+ * @brief Aggiorna le somme incrementali tra due stati consecutivi.
+ *
+ * Riporta su \p after le somme di \p before corrette per le sole differenze
+ * dei bitboard (2-4 bit per mossa: partenza, destinazione, eventuale
+ * cattura, torre dell'arrocco, pezzo promosso). Se \p before non è seminato
+ * anche \p after resta non seminato e la valutazione ripiegherà sul calcolo
+ * completo.
+ *
+ * @param[in]     before Stato di partenza (tipicamente lo snapshot di undo).
+ * @param[in,out] after  Stato di arrivo, già mutato.
+ */
+void chess_eval_update(const bitboard_state_t *before, bitboard_state_t *after);
+
+/**
+ * @brief Valutazione statica della posizione (non terminale).
+ *
+ * Fusione midgame/endgame delle somme materiale+PST in proporzione alla
+ * fase, più il bonus per la coppia di alfieri. Con lo stato seminato costa
+ * una combinazione lineare e due popcount; altrimenti ricalcola da zero.
+ *
+ * @param[in] state Stato di gioco da valutare.
+ * @return Punteggio in centesimi di pedone (positivo = vantaggio Bianco).
+ */
+int chess_eval_position(const bitboard_state_t *state);
+
+/**
+ * @brief Valuta un array contiguo di posizioni in blocco.
+ *
+ * Stessa semantica di \ref chess_eval_position applicata a \p n stati
+ * consecutivi (per-elemento: `out[i] = chess_eval_position(&states[i])`),
+ * ma organizzata per il throughput: una passata di raccolta delle somme e
+ * una passata di sola aritmetica su array locali, che il compilatore
+ * vettorizza con l'ISA dei flag di build. Pensata per le pipeline offline
+ * di scoring (corpora di \ref chess_pos_record_t mmappati, tuning della
+ * valutazione), dove le foglie arrivano a milioni per ciclo.
+ *
+ * @param[in]  states Array di \p n stati (idealmente seminati: il ripiego
+ *                    sul ricalcolo completo resta per-elemento).
+ * @param[in]  n      Numero di stati da valutare.
+ * @param[out] out    Array di \p n punteggi, uno per stato.
+ */
+void chess_evaluate_batch(const bitboard_state_t *states, int n, int *out);
+
+#endif /* CHESS_EVAL_H */
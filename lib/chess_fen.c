@@ -0,0 +1,272 @@
+/**
+ * ##VERSION## "chess_fen.c 1.0"
+ */
+
+#include "chess_fen.h"
+#include "chess_hash.h"
+#include "chess_eval.h"
+#include <string.h>
+#include <stdio.h>
+
+/*
+ * Ordine uniforme dei 12 bitboard, lo stesso di bitboard_state_t e del
+ * record binario: indici 0-5 i pezzi bianchi (P N B R Q K), 6-11 i neri.
+ */
+static uint64_t *state_boards(bitboard_state_t *s, int i)
+{
+    uint64_t *boards[12] = {
+        &s->white_pawns, &s->white_knights, &s->white_bishops,
+        &s->white_rooks, &s->white_queens,  &s->white_kings,
+        &s->black_pawns, &s->black_knights, &s->black_bishops,
+        &s->black_rooks, &s->black_queens,  &s->black_kings
+    };
+    return boards[i];
+}
+
+/* Lettere FEN nello stesso ordine dei 12 bitboard */
+static const char fen_piece_chars[13] = "PNBRQKpnbrqk";
+
+/* Indice del bitboard per una lettera FEN, -1 se non è un pezzo */
+static int piece_index(char c)
+{
+    const char *p = strchr(fen_piece_chars, c);
+    return (p && c != '\0') ? (int)(p - fen_piece_chars) : -1;
+}
+
+/* Chiude l'import: occupazioni, hash e somme di valutazione seminati */
+static void finish_import(bitboard_state_t *state)
+{
+    chess_refresh_occupancy(state);
+    chess_refresh_hash(state);
+    chess_refresh_eval(state);
+}
+
+/* Salta gli spazi; ritorna il primo carattere non-spazio */
+static const char *skip_spaces(const char *p)
+{
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+int chess_fen_parse(const char *fen, bitboard_state_t *state)
+{
+    if (!fen || !state) {
+        return 0;
+    }
+
+    memset(state, 0, sizeof(*state));
+    state->en_passant = 255;
+    state->fullmove_number = 1;
+
+    /* 1) Disposizione dei pezzi: otto traverse dall'ottava alla prima,
+     *    separate da '/', ciascuna lunga esattamente otto colonne. */
+    const char *p = skip_spaces(fen);
+    for (int rank = 7; rank >= 0; rank--) {
+        int file = 0;
+        while (*p != '\0' && *p != '/' && *p != ' ') {
+            if (*p >= '1' && *p <= '8') {
+                file += *p - '0';
+            } else {
+                int idx = piece_index(*p);
+                if (idx < 0 || file > 7) {
+                    return 0;
+                }
+                *state_boards(state, idx) |= 1ULL << (rank * 8 + file);
+                file++;
+            }
+            p++;
+        }
+        if (file != 8) {
+            return 0;
+        }
+        if (rank > 0) {
+            if (*p != '/') {
+                return 0;
+            }
+            p++;
+        }
+    }
+
+    /* 2) Giocatore di turno */
+    p = skip_spaces(p);
+    if (*p == 'w') {
+        state->current_player = 1;
+    } else if (*p == 'b') {
+        state->current_player = -1;
+    } else {
+        return 0;
+    }
+    p++;
+
+    /* 3) Diritti di arrocco (stessa bitmask di initialize_board) */
+    p = skip_spaces(p);
+    if (*p == '-') {
+        p++;
+    } else {
+        const char *start = p;
+        while (*p == 'K' || *p == 'Q' || *p == 'k' || *p == 'q') {
+            switch (*p) {
+                case 'K': state->castling_rights |= 1; break;
+                case 'Q': state->castling_rights |= 2; break;
+                case 'k': state->castling_rights |= 4; break;
+                case 'q': state->castling_rights |= 8; break;
+            }
+            p++;
+        }
+        if (p == start) {
+            return 0;
+        }
+    }
+
+    /* 4) Casella en passant */
+    p = skip_spaces(p);
+    if (*p == '-') {
+        p++;
+    } else {
+        if (p[0] < 'a' || p[0] > 'h' || p[1] < '1' || p[1] > '8') {
+            return 0;
+        }
+        state->en_passant = (uint8_t)((p[1] - '1') * 8 + (p[0] - 'a'));
+        p += 2;
+    }
+
+    /* 5-6) Contatori, opzionali (le righe EPD si fermano al campo 4) */
+    p = skip_spaces(p);
+    if (*p >= '0' && *p <= '9') {
+        unsigned half = 0, full = 0;
+        if (sscanf(p, "%u %u", &half, &full) == 2 && full >= 1) {
+            state->halfmove_clock = (uint8_t)half;
+            state->fullmove_number = (uint8_t)full;
+        }
+    }
+
+    /* Sanità minima: un re per parte */
+    if (__builtin_popcountll(state->white_kings) != 1 ||
+        __builtin_popcountll(state->black_kings) != 1) {
+        return 0;
+    }
+
+    finish_import(state);
+    return 1;
+}
+
+int chess_fen_write(const bitboard_state_t *state, char *buf, size_t buf_size)
+{
+    if (!state || !buf || buf_size < CHESS_FEN_MAX) {
+        return 0;
+    }
+
+    char *out = buf;
+
+    /* 1) Disposizione dei pezzi */
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < 8; file++) {
+            uint64_t mask = 1ULL << (rank * 8 + file);
+            int idx = -1;
+            for (int i = 0; i < 12; i++) {
+                if (*state_boards((bitboard_state_t*)state, i) & mask) {
+                    idx = i;
+                    break;
+                }
+            }
+            if (idx < 0) {
+                empty++;
+            } else {
+                if (empty > 0) {
+                    *out++ = (char)('0' + empty);
+                    empty = 0;
+                }
+                *out++ = fen_piece_chars[idx];
+            }
+        }
+        if (empty > 0) {
+            *out++ = (char)('0' + empty);
+        }
+        if (rank > 0) {
+            *out++ = '/';
+        }
+    }
+
+    /* 2) Giocatore di turno */
+    *out++ = ' ';
+    *out++ = (state->current_player == 1) ? 'w' : 'b';
+
+    /* 3) Diritti di arrocco */
+    *out++ = ' ';
+    if (state->castling_rights == 0) {
+        *out++ = '-';
+    } else {
+        if (state->castling_rights & 1) *out++ = 'K';
+        if (state->castling_rights & 2) *out++ = 'Q';
+        if (state->castling_rights & 4) *out++ = 'k';
+        if (state->castling_rights & 8) *out++ = 'q';
+    }
+
+    /* 4) Casella en passant */
+    *out++ = ' ';
+    if (state->en_passant == 255) {
+        *out++ = '-';
+    } else {
+        *out++ = (char)('a' + state->en_passant % 8);
+        *out++ = (char)('1' + state->en_passant / 8);
+    }
+
+    /* 5-6) Contatori */
+    out += snprintf(out, buf_size - (size_t)(out - buf), " %u %u",
+                    (unsigned)state->halfmove_clock,
+                    (unsigned)state->fullmove_number);
+
+    return (int)(out - buf);
+}
+
+int chess_epd_parse(const char *line, bitboard_state_t *state, const char **ops)
+{
+    if (!chess_fen_parse(line, state)) {
+        return 0;
+    }
+
+    if (ops) {
+        /* Gli opcode iniziano dopo il quarto campo (la FEN a quattro campi
+         * è sempre accettata da chess_fen_parse): saltiamo quattro token. */
+        const char *p = skip_spaces(line);
+        for (int field = 0; field < 4; field++) {
+            while (*p != '\0' && *p != ' ' && *p != '\t') p++;
+            p = skip_spaces(p);
+        }
+        *ops = p;
+    }
+    return 1;
+}
+
+void chess_pos_pack(const bitboard_state_t *state, chess_pos_record_t *rec)
+{
+    if (!state || !rec) return;
+
+    memset(rec, 0, sizeof(*rec)); /* padding a zero: file confrontabili */
+    for (int i = 0; i < 12; i++) {
+        rec->boards[i] = *state_boards((bitboard_state_t*)state, i);
+    }
+    rec->castling_rights = state->castling_rights;
+    rec->en_passant      = state->en_passant;
+    rec->halfmove_clock  = state->halfmove_clock;
+    rec->fullmove_number = state->fullmove_number;
+    rec->player          = (int8_t)state->current_player;
+}
+
+void chess_pos_unpack(const chess_pos_record_t *rec, bitboard_state_t *state)
+{
+    if (!rec || !state) return;
+
+    memset(state, 0, sizeof(*state));
+    for (int i = 0; i < 12; i++) {
+        *state_boards(state, i) = rec->boards[i];
+    }
+    state->castling_rights = rec->castling_rights;
+    state->en_passant      = rec->en_passant;
+    state->halfmove_clock  = rec->halfmove_clock;
+    state->fullmove_number = rec->fullmove_number;
+    state->current_player  = rec->player;
+
+    finish_import(state);
+}
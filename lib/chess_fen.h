@@ -0,0 +1,122 @@
+/**
+ * ##VERSION## "chess_fen.h 1.0"
+ *
+ * @file chess_fen.h
+ * @brief Import/export di posizioni: FEN, righe EPD e formato binario compatto.
+ *
+ * Fino ad ora una posizione poteva nascere solo da initialize_board() più una
+ * sequenza di mosse: benchmark, suite di test e corpora di tuning hanno invece
+ * bisogno di caricare posizioni arbitrarie. Questo modulo offre tre formati:
+ *
+ *  - FEN (Forsyth-Edwards Notation), il formato testuale standard: parsing e
+ *    serializzazione completi dei sei campi.
+ *  - EPD (Extended Position Description): una riga FEN ridotta ai primi
+ *    quattro campi seguita da opcode (`bm`, `id`, ...); il parser estrae la
+ *    posizione e restituisce il puntatore agli opcode, che restano al
+ *    chiamante.
+ *  - Record binario a dimensione fissa (\ref chess_pos_record_t): i 12
+ *    bitboard grezzi più i flag, pensato per corpora di massa da mappare in
+ *    memoria e scorrere senza alcun parsing (un file è un semplice array di
+ *    record).
+ *
+ * Tutte le funzioni di import chiudono lo stato con chess_refresh_occupancy,
+ * chess_refresh_hash e chess_refresh_eval: la posizione caricata è subito
+ * pronta per generazione, ricerca e valutazione incrementale.
+ */
+
+#ifndef CHESS_FEN_H
+#define CHESS_FEN_H
+
+#include "chess_state.h"
+
+/**
+ * @def CHESS_FEN_MAX
+ * Dimensione di buffer sufficiente per qualunque FEN prodotta da
+ * \ref chess_fen_write (la FEN più lunga possibile resta sotto i 90
+ * caratteri, terminatore compreso).
+ */
+#define CHESS_FEN_MAX 96
+
+/**
+ * @brief Record binario a dimensione fissa di una posizione.
+ *
+ * Layout: i 12 bitboard nell'ordine dei campi di \ref bitboard_state_t
+ * (pedoni..re bianchi, poi neri), seguiti dai flag. `player` usa la stessa
+ * convenzione dello stato (1 = Bianco, -1 = Nero). I byte di padding in coda
+ * vengono azzerati da \ref chess_pos_pack, così i file sono confrontabili
+ * byte a byte. Un corpus su disco è un array contiguo di questi record,
+ * adatto a mmap: l'import è una \ref chess_pos_unpack per record, senza
+ * alcun parsing.
+ */
+typedef struct {
+    uint64_t boards[12];     /**< bitboard nell'ordine di bitboard_state_t */
+    uint8_t  castling_rights;/**< bitmask come nello stato */
+    uint8_t  en_passant;     /**< 0-63, 255 se assente */
+    uint8_t  halfmove_clock; /**< contatore regola delle 50 mosse */
+    uint8_t  fullmove_number;/**< numero del turno */
+    int8_t   player;         /**< 1 = Bianco, -1 = Nero */
+    uint8_t  pad[3];         /**< riserva, sempre a zero */
+} chess_pos_record_t;
+
+/**
+ * @brief Interpreta una stringa FEN e riempie \p state.
+ *
+ * Accetta sia la FEN completa a sei campi sia la forma a quattro campi usata
+ * dalle righe EPD (halfmove e fullmove assumono 0 e 1). La stringa può
+ * proseguire oltre la posizione: il parsing si ferma da solo e il resto
+ * viene ignorato.
+ *
+ * @param[in]  fen   Stringa FEN (almeno i primi quattro campi).
+ * @param[out] state Stato da riempire; in caso di errore resta indefinito.
+ * @return 1 se il parsing è riuscito, 0 se la stringa è malformata.
+ */
+int chess_fen_parse(const char *fen, bitboard_state_t *state);
+
+/**
+ * @brief Serializza \p state in una stringa FEN a sei campi.
+ *
+ * @param[in]  state    Posizione da serializzare.
+ * @param[out] buf      Buffer di output (consigliato \ref CHESS_FEN_MAX byte).
+ * @param[in]  buf_size Capienza del buffer.
+ * @return Lunghezza della stringa scritta (terminatore escluso), oppure 0 se
+ *         il buffer non basta o i parametri non sono validi.
+ */
+int chess_fen_write(const bitboard_state_t *state, char *buf, size_t buf_size);
+
+/**
+ * @brief Interpreta una riga EPD: posizione più eventuali opcode.
+ *
+ * La posizione è una FEN a quattro campi; tutto ciò che segue (gli opcode
+ * `bm`, `id`, `am`, ... separati da `;`) NON viene interpretato: \p ops
+ * riceve il puntatore al primo carattere dopo la posizione, all'interno
+ * della stringa del chiamante, così ogni suite può estrarre gli opcode che
+ * le interessano.
+ *
+ * @param[in]  line  Riga EPD.
+ * @param[out] state Stato da riempire.
+ * @param[out] ops   Puntatore agli opcode dentro \p line (o alla stringa
+ *                   vuota se assenti); può essere NULL se non interessa.
+ * @return 1 se la posizione è stata letta, 0 se la riga è malformata.
+ */
+int chess_epd_parse(const char *line, bitboard_state_t *state, const char **ops);
+
+/**
+ * @brief Impacchetta \p state in un record binario (padding azzerato).
+ *
+ * @param[in]  state Posizione da impacchettare.
+ * @param[out] rec   Record di destinazione.
+ */
+void chess_pos_pack(const bitboard_state_t *state, chess_pos_record_t *rec);
+
+/**
+ * @brief Ricostruisce lo stato da un record binario.
+ *
+ * Ripristina occupazioni, hash e somme di valutazione: lo stato è pronto
+ * per la ricerca come dopo una \ref chess_fen_parse.
+ *
+ * @param[in]  rec   Record da leggere (tipicamente dentro un file mmappato).
+ * @param[out] state Stato da riempire.
+ */
+void chess_pos_unpack(const chess_pos_record_t *rec, bitboard_state_t *state);
+
+#endif /* CHESS_FEN_H */
@@ -1,5 +1,5 @@
 /**
- * ##VERSION## "chess_game_descriptor.c 1.0"
+ * ##VERSION## "chess_game_descriptor.c 1.5"
 */
 
 #define CHESS_GAME_DESCRIPTOR_C
@@ -10,6 +10,7 @@
 #include "chess_moves.h"
 #include "chess_game_dynamics.h"
 #include "chess_hash.h"
+#include "chess_book.h"
 #include <stdlib.h>
 
 game_descriptor_t* initialize_chess_game_descriptor() {
@@ -44,5 +45,40 @@ game_descriptor_t* initialize_chess_game_descriptor() {
     gd->hash_state = chess_hash_state;
     gd->equals_state = chess_equals_state;
 
+    // Ordinamento delle mosse (killer/history in MiniMax)
+    gd->is_capture = chess_is_capture;
+    gd->move_index = chess_move_index;
+    gd->pack_move = chess_move_pack;
+
+    // Ricerca di quiescenza
+    gd->get_capture_moves = chess_get_capture_moves;
+
+    // Generazione nel buffer del chiamante (la ricerca la preferisce)
+    gd->generate_moves = chess_generate_moves;
+    gd->move_size = sizeof(chess_move_t);
+
+    // I generatori emettono SOLO mosse legali: lista vuota <=> terminale,
+    // la ricerca non deve richiamare is_terminal a ogni nodo interno
+    gd->moves_imply_terminal = 1;
+
+    // Patta per triplice ripetizione: la storia degli hash è mantenuta da
+    // chess_make_move/chess_unmake_move (vedi chess_repetition_reset)
+    gd->is_draw = chess_is_repetition_draw;
+
+    // Libro di aperture: restituisce NULL finché chess_book_open non ha
+    // mappato un libro, quindi senza libro i driver cercano come sempre
+    gd->get_book_move = chess_book_move;
+
+    // Make/unmake in place (niente malloc/free per nodo nella ricerca)
+    gd->make_move = chess_make_move;
+    gd->unmake_move = chess_unmake_move;
+    gd->undo_size = sizeof(chess_undo_t);
+
+    // Potatura null-move
+    gd->make_null_move = chess_make_null_move;
+
+    // Dimensione dello stato: abilita la cache by-value (minimax_cache_create)
+    gd->state_size = sizeof(bitboard_state_t);
+
     return gd;
 }
@@ -7,32 +7,136 @@
 #include "chess_hash.h"
 #include "chess_state.h"
 #include "chess_moves.h"
+#include "chess_magic.h"
+#include "chess_eval.h"
+#include "chess_bitbase.h"
 #include "obj_trace.h"
 
+/* Span di profilazione della pipeline di ricerca (attivi solo compilando
+   con -DTRACE_SPANS_ON, vedi obj_trace.h) */
+TRACE_SPAN_DEFINE(span_make_move, "chess_make_move");
+TRACE_SPAN_DEFINE(span_evaluate, "chess_evaluate");
+
+/* --------------------------------------------------------------------------
+ * STORIA DELLE POSIZIONI (triplice ripetizione)
+ * --------------------------------------------------------------------------
+ * Pila per-thread degli hash Zobrist delle posizioni raggiunte: seminata dal
+ * chiamante con il game record (chess_repetition_reset + chess_repetition_push),
+ * poi mantenuta automaticamente da chess_make_move / chess_make_null_move
+ * (push) e chess_unmake_move (pop). chess_is_repetition_draw la consulta per
+ * chiudere subito come patte le linee che ripetono tre volte la stessa
+ * posizione.
+ *
+ * Per-thread come le altre strutture ausiliarie della ricerca (pool dei
+ * vettori mosse, killer/history in minimax.c): niente lock, ma i worker
+ * della ricerca parallela vedono solo la storia del proprio sottoalbero,
+ * non quella della partita — le ripetizioni che attraversano il confine
+ * vengono semplicemente non rilevate, mai inventate.
+ *
+ * Oltre la capacità la pila smette di memorizzare ma continua a contare,
+ * così push e pop restano simmetrici; finché la storia è tronca il
+ * rilevamento si disattiva (meglio nessuna patta che una falsa, vedi
+ * chess_is_repetition_draw) e riprende quando i pop rientrano in capienza.
+ */
+#define CHESS_REP_STACK_MAX 1024  /* ~record di partita + profondità di ricerca */
+
+static __thread uint64_t rep_stack[CHESS_REP_STACK_MAX];
+static __thread int rep_top = 0;
+
+/**
+ * @brief Azzera la storia delle posizioni per il rilevamento delle ripetizioni.
+ */
+void chess_repetition_reset(void)
+{
+    rep_top = 0;
+}
+
+/**
+ * @brief Impila l'hash di una posizione nella storia delle ripetizioni.
+ */
+void chess_repetition_push(uint64_t hash)
+{
+    if (rep_top < CHESS_REP_STACK_MAX) {
+        rep_stack[rep_top] = hash;
+    }
+    rep_top++;
+}
+
+/**
+ * @brief Toglie dalla pila l'ultima posizione impilata (lato unmake).
+ */
+static void repetition_pop(void)
+{
+    if (rep_top > 0) {
+        rep_top--;
+    }
+}
+
+/**
+ * @brief Verifica se la posizione corrente è patta per triplice ripetizione.
+ */
+int chess_is_repetition_draw(const void *state)
+{
+    if (!state) {
+        return 0;
+    }
+    const bitboard_state_t *bit_state = (const bitboard_state_t*)state;
+
+    if (rep_top > CHESS_REP_STACK_MAX) {
+        /* Storia tronca: la posizione corrente non è memorizzata e la
+         * finestra non sarebbe allineata con le mezze mosse reali. */
+        return 0;
+    }
+    int stored = rep_top;
+    if (stored < 3) {
+        return 0; /* servono almeno tre occorrenze, quindi tre posizioni */
+    }
+
+    /* Solo le posizioni dall'ultima mossa irreversibile (cattura o mossa di
+     * pedone) possono coincidere con quella corrente: la finestra utile è
+     * halfmove_clock mezze mosse più la posizione corrente stessa. */
+    int window = (int)bit_state->halfmove_clock + 1;
+    int lo = stored - window;
+    if (lo < 0) {
+        lo = 0;
+    }
+
+    uint64_t h = chess_hash_state(bit_state);
+    int count = 0;
+    for (int i = stored - 1; i >= lo; i--) {
+        if (rep_stack[i] == h && ++count >= 3) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /**
  * @brief Restituisce il bitboard di tutti i pezzi bianchi nello stato \p s.
  *
+ * Legge l'occupazione aggregata mantenuta nello stato (vedi
+ * \ref chess_refresh_occupancy) invece di rifare l'OR dei sei bitboard.
+ *
  * @param s Puntatore allo stato bitboard.
  * @return Bitmask con 1 sulle caselle contenenti pezzi bianchi.
  */
 static inline uint64_t compute_white_occ(const bitboard_state_t *s)
 {
-    return (s->white_pawns   | s->white_knights |
-            s->white_bishops | s->white_rooks   |
-            s->white_queens  | s->white_kings);
+    return s->occupied_white;
 }
 
 /**
  * @brief Restituisce il bitboard di tutti i pezzi neri nello stato \p s.
  *
+ * Legge l'occupazione aggregata mantenuta nello stato (vedi
+ * \ref chess_refresh_occupancy) invece di rifare l'OR dei sei bitboard.
+ *
  * @param s Puntatore allo stato bitboard.
  * @return Bitmask con 1 sulle caselle contenenti pezzi neri.
  */
 static inline uint64_t compute_black_occ(const bitboard_state_t *s)
 {
-    return (s->black_pawns   | s->black_knights |
-            s->black_bishops | s->black_rooks   |
-            s->black_queens  | s->black_kings);
+    return s->occupied_black;
 }
 
 /**
@@ -43,8 +147,7 @@ static inline uint64_t compute_black_occ(const bitboard_state_t *s)
  */
 static inline uint64_t compute_all_occ(const bitboard_state_t *s)
 {
-    // Usiamo le funzioni inline appena definite
-    return compute_white_occ(s) | compute_black_occ(s);
+    return s->occupied_all;
 }
 
 
@@ -154,8 +257,8 @@ void remove_piece_from_bitboards(bitboard_state_t *tempState, int from_square, i
 bitboard_state_t* simulate_position_without_piece(const bitboard_state_t *state,
                                                          const chess_move_t *move)
 {
-    // Alloco una nuova struttura
-    bitboard_state_t *tempState = (bitboard_state_t*)malloc(sizeof(bitboard_state_t));
+    // Alloco una nuova struttura (dalla free-list per-thread degli stati)
+    bitboard_state_t *tempState = chess_alloc_state();
     if (!tempState) {
         return NULL; // out-of-memory
     }
@@ -191,18 +294,18 @@ bool is_attacked_by_pawn(const bitboard_state_t *state, int square, int attacker
     const uint64_t mask = 1ULL << square;
 
     if (attacker_player == 1) {
-        // Bianchi: un pedone bianco attacca "square" se "square" è diagonale
-        // in alto a sinistra o in alto a destra rispetto al pedone.
-        // Invertendo il discorso: se "square" è la destinazione, la posizione
-        // di partenza del pedone è "square + 7" (destra) o "square + 9" (sinistra).
+        // Bianchi: un pedone bianco in "p" attacca "p + 7" e "p + 9" (sale
+        // verso l'alto). Invertendo il discorso: "square" è attaccata se c'è
+        // un pedone bianco in "square - 7" o "square - 9".
         // Attenzione al wrap sugli estremi del file.
-        if (((mask << 7) & attacker_pawns & NOT_H_FILE) != 0ULL) return true;
-        if (((mask << 9) & attacker_pawns & NOT_A_FILE) != 0ULL) return true;
-    } else {
-        // Neri: un pedone nero attacca "square" se "square" è diagonale
-        // in basso a sinistra (square - 9) o in basso a destra (square - 7).
         if (((mask >> 7) & attacker_pawns & NOT_A_FILE) != 0ULL) return true;
         if (((mask >> 9) & attacker_pawns & NOT_H_FILE) != 0ULL) return true;
+    } else {
+        // Neri: un pedone nero in "p" attacca "p - 7" e "p - 9" (scende verso
+        // il basso), quindi "square" è attaccata se c'è un pedone nero in
+        // "square + 7" o "square + 9".
+        if (((mask << 7) & attacker_pawns & NOT_H_FILE) != 0ULL) return true;
+        if (((mask << 9) & attacker_pawns & NOT_A_FILE) != 0ULL) return true;
     }
 
     return false;
@@ -220,56 +323,11 @@ bool is_attacked_by_knight(const bitboard_state_t *state, int square, int attack
                                 ? state->white_knights
                                 : state->black_knights;
 
-    // Costruiamo una maschera con un 1 sul bit "square"
-    uint64_t sq_mask = 1ULL << square;
-
-    // Verifichiamo se un cavallo dell'avversario può occupare "square".
-    // (In altre parole, spostiamo "sq_mask" nelle posizioni da cui un cavallo
-    // arriverebbe a "square" e controlliamo se coincide con un cavallo avversario).
-    uint64_t knights_from_positions = 0ULL;
-
-    // Cavalcando "from" su quell square, i possibili "from" sono:
-    // shift a sinistra / destra di 6, 10, 15, 17 con maschere di file.
-
-    // 2 verso sinistra e 1 in alto (square + 6)
-    if ((sq_mask << 6) & NOT_GH_FILE) {
-        knights_from_positions |= (sq_mask << 6);
-    }
-    // 2 verso sinistra e 1 in basso (square - 10)
-    if ((sq_mask >> 10) & NOT_GH_FILE) {
-        knights_from_positions |= (sq_mask >> 10);
-    }
-    // 2 verso destra e 1 in alto (square + 10)
-    if ((sq_mask << 10) & NOT_AB_FILE) {
-        knights_from_positions |= (sq_mask << 10);
-    }
-    // 2 verso destra e 1 in basso (square - 6)
-    if ((sq_mask >> 6) & NOT_AB_FILE) {
-        knights_from_positions |= (sq_mask >> 6);
-    }
-    // 1 verso sinistra e 2 in alto (square + 15)
-    if ((sq_mask << 15) & NOT_H_FILE) {
-        knights_from_positions |= (sq_mask << 15);
-    }
-    // 1 verso sinistra e 2 in basso (square - 17)
-    if ((sq_mask >> 17) & NOT_H_FILE) {
-        knights_from_positions |= (sq_mask >> 17);
-    }
-    // 1 verso destra e 2 in alto (square + 17)
-    if ((sq_mask << 17) & NOT_A_FILE) {
-        knights_from_positions |= (sq_mask << 17);
-    }
-    // 1 verso destra e 2 in basso (square - 15)
-    if ((sq_mask >> 15) & NOT_A_FILE) {
-        knights_from_positions |= (sq_mask >> 15);
-    }
-
-    // Ora se un cavallo avversario è in una di queste posizioni, la casella è sotto attacco
-    if (knights_from_positions & attacker_knights) {
-        return true;
-    }
-
-    return false;
+    // L'attacco del cavallo è simmetrico: le caselle da cui un cavallo
+    // arriva su "square" sono le stesse che un cavallo su "square"
+    // attaccherebbe. Una lettura di tabella al posto degli otto shift.
+    chess_magic_init();
+    return (chess_knight_attacks[square] & attacker_knights) != 0;
 }
 
 /**
@@ -393,9 +451,6 @@ bool is_attacked_by_bishop_or_queen(const bitboard_state_t *state,
                                            int square,
                                            int attacker_player)
 {
-    // Costruiamo un singolo bit con "square"
-    uint64_t sq_mask = 1ULL << square;
-
     // Bitboard dei pezzi "sliding" diagonali:
     uint64_t attacker_bishops = (attacker_player == 1)
                                 ? state->white_bishops
@@ -406,27 +461,13 @@ bool is_attacked_by_bishop_or_queen(const bitboard_state_t *state,
 
     uint64_t occupancy = compute_all_occ(state);
 
-    // Esplora 4 diagonali: +9, -9, +7, -7.
-    // Vediamo se, lungo quel raggio, troviamo un alfiere o una regina avversaria.
-    // Se "sq_mask" appare in quell'insieme di raggi di un bishop/queen, indica attacco.
-    uint64_t diag_up_right = ray_moves(sq_mask, +9, occupancy);  // spostarsi su-destra
-    uint64_t diag_up_left  = ray_moves(sq_mask, +7, occupancy);  // spostarsi su-sinistra
-    uint64_t diag_dn_right = ray_moves(sq_mask, -7, occupancy);  // giù-destra
-    uint64_t diag_dn_left  = ray_moves(sq_mask, -9, occupancy);  // giù-sinistra
-
-    // Ora controlliamo se in una di queste posizioni c'è un alfiere o una regina
-    // che "copre" esattamente quell'angolo di attacco.
-    // Esempio: se c'è un bit di "attacker_bishops" in diag_up_right => attacco diagonale
-    // (lo includiamo in diag_up_right e stiamo a vedere se coincide).
-    // Ma attenzione: "diag_up_right" segna TUTTE le celle che si vedono salendo a dx
-    // sino al primo pezzo, inclusa la posizione di quel pezzo. Quindi,
-    // se quell'ultimo pezzo è un bishop/queen, => scacco.
-    if (diag_up_right & (attacker_bishops | attacker_queens)) return true;
-    if (diag_up_left  & (attacker_bishops | attacker_queens)) return true;
-    if (diag_dn_right & (attacker_bishops | attacker_queens)) return true;
-    if (diag_dn_left  & (attacker_bishops | attacker_queens)) return true;
+    // Lookup magica: l'insieme diagonale "visibile" da square, inclusa la
+    // prima casella occupata di ogni raggio. Se lì c'è un alfiere o una
+    // regina avversaria, la casella è attaccata.
+    chess_magic_init();
+    uint64_t diag = chess_magic_bishop_attacks(square, occupancy);
 
-    return false;
+    return (diag & (attacker_bishops | attacker_queens)) != 0;
 }
 
 /**
@@ -438,9 +479,6 @@ bool is_attacked_by_rook_or_queen(const bitboard_state_t *state,
                                          int square,
                                          int attacker_player)
 {
-    // Bit della casella "square"
-    uint64_t sq_mask = 1ULL << square;
-
     // Bitboard dei pezzi rook e queen
     uint64_t attacker_rooks = (attacker_player == 1)
                               ? state->white_rooks
@@ -451,19 +489,13 @@ bool is_attacked_by_rook_or_queen(const bitboard_state_t *state,
 
     uint64_t occupancy = compute_all_occ(state);
 
-    // Esploriamo 4 direzioni: file su (+8), file giù (-8), rank destra (+1), rank sinistra (-1).
-    uint64_t up_moves    = ray_moves(sq_mask, +8, occupancy);
-    uint64_t down_moves  = ray_moves(sq_mask, -8, occupancy);
-    uint64_t right_moves = ray_moves(sq_mask, +1, occupancy);
-    uint64_t left_moves  = ray_moves(sq_mask, -1, occupancy);
-
-    // Se su una di queste direzioni troviamo un rook/queen, => attacco
-    if (up_moves    & (attacker_rooks | attacker_queens)) return true;
-    if (down_moves  & (attacker_rooks | attacker_queens)) return true;
-    if (right_moves & (attacker_rooks | attacker_queens)) return true;
-    if (left_moves  & (attacker_rooks | attacker_queens)) return true;
+    // Lookup magica: l'insieme di linea "visibile" da square, inclusa la
+    // prima casella occupata di ogni raggio. Se lì c'è una torre o una
+    // regina avversaria, la casella è attaccata.
+    chess_magic_init();
+    uint64_t lines = chess_magic_rook_attacks(square, occupancy);
 
-    return false;
+    return (lines & (attacker_rooks | attacker_queens)) != 0;
 }
 
 /**
@@ -480,34 +512,10 @@ bool is_attacked_by_king(const bitboard_state_t *state, int square, int attacker
 
     if (!attacker_king) return false;
 
-    // Se l'avversario ha un re in posizione "k", vediamo se "k" è in una delle
-    // 8 caselle adiacenti a "square".
-    // Qui possiamo semplicemente controllare la distanza in file e rank, oppure
-    // costruire le maschere di "king move" e verificare se "square" è incluso.
-    // Per semplicità, troviamo la posizione "k_pos" e controlliamo la differenza.
-
-#ifdef __GNUC__
-    int k_pos = __builtin_ctzll(attacker_king);
-#else
-    int k_pos = 0;
-    while (k_pos < 64 && !(attacker_king & (1ULL << k_pos))) {
-        k_pos++;
-    }
-    if (k_pos == 64) return false;
-#endif
-
-    int king_row = k_pos / 8;
-    int king_col = k_pos % 8;
-
-    int sq_row   = square / 8;
-    int sq_col   = square % 8;
-
-    // Se la differenza assoluta fra row e col non supera 1, => adiacente
-    if (abs(king_row - sq_row) <= 1 && abs(king_col - sq_col) <= 1) {
-        return true;
-    }
-
-    return false;
+    // Come per il cavallo: la tabella delle adiacenze è simmetrica, quindi
+    // "square" è attaccata se il re avversario sta su una casella adiacente.
+    chess_magic_init();
+    return (chess_king_attacks[square] & attacker_king) != 0;
 }
 
 
@@ -528,38 +536,9 @@ bool is_king_in_check(const bitboard_state_t *state, int player)
         return false;
     }
 
-    // 2) L'avversario è -player
-    int attacker = -player;
-
-    // 3) Verifica TUTTI i possibili attacchi
-
-    // a) pedoni avversari
-    if (is_attacked_by_pawn(state, king_pos, attacker)) {
-        return true;
-    }
-
-    // b) cavalli avversari
-    if (is_attacked_by_knight(state, king_pos, attacker)) {
-        return true;
-    }
-
-    // c) alfieri o regine avversari (diagonali)
-    if (is_attacked_by_bishop_or_queen(state, king_pos, attacker)) {
-        return true;
-    }
-
-    // d) torri o regine avversari (dritte, orizz/vert)
-    if (is_attacked_by_rook_or_queen(state, king_pos, attacker)) {
-        return true;
-    }
-
-    // e) re avversario
-    if (is_attacked_by_king(state, king_pos, attacker)) {
-        return true;
-    }
-
-    // Se arriviamo qui, nessun attacco trovato => re non in scacco
-    return false;
+    // 2) Un solo passaggio sulle tabelle: il re è in scacco se l'insieme
+    //    degli attaccanti della sua casella non è vuoto
+    return chess_attackers_to(state, king_pos, -player) != 0ULL;
 }
 
 
@@ -567,13 +546,19 @@ bool is_king_in_check(const bitboard_state_t *state, int player)
  * @brief Verifica se il pezzo che vogliamo muovere è "pinned".
  *
  * Significato di “pinned”:
- *  - Se sposto il pezzo da `move->from`, il Re (del giocatore che muove) rimane (o diventa) in scacco.
+ *  - Se eseguo la mossa `move`, il Re (del giocatore che muove) rimane (o diventa) in scacco.
  *
  * Implementazione:
- *  - Localizza il Re.
- *  - Crea una copia dello stato in cui il pezzo su `move->from` è rimosso.
+ *  - Crea una copia dello stato in cui il pezzo su `move->from` è rimosso,
+ *    l'eventuale pezzo catturato su `move->to` è rimosso e il pezzo mosso
+ *    viene riposizionato su `move->to`.
  *  - Verifica se il Re risulta in scacco in quella configurazione.
  *
+ * ATTENZIONE: non basta togliere il pezzo da `from`! Un pezzo inchiodato può
+ * comunque muoversi LUNGO la linea dell'inchiodatura (o catturare chi lo
+ * inchioda): se non riposizioniamo il pezzo su `to`, queste mosse legali
+ * verrebbero scartate (bug storico scoperto con perft, vedi chess_perft.c).
+ *
  * @param[in] state Riferimento allo stato attuale (bitboard_state_t).
  * @param[in] move  Mossa che si vuole applicare (chess_move_t).
  * @return `true` se il pezzo è pinned (la mossa è illegale), `false` altrimenti.
@@ -594,13 +579,40 @@ bool is_move_pinned(const bitboard_state_t *state, const chess_move_t *move)
         return false;
     }
 
-    // 3) Controlla se in questo stato (senza il pezzo su from) il Re è in scacco
+    // 3) Rimuovo l'eventuale pezzo avversario catturato su "to" (per l'en
+    //    passant il pedone catturato NON sta su "to" ma sulla casella
+    //    adiacente) ...
+    if (move->is_en_passant) {
+        int captured_sq = (state->current_player == 1) ? move->to - 8
+                                                       : move->to + 8;
+        remove_piece_from_bitboards(temp, captured_sq, -state->current_player);
+    } else {
+        remove_piece_from_bitboards(temp, move->to, -state->current_player);
+    }
+
+    // 4) ... e riposiziono il pezzo mosso su "to": ai fini del controllo di
+    //    scacco conta solo che la casella risulti occupata da un pezzo amico
+    //    (blocca le linee di attacco), il tipo è irrilevante. Per i pedoni il
+    //    bitboard scelto è comunque quello giusto.
+    {
+        uint64_t to_mask = 1ULL << move->to;
+        if (state->current_player == 1) {
+            temp->white_pawns |= to_mask;
+        } else {
+            temp->black_pawns |= to_mask;
+        }
+    }
+
+    // 5) Controlla se in questo stato (con la mossa "simulata") il Re è in
+    //    scacco. I bitboard di temp sono stati modificati a mano, quindi le
+    //    occupazioni aggregate vanno riallineate prima del test.
+    chess_refresh_occupancy(temp);
     bool pinned = is_king_in_check(temp, state->current_player);
 
-    // 4) Libera la copia temporanea
-    free(temp);
+    // 6) Libera la copia temporanea (torna nella free-list)
+    chess_free_state(temp);
 
-    // 5) Se pinned == true, vuol dire che quel pezzo non può muoversi liberamente
+    // 7) Se pinned == true, vuol dire che quella mossa lascia il Re in presa
     return pinned;
 }
 
@@ -1006,6 +1018,16 @@ void handle_promotion(bitboard_state_t *new_state, const chess_move_t *move)
  *   - Se muovo una torre in un angolo, perdo il diritto corrispondente (lungo o corto).
  *   - Se catturo una torre avversaria in un angolo, l’avversario perde il diritto corrispondente.
  *
+ * Implementazione: la logica è puramente POSIZIONALE — qualsiasi mossa che
+ * parte da, o arriva su, una casella "sensibile" (E1/E8, angoli) azzera i
+ * diritti associati a quella casella. Non serve ispezionare i bitboard, e
+ * questo rende la funzione corretta sia prima che dopo l'applicazione della
+ * mossa (viene chiamata DOPO, quindi i pezzi hanno già lasciato 'from' e una
+ * torre catturata è già sparita: i vecchi test sui bitboard fallivano sempre,
+ * bug storico scoperto con perft — vedi chess_perft.c). È anche innocuo
+ * azzerare diritti già persi: se su E1 muove un pezzo che non è il Re, i
+ * diritti bianchi erano comunque già azzerati quando il Re ha lasciato E1.
+ *
  * @param[in,out] new_state Stato da modificare.
  * @param[in]     move      Mossa che potrebbe influire sui diritti di arrocco.
  */
@@ -1016,90 +1038,24 @@ void update_castling_rights(bitboard_state_t *new_state, const chess_move_t *mov
     // - White Rooks in A1=0, H1=7
     // - Black King in E8=60
     // - Black Rooks in A8=56, H8=63
-
-    // (Adatta i valori se la tua convenzione differisce)
-
-    // 1) Se la mossa sposta il Re (bianco o nero), azzera i diritti per quel colore
-    //    Identifichiamo se la casella 'from' contiene un re bianco o nero
-    //    (in new_state->white_kings / new_state->black_kings).
-
-    uint64_t from_mask = 1ULL << move->from;
-    uint64_t to_mask   = 1ULL << move->to;
-
-    // Esempio di bitmask per i diritti (1,2,4,8). 
-    //  White kingside = 0x1
+    //
+    // Bitmask dei diritti:
+    //  White kingside  = 0x1
     //  White queenside = 0x2
-    //  Black kingside = 0x4
+    //  Black kingside  = 0x4
     //  Black queenside = 0x8
 
-    // Salviamo la maschera attuale
     uint8_t rights = new_state->castling_rights;
 
-    // --- 1) SE MUOVO IL RE ---
-    bool is_white_king = (new_state->white_kings & from_mask) != 0ULL;
-    bool is_black_king = (new_state->black_kings & from_mask) != 0ULL;
-
-    if (is_white_king) {
-        // Rimuovo i bit di White kingside e White queenside
-        // => (0x1 e 0x2) => 0x3 = b11
-        rights &= ~0x3; 
-    }
-    if (is_black_king) {
-        // Rimuovo i bit di Black kingside e Black queenside
-        // => (0x4 e 0x8) => 0xC = b1100
-        rights &= ~0xC; 
-    }
-
-    // --- 2) SE MUOVO UNA TORRE BIANCA O CATTURO UNA TORRE BIANCA ---
-    //    A1 = 0 => White queenside
-    //    H1 = 7 => White kingside
+    // --- Caselle del Re: muovere DA e1/e8 perde entrambi i diritti del colore
+    if (move->from == 4)  rights &= ~0x3;  // E1: Re bianco
+    if (move->from == 60) rights &= ~0xC;  // E8: Re nero
 
-    // 2a) Mossa di una torre bianca?
-    bool is_white_rook_from = ((new_state->white_rooks & from_mask) != 0ULL);
-
-    // 2b) Cattura di una torre bianca? => se 'to_mask' e' su white_rooks => to conteneva una torre bianca
-    bool is_white_rook_to   = ((new_state->white_rooks & to_mask) != 0ULL);
-
-    // Idem per torri nere
-    bool is_black_rook_from = ((new_state->black_rooks & from_mask) != 0ULL);
-    bool is_black_rook_to   = ((new_state->black_rooks & to_mask) != 0ULL);
-
-    // Se muovo una torre, "from" era su un angolo => perdo il diritto corrispondente
-    // Oppure se catturo una torre avversaria in un angolo, quell'avversario perde il diritto.
-
-    // --- Torre bianca su A1=0 => rimuove white queenside (0x2)
-    if (is_white_rook_from && move->from == 0) {
-        rights &= ~0x2;
-    }
-    // --- Torre bianca su H1=7 => rimuove white kingside (0x1)
-    if (is_white_rook_from && move->from == 7) {
-        rights &= ~0x1;
-    }
-    // --- Cattura di una torre bianca su A1=0 => rimuove white queenside
-    if (is_black_rook_from && move->to == 0 && is_white_rook_to) {
-        rights &= ~0x2;
-    }
-    // --- Cattura di una torre bianca su H1=7 => rimuove white kingside
-    if (is_black_rook_from && move->to == 7 && is_white_rook_to) {
-        rights &= ~0x1;
-    }
-
-    // --- Torre nera su A8=56 => rimuove black queenside (0x8)
-    if (is_black_rook_from && move->from == 56) {
-        rights &= ~0x8;
-    }
-    // --- Torre nera su H8=63 => rimuove black kingside (0x4)
-    if (is_black_rook_from && move->from == 63) {
-        rights &= ~0x4;
-    }
-    // --- Cattura di una torre nera su A8=56 => rimuove black queenside
-    if (is_white_rook_from && move->to == 56 && is_black_rook_to) {
-        rights &= ~0x8;
-    }
-    // --- Cattura di una torre nera su H8=63 => rimuove black kingside
-    if (is_white_rook_from && move->to == 63 && is_black_rook_to) {
-        rights &= ~0x4;
-    }
+    // --- Angoli: torre che muove (from) o torre catturata (to)
+    if (move->from == 0  || move->to == 0)  rights &= ~0x2;  // A1
+    if (move->from == 7  || move->to == 7)  rights &= ~0x1;  // H1
+    if (move->from == 56 || move->to == 56) rights &= ~0x8;  // A8
+    if (move->from == 63 || move->to == 63) rights &= ~0x4;  // H8
 
     // Aggiorna i diritti nel nuovo stato
     new_state->castling_rights = rights;
@@ -1123,13 +1079,14 @@ void update_en_passant(bitboard_state_t *new_state, const chess_move_t *move)
     new_state->en_passant = 255;
 
     // 2) Verifica se è effettivamente un "pedone" che sta muovendo.
-    //    Possiamo controllare se la casella 'from' contiene un pedone
-    //    (bianco o nero) nel bitboard.
-    //    Altrimenti, non è mossa di pedone => en_passant resta 255.
-    uint64_t from_mask = 1ULL << move->from;
+    //    ATTENZIONE: questa funzione viene chiamata DOPO apply_regular_move,
+    //    quindi il pezzo ha già lasciato 'from': va cercato sulla casella
+    //    di arrivo 'to'. (Una spinta di due passi non è mai una promozione,
+    //    quindi sul 'to' il pedone è ancora un pedone.)
+    uint64_t to_mask = 1ULL << move->to;
 
-    bool is_white_pawn = ((new_state->white_pawns & from_mask) != 0ULL);
-    bool is_black_pawn = ((new_state->black_pawns & from_mask) != 0ULL);
+    bool is_white_pawn = ((new_state->white_pawns & to_mask) != 0ULL);
+    bool is_black_pawn = ((new_state->black_pawns & to_mask) != 0ULL);
 
     if (!is_white_pawn && !is_black_pawn) {
         // Non è un pedone => non modifichiamo en_passant
@@ -1249,11 +1206,12 @@ int get_castling_squares(int from, int to, int squares[3])
     }
 
     // Arrocco lungo Bianco: E1 (4) -> C1 (2)
-    // "in mezzo": B1 (1) e D1 (3) – (C1=2 è la destinazione, la escludiamo)
+    // "in mezzo": solo D1 (3) – (C1=2 è la destinazione, la escludiamo).
+    // NOTA: B1 deve essere LIBERA (verificato in fase di generazione) ma il
+    // re non la attraversa, quindi può tranquillamente essere sotto attacco.
     if (from == 4 && to == 2) {
-        squares[0] = 1;  // B1
-        squares[1] = 3;  // D1
-        return 2;
+        squares[0] = 3;  // D1
+        return 1;
     }
 
     // ============ NERO =============
@@ -1266,11 +1224,12 @@ int get_castling_squares(int from, int to, int squares[3])
     }
 
     // Arrocco lungo Nero: E8 (60) -> C8 (58)
-    // "in mezzo": B8 (57) e D8 (59) – (C8=58 è la destinazione, la escludiamo)
+    // "in mezzo": solo D8 (59) – (C8=58 è la destinazione, la escludiamo).
+    // NOTA: B8 deve essere LIBERA (verificato in fase di generazione) ma il
+    // re non la attraversa, quindi può tranquillamente essere sotto attacco.
     if (from == 60 && to == 58) {
-        squares[0] = 57; // B8
-        squares[1] = 59; // D8
-        return 2;
+        squares[0] = 59; // D8
+        return 1;
     }
 
     // Se non corrisponde a questi 4 casi, ritorno 0 (arrocco non riconosciuto)
@@ -1305,35 +1264,358 @@ bool is_square_attacked(const bitboard_state_t *state,
                                int square,
                                int attacker_player)
 {
-    // 1) Pedoni avversari
-    if (is_attacked_by_pawn(state, square, attacker_player)) {
-        return true;
+    // Un solo passaggio: chi attacca la casella è un bitboard, e qui basta
+    // sapere se è vuoto o no
+    return chess_attackers_to(state, square, attacker_player) != 0ULL;
+}
+
+/**
+ * @brief Restituisce il bitboard dei pezzi di `attacker_player` che attaccano
+ *        la casella `square`.
+ *
+ * Stessa copertura di \ref is_square_attacked (pedoni, cavalli, alfieri/regine,
+ * torri/regine, re) ma in un unico passaggio sulle tabelle: gli attacchi sono
+ * simmetrici, quindi le caselle da cui un pezzo arriva su `square` sono quelle
+ * che un pezzo identico piazzato su `square` attaccherebbe. Il risultato è
+ * l'insieme completo degli attaccanti, non solo un sì/no: serve alle maschere
+ * di legalità (scaccanti multipli) e ai consumatori che vogliono enumerare.
+ *
+ * @param[in] state           Stato di gioco (bitboard_state_t).
+ * @param[in] square          Indice 0..63 della casella da controllare.
+ * @param[in] attacker_player Giocatore (1 = Bianco, -1 = Nero) attaccante.
+ * @return Bitboard con 1 sulle caselle dei pezzi attaccanti (0 = nessuno).
+ */
+uint64_t chess_attackers_to(const bitboard_state_t *state,
+                            int square,
+                            int attacker_player)
+{
+    chess_magic_init();
+
+    const uint64_t mask = 1ULL << square;
+    const uint64_t occ  = state->occupied_all;
+    uint64_t attackers = 0ULL;
+
+    // Pedoni: stessi shift (e stesse maschere anti-wrap) di is_attacked_by_pawn
+    if (attacker_player == 1) {
+        attackers |= (mask >> 7) & state->white_pawns & NOT_A_FILE;
+        attackers |= (mask >> 9) & state->white_pawns & NOT_H_FILE;
+    } else {
+        attackers |= (mask << 7) & state->black_pawns & NOT_H_FILE;
+        attackers |= (mask << 9) & state->black_pawns & NOT_A_FILE;
     }
 
-    // 2) Cavalli avversari
-    if (is_attacked_by_knight(state, square, attacker_player)) {
-        return true;
+    uint64_t knights = (attacker_player == 1) ? state->white_knights
+                                              : state->black_knights;
+    attackers |= chess_knight_attacks[square] & knights;
+
+    uint64_t kings = (attacker_player == 1) ? state->white_kings
+                                            : state->black_kings;
+    attackers |= chess_king_attacks[square] & kings;
+
+    uint64_t diag = (attacker_player == 1)
+        ? (state->white_bishops | state->white_queens)
+        : (state->black_bishops | state->black_queens);
+    attackers |= chess_magic_bishop_attacks(square, occ) & diag;
+
+    uint64_t line = (attacker_player == 1)
+        ? (state->white_rooks | state->white_queens)
+        : (state->black_rooks | state->black_queens);
+    attackers |= chess_magic_rook_attacks(square, occ) & line;
+
+    return attackers;
+}
+
+/**
+ * @brief Costruisce la mappa completa delle caselle attaccate da
+ *        `attacker_player` nella posizione `state`.
+ *
+ * Un'unica passata sui pezzi dell'attaccante (shift collettivi per i pedoni,
+ * tabelle per cavalli e re, tabelle magiche per gli sliders) produce l'unione
+ * di tutte le caselle sotto tiro. Chi deve interrogare più caselle della
+ * stessa posizione — l'arrocco attraversa fino a tre caselle — calcola la
+ * mappa una volta e poi testa ogni casella con un AND, invece di ripetere
+ * i sei sondaggi di \ref is_square_attacked per ciascuna.
+ *
+ * @param[in] state           Stato di gioco (bitboard_state_t).
+ * @param[in] attacker_player Giocatore (1 = Bianco, -1 = Nero) attaccante.
+ * @return Bitboard con 1 su ogni casella attaccata da almeno un pezzo.
+ */
+uint64_t chess_attack_map(const bitboard_state_t *state, int attacker_player)
+{
+    chess_magic_init();
+
+    const uint64_t occ = state->occupied_all;
+    uint64_t map = 0ULL;
+
+    // Pedoni: tutto l'insieme in due shift (catture a sinistra e a destra)
+    if (attacker_player == 1) {
+        map |= (state->white_pawns & NOT_A_FILE) << 7;
+        map |= (state->white_pawns & NOT_H_FILE) << 9;
+    } else {
+        map |= (state->black_pawns & NOT_H_FILE) >> 7;
+        map |= (state->black_pawns & NOT_A_FILE) >> 9;
     }
 
-    // 3) Alfieri o Regine (diagonali)
-    if (is_attacked_by_bishop_or_queen(state, square, attacker_player)) {
-        return true;
+    uint64_t knights = (attacker_player == 1) ? state->white_knights
+                                              : state->black_knights;
+    while (knights) {
+        int from = __builtin_ctzll(knights);
+        knights &= knights - 1;
+        map |= chess_knight_attacks[from];
     }
 
-    // 4) Torri o Regine (verticale/orizzontale)
-    if (is_attacked_by_rook_or_queen(state, square, attacker_player)) {
-        return true;
+    uint64_t kings = (attacker_player == 1) ? state->white_kings
+                                            : state->black_kings;
+    while (kings) {
+        int from = __builtin_ctzll(kings);
+        kings &= kings - 1;
+        map |= chess_king_attacks[from];
     }
 
-    // 5) Re avversario
-    if (is_attacked_by_king(state, square, attacker_player)) {
+    uint64_t diag = (attacker_player == 1)
+        ? (state->white_bishops | state->white_queens)
+        : (state->black_bishops | state->black_queens);
+    while (diag) {
+        int from = __builtin_ctzll(diag);
+        diag &= diag - 1;
+        map |= chess_magic_bishop_attacks(from, occ);
+    }
+
+    uint64_t line = (attacker_player == 1)
+        ? (state->white_rooks | state->white_queens)
+        : (state->black_rooks | state->black_queens);
+    while (line) {
+        int from = __builtin_ctzll(line);
+        line &= line - 1;
+        map |= chess_magic_rook_attacks(from, occ);
+    }
+
+    return map;
+}
+
+/* --------------------------------------------------------------------------
+ * LEGALITÀ SENZA APPLICARE: maschere di scacco e inchiodatura per posizione
+ * --------------------------------------------------------------------------
+ */
+
+/* Occupazione dei pezzi di un colore (1 = bianco, -1 = nero) */
+static uint64_t compute_player_occ(const bitboard_state_t *state, int player) {
+    return (player == 1) ? state->occupied_white : state->occupied_black;
+}
+
+/* Come is_square_attacked, ma con un'occupazione arbitraria per i raggi:
+   serve per le mosse di re, dove il re va tolto dall'occupazione (la sua
+   vecchia casella non deve bloccare il raggio dell'attaccante). I pezzi
+   "a salto" non dipendono dall'occupazione e usano i controlli standard. */
+static bool square_attacked_with_occ(const bitboard_state_t *state,
+                                     int square,
+                                     int attacker_player,
+                                     uint64_t occupancy)
+{
+    if (is_attacked_by_pawn(state, square, attacker_player))   return true;
+    if (is_attacked_by_knight(state, square, attacker_player)) return true;
+    if (is_attacked_by_king(state, square, attacker_player))   return true;
+
+    uint64_t diag_attackers = (attacker_player == 1)
+        ? (state->white_bishops | state->white_queens)
+        : (state->black_bishops | state->black_queens);
+    if (chess_magic_bishop_attacks(square, occupancy) & diag_attackers) {
         return true;
     }
 
-    // Nessun attacco trovato => non è sotto tiro
+    uint64_t line_attackers = (attacker_player == 1)
+        ? (state->white_rooks | state->white_queens)
+        : (state->black_rooks | state->black_queens);
+    if (chess_magic_rook_attacks(square, occupancy) & line_attackers) {
+        return true;
+    }
     return false;
 }
 
+/**
+ * @brief Calcola una volta per posizione le maschere di legalità.
+ *
+ * Riempie \p leg con: casella del re di chi muove, bitboard dei pezzi che
+ * lo scaccano, maschera di evasione (caselle che catturano lo scaccante o
+ * bloccano il suo raggio), pezzi inchiodati e raggio di inchiodatura per
+ * ciascuno. Con queste maschere `chess_is_move_legal` decide la legalità
+ * di ogni mossa senza applicarla.
+ */
+void chess_compute_legality(const bitboard_state_t *state, chess_legality_t *leg)
+{
+    chess_magic_init();
+
+    int player = state->current_player;
+    uint64_t own_occ = compute_player_occ(state, player);
+    uint64_t opp_occ = compute_player_occ(state, -player);
+    uint64_t occ = own_occ | opp_occ;
+
+    leg->checkers = 0ULL;
+    leg->evasion_mask = ~0ULL;
+    leg->pinned = 0ULL;
+    leg->king_sq = get_king_position(state, player);
+    if (leg->king_sq < 0) {
+        return; /* stato anomalo senza re: nessun filtro */
+    }
+
+    int ksq = leg->king_sq;
+
+    /* 1) Scaccanti diretti del re: l'insieme completo degli attaccanti in un
+       passaggio (include il re avversario adiacente, impossibile in partite
+       regolari ma presente in stati di test costruiti a mano) */
+    leg->checkers = chess_attackers_to(state, ksq, -player);
+
+    /* Sliders avversari, per la ricerca delle inchiodature al punto 3 */
+    uint64_t opp_diag = (player == 1)
+        ? (state->black_bishops | state->black_queens)
+        : (state->white_bishops | state->white_queens);
+    uint64_t opp_line = (player == 1)
+        ? (state->black_rooks | state->black_queens)
+        : (state->white_rooks | state->white_queens);
+
+    /* 2) Maschera di evasione: con uno scaccante solo si può catturarlo o
+       bloccarne il raggio; con doppio scacco muove solo il re */
+    int n_checkers = __builtin_popcountll(leg->checkers);
+    if (n_checkers == 1) {
+        int csq = __builtin_ctzll(leg->checkers);
+        leg->evasion_mask = leg->checkers | chess_between[ksq][csq];
+    } else if (n_checkers >= 2) {
+        leg->evasion_mask = 0ULL;
+    }
+
+    /* 3) Inchiodature: tolgo dall'occupazione i miei pezzi che bloccano i
+       raggi verso il re (raggi-x) e guardo quali slider avversari ora lo
+       vedrebbero. Per ogni candidato, se fra lui e il re c'è ESATTAMENTE
+       un mio pezzo, quel pezzo è inchiodato sul raggio. */
+    uint64_t blockers = (chess_magic_rook_attacks(ksq, occ) |
+                         chess_magic_bishop_attacks(ksq, occ)) & own_occ;
+    uint64_t occ_xray = occ ^ blockers;
+    uint64_t pinners = (chess_magic_rook_attacks(ksq, occ_xray) & opp_line)
+                     | (chess_magic_bishop_attacks(ksq, occ_xray) & opp_diag);
+    pinners &= ~leg->checkers; /* chi già scacca non inchioda */
+
+    while (pinners) {
+        int psq = __builtin_ctzll(pinners);
+        pinners &= pinners - 1;
+
+        uint64_t ray = chess_between[ksq][psq];
+        uint64_t blocking = ray & occ;
+        if (__builtin_popcountll(blocking) == 1 && (blocking & own_occ)) {
+            int bsq = __builtin_ctzll(blocking);
+            leg->pinned |= blocking;
+            /* Il pezzo inchiodato può muoversi solo lungo il raggio,
+               inclusa la cattura dell'inchiodatore */
+            leg->pin_ray[bsq] = ray | (1ULL << psq);
+        }
+    }
+}
+
+/* Legalità di una mossa verificata applicandola davvero: riservata ai casi
+   che le maschere non coprono (en passant, stati anomali) */
+static bool move_legal_by_apply(const bitboard_state_t *state,
+                                const chess_move_t *move)
+{
+    void *new_state = chess_apply_move(state, move);
+    if (!new_state) {
+        return false;
+    }
+    chess_free_state(new_state);
+    return true;
+}
+
+/**
+ * @brief Decide se una pseudo-mossa è legale usando le maschere precalcolate.
+ *
+ * Accetta esattamente le stesse mosse che `chess_make_move` applicherebbe
+ * con successo, ma senza copiare lo stato né rifare la scansione completa
+ * degli attacchi. L'en passant (raro) ricade sull'applicazione reale:
+ * può scoprire scacchi di traversa che le maschere non vedono.
+ */
+bool chess_is_move_legal(const bitboard_state_t *state,
+                         const chess_move_t *move,
+                         const chess_legality_t *leg)
+{
+    if (leg->king_sq < 0) {
+        return move_legal_by_apply(state, move); /* stato anomalo */
+    }
+
+    uint64_t to_bit = 1ULL << move->to;
+
+    /* Una pseudo-mossa che "cattura" il re avversario non è mai legale
+       (stessa regola di chess_make_move) */
+    uint64_t opp_king = (state->current_player == 1)
+                        ? state->black_kings : state->white_kings;
+    if (opp_king & to_bit) {
+        return false;
+    }
+
+    /* En passant: due pezzi lasciano la stessa traversa, con possibili
+       scacchi scoperti che le maschere non modellano. Caso raro. */
+    if (move->is_en_passant) {
+        return move_legal_by_apply(state, move);
+    }
+
+    if (move->from == leg->king_sq) {
+        /* Mosse di re: la destinazione (e per l'arrocco le caselle
+           attraversate) non dev'essere attaccata, valutando i raggi con
+           il re TOLTO dall'occupazione */
+        int attacker = -state->current_player;
+        uint64_t occ = compute_player_occ(state, 1) | compute_player_occ(state, -1);
+        uint64_t occ_no_king = occ ^ (1ULL << leg->king_sq);
+
+        if (move->is_castling) {
+            if (leg->checkers) {
+                return false; /* non si arrocca sotto scacco */
+            }
+            /* Stesse verifiche di is_legal_castle: caselle attraversate
+               valutate con il re ANCORA sulla casella di partenza, per
+               accettare esattamente le stesse mosse di chess_make_move */
+            int squares[3];
+            int n_squares = get_castling_squares(move->from, move->to, squares);
+            if (n_squares == 0) {
+                return false;
+            }
+            /* mappa di attacco avversaria calcolata una volta, un AND per
+               casella attraversata (come in is_legal_castle) */
+            uint64_t attacked = chess_attack_map(state, attacker);
+            for (int i = 0; i < n_squares; i++) {
+                if (attacked & (1ULL << squares[i])) {
+                    return false;
+                }
+            }
+            /* get_castling_squares ESCLUDE la destinazione: chess_make_move
+               la copre con is_king_in_check DOPO l'applicazione. Replichiamo
+               quel test con l'occupazione post-arrocco (re e torre mossi). */
+            int rook_from, rook_to;
+            switch (move->to) {
+                case 6:  rook_from = 7;  rook_to = 5;  break; /* O-O bianco */
+                case 2:  rook_from = 0;  rook_to = 3;  break; /* O-O-O bianco */
+                case 62: rook_from = 63; rook_to = 61; break; /* O-O nero */
+                default: rook_from = 56; rook_to = 59; break; /* O-O-O nero */
+            }
+            uint64_t occ_after = occ
+                ^ (1ULL << move->from) ^ (1ULL << move->to)
+                ^ (1ULL << rook_from)  ^ (1ULL << rook_to);
+            return !square_attacked_with_occ(state, move->to, attacker, occ_after);
+        }
+
+        return !square_attacked_with_occ(state, move->to, attacker, occ_no_king);
+    }
+
+    /* Mosse degli altri pezzi */
+    if (leg->evasion_mask == 0ULL) {
+        return false; /* doppio scacco: muove solo il re */
+    }
+    if ((leg->pinned & (1ULL << move->from)) &&
+        !(leg->pin_ray[move->from] & to_bit)) {
+        return false; /* pezzo inchiodato fuori dal suo raggio */
+    }
+    if (leg->checkers && !(leg->evasion_mask & to_bit)) {
+        return false; /* sotto scacco: o cattura lo scaccante o blocca */
+    }
+    return true;
+}
+
 
 /**
  * @brief Verifica se l’arrocco indicato da `ch_move` è legale, controllando
@@ -1355,17 +1637,8 @@ bool is_legal_castle(bitboard_state_t *temp_state,
     int current_player = temp_state->current_player;  // 1=bianco, -1=nero
     int attacker = -current_player;
 
-    // 2) Controllo di base: se re è in scacco, non possiamo arroccare
-    //    (in alcune implementazioni si controlla “non era in scacco all’inizio”
-    //     e “non attraversi caselle sotto scacco”).
-    //    Verifichiamo se nella posizione attuale (temp_state),
-    //    il re è già in scacco.
-    if (is_king_in_check(temp_state, current_player)) {
-        return false;
-    }
-
-    // 3) Determina quali caselle il re attraversa
-    //    (inclusa la destinazione), a seconda che sia corto o lungo, bianco o nero
+    // 2) Determina quali caselle il re attraversa
+    //    (esclusa la destinazione), a seconda che sia corto o lungo, bianco o nero
     int squares[3] = { -1, -1, -1 };  // al max 3 caselle
     int n_squares = get_castling_squares(from, to, squares);
     if (n_squares == 0) {
@@ -1373,17 +1646,21 @@ bool is_legal_castle(bitboard_state_t *temp_state,
         return false;
     }
 
-    // 4) Verifica che TUTTE queste caselle intermedie/destinazione siano libere
+    // 3) Verifica che TUTTE queste caselle intermedie/destinazione siano libere
     //    (tranne la casella “to” se decidi che in quell’indice c’è Re? In genere,
     //     la destinazione dev’essere libera comunque prima di spostarci).
     //
     // NON SERVE. Controllato durante la generazione delle mosse.
 
-    // 5) Verifica che TUTTE queste caselle non siano sotto attacco dall’avversario
-    //    (il re non può attraversare o finire su caselle controllate).
+    // 4) Il re non può partire da, attraversare o finire su caselle sotto
+    //    attacco: la mappa di attacco avversaria si calcola UNA volta e ogni
+    //    casella costa un AND, invece di rifare i sei sondaggi per ciascuna
+    uint64_t attacked = chess_attack_map(temp_state, attacker);
+    if (attacked & (1ULL << from)) {
+        return false;   // re già in scacco
+    }
     for (int i = 0; i < n_squares; i++) {
-        int sq = squares[i];
-        if (is_square_attacked(temp_state, sq, attacker)) {
+        if (attacked & (1ULL << squares[i])) {
             return false;
         }
     }
@@ -1417,80 +1694,187 @@ void* chess_apply_move(const void *state, const void *move)
         return NULL; // Parametri non validi
     }
 
-    // Cast dei parametri ai tipi concreti
-    const bitboard_state_t *old_state = (const bitboard_state_t*)state;
-    const chess_move_t     *ch_move   = (const chess_move_t*)move;
+    // Alloco un nuovo stato, lo copio dall'originale e ci eseguo la mossa
+    // in place: la validazione è tutta in chess_make_move.
+    bitboard_state_t *new_state = chess_alloc_state();
+    if (!new_state) {
+        return NULL; // Fallimento allocazione
+    }
+    *new_state = *(const bitboard_state_t*)state; // Copia superficiale (bit a bit)
+
+    chess_undo_t undo;
+    if (!chess_make_move(new_state, move, &undo)) {
+        chess_free_state(new_state);
+        return NULL; // Mossa illegale
+    }
+
+    return new_state;
+}
+
 
-    // 1) Controllo se il pezzo da muovere è pinned: se sì, mossa illegale.
-    if (is_move_pinned(old_state, ch_move)) {
-        return NULL;
+/**
+ * @brief Applica una mossa IN PLACE sullo stato, riempiendo il record di undo.
+ *
+ * Stesse validazioni di `chess_apply_move` (pinned, cattura del Re avversario,
+ * arrocco illegale, Re lasciato in scacco) ma senza allocazioni: l'undo è uno
+ * snapshot dello stato precedente, quindi il ripristino è un assegnamento.
+ *
+ * @param[in,out] state Stato di gioco (`bitboard_state_t*`) su cui muovere.
+ * @param[in]     move  Mossa da applicare (`chess_move_t*`).
+ * @param[out]    undo  Record di undo (`chess_undo_t*`) da riempire.
+ * @return 1 se la mossa è stata applicata, 0 se è illegale (stato invariato).
+ */
+int chess_make_move(void *state, const void *move, void *undo)
+{
+    if (!state || !move || !undo) {
+        return 0; // Parametri non validi
     }
+    TRACE_SPAN_SCOPE(span_make_move);
+
+    bitboard_state_t   *bit_state = (bitboard_state_t*)state;
+    const chess_move_t *ch_move   = (const chess_move_t*)move;
+    chess_undo_t       *ch_undo   = (chess_undo_t*)undo;
+
+    // 1) NOTA: nessun pre-filtro `is_move_pinned` qui. La verifica al punto 7
+    //    (re in scacco dopo la mossa) copre già tutte le inchiodature senza
+    //    allocare uno stato temporaneo per ogni mossa.
 
     // 2) Controllo se la mossa cattura il Re avversario (caso pseudo-mossa che va sul re)
     {
-        uint64_t opp_king_bb = (old_state->current_player == 1)
-                               ? old_state->black_kings
-                               : old_state->white_kings;
+        uint64_t opp_king_bb = (bit_state->current_player == 1)
+                               ? bit_state->black_kings
+                               : bit_state->white_kings;
         uint64_t to_mask = 1ULL << ch_move->to;
         if (opp_king_bb & to_mask) {
             // Mossa che cattura il re avversario: illegale.
-            return NULL;
+            return 0;
         }
     }
 
-    // 3) Alloco un nuovo stato e ne copio il contenuto
-    bitboard_state_t *new_state = (bitboard_state_t*)malloc(sizeof(bitboard_state_t));
-    if (!new_state) {
-        return NULL; // Fallimento allocazione
+    // 3) L'arrocco va validato PRIMA di toccare lo stato
+    if (ch_move->is_castling && !is_legal_castle(bit_state, ch_move)) {
+        return 0;
     }
-    *new_state = *old_state; // Copia superficiale (bit a bit)
 
-    // 4) Applicazione della mossa
+    // 4) Snapshot per l'undo, poi applicazione della mossa in place
+    ch_undo->prev = *bit_state;
+
     bool was_capture_or_pawn_move = false;
 
     if (ch_move->is_castling) {
-        // A) Eseguiamo i controlli specifici per l’arrocco
-        if (!is_legal_castle(new_state, ch_move)) {
-            // Se la funzione di validazione fallisce,
-            // liberiamo lo stato e ritorniamo NULL.
-            free(new_state);
-            return NULL;
-        }
-        // B) Se la validazione ha successo, spostiamo Re e Torre
-        apply_castling(new_state, ch_move);
+        apply_castling(bit_state, ch_move);
     }
     else if (ch_move->is_en_passant) {
-        apply_en_passant(new_state, ch_move);
+        apply_en_passant(bit_state, ch_move);
         was_capture_or_pawn_move = true;
     }
     else {
         // Promozione?
         if (ch_move->promotion != 0) {
-            apply_regular_move(new_state, ch_move);
-            handle_promotion(new_state, ch_move);
+            apply_regular_move(bit_state, ch_move);
+            handle_promotion(bit_state, ch_move);
             was_capture_or_pawn_move = true;  // è un pedone
         } else {
             // Mossa regolare
-            was_capture_or_pawn_move = apply_regular_move(new_state, ch_move); // PATCH: per gestire halfmove in apply regular move
+            was_capture_or_pawn_move = apply_regular_move(bit_state, ch_move); // PATCH: per gestire halfmove in apply regular move
         }
     }
 
+    // 4b) Le occupazioni aggregate vanno riallineate PRIMA del controllo di
+    //     scacco al punto 7, che legge proprio quelle
+    chess_refresh_occupancy(bit_state);
+
     // 5) Aggiorno diritti di arrocco, en_passant e contatori di mosse
-    update_castling_rights(new_state, ch_move);
-    update_en_passant(new_state, ch_move);
-    update_move_counters(new_state, was_capture_or_pawn_move);
+    update_castling_rights(bit_state, ch_move);
+    update_en_passant(bit_state, ch_move);
+    update_move_counters(bit_state, was_capture_or_pawn_move);
 
     // 6) Cambio giocatore
-    new_state->current_player = -(old_state->current_player);
+    bit_state->current_player = -(ch_undo->prev.current_player);
 
     // 7) Verifico se il Re del “vecchio giocatore” (chi ha mosso) è in scacco dopo la mossa
-    if (is_king_in_check(new_state, -(new_state->current_player))) {
-        free(new_state);
-        return NULL;
+    if (is_king_in_check(bit_state, -(bit_state->current_player))) {
+        *bit_state = ch_undo->prev; // Mossa illegale: ripristino lo stato
+        return 0;
     }
 
-    // 8) Se tutto ok, restituisco il nuovo stato
-    return new_state;
+    // 8) Ridondanze incrementali, dopo il controllo di scacco (sulle mosse
+    //    illegali non si paga nulla): hash Zobrist e somme di valutazione,
+    //    entrambi aggiornati per differenza rispetto allo snapshot di undo.
+    bit_state->hash = chess_hash_update(&ch_undo->prev, bit_state);
+    chess_eval_update(&ch_undo->prev, bit_state);
+
+    // 9) La posizione raggiunta entra nella storia delle ripetizioni
+    //    (chess_unmake_move la toglierà)
+    chess_repetition_push(bit_state->hash);
+
+    // 10) Se tutto ok, la mossa è stata eseguita
+    return 1;
+}
+
+
+/**
+ * @brief Disfa una mossa eseguita con `chess_make_move`, ripristinando lo stato.
+ *
+ * @param[in,out] state Stato di gioco (`bitboard_state_t*`) da ripristinare.
+ * @param[in]     undo  Record riempito dalla `chess_make_move` corrispondente.
+ */
+void chess_unmake_move(void *state, const void *undo)
+{
+    if (!state || !undo) {
+        return;
+    }
+    *(bitboard_state_t*)state = ((const chess_undo_t*)undo)->prev;
+    repetition_pop(); /* la posizione disfatta esce dalla storia */
+}
+
+
+/**
+ * @brief Esegue la "mossa nulla": passa il turno all'avversario senza muovere.
+ *
+ * Usata dalla potatura null-move di MiniMax. Viene rifiutata quando non è
+ * sicura: se il giocatore di turno è sotto scacco (passare sarebbe illegale
+ * e falserebbe la ricerca) o se ha solo Re e pedoni (posizioni a rischio
+ * zugzwang, dove passare può essere davvero la mossa migliore).
+ *
+ * @param[in,out] state Stato di gioco (`bitboard_state_t*`).
+ * @param[out]    undo  Record di undo (`chess_undo_t*`), da disfare con
+ *                      `chess_unmake_move`.
+ * @return 1 se la mossa nulla è stata eseguita, 0 se va evitata.
+ */
+int chess_make_null_move(void *state, void *undo)
+{
+    if (!state || !undo) {
+        return 0;
+    }
+
+    bitboard_state_t *bit_state = (bitboard_state_t*)state;
+    chess_undo_t     *ch_undo   = (chess_undo_t*)undo;
+
+    // Mai sotto scacco: "passare" maschererebbe lo scacco al proprio Re
+    if (is_king_in_check(bit_state, bit_state->current_player)) {
+        return 0;
+    }
+
+    // Rischio zugzwang: solo Re e pedoni => niente null move
+    uint64_t heavy_pieces = (bit_state->current_player == 1)
+        ? (bit_state->white_knights | bit_state->white_bishops |
+           bit_state->white_rooks   | bit_state->white_queens)
+        : (bit_state->black_knights | bit_state->black_bishops |
+           bit_state->black_rooks   | bit_state->black_queens);
+    if (heavy_pieces == 0) {
+        return 0;
+    }
+
+    ch_undo->prev = *bit_state;
+    bit_state->current_player = -(bit_state->current_player);
+    bit_state->en_passant = 255; // il diritto di en passant decade
+    // Anche la mossa nulla cambia turno ed en passant: l'hash va con loro
+    bit_state->hash = chess_hash_update(&ch_undo->prev, bit_state);
+    // Push simmetrico al pop di chess_unmake_move; l'hash con il turno
+    // invertito non coincide mai con una posizione davvero giocata
+    chess_repetition_push(bit_state->hash);
+    return 1;
 }
 
 
@@ -1511,61 +1895,11 @@ int chess_is_terminal(const void *state)
     // Cast del parametro generico allo stato bitboard
     const bitboard_state_t *bit_state = (const bitboard_state_t*)state;
 
-    // 1) Genera TUTTE le pseudo-mosse (incluso cattura Re avversario, en passant, ecc.)
-    dynamic_vector_t *moves = chess_get_moves(bit_state);
-    if (!moves) {
-        // Se per qualche ragione non riusciamo a generare le mosse,
-        // potremmo considerare lo stato come terminale o generare errore.
-        return 1;
-    }
-
-    int num_moves = chess_get_num_moves(moves);
-    if (num_moves == 0) {
-        // Non ci sono pseudo-mosse nemmeno prima del filtraggio:
-        // Se il Re è in scacco => scacco matto, se non in scacco => stallo.
-        chess_free_moves(moves);
-
-        return 1; // Stato terminale
-
-        // Controlla se il re del giocatore corrente è in scacco
-        // (chi deve muovere si trova in scacco ma non ha mosse => checkmate)
-        //if (is_king_in_check(bit_state, bit_state->current_player)) {
-        //    return 1;  // scacco matto => terminale
-        //} else {
-        //    return 1;  // stallo => terminale
-        //}
-    };
-
-    // 2) FASE DI FILTRAGGIO: controlliamo per ciascuna pseudo-mossa se è effettivamente legale.
-    //    Se troviamo almeno una mossa LEGITTIMA, lo stato non è terminale => 0.
-
-    // Strategia:
-    //  - Per ogni pseudo-mossa, applichiamo "chess_apply_move" su una copia dello stato
-    //    (se la mossa è pinned, cattura re avversario, o lascia in scacco, "chess_apply_move" 
-    //    dovrebbe restituire NULL).
-    //  - Se chess_apply_move restituisce un nuovo stato NON NULL => c'è una mossa legale => non terminale.
-
-    for (int i = 0; i < num_moves; i++) {
-        const chess_move_t *mv = (const chess_move_t*)chess_get_move_at(moves, i);
-        if (!mv) continue;  // per sicurezza
-
-        // Proviamo ad applicare la mossa: se è illegale, tornerà NULL
-        void *new_state = chess_apply_move(bit_state, mv);
-        if (new_state != NULL) {
-            // sign. la mossa è legale => esiste almeno una mossa valida => non terminale
-            chess_free_state(new_state);
-            chess_free_moves(moves);
-            return 0;  // esiste una mossa => stato NON terminale
-        }
-    }
-
-    // 3) Se nessuna pseudo-mossa è sopravvissuta (cioè tutte illegali),
-    //    allora siamo in stallo o scacco matto:
-    //    - Se il re è in scacco => scacco matto => terminale
-    //    - Altrimenti stallo => terminale
-
-    chess_free_moves(moves);
-    return 1;
+    // Lo stato è terminale se e solo se non esiste alcuna mossa legale
+    // (scacco matto se il re è in scacco, stallo altrimenti — per il valore
+    // terminale la distinzione non serve qui). chess_has_legal_move esce
+    // alla prima mossa legale trovata, senza generare la lista completa.
+    return chess_has_legal_move(bit_state) ? 0 : 1;
 
     //if (is_king_in_check(bit_state, bit_state->current_player)) {
     //    // scacco matto
@@ -1611,6 +1945,7 @@ int chess_evaluate(const void *state)
         // Per sicurezza, stato nullo => valutazione neutra (o errore).
         return 0;
     }
+    TRACE_SPAN_SCOPE(span_evaluate);
 
     const bitboard_state_t *bs = (const bitboard_state_t*)state;
 
@@ -1656,69 +1991,22 @@ int chess_evaluate(const void *state)
         return 0;  // patta / stallo
     }
 
-    // 2) VALUTAZIONE MATERIALE SEMPLICE
-    //    Conta i pezzi bianchi e neri, assegna un punteggio base per ciascun tipo.
-    //    Esempio di valori:
-    //    - pedone   = 100
-    //    - cavallo  = 320
-    //    - alfiere  = 330 (oppure 320, dipende dalle preferenze)
-    //    - torre    = 500
-    //    - regina   = 900
-    //    - re       = 20000 (opzionale, di solito non si conta il re,
-    //      ma puoi dare un valore enorme per impedire cattura del re in stime).
-    //    Qui omettiamo il re o gli diamo un valore altissimo per
-    //    completare la differenza.
-
-    // 2a) Conta i bit a 1 in ciascun bitboard con una popcount
-    //     (oppure un loop). Qui assumiamo di avere __builtin_popcountll per semplicità.
-    //     Se il tuo compilatore non la supporta, puoi implementare una popcount a mano.
-
-    int white_pawns   = __builtin_popcountll(bs->white_pawns);
-    int white_knights = __builtin_popcountll(bs->white_knights);
-    int white_bishops = __builtin_popcountll(bs->white_bishops);
-    int white_rooks   = __builtin_popcountll(bs->white_rooks);
-    int white_queens  = __builtin_popcountll(bs->white_queens);
-    // int white_kings   = __builtin_popcountll(bs->white_kings); // di solito 1
-
-    int black_pawns   = __builtin_popcountll(bs->black_pawns);
-    int black_knights = __builtin_popcountll(bs->black_knights);
-    int black_bishops = __builtin_popcountll(bs->black_bishops);
-    int black_rooks   = __builtin_popcountll(bs->black_rooks);
-    int black_queens  = __builtin_popcountll(bs->black_queens);
-    // int black_kings   = __builtin_popcountll(bs->black_kings); // di solito 1
-
-    // 2b) Calcoliamo il punteggio (material) = (materia bianca - materia nera)
-    //    con i valori di base
-    int wscore = 0;
-    wscore += white_pawns   * 100;
-    wscore += white_knights * 320;
-    wscore += white_bishops * 330;
-    wscore += white_rooks   * 500;
-    wscore += white_queens  * 900;
-    // wscore += white_kings   * 20000; // se vuoi contare pure il re
-
-    int bscore = 0;
-    bscore += black_pawns   * 100;
-    bscore += black_knights * 320;
-    bscore += black_bishops * 330;
-    bscore += black_rooks   * 500;
-    bscore += black_queens  * 900;
-    // bscore += black_kings   * 20000;
-
-    int material_score = wscore - bscore;
-
-    // 3) BONUS / MALUS SEMPLICI (opzionali)
-    //    Ad esempio, +30 se c'è un "bishop pair" (due alfieri) per un colore.
-    //    Se vuoi, puoi farlo:
-    if (white_bishops >= 2) material_score += 30; 
-    if (black_bishops >= 2) material_score -= 30;
-
-    // 4) ALTRE EURISTICHE (centro, sviluppo, etc.) ... (omesse in questa versione)
-
-    // 5) RESTITUISCI IL RISULTATO
-    //    Valore positivo => vantaggio Bianco
-    //    Valore negativo => vantaggio Nero
-    //    (Puoi aggiungere un piccolissimo bonus a "bs->current_player" se vuoi incentivare la mossa del giocatore di turno)
-    return material_score;
+    // 2) BITBASE dei finali elementari: con materiale KQK/KRK (e bitbase
+    //    aperta, vedi chess_bitbase_open) il verdetto teorico è
+    //    precalcolato — niente euristica che brancola oltre l'orizzonte,
+    //    il sottoalbero si chiude al primo nodo foglia.
+    int bb_score;
+    if (chess_bitbase_probe(bs, &bb_score)) {
+        return bb_score;
+    }
+
+    // 3) VALUTAZIONE STATICA: materiale + piece-square table con fusione
+    //    midgame/endgame (chess_eval.h). Le somme viaggiano nello stato e
+    //    vengono mantenute da chess_make_move per differenza, quindi qui
+    //    il costo è una combinazione lineare e due popcount — niente
+    //    riconteggio del materiale a ogni foglia. Il bonus per la coppia
+    //    di alfieri della vecchia valutazione è conservato lì dentro.
+    //    Valore positivo => vantaggio Bianco, negativo => vantaggio Nero.
+    return chess_eval_position(bs);
 }
 
@@ -19,6 +19,102 @@
  */
 void* chess_apply_move(const void *state, const void *move);
 
+/**
+ * @brief Record di undo per la coppia `chess_make_move` / `chess_unmake_move`.
+ *
+ * Contiene lo snapshot completo dello stato precedente alla mossa: una
+ * `bitboard_state_t` occupa poco più di cento byte (un paio di linee di
+ * cache), per cui copiarla sullo stack è molto più economico della coppia
+ * malloc/free richiesta da `chess_apply_move`, e rende l'unmake un semplice
+ * assegnamento senza dover invertire arrocchi, promozioni o en passant.
+ */
+typedef struct {
+    bitboard_state_t prev; /**< Stato completo PRIMA della mossa */
+} chess_undo_t;
+
+/**
+ * @brief Applica una mossa IN PLACE sullo stato, riempiendo il record di undo.
+ *
+ * Esegue le stesse validazioni di `chess_apply_move` (pezzo pinned, cattura
+ * del Re avversario, arrocco illegale, Re lasciato in scacco) ma senza
+ * allocare un nuovo stato: la mossa viene eseguita direttamente su \p state.
+ * Se la mossa risulta illegale lo stato resta invariato.
+ *
+ * Firma compatibile con la callback opzionale `make_move` di
+ * `game_descriptor_t` (\p undo deve puntare a una `chess_undo_t`).
+ *
+ * @param[in,out] state Stato di gioco (`bitboard_state_t*`) su cui muovere.
+ * @param[in]     move  Mossa da applicare (`chess_move_t*`).
+ * @param[out]    undo  Record di undo (`chess_undo_t*`) da riempire.
+ * @return 1 se la mossa è stata applicata, 0 se è illegale (stato invariato).
+ */
+int chess_make_move(void *state, const void *move, void *undo);
+
+/**
+ * @brief Disfa una mossa eseguita con `chess_make_move`, ripristinando lo stato.
+ *
+ * Firma compatibile con la callback opzionale `unmake_move` di
+ * `game_descriptor_t`.
+ *
+ * @param[in,out] state Stato di gioco (`bitboard_state_t*`) da ripristinare.
+ * @param[in]     undo  Record riempito dalla `chess_make_move` corrispondente.
+ */
+void chess_unmake_move(void *state, const void *undo);
+
+/**
+ * @brief Esegue la "mossa nulla": passa il turno senza muovere alcun pezzo.
+ *
+ * Firma compatibile con la callback opzionale `make_null_move` di
+ * `game_descriptor_t` (potatura null-move). Rifiuta la mossa nulla se il
+ * giocatore di turno è sotto scacco o ha solo Re e pedoni (zugzwang).
+ *
+ * @param[in,out] state Stato di gioco (`bitboard_state_t*`).
+ * @param[out]    undo  Record di undo (`chess_undo_t*`), da disfare con
+ *                      `chess_unmake_move`.
+ * @return 1 se la mossa nulla è stata eseguita, 0 se va evitata.
+ */
+int chess_make_null_move(void *state, void *undo);
+
+/**
+ * @brief Azzera la storia delle posizioni per il rilevamento delle ripetizioni.
+ *
+ * La storia è una pila per-thread di hash Zobrist: `chess_make_move` e
+ * `chess_make_null_move` impilano l'hash della posizione raggiunta,
+ * `chess_unmake_move` lo toglie. Va azzerata all'inizio di una nuova
+ * partita e poi seminata con le posizioni già giocate (vedi
+ * \ref chess_repetition_push).
+ */
+void chess_repetition_reset(void);
+
+/**
+ * @brief Impila l'hash di una posizione nella storia delle ripetizioni.
+ *
+ * Serve a seminare la storia con il game record: dopo
+ * \ref chess_repetition_reset va impilato l'hash della posizione iniziale.
+ * Chi poi gioca le mosse con `chess_apply_move`/`chess_make_move` ottiene
+ * gli impilamenti successivi gratis, uno per mossa applicata.
+ *
+ * @param[in] hash Hash Zobrist della posizione (vedi chess_hash_state).
+ */
+void chess_repetition_push(uint64_t hash);
+
+/**
+ * @brief Verifica se la posizione corrente è patta per triplice ripetizione.
+ *
+ * Conta le occorrenze dell'hash di \p state nella storia per-thread (che
+ * include la posizione corrente, impilata dalla `chess_make_move` che l'ha
+ * raggiunta): alla terza occorrenza la partita è patta. La scansione si
+ * ferma all'ultima mossa irreversibile (halfmove_clock): prima di una
+ * cattura o di una mossa di pedone nessuna posizione può ripetersi.
+ *
+ * Firma compatibile con la callback opzionale `is_draw` di
+ * `game_descriptor_t`.
+ *
+ * @param[in] state Stato di gioco (`bitboard_state_t*`).
+ * @return 1 se patta per ripetizione, 0 altrimenti.
+ */
+int chess_is_repetition_draw(const void *state);
+
 /**
  * @brief Verifica se uno stato di gioco è terminale (scacco matto, stallo, patta, ecc.).
  *
@@ -109,6 +205,66 @@ bool is_attacked_by_king(const bitboard_state_t *state,
  */
 bool is_square_attacked(const bitboard_state_t *state, int square, int attacker_player);
 
+/**
+ * @brief Bitboard dei pezzi di \p attacker_player che attaccano \p square.
+ *
+ * Stessa copertura di \ref is_square_attacked, ma restituisce l'insieme
+ * completo degli attaccanti in un unico passaggio sulle tabelle di attacco:
+ * utile quando serve distinguere scacco singolo e doppio o enumerare chi
+ * attacca (maschere di legalità, valutazione del re).
+ */
+uint64_t chess_attackers_to(const bitboard_state_t *state, int square, int attacker_player);
+
+/**
+ * @brief Mappa completa delle caselle attaccate da \p attacker_player.
+ *
+ * Unione degli insiemi di attacco di tutti i pezzi dell'attaccante, calcolata
+ * in una sola passata. Chi interroga più caselle della stessa posizione (per
+ * esempio le caselle attraversate dal re nell'arrocco) la calcola una volta e
+ * testa ogni casella con un AND.
+ */
+uint64_t chess_attack_map(const bitboard_state_t *state, int attacker_player);
+
+/**
+ * @struct chess_legality_s
+ * @brief Maschere di legalità precalcolate per una posizione.
+ *
+ * Vengono riempite UNA volta per posizione da \ref chess_compute_legality e
+ * permettono a \ref chess_is_move_legal di decidere la legalità di ogni
+ * pseudo-mossa in O(1), senza applicarla su una copia dello stato.
+ */
+typedef struct chess_legality_s {
+    int      king_sq;       /**< Casella del re di chi muove (-1 se assente). */
+    uint64_t checkers;      /**< Pezzi avversari che danno scacco al re. */
+    uint64_t evasion_mask;  /**< Caselle ammesse ai pezzi diversi dal re:
+                                 ~0 senza scacco, cattura/blocco con uno
+                                 scaccante, 0 con doppio scacco. */
+    uint64_t pinned;        /**< Pezzi propri inchiodati al re. */
+    uint64_t pin_ray[64];   /**< Per ogni pezzo inchiodato, il raggio su cui
+                                 può muoversi (inchiodatore incluso). */
+} chess_legality_t;
+
+/**
+ * @brief Riempie \p leg con le maschere di legalità della posizione \p state.
+ *
+ * Costo: qualche lookup nelle tabelle magiche, indipendente dal numero di
+ * mosse. Va richiamata a ogni nuova posizione prima di \ref chess_is_move_legal.
+ */
+void chess_compute_legality(const bitboard_state_t *state, chess_legality_t *leg);
+
+/**
+ * @brief Decide se la pseudo-mossa \p move è legale in \p state.
+ *
+ * Accetta esattamente le mosse che \ref chess_make_move applicherebbe con
+ * successo. Solo l'en passant ricade sull'applicazione reale della mossa.
+ *
+ * @param[in] move Pseudo-mossa (chess_move_t) generata per \p state.
+ * @param[in] leg  Maschere calcolate da \ref chess_compute_legality su \p state.
+ */
+bool chess_is_move_legal(const bitboard_state_t *state,
+                         const chess_move_t *move,
+                         const chess_legality_t *leg);
+
 /**
  * @brief Esegue la mossa di arrocco (sposta Re e Torre).
  */
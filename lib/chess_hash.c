@@ -1,5 +1,5 @@
 /**
- * ##VERSION## "chess_hash.c 1.0"
+ * ##VERSION## "chess_hash.c 1.1"
 */
 
 #include "chess_hash.h"
@@ -92,23 +92,13 @@ void chess_hash_init(void) {
 }
 
 /**
- * @brief Calcola l'hash Zobrist per uno stato di gioco.
- *
- * Questa funzione utilizza le chiavi Zobrist generate dinamicamente
- * per calcolare l'hash dello stato di gioco.
+ * @brief Calcola l'hash Zobrist da zero, scandendo i 12 bitboard.
  *
- * @param state Puntatore allo stato di gioco (`bitboard_state_t`).
- * @return Hash Zobrist dello stato di gioco (uint64_t).
+ * È il calcolo completo di riferimento: viene usato per seminare il campo
+ * incrementale `hash` dello stato e come ripiego per gli stati costruiti a
+ * mano che non lo hanno mai seminato.
  */
-uint64_t chess_hash_state(const void *state_void) {
-    if (!zobrist_initialized) {
-        fprintf(stderr, "Errore: chess_hash_init() non è stata chiamata.\n");
-        return 0;
-    }
-
-    if (!state_void) return 0;
-    
-    const bitboard_state_t *state = (const bitboard_state_t*)state_void;
+static uint64_t compute_full_hash(const bitboard_state_t *state) {
     uint64_t hash = 0;
 
     // Calcola l'hash per i pezzi
@@ -144,6 +134,117 @@ uint64_t chess_hash_state(const void *state_void) {
     return hash;
 }
 
+/**
+ * @brief Calcola l'hash Zobrist per uno stato di gioco.
+ *
+ * Se lo stato porta con sé il campo incrementale `hash` (seminato da
+ * `initialize_board` o `chess_refresh_hash` e mantenuto da
+ * `chess_make_move`), la funzione è una semplice lettura di campo: niente
+ * scansione dei bitboard a ogni probe o store della cache. Il valore 0
+ * funge da "non seminato" e fa scattare il calcolo completo di riferimento
+ * (la probabilità che un hash reale valga proprio 0 è 2^-64).
+ *
+ * @param state Puntatore allo stato di gioco (`bitboard_state_t`).
+ * @return Hash Zobrist dello stato di gioco (uint64_t).
+ */
+uint64_t chess_hash_state(const void *state_void) {
+    if (!zobrist_initialized) {
+        fprintf(stderr, "Errore: chess_hash_init() non è stata chiamata.\n");
+        return 0;
+    }
+
+    if (!state_void) return 0;
+
+    const bitboard_state_t *state = (const bitboard_state_t*)state_void;
+    if (state->hash != 0) {
+        return state->hash; // campo incrementale già seminato
+    }
+    return compute_full_hash(state);
+}
+
+/**
+ * @brief Semina (o riallinea) il campo `hash` incrementale dello stato.
+ *
+ * Da chiamare a chiusura del setup di uno stato costruito a mano che verrà
+ * hashato: da quel momento `chess_make_move` lo mantiene per XOR delle sole
+ * differenze. Inizializza le chiavi Zobrist se necessario.
+ *
+ * @param[in,out] state Stato di gioco da seminare.
+ */
+void chess_refresh_hash(bitboard_state_t *state) {
+    if (!state) return;
+    chess_hash_init();
+    state->hash = compute_full_hash(state);
+}
+
+/**
+ * @brief Aggiorna l'hash incrementale tra due stati consecutivi.
+ *
+ * Calcola l'hash di \p after partendo da quello di \p before e XOR-ando le
+ * chiavi delle sole differenze: i bit cambiati dei 12 bitboard (2-4 per una
+ * mossa: partenza, destinazione, eventuale pezzo catturato o torre
+ * dell'arrocco), i diritti di arrocco se variati, la casella en passant se
+ * variata e il cambio di turno. Niente scansione completa della scacchiera.
+ *
+ * Se \p before non è seminato (hash 0), ripiega sul calcolo completo.
+ *
+ * @param[in] before Stato di partenza (tipicamente lo snapshot di undo).
+ * @param[in] after  Stato di arrivo, già mutato.
+ * @return L'hash Zobrist di \p after.
+ */
+uint64_t chess_hash_update(const bitboard_state_t *before,
+                           const bitboard_state_t *after) {
+    if (!before || !after) return 0;
+    if (!zobrist_initialized || before->hash == 0) {
+        chess_hash_init();
+        return compute_full_hash(after);
+    }
+
+    uint64_t hash = before->hash;
+
+    uint64_t before_pieces[12] = {
+        before->white_pawns, before->white_knights, before->white_bishops,
+        before->white_rooks, before->white_queens, before->white_kings,
+        before->black_pawns, before->black_knights, before->black_bishops,
+        before->black_rooks, before->black_queens, before->black_kings
+    };
+    uint64_t after_pieces[12] = {
+        after->white_pawns, after->white_knights, after->white_bishops,
+        after->white_rooks, after->white_queens, after->white_kings,
+        after->black_pawns, after->black_knights, after->black_bishops,
+        after->black_rooks, after->black_queens, after->black_kings
+    };
+
+    for (int piece = 0; piece < 12; piece++) {
+        uint64_t diff = before_pieces[piece] ^ after_pieces[piece];
+        while (diff) {
+            int sq = __builtin_ctzll(diff);
+            hash ^= zobrist_keys.piece_keys[piece][sq];
+            diff &= diff - 1;
+        }
+    }
+
+    if (before->castling_rights != after->castling_rights) {
+        hash ^= zobrist_keys.castling_keys[before->castling_rights & 0xF];
+        hash ^= zobrist_keys.castling_keys[after->castling_rights & 0xF];
+    }
+
+    if (before->en_passant != after->en_passant) {
+        if (before->en_passant < 64) {
+            hash ^= zobrist_keys.en_passant_keys[before->en_passant];
+        }
+        if (after->en_passant < 64) {
+            hash ^= zobrist_keys.en_passant_keys[after->en_passant];
+        }
+    }
+
+    if (before->current_player != after->current_player) {
+        hash ^= zobrist_keys.side_to_move_key;
+    }
+
+    return hash;
+}
+
 /**
  * @brief Confronta due stati di gioco per l'uguaglianza.
  *
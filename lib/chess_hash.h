@@ -1,5 +1,5 @@
 /******************************************************************************
-# ##VERSION## "chess_hash.h 1.0"
+# ##VERSION## "chess_hash.h 1.1"
 #
 # Nome Progetto  : ChessEngine
 # Versione       : 1.0
@@ -92,6 +92,34 @@ void chess_hash_init(void);
  */
 uint64_t chess_hash_state(const void *state);
 
+/**
+ * @brief Semina (o riallinea) il campo `hash` incrementale dello stato.
+ *
+ * Dopo la chiamata `chess_hash_state` è una lettura di campo e
+ * `chess_make_move` mantiene l'hash per XOR delle sole differenze.
+ * `initialize_board` la chiama già; serve a chi costruisce uno stato a
+ * mano (test, parser di posizioni) che verrà hashato. Inizializza le
+ * chiavi Zobrist se necessario.
+ *
+ * @param[in,out] state Stato di gioco (`bitboard_state_t`) da seminare.
+ */
+void chess_refresh_hash(bitboard_state_t *state);
+
+/**
+ * @brief Aggiorna l'hash incrementale tra due stati consecutivi.
+ *
+ * Ritorna l'hash di \p after partendo da `before->hash` e XOR-ando le
+ * chiavi delle sole differenze (bit dei pezzi cambiati, diritti di
+ * arrocco, en passant, turno). Con \p before non seminato (hash 0)
+ * ripiega sul calcolo completo.
+ *
+ * @param[in] before Stato di partenza (es. lo snapshot di undo).
+ * @param[in] after  Stato di arrivo, già mutato.
+ * @return L'hash Zobrist di \p after.
+ */
+uint64_t chess_hash_update(const bitboard_state_t *before,
+                           const bitboard_state_t *after);
+
 /**
  * @brief Confronta due stati di gioco per l'uguaglianza.
  *
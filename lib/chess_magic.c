@@ -0,0 +1,239 @@
+/**
+ * ##VERSION## "chess_magic.c 1.2"
+ */
+
+#include "chess_magic.h"
+#include <pthread.h>
+
+/* Voci magiche per casella, riempite una sola volta da chess_magic_init */
+chess_magic_entry_t chess_rook_magics[64];
+chess_magic_entry_t chess_bishop_magics[64];
+
+/* Tabelle di attacco dei pezzi "a salto": una voce per casella */
+uint64_t chess_knight_attacks[64];
+uint64_t chess_king_attacks[64];
+
+/* Caselle strettamente comprese fra due caselle allineate (0 altrimenti) */
+uint64_t chess_between[64][64];
+
+/*
+ * Tabelle di attacco condivise: ogni casella possiede una finestra
+ * contigua di 2^(bit rilevanti) voci. Le dimensioni totali sono fisse:
+ * torre 4*4096 + 24*2048 + 36*1024 = 102400 voci, alfiere 5248.
+ */
+#define ROOK_TABLE_SIZE   102400
+#define BISHOP_TABLE_SIZE   5248
+
+static uint64_t rook_table[ROOK_TABLE_SIZE];
+static uint64_t bishop_table[BISHOP_TABLE_SIZE];
+
+/* Direzioni (delta colonna, delta riga) dei due tipi di scorrimento */
+static const int rook_dirs[4][2]   = { {+1, 0}, {-1, 0}, {0, +1}, {0, -1} };
+static const int bishop_dirs[4][2] = { {+1, +1}, {+1, -1}, {-1, +1}, {-1, -1} };
+
+/*
+ * Attacchi di riferimento calcolati col raggio casella-per-casella:
+ * usati solo in fase di inizializzazione per riempire le tabelle.
+ * Include la prima casella occupata di ogni raggio (come ray_moves).
+ */
+static uint64_t sliding_attacks_ref(int square, uint64_t occupancy,
+                                    const int dirs[4][2])
+{
+    uint64_t attacks = 0ULL;
+    int col = square % 8;
+    int row = square / 8;
+
+    for (int d = 0; d < 4; d++) {
+        int c = col + dirs[d][0];
+        int r = row + dirs[d][1];
+        while (c >= 0 && c <= 7 && r >= 0 && r <= 7) {
+            uint64_t bit = 1ULL << (r * 8 + c);
+            attacks |= bit;
+            if (occupancy & bit) {
+                break; /* primo pezzo incontrato: incluso, poi stop */
+            }
+            c += dirs[d][0];
+            r += dirs[d][1];
+        }
+    }
+    return attacks;
+}
+
+/*
+ * Maschera dell'occupazione rilevante: i raggi senza l'ultima casella di
+ * ogni direzione (un pezzo sul bordo non cambia l'insieme di attacco).
+ */
+static uint64_t relevant_mask(int square, const int dirs[4][2]) {
+    uint64_t mask = 0ULL;
+    int col = square % 8;
+    int row = square / 8;
+
+    for (int d = 0; d < 4; d++) {
+        int c = col + dirs[d][0];
+        int r = row + dirs[d][1];
+        /* Include la casella solo se la successiva resta in scacchiera */
+        while (c + dirs[d][0] >= 0 && c + dirs[d][0] <= 7 &&
+               r + dirs[d][1] >= 0 && r + dirs[d][1] <= 7) {
+            mask |= 1ULL << (r * 8 + c);
+            c += dirs[d][0];
+            r += dirs[d][1];
+        }
+    }
+    return mask;
+}
+
+/* PRNG xorshift64* con seme fisso: la ricerca dei magici è deterministica */
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rnd64(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+/* Candidato magico sparso: pochi bit a 1 convergono molto più in fretta */
+static uint64_t rnd_sparse(void) {
+    return rnd64() & rnd64() & rnd64();
+}
+
+/*
+ * Trova i magici e riempie le tabelle per un tipo di scorrimento.
+ * Per ogni casella enumera tutti i sottoinsiemi della maschera rilevante
+ * (trucco carry-rippler) e prova candidati casuali finché la mappatura
+ * indice -> attacchi è priva di collisioni dannose (collisioni tra
+ * occupazioni con lo stesso insieme di attacco sono innocue).
+ * Ritorna il puntatore alla prima voce libera dopo l'ultima finestra.
+ */
+static uint64_t* init_magics(chess_magic_entry_t entries[64],
+                             uint64_t *table,
+                             const int dirs[4][2])
+{
+    static uint64_t occs[4096];
+    static uint64_t refs[4096];
+    static int age[4096];
+    static int epoch = 0;
+
+    for (int sq = 0; sq < 64; sq++) {
+        uint64_t mask = relevant_mask(sq, dirs);
+        int bits = __builtin_popcountll(mask);
+        int shift = 64 - bits;
+        int size = 1 << bits;
+
+        /* Enumera i sottoinsiemi della maschera (carry-rippler) */
+        int n = 0;
+        uint64_t sub = 0ULL;
+        do {
+            occs[n] = sub;
+            refs[n] = sliding_attacks_ref(sq, sub, dirs);
+            n++;
+            sub = (sub - mask) & mask;
+        } while (sub != 0ULL);
+
+        uint64_t magic;
+        for (;;) {
+            magic = rnd_sparse();
+            /* Scarto rapido: i bit alti del prodotto devono essere densi */
+            if (__builtin_popcountll((mask * magic) & 0xFF00000000000000ULL) < 6) {
+                continue;
+            }
+
+            epoch++;
+            int ok = 1;
+            for (int i = 0; i < n; i++) {
+                size_t idx = (size_t)((occs[i] * magic) >> shift);
+                if (age[idx] != epoch) {
+                    age[idx] = epoch;
+                    table[idx] = refs[i];
+                } else if (table[idx] != refs[i]) {
+                    ok = 0; /* collisione dannosa: nuovo candidato */
+                    break;
+                }
+            }
+            if (ok) {
+                break;
+            }
+        }
+
+        entries[sq].mask = mask;
+        entries[sq].magic = magic;
+        entries[sq].attacks = table;
+        entries[sq].shift = shift;
+        table += size;
+    }
+    return table;
+}
+
+/* Riempie le tabelle dei pezzi "a salto" (cavallo e re) */
+static void init_step_tables(void) {
+    static const int knight_steps[8][2] = {
+        {+1, +2}, {+2, +1}, {+2, -1}, {+1, -2},
+        {-1, -2}, {-2, -1}, {-2, +1}, {-1, +2}
+    };
+    static const int king_steps[8][2] = {
+        {+1, 0}, {+1, +1}, {0, +1}, {-1, +1},
+        {-1, 0}, {-1, -1}, {0, -1}, {+1, -1}
+    };
+
+    for (int sq = 0; sq < 64; sq++) {
+        int col = sq % 8;
+        int row = sq / 8;
+        uint64_t n_att = 0ULL;
+        uint64_t k_att = 0ULL;
+
+        for (int d = 0; d < 8; d++) {
+            int nc = col + knight_steps[d][0];
+            int nr = row + knight_steps[d][1];
+            if (nc >= 0 && nc <= 7 && nr >= 0 && nr <= 7) {
+                n_att |= 1ULL << (nr * 8 + nc);
+            }
+            int kc = col + king_steps[d][0];
+            int kr = row + king_steps[d][1];
+            if (kc >= 0 && kc <= 7 && kr >= 0 && kr <= 7) {
+                k_att |= 1ULL << (kr * 8 + kc);
+            }
+        }
+        chess_knight_attacks[sq] = n_att;
+        chess_king_attacks[sq] = k_att;
+    }
+}
+
+/* Riempie chess_between: per ogni coppia di caselle allineate in linea o
+   in diagonale, il bitboard delle caselle strettamente comprese */
+static void init_between_table(void) {
+    static const int all_dirs[8][2] = {
+        {+1, 0}, {-1, 0}, {0, +1}, {0, -1},
+        {+1, +1}, {+1, -1}, {-1, +1}, {-1, -1}
+    };
+
+    for (int sq = 0; sq < 64; sq++) {
+        int col = sq % 8;
+        int row = sq / 8;
+        for (int d = 0; d < 8; d++) {
+            uint64_t path = 0ULL;
+            int c = col + all_dirs[d][0];
+            int r = row + all_dirs[d][1];
+            while (c >= 0 && c <= 7 && r >= 0 && r <= 7) {
+                int t = r * 8 + c;
+                chess_between[sq][t] = path; /* caselle già attraversate */
+                path |= 1ULL << t;
+                c += all_dirs[d][0];
+                r += all_dirs[d][1];
+            }
+        }
+    }
+}
+
+static void chess_magic_build(void) {
+    init_magics(chess_rook_magics, rook_table, rook_dirs);
+    init_magics(chess_bishop_magics, bishop_table, bishop_dirs);
+    init_step_tables();
+    init_between_table();
+}
+
+static pthread_once_t magic_once = PTHREAD_ONCE_INIT;
+
+/* Costruzione una-tantum delle tabelle (thread-safe, idempotente) */
+void chess_magic_init(void) {
+    pthread_once(&magic_once, chess_magic_build);
+}
@@ -1,5 +1,5 @@
 /**
- * ##VERSION## "chess_moves.c 1.0"
+ * ##VERSION## "chess_moves.c 2.0"
  */
 
 #include "chess_moves.h"
@@ -9,8 +9,75 @@
 #include "chess_moves_rook.h"
 #include "chess_moves_queen.h"
 #include "chess_moves_king.h"
+#include "chess_game_dynamics.h"
+#include "chess_magic.h"
+#include "obj_trace.h"
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+
+/* Span di profilazione della pipeline di ricerca (attivi solo compilando
+   con -DTRACE_SPANS_ON, vedi obj_trace.h) */
+TRACE_SPAN_DEFINE(span_movegen, "chess_get_moves");
+TRACE_SPAN_DEFINE(span_movegen_capt, "chess_get_capture_moves");
+
+/* --------------------------------------------------------------------------
+ * POOL DI BLOCCHI PER LE COPIE DI MOSSA
+ * --------------------------------------------------------------------------
+ * chess_copy_move/chess_free_move allocano sempre lo stesso blocco da
+ * sizeof(chess_move_t): usiamo un obj_mem_pool (obj_mem.h) che ricicla i
+ * blocchi liberati invece di passare da malloc/free. Il pool è unico e
+ * protetto da mutex perché le copie attraversano i thread (un worker SMP
+ * copia la mossa migliore, il main la libera dopo la join); il lock non è
+ * conteso perché copy_move scatta solo sugli eventi "nuova mossa migliore",
+ * non a ogni nodo.
+ */
+
+static obj_mem_pool_t *move_copy_pool = NULL;
+static pthread_mutex_t move_copy_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* --------------------------------------------------------------------------
+ * POOL PER-THREAD DI VETTORI DI MOSSE RICICLABILI
+ * --------------------------------------------------------------------------
+ * La ricerca minimax chiama get_moves/free_moves a ogni nodo: invece di
+ * creare e distruggere un vettore per nodo, teniamo una piccola pila di
+ * vettori già allocati (uno per livello di ricerca attivo, più quelli della
+ * quiescenza) e li ricicliamo con dv_clear. Il pool è per-thread (__thread,
+ * come le tabelle killer/history in minimax.c) perché SMP e YBWC cercano
+ * in parallelo.
+ */
+
+#define MOVE_VECTOR_POOL_DEPTH 64  /* vettori vivi contemporaneamente per thread */
+#define MOVE_VECTOR_CAPACITY   64  /* capacità iniziale (una posizione tipica ha ~35 mosse) */
+
+static __thread dynamic_vector_t *move_vec_pool[MOVE_VECTOR_POOL_DEPTH];
+static __thread int move_vec_pool_top = 0;
+
+/**
+ * @brief Preleva dal pool un vettore di mosse vuoto (o ne crea uno nuovo).
+ */
+static dynamic_vector_t* acquire_move_vector(void) {
+    if (move_vec_pool_top > 0) {
+        dynamic_vector_t *dv = move_vec_pool[--move_vec_pool_top];
+        dv_clear(dv);
+        return dv;
+    }
+    return dv_create_sized(sizeof(chess_move_t), MOVE_VECTOR_CAPACITY);
+}
+
+/**
+ * @brief Restituisce un vettore al pool per il riutilizzo.
+ *
+ * @return 1 se il vettore è stato accettato nel pool, 0 se il pool è pieno
+ *         (in tal caso il chiamante deve liberarlo con dv_free).
+ */
+static int release_move_vector(dynamic_vector_t *dv) {
+    if (move_vec_pool_top < MOVE_VECTOR_POOL_DEPTH) {
+        move_vec_pool[move_vec_pool_top++] = dv;
+        return 1;
+    }
+    return 0;
+}
 
 /* --------------------------------------------------------------------------
  * DEFINIZIONE DELLE FUNZIONI DI GENERAZIONE COMPLETA DELLE MOSSE
@@ -35,8 +102,11 @@
  */
 dynamic_vector_t* chess_get_moves(const void *state_void) {
     if (!state_void) return NULL;
+    TRACE_SPAN_SCOPE(span_movegen);
     const bitboard_state_t *state = (const bitboard_state_t*)state_void;
-    dynamic_vector_t *moves = dv_create();
+    // Vettore per valore riciclato dal pool: un'unica allocazione contigua
+    // per tutta la lista, niente malloc per singola mossa né per vettore
+    dynamic_vector_t *moves = acquire_move_vector();
     if (!moves) return NULL;
 
     // Verifichiamo chi deve muovere (Bianco = 1, Nero = -1 o altro)
@@ -58,18 +128,373 @@ dynamic_vector_t* chess_get_moves(const void *state_void) {
         generate_black_king_moves(state, moves);
     }
 
+    // Filtro di legalità in place: le maschere (scaccanti, inchiodature,
+    // evasioni) si calcolano UNA volta per posizione, poi ogni pseudo-mossa
+    // costa un test O(1) invece di una copia dello stato + scansione attacchi
+    chess_legality_t leg;
+    chess_compute_legality(state, &leg);
+
+    chess_move_t *buf = (chess_move_t*)dv_data(moves);
+    size_t n = dv_size(moves);
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (chess_is_move_legal(state, &buf[i], &leg)) {
+            if (kept != i) {
+                buf[kept] = buf[i]; // compattazione in place
+            }
+            kept++;
+        }
+    }
+    dv_truncate(moves, kept);
+
     return moves;
 }
 
+/**
+ * @brief Genera tutte le mosse legali nel buffer del chiamante.
+ *
+ * La generazione vera e propria passa ancora dalla pipeline per vettore
+ * (generatori per pezzo + filtro di legalità in place), ma il vettore del
+ * pool viene restituito subito dopo la copia: il chiamante — tipicamente un
+ * nodo della ricerca, con il buffer sul proprio stack — non tiene occupato
+ * uno slot del pool per tutta la vita del nodo e non ha nulla da liberare.
+ *
+ * @param[in]  state     Stato corrente del gioco (`bitboard_state_t`).
+ * @param[out] out_moves Buffer del chiamante (array di `chess_move_t`).
+ * @param[in]  max_moves Capienza del buffer in mosse.
+ * @return Il numero di mosse legali scritte, o -1 se non entrano nel buffer.
+ */
+int chess_generate_moves(const void *state, void *out_moves, int max_moves) {
+    if (!state || !out_moves || max_moves <= 0) return -1;
+
+    dynamic_vector_t *moves = chess_get_moves(state);
+    if (!moves) return -1;
+
+    int n = (int)dv_size(moves);
+    if (n > max_moves) {
+        chess_free_moves(moves);
+        return -1;
+    }
+    memcpy(out_moves, dv_data(moves), (size_t)n * sizeof(chess_move_t));
+    chess_free_moves(moves);
+    return n;
+}
+
+/**
+ * @brief Verifica se il giocatore di turno ha almeno una mossa legale.
+ *
+ * Predicato a uscita anticipata per il test di terminalità: invece di
+ * generare e filtrare la lista completa (come \ref chess_get_moves), i
+ * generatori per pezzo vengono eseguiti uno alla volta — re per primo,
+ * perché sotto scacco le sue mosse sono le candidate più probabili — e la
+ * funzione ritorna alla PRIMA pseudo-mossa che supera il filtro di
+ * legalità. Nel caso tipico (decine di mosse legali) il costo è una
+ * frazione della generazione completa; solo su matto e stallo, dove la
+ * risposta è "nessuna", il lavoro equivale a quello di chess_get_moves.
+ *
+ * @param[in] state Stato corrente del gioco (`bitboard_state_t`).
+ * @return 1 se esiste almeno una mossa legale, 0 altrimenti (matto o stallo).
+ */
+int chess_has_legal_move(const void *state_void) {
+    if (!state_void) return 0;
+    const bitboard_state_t *state = (const bitboard_state_t*)state_void;
+
+    chess_legality_t leg;
+    chess_compute_legality(state, &leg);
+
+    dynamic_vector_t *moves = acquire_move_vector();
+    if (!moves) return 0;
+
+    typedef void (*piece_gen_fn)(const bitboard_state_t*, dynamic_vector_t*);
+    static const piece_gen_fn white_gens[6] = {
+        generate_white_king_moves,   generate_white_pawn_moves,
+        generate_white_knight_moves, generate_white_bishop_moves,
+        generate_white_rook_moves,   generate_white_queen_moves
+    };
+    static const piece_gen_fn black_gens[6] = {
+        generate_black_king_moves,   generate_black_pawn_moves,
+        generate_black_knight_moves, generate_black_bishop_moves,
+        generate_black_rook_moves,   generate_black_queen_moves
+    };
+    const piece_gen_fn *gens =
+        (state->current_player == 1) ? white_gens : black_gens;
+
+    for (int g = 0; g < 6; g++) {
+        dv_clear(moves);
+        gens[g](state, moves);
+        chess_move_t *buf = (chess_move_t*)dv_data(moves);
+        size_t n = dv_size(moves);
+        for (size_t i = 0; i < n; i++) {
+            if (chess_is_move_legal(state, &buf[i], &leg)) {
+                chess_free_moves(moves);
+                return 1;
+            }
+        }
+    }
+
+    chess_free_moves(moves);
+    return 0;
+}
+
+
+/* --------------------------------------------------------------------------
+ * GENERAZIONE DIRETTA DELLE SOLE MOSSE FORZANTI
+ * --------------------------------------------------------------------------
+ * Per cavalli, alfieri, torri, regine e re basta intersecare gli insiemi di
+ * attacco precalcolati con l'occupazione avversaria: le mosse tranquille non
+ * vengono proprio generate, invece di essere generate e poi scartate. I
+ * pedoni passano dal loro generatore completo (promozioni ed en passant
+ * vivono lì, e le spinte tranquille in eccesso sono poche): il filtro finale
+ * trattiene solo le mosse legali e forzanti secondo chess_is_capture.
+ */
+static void generate_piece_captures(const bitboard_state_t *state,
+                                    dynamic_vector_t *moves)
+{
+    chess_magic_init();
+
+    uint64_t white_occ = state->occupied_white;
+    uint64_t black_occ = state->occupied_black;
+    uint64_t occ       = state->occupied_all;
+
+    uint64_t opp_occ, knights, bishops, rooks, queens, kings;
+    if (state->current_player == 1) {
+        opp_occ = black_occ;
+        knights = state->white_knights;
+        bishops = state->white_bishops;
+        rooks   = state->white_rooks;
+        queens  = state->white_queens;
+        kings   = state->white_kings;
+    } else {
+        opp_occ = white_occ;
+        knights = state->black_knights;
+        bishops = state->black_bishops;
+        rooks   = state->black_rooks;
+        queens  = state->black_queens;
+        kings   = state->black_kings;
+    }
+
+    while (knights) {
+        int from = __builtin_ctzll(knights);
+        knights &= knights - 1;
+        uint64_t attacks = chess_knight_attacks[from] & opp_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
+    }
+    while (bishops) {
+        int from = __builtin_ctzll(bishops);
+        bishops &= bishops - 1;
+        uint64_t attacks = chess_magic_bishop_attacks(from, occ) & opp_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
+    }
+    while (rooks) {
+        int from = __builtin_ctzll(rooks);
+        rooks &= rooks - 1;
+        uint64_t attacks = chess_magic_rook_attacks(from, occ) & opp_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
+    }
+    while (queens) {
+        int from = __builtin_ctzll(queens);
+        queens &= queens - 1;
+        uint64_t attacks = chess_magic_queen_attacks(from, occ) & opp_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
+    }
+    while (kings) {
+        int from = __builtin_ctzll(kings);
+        kings &= kings - 1;
+        uint64_t attacks = chess_king_attacks[from] & opp_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
+    }
+}
+
+/**
+ * @brief Implementa la funzione di callback per le sole mosse di cattura.
+ *
+ * Le catture dei pezzi vengono generate direttamente dalle tabelle di
+ * attacco (\ref generate_piece_captures): le mosse tranquille — la grande
+ * maggioranza in una posizione tipica — non vengono mai prodotte. Il
+ * risultato contiene solo mosse legali e forzanti (catture regolari,
+ * en passant, promozioni), come il filtro `chess_is_capture` sull'esito
+ * di `chess_get_moves`.
+ *
+ * @param[in] state_void Puntatore allo stato corrente del gioco (`bitboard_state_t`).
+ * @return Un puntatore a `dynamic_vector_t` contenente le sole mosse di cattura
+ *         (`chess_move_t*`), da liberare con `chess_free_moves`.
+ */
+dynamic_vector_t* chess_get_capture_moves(const void *state_void) {
+    if (!state_void) return NULL;
+    TRACE_SPAN_SCOPE(span_movegen_capt);
+    const bitboard_state_t *state = (const bitboard_state_t*)state_void;
+
+    dynamic_vector_t *captures = acquire_move_vector();
+    if (!captures) return NULL;
+
+    if (state->current_player == 1) {
+        generate_white_pawn_moves(state, captures);
+    } else {
+        generate_black_pawn_moves(state, captures);
+    }
+    generate_piece_captures(state, captures);
+
+    // Filtro in place: restano le mosse legali E forzanti (qui cadono le
+    // spinte tranquille dei pedoni generate insieme alle catture)
+    chess_legality_t leg;
+    chess_compute_legality(state, &leg);
+
+    chess_move_t *buf = (chess_move_t*)dv_data(captures);
+    size_t n = dv_size(captures);
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (chess_is_capture(state_void, &buf[i]) &&
+            chess_is_move_legal(state, &buf[i], &leg)) {
+            if (kept != i) {
+                buf[kept] = buf[i];
+            }
+            kept++;
+        }
+    }
+    dv_truncate(captures, kept);
+
+    return captures;
+}
+
+/* --------------------------------------------------------------------------
+ * GENERATORE A STADI
+ * --------------------------------------------------------------------------
+ * Le mosse vengono prodotte man mano che il consumatore le chiede: prima
+ * l'eventuale mossa suggerita (TT), poi le catture, e solo se nessuna di
+ * queste basta vengono generate anche le mosse tranquille. In una ricerca
+ * con buon ordinamento la maggior parte dei nodi taglia sulle prime mosse:
+ * lo stadio delle tranquille — il più numeroso — spesso non viene mai
+ * materializzato.
+ */
+struct chess_movegen_s {
+    const bitboard_state_t *state;
+    dynamic_vector_t *captures; /* stadio delle catture (con la TT in testa) */
+    dynamic_vector_t *all;      /* vettore completo, generato su richiesta */
+    size_t idx;                 /* prossimo elemento dello stadio corrente */
+    int in_quiets;              /* 0 = stadio catture, 1 = stadio tranquille */
+    int tt_index;               /* mossa suggerita impaccata (chess_move_pack), o -1 */
+};
+
+/* Porta in testa al buffer la mossa con codifica impaccata tt_index (se
+   presente fra le posizioni [first, size)), scambiandola con buf[first] */
+static void hoist_tt_move(chess_move_t *buf, size_t first, size_t size,
+                          int tt_index)
+{
+    if (tt_index < 0) return;
+    for (size_t i = first; i < size; i++) {
+        if (chess_move_pack(&buf[i]) == tt_index) {
+            chess_move_t tmp = buf[first];
+            buf[first] = buf[i];
+            buf[i] = tmp;
+            return;
+        }
+    }
+}
+
+chess_movegen_t* chess_movegen_start(const void *state_void, int tt_move_index) {
+    if (!state_void) return NULL;
+
+    chess_movegen_t *gen = (chess_movegen_t*)malloc(sizeof(*gen));
+    if (!gen) return NULL;
+
+    gen->state = (const bitboard_state_t*)state_void;
+    gen->captures = chess_get_capture_moves(state_void);
+    gen->all = NULL;
+    gen->idx = 0;
+    gen->in_quiets = 0;
+    gen->tt_index = tt_move_index;
+
+    if (!gen->captures) {
+        free(gen);
+        return NULL;
+    }
+
+    // Stadio 1: se la mossa TT è una cattura va esaminata per prima
+    hoist_tt_move((chess_move_t*)dv_data(gen->captures), 0,
+                  dv_size(gen->captures), tt_move_index);
+    return gen;
+}
+
+const chess_move_t* chess_movegen_next(chess_movegen_t *gen) {
+    if (!gen) return NULL;
+
+    if (!gen->in_quiets) {
+        if (gen->idx < dv_size(gen->captures)) {
+            chess_move_t *buf = (chess_move_t*)dv_data(gen->captures);
+            return &buf[gen->idx++];
+        }
+        // Catture esaurite: SOLO ora si genera il vettore completo
+        gen->in_quiets = 1;
+        gen->idx = 0;
+        gen->all = chess_get_moves(gen->state);
+        if (!gen->all) return NULL;
+
+        // Se la mossa TT è tranquilla, portala davanti alla prima tranquilla
+        chess_move_t *buf = (chess_move_t*)dv_data(gen->all);
+        size_t n = dv_size(gen->all);
+        size_t first_quiet = 0;
+        while (first_quiet < n &&
+               chess_is_capture(gen->state, &buf[first_quiet])) {
+            first_quiet++;
+        }
+        if (first_quiet < n) {
+            hoist_tt_move(buf, first_quiet, n, gen->tt_index);
+        }
+    }
+
+    // Stadio delle tranquille: le catture (già servite) vengono saltate
+    chess_move_t *buf = (chess_move_t*)dv_data(gen->all);
+    size_t n = dv_size(gen->all);
+    while (gen->idx < n) {
+        chess_move_t *mv = &buf[gen->idx++];
+        if (!chess_is_capture(gen->state, mv)) {
+            return mv;
+        }
+    }
+    return NULL;
+}
+
+void chess_movegen_end(chess_movegen_t *gen) {
+    if (!gen) return;
+    if (gen->captures) {
+        chess_free_moves(gen->captures);
+    }
+    if (gen->all) {
+        chess_free_moves(gen->all);
+    }
+    free(gen);
+}
 
 /**
  * @brief Implementa la funzione di callback per liberare il vettore delle mosse.
  *
- * Questa funzione libera tutta la memoria allocata per le mosse all'interno del
- * vettore dinamico e poi libera il vettore stesso. È essenziale chiamare questa
- * funzione per evitare perdite di memoria dopo aver terminato l'utilizzo delle mosse.
+ * Restituisce la lista di mosse al sistema. I vettori per valore (quelli
+ * creati da `chess_get_moves`/`chess_get_capture_moves`) vengono riciclati
+ * nel pool per-thread invece di essere distrutti; per compatibilità, su un
+ * eventuale vettore per puntatore vengono ancora liberate le singole mosse
+ * allocate e poi il vettore stesso.
  *
- * @param[in] moves_vec Vettore dinamico contenente le mosse (`chess_move_t*`).
+ * @param[in] moves_vec Vettore dinamico contenente le mosse (`chess_move_t`).
  *
  * @note
  *   - Dopo la chiamata a questa funzione, `moves_vec` non sarà più valido.
@@ -77,11 +502,21 @@ dynamic_vector_t* chess_get_moves(const void *state_void) {
  */
 void chess_free_moves(dynamic_vector_t *moves_vec) {
     if (!moves_vec) return;
-    int num_moves = dv_size(moves_vec);
-    for (int i = 0; i < num_moves; i++) {
-        chess_move_t *move = (chess_move_t*)dv_get(moves_vec, i);
-        if (move) {
-            free(move);
+    if (dv_elem_size(moves_vec) == sizeof(chess_move_t)) {
+        // Vettore per valore del pool: prova a riciclarlo, altrimenti libera
+        if (!release_move_vector(moves_vec)) {
+            dv_free(moves_vec);
+        }
+        return;
+    }
+    if (dv_elem_size(moves_vec) == 0) {
+        // Vettore per puntatore: le mosse sono allocazioni individuali
+        int num_moves = dv_size(moves_vec);
+        for (int i = 0; i < num_moves; i++) {
+            chess_move_t *move = (chess_move_t*)dv_get(moves_vec, i);
+            if (move) {
+                free(move);
+            }
         }
     }
     dv_free(moves_vec);
@@ -142,7 +577,16 @@ void* chess_get_move_at(const dynamic_vector_t *moves_vec, int index) {
 void* chess_copy_move(const void *move_void) {
     if (!move_void) return NULL;
     const chess_move_t *move = (const chess_move_t*)move_void;
-    chess_move_t *new_move = (chess_move_t*)malloc(sizeof(chess_move_t));
+
+    pthread_mutex_lock(&move_copy_pool_mutex);
+    if (!move_copy_pool) {
+        move_copy_pool = obj_mem_pool_create(sizeof(chess_move_t), 0);
+    }
+    chess_move_t *new_move = move_copy_pool
+        ? (chess_move_t*)obj_mem_pool_alloc(move_copy_pool)
+        : NULL;
+    pthread_mutex_unlock(&move_copy_pool_mutex);
+
     if (!new_move) return NULL;
     memcpy(new_move, move, sizeof(chess_move_t));
     return new_move;
@@ -162,9 +606,94 @@ void* chess_copy_move(const void *move_void) {
  *   - Assicurarsi di non utilizzare la mossa dopo averla liberata.
  */
 void chess_free_move(void *move_void) {
-    if (move_void) {
-        free(move_void);
+    if (!move_void) return;
+    /* Tutte le mosse singole provengono da chess_copy_move, quindi dal pool */
+    pthread_mutex_lock(&move_copy_pool_mutex);
+    obj_mem_pool_free(move_copy_pool, move_void);
+    pthread_mutex_unlock(&move_copy_pool_mutex);
+}
+
+/**
+ * @brief Implementa la funzione di callback per riconoscere le catture.
+ *
+ * Una mossa è considerata "forzante" (da esaminare per prima nell'ordinamento)
+ * se cattura un pezzo avversario sulla casella di arrivo, se è un en passant
+ * oppure se è una promozione.
+ *
+ * @param[in] state_void Stato corrente del gioco (`bitboard_state_t`), PRIMA della mossa.
+ * @param[in] move_void Mossa da classificare (`chess_move_t*`).
+ * @return 1 se la mossa è una cattura o una promozione, 0 altrimenti.
+ */
+int chess_is_capture(const void *state_void, const void *move_void) {
+    if (!state_void || !move_void) return 0;
+    const bitboard_state_t *state = (const bitboard_state_t*)state_void;
+    const chess_move_t *move = (const chess_move_t*)move_void;
+
+    if (move->is_en_passant) return 1;
+    if (move->promotion != 0) return 1;
+
+    // Cattura regolare: sulla casella di arrivo c'è un pezzo avversario
+    uint64_t to_bit = 1ULL << move->to;
+    uint64_t opp_occ = (state->current_player == 1) ? state->occupied_black
+                                                    : state->occupied_white;
+    return (to_bit & opp_occ) ? 1 : 0;
+}
+
+/**
+ * @brief Implementa la funzione di callback per l'indice compatto from/to.
+ *
+ * @param[in] move_void Mossa da mappare (`chess_move_t*`).
+ * @return Indice from*64+to in [0, 4096), oppure -1 se `move_void` è `NULL`.
+ */
+int chess_move_index(const void *move_void) {
+    if (!move_void) return -1;
+    const chess_move_t *move = (const chess_move_t*)move_void;
+    return (int)move->from * 64 + (int)move->to;
+}
+
+/**
+ * @brief Impacca una mossa in 16 bit (bit 0-5 to, 6-11 from, 12-15 tipo).
+ *
+ * Tipo: 0 = normale, 1-4 = promozione (stessi valori di `promotion`),
+ * 5 = arrocco, 6 = en passant. Promozione, arrocco ed en passant si
+ * escludono a vicenda, quindi un nibble basta per tutti e tre.
+ */
+int chess_move_pack(const void *move_void) {
+    if (!move_void) return -1;
+    const chess_move_t *move = (const chess_move_t*)move_void;
+
+    int kind = 0;
+    if (move->promotion != 0) {
+        kind = move->promotion;          /* 1-4 = N/B/R/Q */
+    } else if (move->is_castling) {
+        kind = 5;
+    } else if (move->is_en_passant) {
+        kind = 6;
+    }
+    return ((int)move->to) | ((int)move->from << 6) | (kind << 12);
+}
+
+/**
+ * @brief Disfa la codifica di chess_move_pack ricostruendo la mossa.
+ */
+int chess_move_unpack(int packed, chess_move_t *move) {
+    if (!move) return 0;
+    memset(move, 0, sizeof(*move));
+    if (packed < 0 || packed > 0xFFFF) return 0;
+
+    move->to   = (uint8_t)(packed & 0x3F);
+    move->from = (uint8_t)((packed >> 6) & 0x3F);
+    int kind = (packed >> 12) & 0xF;
+    if (kind >= 1 && kind <= 4) {
+        move->promotion = (uint8_t)kind;
+    } else if (kind == 5) {
+        move->is_castling = 1;
+    } else if (kind == 6) {
+        move->is_en_passant = 1;
+    } else if (kind != 0) {
+        return 0; /* nibble di tipo sconosciuto */
     }
+    return 1;
 }
 
 /* --------------------------------------------------------------------------
@@ -189,20 +718,18 @@ void chess_free_move(void *move_void) {
  * @param[in] is_castling Flag per arrocco (1 = sì, 0 = no).
  * @param[in] is_en_passant Flag per en passant (1 = sì, 0 = no).
  */
-void add_move(dynamic_vector_t *moves, uint8_t from, uint8_t to, 
+void add_move(dynamic_vector_t *moves, uint8_t from, uint8_t to,
                      uint8_t promotion, uint8_t is_castling, uint8_t is_en_passant)
 {
-    chess_move_t *move = (chess_move_t*)malloc(sizeof(chess_move_t));
-    if (!move) {
-        // Possibile log errore
-        return;
-    }
-    move->from = from;
-    move->to = to;
-    move->promotion = promotion;
-    move->is_castling = is_castling;
-    move->is_en_passant = is_en_passant;
-    dv_push_back(moves, move);
+    // La mossa viene copiata per valore nel buffer contiguo del vettore:
+    // nessuna allocazione per singola mossa
+    chess_move_t move;
+    move.from = from;
+    move.to = to;
+    move.promotion = promotion;
+    move.is_castling = is_castling;
+    move.is_en_passant = is_en_passant;
+    dv_push_back_value(moves, &move);
 }
 
 /* --------------------------------------------------------------------------
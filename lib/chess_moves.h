@@ -1,5 +1,5 @@
 /******************************************************************************
-# ##VERSION## "chess_moves.h 1.0"
+# ##VERSION## "chess_moves.h 1.5"
 #
 # Nome Progetto  : ChessEngine
 # Versione       : 1.0
@@ -73,13 +73,14 @@ typedef struct {
 } chess_move_t;
 
 /**
- * @brief Funzione di callback per ottenere tutte le mosse legali da uno stato. Genera tutte le pseudo mosse 
- * legali nello stato corrente. Inclusa la cattura del re avversario. Assume che ci sia una fase di 
- * filtro successiva che escluda le mosse non valide in base alle regole complesse degli scacchi. Ad
- * esempio, genera la mossa che cattura il re avversario, genera le mosse en-passant in base ai flag di stato,
- * genera le mosse di arrocco lungo e corto in base ai flag di stato ma non controlla se una delle caselle
- * su cui si muove il re siano sotto scacco, non controlla se un pezzo è pinned e nel caso in cui venga mosso
- * il proprio re vada sotto scacco.
+ * @brief Funzione di callback per ottenere tutte le mosse legali da uno stato.
+ *
+ * Genera le pseudo-mosse con i generatori per pezzo e poi le filtra in place
+ * con le maschere di legalità (\ref chess_compute_legality /
+ * \ref chess_is_move_legal): inchiodature, scacchi da parare, caselle vietate
+ * al re e arrocchi attraverso caselle attaccate vengono esclusi qui. Il
+ * vettore restituito contiene quindi SOLO mosse legali: `chess_make_move` le
+ * accetta tutte, e una lista vuota equivale a matto o stallo.
  *
  * @param[in] state Stato corrente del gioco (`bitboard_state_t`).
  * @return Un puntatore a `dynamic_vector_t` contenente tutte le mosse legali (`chess_move_t*`).
@@ -89,6 +90,91 @@ typedef struct {
  */
 dynamic_vector_t* chess_get_moves(const void *state);
 
+/**
+ * @brief Genera tutte le mosse legali in un buffer fornito dal chiamante.
+ *
+ * Variante di \ref chess_get_moves senza vettore dinamico: le mosse legali
+ * vengono scritte come array contiguo di `chess_move_t` in \p out_moves.
+ * Un buffer di 256 elementi basta sempre (il massimo teorico di mosse legali
+ * è 218). Niente da liberare: è il formato con cui la ricerca MiniMax tiene
+ * la lista del nodo sullo stack (callback `generate_moves` del descrittore).
+ *
+ * @param[in]  state     Stato corrente del gioco (`bitboard_state_t`).
+ * @param[out] out_moves Buffer del chiamante (array di `chess_move_t`,
+ *                       almeno \p max_moves elementi).
+ * @param[in]  max_moves Capienza del buffer in mosse.
+ * @return Il numero di mosse legali scritte (0 = matto o stallo), oppure -1
+ *         se i parametri non sono validi o le mosse non entrano nel buffer.
+ */
+int chess_generate_moves(const void *state, void *out_moves, int max_moves);
+
+/**
+ * @brief Verifica se il giocatore di turno ha almeno una mossa legale.
+ *
+ * Esce alla PRIMA mossa legale trovata (re per primo, poi gli altri pezzi)
+ * invece di generare e filtrare la lista completa: è il predicato usato da
+ * \ref chess_is_terminal, che deve solo rispondere "esiste una mossa?".
+ *
+ * @param[in] state Stato corrente del gioco (`bitboard_state_t`).
+ * @return 1 se esiste almeno una mossa legale, 0 altrimenti (matto o stallo).
+ */
+int chess_has_legal_move(const void *state);
+
+/**
+ * @brief Funzione di callback per ottenere le sole pseudo-mosse di cattura.
+ *
+ * Genera le pseudo-mosse come `chess_get_moves` ma conserva soltanto quelle
+ * "forzanti": catture regolari, en passant e promozioni. È il generatore
+ * usato dalla ricerca di quiescenza di MiniMax, che estende solo le linee
+ * di cattura oltre la profondità nominale.
+ *
+ * @param[in] state Stato corrente del gioco (`bitboard_state_t`).
+ * @return Un puntatore a `dynamic_vector_t` contenente le sole mosse di cattura
+ *         (`chess_move_t*`), da liberare con `chess_free_moves`.
+ */
+dynamic_vector_t* chess_get_capture_moves(const void *state);
+
+/**
+ * @struct chess_movegen_s
+ * @brief Generatore a stadi: le mosse vengono prodotte man mano che il
+ *        consumatore le chiede.
+ *
+ * Ordine di emissione: l'eventuale mossa suggerita (impaccata, vedi
+ * \ref chess_move_pack),
+ * poi le catture — generate direttamente dalle tabelle di attacco — e solo
+ * alla fine le mosse tranquille, il cui vettore viene materializzato alla
+ * prima richiesta oltre l'ultima cattura. Un consumatore che si ferma dopo
+ * le prime mosse (taglio beta, test di esistenza di una mossa legale) non
+ * paga mai la generazione delle tranquille.
+ */
+typedef struct chess_movegen_s chess_movegen_t;
+
+/**
+ * @brief Avvia un generatore a stadi sulla posizione \p state.
+ *
+ * @param[in] state         Stato corrente del gioco (`bitboard_state_t`).
+ * @param[in] tt_move_index Mossa da emettere per prima, impaccata con
+ *                          \ref chess_move_pack, oppure -1 se non c'è un
+ *                          suggerimento.
+ * @return Generatore da consumare con \ref chess_movegen_next e chiudere
+ *         con \ref chess_movegen_end, oppure NULL in caso di errore.
+ */
+chess_movegen_t* chess_movegen_start(const void *state, int tt_move_index);
+
+/**
+ * @brief Restituisce la prossima mossa legale, o NULL a fine lista.
+ *
+ * @param[in] gen Generatore avviato con \ref chess_movegen_start.
+ * @return Puntatore alla mossa (valido fino a \ref chess_movegen_end),
+ *         oppure NULL quando le mosse sono esaurite.
+ */
+const chess_move_t* chess_movegen_next(chess_movegen_t *gen);
+
+/**
+ * @brief Chiude il generatore liberando i vettori interni.
+ */
+void chess_movegen_end(chess_movegen_t *gen);
+
 /**
  * @brief Funzione di callback per liberare il vettore di mosse.
  *
@@ -130,8 +216,55 @@ void* chess_copy_move(const void *move);
  */
 void chess_free_move(void *move);
 
+/**
+ * @brief Funzione di callback per riconoscere se una mossa è una cattura (o promozione).
+ *
+ * Usata dalla fase di ordinamento delle mosse di MiniMax per esaminare per
+ * prime le mosse "forzanti": catture regolari, en passant e promozioni.
+ *
+ * @param[in] state Stato corrente del gioco (`bitboard_state_t`), PRIMA della mossa.
+ * @param[in] move Mossa da classificare (`chess_move_t*`).
+ * @return 1 se la mossa cattura un pezzo avversario o promuove un pedone, 0 altrimenti.
+ */
+int chess_is_capture(const void *state, const void *move);
+
+/**
+ * @brief Funzione di callback per mappare una mossa su un indice compatto from/to.
+ *
+ * L'indice (from*64+to, nell'intervallo 0..4095) identifica la mossa nella
+ * history table e nei killer slot di MiniMax.
+ *
+ * @param[in] move Mossa da mappare (`chess_move_t*`).
+ * @return Indice in [0, 4096), oppure -1 se `move` è `NULL`.
+ */
+int chess_move_index(const void *move);
+
+/**
+ * @brief Impacca una mossa in 16 bit, in modo REVERSIBILE.
+ *
+ * Layout: bit 0-5 = casella di arrivo, bit 6-11 = casella di partenza,
+ * bit 12-15 = tipo (0 = normale, 1-4 = promozione N/B/R/Q, 5 = arrocco,
+ * 6 = en passant). A differenza di \ref chess_move_index, la codifica
+ * distingue le promozioni e si disfa con \ref chess_move_unpack: è il
+ * formato con cui la mossa migliore viaggia per valore nella transposition
+ * table, senza coppie copy/free né puntatori.
+ *
+ * @param[in] move Mossa da impaccare (`chess_move_t*`).
+ * @return Valore in [0, 0xFFFF), oppure -1 se `move` è `NULL`.
+ */
+int chess_move_pack(const void *move);
+
+/**
+ * @brief Disfa la codifica di \ref chess_move_pack ricostruendo la mossa.
+ *
+ * @param[in]  packed Valore prodotto da \ref chess_move_pack.
+ * @param[out] move   Mossa ricostruita (`chess_move_t*`).
+ * @return 1 se la codifica è valida, 0 altrimenti (mossa azzerata).
+ */
+int chess_move_unpack(int packed, chess_move_t *move);
+
 /*
-** Utilità di supporto 
+** Utilità di supporto
 **
 */
 
@@ -1,10 +1,11 @@
 /**
- * ##VERSION## "chess_moves_black.c 1.2"
+ * ##VERSION## "chess_moves_black.c 1.4"
  *
  */
 
 #include "chess_moves_bishop.h"
 #include "chess_moves.h"
+#include "chess_magic.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
@@ -16,25 +17,25 @@ void generate_black_bishop_moves(const bitboard_state_t *state, dynamic_vector_t
     uint64_t bishops = state->black_bishops;
 
     // Bitboard di occupazione
-    uint64_t black_occ = state->black_pawns | state->black_knights | state->black_bishops |
-                         state->black_rooks | state->black_queens | state->black_kings;
-    uint64_t white_occ = state->white_pawns | state->white_knights | state->white_bishops |
-                         state->white_rooks | state->white_queens | state->white_kings;
+    uint64_t black_occ = state->occupied_black;
+    uint64_t white_occ = state->occupied_white;
+
+    chess_magic_init();
 
     while (bishops) {
         int from = __builtin_ctzll(bishops);
         bishops &= bishops - 1;
 
-        uint64_t from_bit = (1ULL << from);
-
-        // Diagonale Nord-Est: shift = +7, blocco se colonna h => 0x8080808080808080
-        explore_ray(from_bit, from, +7, 0x8080808080808080ULL, black_occ, white_occ, moves);
-        // Diagonale Nord-Ovest: shift = +9, blocco se colonna a => 0x0101010101010101
-        explore_ray(from_bit, from, +9, 0x0101010101010101ULL, black_occ, white_occ, moves);
-        // Diagonale Sud-Est: shift = -9, blocco se colonna h
-        explore_ray(from_bit, from, -9, 0x8080808080808080ULL, black_occ, white_occ, moves);
-        // Diagonale Sud-Ovest: shift = -7, blocco se colonna a
-        explore_ray(from_bit, from, -7, 0x0101010101010101ULL, black_occ, white_occ, moves);
+        // Lookup magica: tutte e quattro le diagonali in un colpo solo.
+        // L'insieme include la prima casella occupata di ogni raggio:
+        // basta togliere i pezzi propri per avere mosse e catture.
+        uint64_t attacks = chess_magic_bishop_attacks(from, black_occ | white_occ)
+                           & ~black_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
     }
 }
 
@@ -45,24 +46,22 @@ void generate_white_bishop_moves(const bitboard_state_t *state, dynamic_vector_t
     uint64_t bishops = state->white_bishops;
 
     // Creiamo i bitboard di occupazione
-    uint64_t white_occ = state->white_pawns   | state->white_knights   | state->white_bishops |
-                         state->white_rooks   | state->white_queens    | state->white_kings;
-    uint64_t black_occ = state->black_pawns   | state->black_knights   | state->black_bishops |
-                         state->black_rooks   | state->black_queens    | state->black_kings;
+    uint64_t white_occ = state->occupied_white;
+    uint64_t black_occ = state->occupied_black;
+
+    chess_magic_init();
 
     while (bishops) {
         int from = __builtin_ctzll(bishops);
         bishops &= bishops - 1;
 
-        uint64_t from_bit = (1ULL << from);
-
-        // Diagonale Nord-Est: shift = +7, blocco se colonna h => mask = 0x8080808080808080
-        explore_ray(from_bit, from, 7, 0x8080808080808080ULL, white_occ, black_occ, moves);
-        // Diagonale Nord-Ovest: shift = +9, blocco se colonna a => mask = 0x0101010101010101
-        explore_ray(from_bit, from, 9, 0x0101010101010101ULL, white_occ, black_occ, moves);
-        // Diagonale Sud-Est: shift = -9, blocco se colonna h => mask = 0x8080808080808080
-        explore_ray(from_bit, from, -9, 0x8080808080808080ULL, white_occ, black_occ, moves);
-        // Diagonale Sud-Ovest: shift = -7, blocco se colonna a => mask = 0x0101010101010101
-        explore_ray(from_bit, from, -7, 0x0101010101010101ULL, white_occ, black_occ, moves);
+        // Lookup magica: tutte e quattro le diagonali in un colpo solo
+        uint64_t attacks = chess_magic_bishop_attacks(from, white_occ | black_occ)
+                           & ~white_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
     }
 }
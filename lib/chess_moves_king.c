@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include "chess_moves.h"       // Per add_move(...)
+#include "chess_magic.h"    // Tabella chess_king_attacks
 #include "chess_state.h"    // Definisce bitboard_state_t, castling_rights, ecc.
 
 #define MASK_BLACK_SHORT_CASTLING ((1ULL << 61) | (1ULL << 62))  // f8, g8
@@ -10,96 +11,22 @@ void generate_black_king_moves(const bitboard_state_t *state, dynamic_vector_t *
     uint64_t king = state->black_kings;
 
     // Occupato da QUALUNQUE pezzo (bianco o nero)
-    uint64_t occupied = state->white_pawns   | state->white_knights | state->white_bishops |
-                        state->white_rooks   | state->white_queens  | state->white_kings  |
-                        state->black_pawns   | state->black_knights | state->black_bishops |
-                        state->black_rooks   | state->black_queens  | state->black_kings;
+    uint64_t occupied = state->occupied_all;
+
+    chess_magic_init();
 
     while (king) {
         int from = __builtin_ctzll(king);
         king &= (king - 1);
 
-        // Estraiamo colonna (file) e traversa (rank)
-        int from_file = from % 8;  // 0..7 (a..h)
-        int from_rank = from / 8;  // 0..7 (1..8 in “reale”)
-
-        // Possibili 8 direzioni di movimento del re (senza arrocco)
-        // offset[8] = { +1, -1, +8, -8, +9, +7, -7, -9 } in uno standard bitboard,
-        // ma useremo i check colonna/riga per evitare wrap.
-        
-        // - - - - - - - - - - - - - - - -
-        // 1) Nord   => from + 8, se rank < 7
-        if (from_rank < 7) {
-            int to = from + 8;
-            // Se la casella NON è occupata da pezzo nero
-            uint64_t black_occ = (state->black_pawns   | state->black_knights | state->black_bishops |
-                                  state->black_rooks   | state->black_queens  | state->black_kings);
-            if (!((1ULL << to) & black_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 2) Sud    => from - 8, se rank > 0
-        if (from_rank > 0) {
-            int to = from - 8;
-            uint64_t black_occ = (state->black_pawns   | state->black_knights | state->black_bishops |
-                                  state->black_rooks   | state->black_queens  | state->black_kings);
-            if (!((1ULL << to) & black_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 3) Est    => from + 1, se file < 7
-        if (from_file < 7) {
-            int to = from + 1;
-            uint64_t black_occ = (state->black_pawns   | state->black_knights | state->black_bishops |
-                                  state->black_rooks   | state->black_queens  | state->black_kings);
-            if (!((1ULL << to) & black_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 4) Ovest  => from - 1, se file > 0
-        if (from_file > 0) {
-            int to = from - 1;
-            uint64_t black_occ = (state->black_pawns   | state->black_knights | state->black_bishops |
-                                  state->black_rooks   | state->black_queens  | state->black_kings);
-            if (!((1ULL << to) & black_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 5) Nord-Est => +9 = +8 +1, se (from_rank < 7 && from_file < 7)
-        if (from_rank < 7 && from_file < 7) {
-            int to = from + 9;
-            uint64_t black_occ = (state->black_pawns   | state->black_knights | state->black_bishops |
-                                  state->black_rooks   | state->black_queens  | state->black_kings);
-            if (!((1ULL << to) & black_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 6) Nord-Ovest => +7 = +8 -1, se (from_rank < 7 && from_file > 0)
-        if (from_rank < 7 && from_file > 0) {
-            int to = from + 7;
-            uint64_t black_occ = (state->black_pawns   | state->black_knights | state->black_bishops |
-                                  state->black_rooks   | state->black_queens  | state->black_kings);
-            if (!((1ULL << to) & black_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 7) Sud-Est => -7 = -8 +1, se (from_rank > 0 && from_file < 7)
-        if (from_rank > 0 && from_file < 7) {
-            int to = from - 7;
-            uint64_t black_occ = (state->black_pawns   | state->black_knights | state->black_bishops |
-                                  state->black_rooks   | state->black_queens  | state->black_kings);
-            if (!((1ULL << to) & black_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 8) Sud-Ovest => -9 = -8 -1, se (from_rank > 0 && from_file > 0)
-        if (from_rank > 0 && from_file > 0) {
-            int to = from - 9;
-            uint64_t black_occ = (state->black_pawns   | state->black_knights | state->black_bishops |
-                                  state->black_rooks   | state->black_queens  | state->black_kings);
-            if (!((1ULL << to) & black_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
+        // Tabella precalcolata delle caselle adiacenti: una lettura al
+        // posto degli otto rami con controlli di riga/colonna
+        uint64_t black_occ = state->occupied_black;
+        uint64_t attacks = chess_king_attacks[from] & ~black_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
         }
 
         // ------------------------------------------------
@@ -136,83 +63,26 @@ void generate_white_king_moves(const bitboard_state_t *state, dynamic_vector_t *
     uint64_t king = state->white_kings;
 
     // Tutte le caselle occupate (bianche o nere)
-    uint64_t occupied = state->white_pawns   | state->white_knights | state->white_bishops |
-                        state->white_rooks   | state->white_queens  | state->white_kings  |
-                        state->black_pawns   | state->black_knights | state->black_bishops |
-                        state->black_rooks   | state->black_queens  | state->black_kings;
+    uint64_t occupied = state->occupied_all;
 
     // Mentre ci sono ancora bit di re bianco (in teoria di solito ce n'è uno solo, 
     // ma gestiamo il caso generico)
+    chess_magic_init();
+
     while (king) {
         // from = indice (0..63) del bit meno significativo attivo in 'king'
         int from = __builtin_ctzll(king);
         // toglie quel bit
         king &= (king - 1);
 
-        // Calcoliamo colonna e riga (file, rank)
-        int from_file = from % 8;  // 0..7
-        int from_rank = from / 8;  // 0..7
-
-        // Creiamo una maschera dei pezzi bianchi per evitare di catturare pezzi propri
-        uint64_t white_occ = state->white_pawns | state->white_knights | state->white_bishops |
-                             state->white_rooks | state->white_queens  | state->white_kings;
-
-        // 1) Nord => from + 8, se from_rank < 7
-        if (from_rank < 7) {
-            int to = from + 8;
-            // se non c'è un pezzo bianco in quella casella
-            if (!((1ULL << to) & white_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 2) Sud => from - 8, se from_rank > 0
-        if (from_rank > 0) {
-            int to = from - 8;
-            if (!((1ULL << to) & white_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 3) Est => from + 1, se from_file < 7
-        if (from_file < 7) {
-            int to = from + 1;
-            if (!((1ULL << to) & white_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 4) Ovest => from - 1, se from_file > 0
-        if (from_file > 0) {
-            int to = from - 1;
-            if (!((1ULL << to) & white_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 5) Nord-Est => from + 9, se (from_file<7 && from_rank<7)
-        if (from_file < 7 && from_rank < 7) {
-            int to = from + 9;
-            if (!((1ULL << to) & white_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 6) Nord-Ovest => from + 7, se (from_file>0 && from_rank<7)
-        if (from_file > 0 && from_rank < 7) {
-            int to = from + 7;
-            if (!((1ULL << to) & white_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 7) Sud-Est => from - 7, se (from_file<7 && from_rank>0)
-        if (from_file < 7 && from_rank > 0) {
-            int to = from - 7;
-            if (!((1ULL << to) & white_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
-        }
-        // 8) Sud-Ovest => from - 9, se (from_file>0 && from_rank>0)
-        if (from_file > 0 && from_rank > 0) {
-            int to = from - 9;
-            if (!((1ULL << to) & white_occ)) {
-                add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
-            }
+        // Tabella precalcolata delle caselle adiacenti: una lettura al
+        // posto degli otto rami con controlli di riga/colonna
+        uint64_t white_occ = state->occupied_white;
+        uint64_t attacks = chess_king_attacks[from] & ~white_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
         }
 
         // -----------------------------------
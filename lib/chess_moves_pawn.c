@@ -1,5 +1,5 @@
 /**
- * ##VERSION## "chess_moves_pawn.c 1.2"
+ * ##VERSION## "chess_moves_pawn.c 1.3"
  *
  */
 
@@ -16,10 +16,7 @@ void generate_black_pawn_moves(const bitboard_state_t *state, dynamic_vector_t *
     uint64_t pawns = state->black_pawns;
 
     // Occupato da QUALUNQUE pezzo
-    uint64_t occupied = state->white_pawns | state->white_knights | state->white_bishops |
-                        state->white_rooks | state->white_queens | state->white_kings |
-                        state->black_pawns | state->black_knights | state->black_bishops |
-                        state->black_rooks | state->black_queens | state->black_kings;
+    uint64_t occupied = state->occupied_all;
     uint64_t empty = ~occupied;
 
     // ------------------------------------------
@@ -62,8 +59,7 @@ void generate_black_pawn_moves(const bitboard_state_t *state, dynamic_vector_t *
     // (pawns >> 7), escludendo colonna a => ~(0x0101010101010101ULL)
     // e deve catturare pezzi bianchi
     uint64_t captures_right = (pawns >> 7) & ~(0x0101010101010101ULL) &
-                              (state->white_pawns | state->white_knights | state->white_bishops |
-                               state->white_rooks | state->white_queens | state->white_kings);
+                              state->occupied_white;
     while (captures_right) {
         int to = __builtin_ctzll(captures_right);
         captures_right &= captures_right - 1;
@@ -86,8 +82,7 @@ void generate_black_pawn_moves(const bitboard_state_t *state, dynamic_vector_t *
     // (pawns >> 9), escludendo colonna h => ~(0x8080808080808080ULL)
     // cattura su pezzi bianchi
     uint64_t captures_left = (pawns >> 9) & ~(0x8080808080808080ULL) &
-                             (state->white_pawns | state->white_knights | state->white_bishops |
-                              state->white_rooks | state->white_queens | state->white_kings);
+                             state->occupied_white;
     while (captures_left) {
         int to = __builtin_ctzll(captures_left);
         captures_left &= captures_left - 1;
@@ -145,10 +140,7 @@ void generate_white_pawn_moves(const bitboard_state_t *state, dynamic_vector_t *
     uint64_t pawns = state->white_pawns;
 
     // Bitboard dei pezzi occupati (bianchi o neri)
-    uint64_t occupied = state->white_pawns | state->white_knights | state->white_bishops |
-                        state->white_rooks | state->white_queens | state->white_kings |
-                        state->black_pawns | state->black_knights | state->black_bishops |
-                        state->black_rooks | state->black_queens | state->black_kings;
+    uint64_t occupied = state->occupied_all;
     // Caselle libere
     uint64_t empty = ~occupied;
 
@@ -191,8 +183,7 @@ void generate_white_pawn_moves(const bitboard_state_t *state, dynamic_vector_t *
     // (pawns << 9) escludendo colonna 'a' => ~(0x0101010101010101ULL)
     // e deve catturare pezzi neri
     uint64_t captures_right = (pawns << 9) & ~(0x0101010101010101ULL) &
-                              (state->black_pawns | state->black_knights | state->black_bishops |
-                               state->black_rooks | state->black_queens | state->black_kings);
+                              state->occupied_black;
     while (captures_right) {
         int to = __builtin_ctzll(captures_right);
         captures_right &= captures_right - 1;
@@ -215,8 +206,7 @@ void generate_white_pawn_moves(const bitboard_state_t *state, dynamic_vector_t *
     // (pawns << 7) escludendo colonna 'h' => ~(0x8080808080808080ULL)
     // cattura su pezzi neri
     uint64_t captures_left = (pawns << 7) & ~(0x8080808080808080ULL) &
-                             (state->black_pawns | state->black_knights | state->black_bishops |
-                              state->black_rooks | state->black_queens | state->black_kings);
+                             state->occupied_black;
     while (captures_left) {
         int to = __builtin_ctzll(captures_left);
         captures_left &= captures_left - 1;
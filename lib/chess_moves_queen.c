@@ -1,10 +1,11 @@
 /**
- * ##VERSION## "chess_moves_queen.c 1.2"
+ * ##VERSION## "chess_moves_queen.c 1.4"
  *
  */
 
 #include "chess_moves_queen.h"
 #include "chess_moves.h"
+#include "chess_magic.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
@@ -23,28 +24,25 @@ void generate_black_queen_moves(const bitboard_state_t *state, dynamic_vector_t
     uint64_t queens = state->black_queens;
 
     // Bitboard di occupazione
-    uint64_t black_occ = state->black_pawns | state->black_knights | state->black_bishops |
-                         state->black_rooks | state->black_queens | state->black_kings;
-    uint64_t white_occ = state->white_pawns | state->white_knights | state->white_bishops |
-                         state->white_rooks | state->white_queens | state->white_kings;
+    uint64_t black_occ = state->occupied_black;
+    uint64_t white_occ = state->occupied_white;
+
+    chess_magic_init();
 
     while (queens) {
         int from = __builtin_ctzll(queens);
         queens &= queens - 1;
 
-        uint64_t from_bit = 1ULL << from;
-
-        // Diagonali (alfiere-like)
-        explore_ray(from_bit, from, +7, 0x8080808080808080ULL, black_occ, white_occ, moves); // NE
-        explore_ray(from_bit, from, +9, 0x0101010101010101ULL, black_occ, white_occ, moves); // NO
-        explore_ray(from_bit, from, -7, 0x0101010101010101ULL, black_occ, white_occ, moves); // SO
-        explore_ray(from_bit, from, -9, 0x8080808080808080ULL, black_occ, white_occ, moves); // SE
-
-        // Linee (torre-like)
-        explore_ray(from_bit, from, +1, 0x8080808080808080ULL, black_occ, white_occ, moves); // Est
-        explore_ray(from_bit, from, -1, 0x0101010101010101ULL, black_occ, white_occ, moves); // Ovest
-        explore_ray(from_bit, from, +8, 0xFF00000000000000ULL, black_occ, white_occ, moves); // Nord
-        explore_ray(from_bit, from, -8, 0x00000000000000FFULL, black_occ, white_occ, moves); // Sud
+        // Lookup magica: diagonali (alfiere) + linee (torre) in due letture.
+        // L'insieme include la prima casella occupata di ogni raggio:
+        // basta togliere i pezzi propri per avere mosse e catture.
+        uint64_t attacks = chess_magic_queen_attacks(from, black_occ | white_occ)
+                           & ~black_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
     }
 }
 
@@ -62,10 +60,10 @@ void generate_white_queen_moves(const bitboard_state_t *state, dynamic_vector_t
     uint64_t queens = state->white_queens;
 
     // Prepara i bitboard di occupazione (per sapere quali caselle sono bloccate)
-    uint64_t white_occ = state->white_pawns   | state->white_knights   | state->white_bishops |
-                         state->white_rooks   | state->white_queens    | state->white_kings;
-    uint64_t black_occ = state->black_pawns   | state->black_knights   | state->black_bishops |
-                         state->black_rooks   | state->black_queens    | state->black_kings;
+    uint64_t white_occ = state->occupied_white;
+    uint64_t black_occ = state->occupied_black;
+
+    chess_magic_init();
 
     while (queens) {
         // Estrai l'indice (0-63) della regina più a destra (LSB)
@@ -73,20 +71,13 @@ void generate_white_queen_moves(const bitboard_state_t *state, dynamic_vector_t
         // Rimuovi questa regina dal bitboard (così troveremo la prossima, se c'è)
         queens &= queens - 1;
 
-        // Costruiamo il bit singolo della casella
-        uint64_t from_bit = 1ULL << from;
-
-        // Ora, come un alfiere: esploriamo 4 direzioni diagonali
-        // (notare i relativi shift e maschere di confine)
-        explore_ray(from_bit, from, +7, 0x8080808080808080ULL, white_occ, black_occ, moves); // Nord-Est
-        explore_ray(from_bit, from, +9, 0x0101010101010101ULL, white_occ, black_occ, moves); // Nord-Ovest
-        explore_ray(from_bit, from, -7, 0x0101010101010101ULL, white_occ, black_occ, moves); // Sud-Ovest
-        explore_ray(from_bit, from, -9, 0x8080808080808080ULL, white_occ, black_occ, moves); // Sud-Est
-
-        // Ora, come una torre: esploriamo 4 direzioni ortogonali
-        explore_ray(from_bit, from, +1, 0x8080808080808080ULL, white_occ, black_occ, moves); // Est
-        explore_ray(from_bit, from, -1, 0x0101010101010101ULL, white_occ, black_occ, moves); // Ovest
-        explore_ray(from_bit, from, +8, 0xFF00000000000000ULL, white_occ, black_occ, moves); // Nord
-        explore_ray(from_bit, from, -8, 0x00000000000000FFULL, white_occ, black_occ, moves); // Sud
+        // Lookup magica: diagonali (alfiere) + linee (torre) in due letture
+        uint64_t attacks = chess_magic_queen_attacks(from, white_occ | black_occ)
+                           & ~white_occ;
+        while (attacks) {
+            int to = __builtin_ctzll(attacks);
+            attacks &= attacks - 1;
+            add_move(moves, (uint8_t)from, (uint8_t)to, 0, 0, 0);
+        }
     }
 }
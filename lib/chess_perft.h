@@ -0,0 +1,60 @@
+/******************************************************************************
+# ##VERSION## "chess_perft.h 1.0"
+#
+# Nome Progetto  : ChessEngine
+# Versione       : 1.0
+# Data Creazione : 31/08/2026
+# Autore         : [Il tuo nome]
+#
+# Descrizione    : Interfaccia del modulo perft ("performance test"): conteggio
+#                  esaustivo dei nodi dell'albero di gioco fino a una profondità
+#                  data. I conteggi alle posizioni standard sono noti in
+#                  letteratura, quindi perft valida l'intera catena
+#                  generazione mosse + make/unmake e, misurato nel tempo,
+#                  fa da benchmark canonico del movegen.
+#
+# Dipendenze     : chess_state.h, stdint.h
+#
+# Uso:
+#   bitboard_state_t state;
+#   initialize_board(&state);
+#   uint64_t nodes = chess_perft(&state, 5);   // atteso: 4865609
+#
+******************************************************************************/
+
+#ifndef CHESS_PERFT_H
+#define CHESS_PERFT_H
+
+#include "chess_state.h"
+#include <stdint.h>
+
+/**
+ * @brief Conta i nodi dell'albero di gioco fino alla profondità \p depth.
+ *
+ * Visita ricorsivamente tutte le mosse LEGALI con make/unmake sullo stesso
+ * buffer di stato (nessuna allocazione per nodo). Al livello foglia non si
+ * ricorre oltre: ogni mossa legale conta 1. Il generatore del motore è
+ * pseudo-legale, quindi anche al livello foglia ogni mossa va validata con
+ * `chess_make_move`; con un generatore completamente legale il conteggio
+ * foglia potrebbe avvenire in blocco senza eseguire le mosse.
+ *
+ * @param[in,out] state Posizione di partenza; al ritorno è invariata.
+ * @param[in]     depth Profondità del conteggio (0 ritorna 1).
+ * @return Numero di nodi (posizioni raggiungibili) a profondità \p depth.
+ */
+uint64_t chess_perft(bitboard_state_t *state, int depth);
+
+/**
+ * @brief Come \ref chess_perft ma stampa il conteggio per ogni mossa radice.
+ *
+ * Formato "divide" classico (es. `e2e4: 600`): confrontando i sottototali
+ * con un motore di riferimento si individua rapidamente la mossa radice
+ * dietro cui si nasconde una discrepanza.
+ *
+ * @param[in,out] state Posizione di partenza; al ritorno è invariata.
+ * @param[in]     depth Profondità del conteggio (>= 1).
+ * @return Numero totale di nodi, come \ref chess_perft.
+ */
+uint64_t chess_perft_divide(bitboard_state_t *state, int depth);
+
+#endif /* CHESS_PERFT_H */
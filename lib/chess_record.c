@@ -0,0 +1,141 @@
+/**
+ * ##VERSION## "chess_record.c 1.0"
+*/
+
+#include "chess_record.h"
+#include "obj_trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* --------------------------------------------------------------------------
+ * Sessione di registrazione: la mappa e le due viste (header + array mosse).
+ * Il percorso caldo (chess_record_move) tocca solo "moves" e "count"; tutto
+ * il resto serve alla chiusura.
+ * -------------------------------------------------------------------------- */
+struct chess_record_s {
+    int                    fd;
+    void                  *map;
+    size_t                 map_size;
+    chess_record_header_t *header;
+    chess_record_move_t   *moves;
+    uint32_t               count;   /* semimosse registrate (anche oltre capienza) */
+};
+
+chess_record_t* chess_record_create(const char *path,
+                                    const char *white,
+                                    const char *black,
+                                    const char *fen)
+{
+    if (!path) {
+        return NULL;
+    }
+
+    chess_record_t *rec = (chess_record_t*)malloc(sizeof(chess_record_t));
+    if (!rec) {
+        return NULL;
+    }
+
+    rec->map_size = sizeof(chess_record_header_t)
+                  + (size_t)CHESS_RECORD_MAX_MOVES * sizeof(chess_record_move_t);
+
+    rec->fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (rec->fd < 0) {
+        TRACE_ERROR(&stdtrace, "chess_record: apertura di '%s' fallita", path);
+        free(rec);
+        return NULL;
+    }
+
+    /* Preallocazione: da qui in poi le scritture sono solo page fault
+       sulla mappa, mai estensioni del file */
+    if (ftruncate(rec->fd, (off_t)rec->map_size) != 0) {
+        TRACE_ERROR(&stdtrace, "chess_record: ftruncate di '%s' fallita", path);
+        close(rec->fd);
+        free(rec);
+        return NULL;
+    }
+
+    rec->map = mmap(NULL, rec->map_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, rec->fd, 0);
+    if (rec->map == MAP_FAILED) {
+        TRACE_ERROR(&stdtrace, "chess_record: mmap di '%s' fallita", path);
+        close(rec->fd);
+        free(rec);
+        return NULL;
+    }
+
+    rec->header = (chess_record_header_t*)rec->map;
+    rec->moves = (chess_record_move_t*)((char*)rec->map
+                                        + sizeof(chess_record_header_t));
+    rec->count = 0;
+
+    memset(rec->header, 0, sizeof(*rec->header));
+    rec->header->magic = CHESS_RECORD_MAGIC;
+    rec->header->version = CHESS_RECORD_VERSION;
+    rec->header->result = CHESS_RECORD_UNFINISHED;
+    if (white) {
+        snprintf(rec->header->white, sizeof(rec->header->white), "%s", white);
+    }
+    if (black) {
+        snprintf(rec->header->black, sizeof(rec->header->black), "%s", black);
+    }
+    if (fen) {
+        snprintf(rec->header->fen, sizeof(rec->header->fen), "%s", fen);
+    }
+
+    return rec;
+}
+
+int chess_record_move(chess_record_t *rec,
+                      const chess_move_t *move,
+                      const search_stats_t *stats,
+                      int depth,
+                      int value)
+{
+    if (!rec || !move) {
+        return 0;
+    }
+    if (rec->count >= CHESS_RECORD_MAX_MOVES) {
+        rec->count++; /* il contatore resta fedele anche se il file è pieno */
+        return 0;
+    }
+
+    chess_record_move_t *slot = &rec->moves[rec->count++];
+    slot->from = move->from;
+    slot->to = move->to;
+    slot->promotion = move->promotion;
+    slot->flags = (uint8_t)((move->is_castling ? 1u : 0u)
+                          | (move->is_en_passant ? 2u : 0u));
+    slot->value = (int32_t)value;
+    slot->depth = (uint32_t)((depth > 0) ? depth : 0);
+    slot->elapsed_ms = stats ? (uint32_t)stats->elapsed_ms : 0;
+    slot->nodes = stats ? (uint64_t)(stats->nodes + stats->qnodes) : 0;
+    slot->reserved = 0;
+    return 1;
+}
+
+void chess_record_close(chess_record_t *rec, char result)
+{
+    if (!rec) {
+        return;
+    }
+
+    uint32_t written = (rec->count < CHESS_RECORD_MAX_MOVES)
+                     ? rec->count : CHESS_RECORD_MAX_MOVES;
+    rec->header->move_count = written;
+    rec->header->result = result;
+
+    size_t used = sizeof(chess_record_header_t)
+                + (size_t)written * sizeof(chess_record_move_t);
+
+    msync(rec->map, used, MS_SYNC);
+    munmap(rec->map, rec->map_size);
+    if (ftruncate(rec->fd, (off_t)used) != 0) {
+        TRACE_WARN(&stdtrace, "chess_record: accorciamento finale fallito");
+    }
+    close(rec->fd);
+    free(rec);
+}
@@ -0,0 +1,144 @@
+#ifndef CHESS_RECORD_H
+#define CHESS_RECORD_H
+
+/**
+ * @file chess_record.h
+ * @brief Registrazione binaria zero-copy delle partite (per il torneo).
+ *
+ * ##VERSION## "chess_record.h 1.0"
+ *
+ * Catturare le partite di self-play raschiando l'output di print_board dal
+ * log di stdtrace costa formattazione e I/O dentro il ciclo di gioco, e
+ * quindi falsa proprio le misure per cui il torneo esiste. Questo modulo
+ * registra mosse e statistiche di ricerca in record binari compatti dentro
+ * un file mmappato PREALLOCATO: sul thread di gioco ogni mossa è un
+ * assegnamento di struct nella mappa — niente formattazione, niente
+ * syscall, niente allocazioni. Il file viene accorciato alla dimensione
+ * reale e sincronizzato solo alla chiusura.
+ *
+ * Un file = una partita (il torneo gioca una partita per processo: nessun
+ * coordinamento tra scrittori). Il formato è consumato da chess_record_pgn,
+ * che riproduce la partita e la esporta in PGN per gli umani.
+ *
+ * Uso tipico nel driver di torneo:
+ * @code
+ *   chess_record_t *rec = chess_record_create(path, "A", "B", fen);
+ *   ...
+ *   // dopo ogni mossa scelta dal motore:
+ *   chess_record_move(rec, move, &stats, depth, value);
+ *   ...
+ *   chess_record_close(rec, CHESS_RECORD_WHITE_WINS);
+ * @endcode
+ */
+
+#include <stdint.h>
+
+#include "chess_state.h"
+#include "chess_moves.h"
+#include "minimax.h"
+
+/** Numero magico in testa al file ("CREC" little-endian) */
+#define CHESS_RECORD_MAGIC   0x43455243u
+
+/** Versione del formato (bump a ogni cambiamento di layout) */
+#define CHESS_RECORD_VERSION 1u
+
+/** Capienza preallocata in semimosse (oltre, le mosse vengono scartate) */
+#define CHESS_RECORD_MAX_MOVES 1024
+
+/** Esiti della partita (campo result dell'header) */
+#define CHESS_RECORD_WHITE_WINS 'w'
+#define CHESS_RECORD_BLACK_WINS 'b'
+#define CHESS_RECORD_DRAW       'd'
+#define CHESS_RECORD_UNFINISHED '*'
+
+/**
+ * @struct chess_record_header_s
+ * @brief Header del file di registrazione (una partita).
+ */
+typedef struct chess_record_header_s {
+    uint32_t magic;       /**< \ref CHESS_RECORD_MAGIC */
+    uint32_t version;     /**< \ref CHESS_RECORD_VERSION */
+    uint32_t move_count;  /**< Semimosse registrate (scritto alla chiusura) */
+    char     result;      /**< CHESS_RECORD_* (scritto alla chiusura) */
+    char     pad[3];
+    char     white[32];   /**< Etichetta del Bianco (troncata) */
+    char     black[32];   /**< Etichetta del Nero (troncata) */
+    char     fen[128];    /**< Posizione iniziale; stringa vuota = startpos */
+} chess_record_header_t;
+
+/**
+ * @struct chess_record_move_s
+ * @brief Una semimossa con le statistiche della ricerca che l'ha scelta.
+ *
+ * 32 byte allineati: l'array nel file si legge con un cast dalla mappa.
+ */
+typedef struct chess_record_move_s {
+    uint8_t  from;        /**< Casella di partenza (0..63, a1=0) */
+    uint8_t  to;          /**< Casella di arrivo */
+    uint8_t  promotion;   /**< 0 nessuna, 1=N 2=B 3=R 4=Q */
+    uint8_t  flags;       /**< bit 0: arrocco, bit 1: en passant */
+    int32_t  value;       /**< Punteggio dell'ultima iterazione completata */
+    uint32_t depth;       /**< Profondità dell'ultima iterazione completata */
+    uint32_t elapsed_ms;  /**< Durata della ricerca della mossa */
+    uint64_t nodes;       /**< Nodi visitati (minimax + quiescenza) */
+    uint64_t reserved;    /**< A zero, per estensioni future */
+} chess_record_move_t;
+
+/**
+ * @brief Sessione di registrazione (opaca: definita in chess_record.c).
+ */
+typedef struct chess_record_s chess_record_t;
+
+/**
+ * @brief Crea il file di registrazione e lo prealloca alla capienza massima.
+ *
+ * Il file viene creato (o troncato se esiste), portato con ftruncate alla
+ * dimensione di header + \ref CHESS_RECORD_MAX_MOVES record e mmappato in
+ * scrittura: da qui in poi registrare una mossa non tocca il filesystem.
+ *
+ * @param[in] path  Percorso del file (convenzione del torneo: .crec).
+ * @param[in] white Etichetta del Bianco (es. nome della configurazione).
+ * @param[in] black Etichetta del Nero.
+ * @param[in] fen   Posizione iniziale, oppure \c NULL per la posizione
+ *                  standard.
+ * @return La sessione, o \c NULL su errore di apertura/mappatura.
+ */
+chess_record_t* chess_record_create(const char *path,
+                                    const char *white,
+                                    const char *black,
+                                    const char *fen);
+
+/**
+ * @brief Registra una semimossa con le statistiche della sua ricerca.
+ *
+ * Un assegnamento di struct nella mappa: nessuna formattazione né syscall.
+ * Oltre la capienza preallocata le mosse vengono contate ma non scritte
+ * (il contatore resta fedele, il file no: caso limite segnalato dal
+ * valore di ritorno).
+ *
+ * @param[in,out] rec   Sessione di registrazione.
+ * @param[in]     move  Mossa giocata.
+ * @param[in]     stats Statistiche della ricerca (da \ref minimax_get_search_stats).
+ * @param[in]     depth Profondità dell'ultima iterazione completata.
+ * @param[in]     value Punteggio dell'ultima iterazione completata.
+ * @return 1 se la mossa è stata scritta, 0 se la capienza è esaurita.
+ */
+int chess_record_move(chess_record_t *rec,
+                      const chess_move_t *move,
+                      const search_stats_t *stats,
+                      int depth,
+                      int value);
+
+/**
+ * @brief Chiude la registrazione: esito, dimensione reale, msync, munmap.
+ *
+ * Scrive esito e contatore nell'header, accorcia il file alla dimensione
+ * effettivamente usata e rilascia la mappa. La sessione non è più valida.
+ *
+ * @param[in,out] rec    Sessione da chiudere (tollerato \c NULL).
+ * @param[in]     result Esito: uno dei CHESS_RECORD_*.
+ */
+void chess_record_close(chess_record_t *rec, char result);
+
+#endif /* CHESS_RECORD_H */
@@ -0,0 +1,247 @@
+/**
+ * ##VERSION## "chess_record_pgn.c 1.0"
+*/
+
+/******************************************************************************
+ * File: chess_record_pgn.c
+ *
+ * Esportatore PGN dei file di registrazione binari (.crec) prodotti da
+ * chess_record: riproduce la partita mossa per mossa dal motore e la scrive
+ * in notazione algebrica standard (SAN), con un commento per mossa che
+ * riporta punteggio, profondità, nodi e tempo della ricerca. Il costo della
+ * formattazione si paga qui, offline: il thread di gioco ha scritto solo
+ * record binari.
+ *
+ * Uso:
+ *   make build TARGET=chess_record_pgn
+ *   ./chess_record_pgn partita1.crec [partita2.crec ...]   (PGN su stdout)
+ *
+ * Ogni mossa del file viene riconvalidata contro il generatore di mosse
+ * legali durante la riproduzione: un file corrotto o di una versione
+ * incompatibile viene rifiutato, mai esportato storto.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chess_state.h"
+#include "chess_moves.h"
+#include "chess_fen.h"
+#include "chess_hash.h"
+#include "chess_game_dynamics.h"
+#include "chess_record.h"
+#include "obj_trace.h"
+
+#define PGN_MAX_MOVES 256  /* mosse legali in una posizione */
+
+/* Lettera SAN del pezzo sulla casella (P/N/B/R/Q/K), '\0' se vuota */
+static char piece_letter_at(const bitboard_state_t *state, int square) {
+    uint64_t bit = 1ULL << square;
+    if ((state->white_pawns | state->black_pawns) & bit)     return 'P';
+    if ((state->white_knights | state->black_knights) & bit) return 'N';
+    if ((state->white_bishops | state->black_bishops) & bit) return 'B';
+    if ((state->white_rooks | state->black_rooks) & bit)     return 'R';
+    if ((state->white_queens | state->black_queens) & bit)   return 'Q';
+    if ((state->white_kings | state->black_kings) & bit)     return 'K';
+    return '\0';
+}
+
+/*
+ * Scrive in san[] la mossa in notazione algebrica standard, valutata PRIMA
+ * di applicarla a *state; poi la applica. Ritorna 0 se la mossa non è
+ * legale nella posizione (file corrotto).
+ */
+static int move_to_san(bitboard_state_t *state, const chess_record_move_t *rec,
+                       char *san, size_t san_size) {
+    static const char promo_letters[] = { '\0', 'N', 'B', 'R', 'Q' };
+
+    /* Riconvalida: la mossa deve esistere tra quelle legali */
+    chess_move_t legal[PGN_MAX_MOVES];
+    int n = chess_generate_moves(state, legal, PGN_MAX_MOVES);
+    const chess_move_t *move = NULL;
+    for (int i = 0; i < n; i++) {
+        if (legal[i].from == rec->from && legal[i].to == rec->to &&
+            legal[i].promotion == rec->promotion) {
+            move = &legal[i];
+            break;
+        }
+    }
+    if (!move) {
+        return 0;
+    }
+
+    char piece = piece_letter_at(state, move->from);
+    int is_capture = (piece_letter_at(state, move->to) != '\0') ||
+                     move->is_en_passant;
+
+    size_t used = 0;
+    if (move->is_castling) {
+        used = (size_t)snprintf(san, san_size,
+                                (move->to > move->from) ? "O-O" : "O-O-O");
+    } else if (piece == 'P') {
+        if (is_capture) {
+            used = (size_t)snprintf(san, san_size, "%cx", 'a' + move->from % 8);
+        }
+        used += (size_t)snprintf(san + used, san_size - used, "%c%c",
+                                 'a' + move->to % 8, '1' + move->to / 8);
+        if (move->promotion >= 1 && move->promotion <= 4) {
+            used += (size_t)snprintf(san + used, san_size - used, "=%c",
+                                     promo_letters[move->promotion]);
+        }
+    } else {
+        san[used++] = piece;
+        /* Disambiguazione: altri pezzi uguali che arrivano sulla stessa
+           casella; prima la colonna, poi la traversa, al limite entrambe */
+        int same_file = 0, same_rank = 0, others = 0;
+        for (int i = 0; i < n; i++) {
+            if (legal[i].to == move->to && legal[i].from != move->from &&
+                piece_letter_at(state, legal[i].from) == piece) {
+                others++;
+                if (legal[i].from % 8 == move->from % 8) same_file++;
+                if (legal[i].from / 8 == move->from / 8) same_rank++;
+            }
+        }
+        if (others > 0) {
+            if (same_file == 0) {
+                san[used++] = (char)('a' + move->from % 8);
+            } else if (same_rank == 0) {
+                san[used++] = (char)('1' + move->from / 8);
+            } else {
+                san[used++] = (char)('a' + move->from % 8);
+                san[used++] = (char)('1' + move->from / 8);
+            }
+        }
+        if (is_capture) {
+            san[used++] = 'x';
+        }
+        used += (size_t)snprintf(san + used, san_size - used, "%c%c",
+                                 'a' + move->to % 8, '1' + move->to / 8);
+    }
+
+    /* Applica e marca scacco/matto guardando la posizione risultante */
+    chess_undo_t undo;
+    if (!chess_make_move(state, move, &undo)) {
+        return 0;
+    }
+    if (is_king_in_check(state, state->current_player)) {
+        san[used++] = chess_is_terminal(state) ? '#' : '+';
+    }
+    san[used] = '\0';
+    return 1;
+}
+
+static const char* result_string(char result) {
+    switch (result) {
+        case CHESS_RECORD_WHITE_WINS: return "1-0";
+        case CHESS_RECORD_BLACK_WINS: return "0-1";
+        case CHESS_RECORD_DRAW:       return "1/2-1/2";
+        default:                      return "*";
+    }
+}
+
+/* Esporta un file .crec come una partita PGN su stdout. Ritorna 0 su errore. */
+static int export_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Impossibile aprire '%s'\n", path);
+        return 0;
+    }
+
+    chess_record_header_t header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != CHESS_RECORD_MAGIC ||
+        header.version != CHESS_RECORD_VERSION) {
+        fprintf(stderr, "'%s' non è un file di registrazione valido\n", path);
+        fclose(f);
+        return 0;
+    }
+
+    bitboard_state_t state;
+    if (header.fen[0] == '\0') {
+        initialize_board(&state);
+    } else if (!chess_fen_parse(header.fen, &state)) {
+        fprintf(stderr, "FEN non interpretabile in '%s'\n", path);
+        fclose(f);
+        return 0;
+    }
+    chess_repetition_reset();
+    chess_repetition_push(chess_hash_state(&state));
+
+    printf("[Event \"self-play\"]\n");
+    printf("[Site \"?\"]\n");
+    printf("[Round \"?\"]\n");
+    printf("[White \"%s\"]\n", header.white[0] ? header.white : "?");
+    printf("[Black \"%s\"]\n", header.black[0] ? header.black : "?");
+    printf("[Result \"%s\"]\n", result_string(header.result));
+    if (header.fen[0] != '\0') {
+        printf("[SetUp \"1\"]\n");
+        printf("[FEN \"%s\"]\n", header.fen);
+    }
+    printf("\n");
+
+    int column = 0;
+    for (uint32_t i = 0; i < header.move_count; i++) {
+        chess_record_move_t rec;
+        if (fread(&rec, sizeof(rec), 1, f) != 1) {
+            fprintf(stderr, "'%s' troncato alla semimossa %u\n", path, i);
+            fclose(f);
+            return 0;
+        }
+
+        char chunk[96];
+        size_t used = 0;
+        if (state.current_player == 1) {
+            used = (size_t)snprintf(chunk, sizeof(chunk), "%d. ",
+                                    state.fullmove_number);
+        } else if (i == 0) {
+            /* Partita che inizia con il Nero (FEN): numero con i puntini */
+            used = (size_t)snprintf(chunk, sizeof(chunk), "%d... ",
+                                    state.fullmove_number);
+        }
+
+        char san[16];
+        if (!move_to_san(&state, &rec, san, sizeof(san))) {
+            fprintf(stderr, "Mossa non legale in '%s' alla semimossa %u "
+                    "(file corrotto?)\n", path, i);
+            fclose(f);
+            return 0;
+        }
+
+        /* Commento con la telemetria della ricerca: punteggio in pedoni,
+           profondità, nodi e tempo */
+        used += (size_t)snprintf(chunk + used, sizeof(chunk) - used,
+                                 "%s {%+.2f/%u %lun %ums} ",
+                                 san, (double)rec.value / 100.0, rec.depth,
+                                 (unsigned long)rec.nodes, rec.elapsed_ms);
+
+        /* A capo attorno alle 80 colonne, da standard PGN */
+        if (column + (int)used > 80) {
+            printf("\n");
+            column = 0;
+        }
+        printf("%s", chunk);
+        column += (int)used;
+    }
+
+    printf("%s\n\n", result_string(header.result));
+    fclose(f);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s partita.crec [altra.crec ...]\n", argv[0]);
+        return 1;
+    }
+
+    trace_set_channel_level(&stdtrace, TRACE_LEVEL_ERROR);
+
+    int failures = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!export_file(argv[i])) {
+            failures++;
+        }
+    }
+    return (failures > 0) ? 1 : 0;
+}
@@ -1,15 +1,38 @@
 // chess_state.c
 #include "chess_state.h"
+#include "chess_hash.h"
+#include "chess_eval.h"
+#include "obj_mem.h"
 #include <string.h>
 #include <stdio.h>
 
+/*
+ * Free-list per-thread per i bitboard_state_t: la ricerca alloca e libera
+ * lo stesso blocco a dimensione fissa a ogni espansione di nodo, quindi i
+ * blocchi liberati vengono trattenuti e riciclati senza toccare il malloc
+ * globale (né i suoi lock, quando la ricerca è multi-thread). I blocchi
+ * sono malloc individuali, quindi allocare in un thread e liberare in un
+ * altro resta sicuro.
+ */
+#define STATE_FREELIST_MAX 256  /* stati trattenuti al massimo per thread */
+
+static __thread obj_mem_freelist_t state_freelist =
+    OBJ_MEM_FREELIST_INIT(sizeof(bitboard_state_t), STATE_FREELIST_MAX);
+
+/**
+ * @brief Alloca un bitboard_state_t non inizializzato dalla free-list per-thread.
+ */
+bitboard_state_t* chess_alloc_state(void) {
+    return (bitboard_state_t*)obj_mem_freelist_alloc(&state_freelist);
+}
+
 /**
  * @brief Crea una copia profonda dello stato del gioco.
  */
 void* chess_copy_state(const void *state) {
     if (!state) return NULL;
 
-    bitboard_state_t* new_state = (bitboard_state_t*)malloc(sizeof(bitboard_state_t));
+    bitboard_state_t* new_state = chess_alloc_state();
     if (!new_state) return NULL;
 
     memcpy(new_state, state, sizeof(bitboard_state_t));
@@ -21,7 +44,7 @@ void* chess_copy_state(const void *state) {
  */
 void chess_free_state(void *state) {
     if (state) {
-        free(state);
+        obj_mem_freelist_free(&state_freelist, state);
     }
 }
 
@@ -91,6 +114,31 @@ void initialize_board(bitboard_state_t *state) {
 
     // **Inizializza il giocatore corrente**
     state->current_player = 1; // 1 = Bianco, -1 = Nero
+
+    // Occupazioni aggregate coerenti con i bitboard appena impostati
+    chess_refresh_occupancy(state);
+
+    // Semina l'hash Zobrist incrementale (da qui in poi lo mantiene
+    // chess_make_move per XOR delle sole differenze)
+    chess_refresh_hash(state);
+
+    // Semina le somme incrementali della valutazione (stesso schema)
+    chess_refresh_eval(state);
+}
+
+/**
+ * @brief Ricalcola le occupazioni aggregate dai 12 bitboard dei pezzi.
+ */
+void chess_refresh_occupancy(bitboard_state_t *state) {
+    if (!state) return;
+
+    state->occupied_white = state->white_pawns   | state->white_knights |
+                            state->white_bishops | state->white_rooks   |
+                            state->white_queens  | state->white_kings;
+    state->occupied_black = state->black_pawns   | state->black_knights |
+                            state->black_bishops | state->black_rooks   |
+                            state->black_queens  | state->black_kings;
+    state->occupied_all   = state->occupied_white | state->occupied_black;
 }
 
 /**
@@ -45,6 +45,41 @@ typedef struct {
     uint8_t halfmove_clock;  /**< Contatore dei mezzi turni per la regola delle 50 mosse */
     uint8_t fullmove_number; /**< Numero del turno (inizia da 1) */
     int current_player;      /**< Giocatore corrente (1 = bianco, -1 = nero) */
+
+    /*
+     * Occupazioni aggregate, derivate dai 12 bitboard qui sopra e mantenute
+     * da chess_make_move: generatori di mosse e test di attacco le leggono
+     * direttamente invece di rifare l'OR dei sei bitboard per colore a ogni
+     * chiamata. Chi costruisce uno stato a mano (test, parser di posizioni)
+     * deve chiudere il setup con chess_refresh_occupancy().
+     */
+    uint64_t occupied_white; /**< OR dei sei bitboard bianchi */
+    uint64_t occupied_black; /**< OR dei sei bitboard neri */
+    uint64_t occupied_all;   /**< occupied_white | occupied_black */
+
+    /*
+     * Hash Zobrist della posizione, mantenuto in modo incrementale da
+     * chess_make_move (XOR delle sole differenze rispetto allo snapshot di
+     * undo): chess_hash_state diventa una lettura di campo invece di una
+     * scansione completa dei 12 bitboard. Il valore 0 significa "non
+     * seminato" (stati costruiti a mano o azzerati): in quel caso l'hash
+     * viene ricalcolato da zero al bisogno. initialize_board lo semina;
+     * chi costruisce uno stato a mano può chiudere il setup con
+     * chess_refresh_hash() (chess_hash.h) se lo stato verrà hashato.
+     */
+    uint64_t hash;           /**< hash Zobrist incrementale (0 = non seminato) */
+
+    /*
+     * Somme incrementali della valutazione (materiale + piece-square table
+     * nelle due fasi, più la fase stessa), mantenute da chess_make_move con
+     * lo stesso schema dell'hash: differenza rispetto allo snapshot di
+     * undo. `eval_ok` a 0 significa "mai seminato" (stati costruiti a
+     * mano): la valutazione ricalcola da zero. Vedi chess_eval.h.
+     */
+    int32_t eval_mg;         /**< somma materiale+PST di mediogioco (B - N) */
+    int32_t eval_eg;         /**< somma materiale+PST di finale (B - N) */
+    int32_t eval_phase;      /**< fase della partita (24 iniziale, 0 finale) */
+    int32_t eval_ok;         /**< 1 se le somme sono seminate e mantenute */
 } bitboard_state_t;
 
 
@@ -63,6 +98,18 @@ typedef struct {
  */
 #define NOT_GH_FILE 0x3f3f3f3f3f3f3f3fULL
 
+/**
+ * @brief Alloca un bitboard_state_t non inizializzato dalla free-list per-thread.
+ *
+ * Gli stati liberati con \ref chess_free_state vengono riciclati da una cache
+ * per-thread (obj_mem_freelist_t, vedi obj_mem.h) invece di tornare
+ * all'allocatore globale: la coppia alloc/free per stato, che scatta a ogni
+ * espansione di nodo, diventa un pop/push su una lista.
+ *
+ * @return Puntatore a un nuovo stato (contenuto indefinito), oppure NULL in caso di errore.
+ */
+bitboard_state_t* chess_alloc_state(void);
+
 /**
  * @brief Crea una copia profonda dello stato del gioco.
  *
@@ -85,6 +132,18 @@ void chess_free_state(void *state);
  */
 void initialize_board(bitboard_state_t *state);
 
+/**
+ * @brief Ricalcola le occupazioni aggregate dai 12 bitboard dei pezzi.
+ *
+ * Ripristina l'invariante `occupied_white`/`occupied_black`/`occupied_all`.
+ * Va chiamata al termine di qualunque costruzione "a mano" dello stato
+ * (posizioni di test, parser); il flusso normale di gioco non ne ha bisogno
+ * perché `chess_make_move` mantiene le occupazioni aggiornate.
+ *
+ * @param[in,out] state Puntatore allo stato del gioco da sistemare.
+ */
+void chess_refresh_occupancy(bitboard_state_t *state);
+
 /**
  * @brief Stampa lo stato della scacchiera in formato testuale (opzionale, per debug).
  *
@@ -0,0 +1,635 @@
+/**
+ * ##VERSION## "chess_tournament.c 1.1"
+*/
+
+/******************************************************************************
+ * File: chess_tournament.c
+ *
+ * Driver di torneo self-play per i run A/B sulle modifiche alla ricerca:
+ * programma N partite motore-contro-motore in parallelo su tutti i core,
+ * con le due configurazioni (A e B) che si alternano Bianco e Nero su un
+ * insieme di aperture, e riassume il risultato con intervallo di confidenza
+ * al 95%, differenza Elo stimata e NPS aggregato per configurazione. Una
+ * suite completa gira in una notte senza interventi manuali, al posto delle
+ * partite singole cronometrate con test_chess_c_vs_c.
+ *
+ * Uso:
+ *   make build TARGET=chess_tournament
+ *   ./chess_tournament [games=N] [jobs=N] [depthA=N] [depthB=N]
+ *                      [tweakA=tok,tok] [tweakB=tok,tok]
+ *                      [openings=FILE] [maxplies=N]
+ *
+ *   games=N      numero di partite (default: 2 per apertura, una per colore)
+ *   jobs=N       partite concorrenti (default: numero di core)
+ *   depthA/B=N   profondità di ricerca delle due configurazioni (default: 5)
+ *   tweakA/B=..  scostamenti dalla configurazione di potatura di default,
+ *                separati da virgola: null/nonull, lmr/nolmr,
+ *                futility/nofutility, staged/nostaged
+ *   openings=F   file di aperture, una FEN per riga ('#' commenta la riga;
+ *                senza file si usa il corpus incorporato di 8 aperture)
+ *   maxplies=N   semimosse massime per partita, poi patta (default: 300)
+ *   record=DIR   registra ogni partita in DIR/partita_NNN.crec (formato
+ *                binario zero-copy di chess_record: mosse e statistiche di
+ *                ricerca senza formattazione sul processo di gioco; la
+ *                conversione in PGN è compito offline di chess_record_pgn)
+ *
+ * Ogni partita gira in un PROCESSO figlio dedicato (fork): transposition
+ * table e configurazione di potatura sono globali di processo
+ * (minimax_set_ttable / minimax_set_search_config), quindi solo un processo
+ * per partita dà a ogni partita — e a ogni lato dentro la partita — le sue
+ * cache, senza toccare il motore. Il figlio riporta il risultato al padre
+ * con una riga su una pipe.
+ *
+ * A parità di configurazione il motore è deterministico: la stessa apertura
+ * con gli stessi colori produce sempre la stessa partita. Per questo il
+ * numero di partite è limitato a 2 × aperture (ripeterle non aggiunge
+ * informazione): per run più lunghi serve un file di aperture più ricco.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "chess_state.h"
+#include "chess_moves.h"
+#include "chess_fen.h"
+#include "chess_hash.h"
+#include "chess_game_dynamics.h"
+#include "chess_game_descriptor.h"
+#include "minimax.h"
+#include "minimax_tt.h"
+#include "chess_record.h"
+#include "obj_trace.h"
+
+/* Transposition table per LATO di ogni partita: con due tavole per figlio e
+ * un figlio per core la memoria totale è 2 * jobs * TOURN_TT_MB MiB */
+#define TOURN_TT_MB 32
+
+/* Limite superiore alle aperture lette da file */
+#define MAX_OPENINGS 512
+
+typedef struct {
+    const char *name; /* etichetta per il report */
+    const char *fen;  /* NULL = posizione iniziale */
+} opening_t;
+
+/* --------------------------------------------------------------------------
+ * CORPUS DI APERTURE INCORPORATO
+ *
+ * Otto posizioni dopo le primissime mosse delle aperture principali: abbastanza
+ * varie da non far convergere tutte le partite sulla stessa struttura, e tutte
+ * posizioni equilibrate (il punteggio atteso di una configurazione contro sé
+ * stessa è 0.5).
+ * -------------------------------------------------------------------------- */
+static const opening_t builtin_openings[] = {
+    { "startpos",   NULL },
+    { "italiana",   "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq -" },
+    { "siciliana",  "rnbqkbnr/pp1ppppp/8/2p5/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq -" },
+    { "francese",   "rnbqkbnr/ppp2ppp/4p3/3p4/3PP3/8/PPP2PPP/RNBQKBNR w KQkq -" },
+    { "caro_kann",  "rnbqkbnr/pp2pppp/2p5/3p4/3PP3/8/PPP2PPP/RNBQKBNR w KQkq -" },
+    { "gambetto_d", "rnbqkbnr/ppp1pppp/8/3p4/2PP4/8/PP2PPPP/RNBQKBNR b KQkq -" },
+    { "est_indiana","rnbqkb1r/pppppp1p/5np1/8/2PP4/8/PP2PPPP/RNBQKBNR w KQkq -" },
+    { "inglese",    "rnbqkbnr/pppp1ppp/8/4p3/2P5/8/PP1PPPPP/RNBQKBNR w KQkq -" },
+};
+
+#define BUILTIN_OPENINGS ((int)(sizeof(builtin_openings) / sizeof(builtin_openings[0])))
+
+/* Esito di una partita, così come il figlio lo riporta sulla pipe */
+typedef struct {
+    char          result;   /* 'A' vince A, 'B' vince B, 'D' patta, '?' errore */
+    char          term;     /* 'm' matto, 's' stallo, 'r' ripetizione,
+                               'f' 50 mosse, 'l' limite semimosse, 'e' errore */
+    int           plies;    /* semimosse giocate */
+    unsigned long nodes_a;  /* nodi (minimax + quiescenza) spesi da A */
+    unsigned long nodes_b;
+    long          ms_a;     /* tempo di ricerca speso da A, in ms */
+    long          ms_b;
+} game_record_t;
+
+/* Configurazioni dei due lati: impostate dal padre leggendo argv, ereditate
+ * dai figli attraverso il fork */
+static int             s_depth_a = 5;
+static int             s_depth_b = 5;
+static search_config_t s_config_a;
+static search_config_t s_config_b;
+static int             s_max_plies = 300;
+static const char     *s_record_dir = NULL;
+
+static long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/* --------------------------------------------------------------------------
+ * LATO FIGLIO: una partita completa
+ * -------------------------------------------------------------------------- */
+
+/* Profondità e punteggio dell'ultima iterazione completata, catturati dalla
+ * callback di progresso per finire nel record binario della mossa */
+static int s_last_depth = 0;
+static int s_last_value = 0;
+
+static void record_progress(const search_progress_t *progress, void *user_data) {
+    (void) user_data;
+    s_last_depth = progress->depth;
+    s_last_value = progress->value;
+}
+
+/*
+ * Gioca una partita dall'apertura data, con A che ha il Bianco se
+ * a_is_white è vero, e riempie il record d'esito. Se crec non è NULL ogni
+ * mossa viene registrata lì con le statistiche della sua ricerca.
+ * Nessun valore di ritorno: gli errori (FEN illeggibile, allocazioni
+ * fallite) finiscono nel record come result='?' e il padre li conteggia
+ * a parte.
+ */
+static void play_game(const game_descriptor_t *gd, const opening_t *op,
+                      int a_is_white, game_record_t *rec,
+                      chess_record_t *crec) {
+    rec->result = '?';
+    rec->term = 'e';
+    rec->plies = 0;
+    rec->nodes_a = rec->nodes_b = 0;
+    rec->ms_a = rec->ms_b = 0;
+
+    bitboard_state_t *state = (bitboard_state_t*) malloc(sizeof(bitboard_state_t));
+    if (!state) {
+        return;
+    }
+    if (op->fen == NULL) {
+        initialize_board(state);
+    } else if (!chess_fen_parse(op->fen, state)) {
+        free(state);
+        return;
+    }
+
+    /* Una tavola per lato: le cache delle due configurazioni non si
+       contaminano, come in un match tra motori separati */
+    minimax_tt_t *tt_a = minimax_tt_create(TOURN_TT_MB);
+    minimax_tt_t *tt_b = minimax_tt_create(TOURN_TT_MB);
+    if (!tt_a || !tt_b) {
+        if (tt_a) minimax_tt_destroy(tt_a);
+        if (tt_b) minimax_tt_destroy(tt_b);
+        chess_free_state(state);
+        return;
+    }
+
+    chess_repetition_reset();
+    chess_repetition_push(chess_hash_state(state));
+
+    if (crec) {
+        minimax_set_progress_callback(record_progress, NULL);
+    }
+
+    /* Patta salvo esito: i break sotto la cambiano dove serve */
+    rec->result = 'D';
+    rec->term = 'l';
+
+    while (rec->plies < s_max_plies) {
+        if (chess_is_terminal(state)) {
+            if (is_king_in_check(state, state->current_player)) {
+                /* Il giocatore di turno è matto: vince l'altro lato */
+                int white_mated = (state->current_player == 1);
+                rec->result = (white_mated == a_is_white) ? 'B' : 'A';
+                rec->term = 'm';
+            } else {
+                rec->result = 'D';
+                rec->term = 's';
+            }
+            break;
+        }
+        if (chess_is_repetition_draw(state)) {
+            rec->result = 'D';
+            rec->term = 'r';
+            break;
+        }
+        if (state->halfmove_clock >= 100) {
+            rec->result = 'D';
+            rec->term = 'f';
+            break;
+        }
+
+        int white_to_move = (state->current_player == 1);
+        int side_is_a = (white_to_move == a_is_white);
+
+        minimax_set_ttable(side_is_a ? tt_a : tt_b);
+        minimax_set_search_config(side_is_a ? &s_config_a : &s_config_b);
+
+        s_last_depth = 0;
+        s_last_value = 0;
+        void *move = get_best_move_id(gd, state,
+                                      side_is_a ? s_depth_a : s_depth_b, NULL);
+        search_stats_t stats = minimax_get_search_stats();
+        if (!move) {
+            rec->result = '?';
+            rec->term = 'e';
+            break;
+        }
+        if (crec) {
+            chess_record_move(crec, (const chess_move_t*) move, &stats,
+                              s_last_depth, s_last_value);
+        }
+        if (side_is_a) {
+            rec->nodes_a += stats.nodes + stats.qnodes;
+            rec->ms_a += stats.elapsed_ms;
+        } else {
+            rec->nodes_b += stats.nodes + stats.qnodes;
+            rec->ms_b += stats.elapsed_ms;
+        }
+
+        void *next = chess_apply_move(state, move);
+        gd->free_move(move);
+        if (!next) {
+            rec->result = '?';
+            rec->term = 'e';
+            break;
+        }
+        chess_free_state(state);
+        state = (bitboard_state_t*) next;
+        rec->plies++;
+    }
+
+    minimax_set_progress_callback(NULL, NULL);
+    minimax_set_ttable(NULL);
+    minimax_tt_destroy(tt_a);
+    minimax_tt_destroy(tt_b);
+    chess_free_state(state);
+}
+
+/* Esito del record di torneo -> esito dell'header di chess_record */
+static char record_result(const game_record_t *rec, int a_is_white) {
+    switch (rec->result) {
+        case 'A': return a_is_white ? CHESS_RECORD_WHITE_WINS
+                                    : CHESS_RECORD_BLACK_WINS;
+        case 'B': return a_is_white ? CHESS_RECORD_BLACK_WINS
+                                    : CHESS_RECORD_WHITE_WINS;
+        case 'D': return CHESS_RECORD_DRAW;
+        default:  return CHESS_RECORD_UNFINISHED;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * LATO PADRE: parsing, scheduling, aggregazione
+ * -------------------------------------------------------------------------- */
+
+/*
+ * Applica a *config gli scostamenti della lista "tok,tok,..." (vedi l'uso in
+ * testa al file). Ritorna 0 su token sconosciuto.
+ */
+static int apply_tweaks(search_config_t *config, const char *list) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char *tok = strtok(buf, ","); tok != NULL; tok = strtok(NULL, ",")) {
+        if      (strcmp(tok, "null") == 0)       config->use_null_move = 1;
+        else if (strcmp(tok, "nonull") == 0)     config->use_null_move = 0;
+        else if (strcmp(tok, "lmr") == 0)        config->use_lmr = 1;
+        else if (strcmp(tok, "nolmr") == 0)      config->use_lmr = 0;
+        else if (strcmp(tok, "futility") == 0)   config->use_futility = 1;
+        else if (strcmp(tok, "nofutility") == 0) config->use_futility = 0;
+        else if (strcmp(tok, "staged") == 0)     config->use_staged_gen = 1;
+        else if (strcmp(tok, "nostaged") == 0)   config->use_staged_gen = 0;
+        else {
+            printf("Scostamento sconosciuto: '%s'\n", tok);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Carica le aperture da un file (una FEN per riga, '#' commenta). Le FEN
+ * vengono validate subito: meglio un errore qui che 2 partite perse nel run.
+ * Ritorna il numero di aperture caricate, 0 su errore.
+ */
+static int load_openings(const char *path, opening_t *out, int max) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        printf("Impossibile aprire il file di aperture '%s'\n", path);
+        return 0;
+    }
+
+    char line[256];
+    int count = 0;
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f) && count < max) {
+        lineno++;
+        line[strcspn(line, "\r\n")] = '\0';
+        char *s = line;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '\0' || *s == '#') {
+            continue;
+        }
+        bitboard_state_t probe;
+        if (!chess_fen_parse(s, &probe)) {
+            printf("FEN non interpretabile a riga %d di '%s'\n", lineno, path);
+            fclose(f);
+            return 0;
+        }
+        char *name = (char*) malloc(32);
+        char *fen = (char*) malloc(strlen(s) + 1);
+        if (!name || !fen) {
+            free(name);
+            free(fen);
+            fclose(f);
+            return 0;
+        }
+        snprintf(name, 32, "riga_%d", lineno);
+        strcpy(fen, s);
+        out[count].name = name;
+        out[count].fen = fen;
+        count++;
+    }
+    fclose(f);
+
+    if (count == 0) {
+        printf("Nessuna apertura in '%s'\n", path);
+    }
+    return count;
+}
+
+/* Differenza Elo dal punteggio atteso, con i punteggi estremi saturati
+ * (con 0 o 1 esatti la formula diverge) */
+static double elo_from_score(double p) {
+    if (p < 0.001) p = 0.001;
+    if (p > 0.999) p = 0.999;
+    return 400.0 * log10(p / (1.0 - p));
+}
+
+static const char* term_description(char term) {
+    switch (term) {
+        case 'm': return "matto";
+        case 's': return "stallo";
+        case 'r': return "ripetizione";
+        case 'f': return "50 mosse";
+        case 'l': return "limite semimosse";
+        default:  return "errore";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int games = 0;            /* 0 = default: 2 per apertura */
+    int jobs = 0;             /* 0 = default: numero di core */
+    const char *openings_path = NULL;
+
+    s_config_a = minimax_get_search_config();
+    s_config_b = s_config_a;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "games=", 6) == 0) {
+            games = atoi(argv[i] + 6);
+        } else if (strncmp(argv[i], "jobs=", 5) == 0) {
+            jobs = atoi(argv[i] + 5);
+        } else if (strncmp(argv[i], "depthA=", 7) == 0) {
+            s_depth_a = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "depthB=", 7) == 0) {
+            s_depth_b = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "tweakA=", 7) == 0) {
+            if (!apply_tweaks(&s_config_a, argv[i] + 7)) return 1;
+        } else if (strncmp(argv[i], "tweakB=", 7) == 0) {
+            if (!apply_tweaks(&s_config_b, argv[i] + 7)) return 1;
+        } else if (strncmp(argv[i], "openings=", 9) == 0) {
+            openings_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "maxplies=", 9) == 0) {
+            s_max_plies = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "record=", 7) == 0) {
+            s_record_dir = argv[i] + 7;
+        } else {
+            printf("Uso: %s [games=N] [jobs=N] [depthA=N] [depthB=N]\n"
+                   "        [tweakA=tok,tok] [tweakB=tok,tok] [openings=FILE]\n"
+                   "        [maxplies=N] [record=DIR]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (s_depth_a < 1 || s_depth_b < 1 || s_max_plies < 2) {
+        printf("Parametri non validi (depth >= 1, maxplies >= 2)\n");
+        return 1;
+    }
+    if (s_record_dir && mkdir(s_record_dir, 0755) != 0 && errno != EEXIST) {
+        printf("Impossibile creare la directory di registrazione '%s'\n",
+               s_record_dir);
+        return 1;
+    }
+
+    /* Aperture: file dell'utente o corpus incorporato */
+    static opening_t file_openings[MAX_OPENINGS];
+    const opening_t *openings = builtin_openings;
+    int n_openings = BUILTIN_OPENINGS;
+    if (openings_path) {
+        n_openings = load_openings(openings_path, file_openings, MAX_OPENINGS);
+        if (n_openings == 0) {
+            return 1;
+        }
+        openings = file_openings;
+    }
+
+    /* Il motore è deterministico a parità di configurazione: oltre le
+       2 partite per apertura (una per colore) si rigiocherebbe l'identico */
+    int total = 2 * n_openings;
+    if (games > 0 && games < total) {
+        total = games;
+    } else if (games > total) {
+        printf("games=%d ridotto a %d: con %d aperture le partite in più "
+               "sarebbero copie identiche\n", games, total, n_openings);
+    }
+
+    if (jobs <= 0) {
+        jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (jobs < 1) jobs = 1;
+    if (jobs > total) jobs = total;
+
+    /* Il torneo misura la ricerca: niente trace di debug nel ciclo caldo
+       (il livello è ereditato dai figli attraverso il fork) */
+    trace_set_channel_level(&stdtrace, TRACE_LEVEL_ERROR);
+
+    game_descriptor_t *gd = initialize_chess_game_descriptor();
+    if (gd == NULL) {
+        printf("Inizializzazione del descrittore fallita\n");
+        return 1;
+    }
+
+    int pipe_fd[2];
+    if (pipe(pipe_fd) != 0) {
+        perror("pipe");
+        free(gd);
+        return 1;
+    }
+    FILE *results_in = fdopen(pipe_fd[0], "r");
+    if (!results_in) {
+        perror("fdopen");
+        free(gd);
+        return 1;
+    }
+
+    printf("=== chess_tournament: %d partite su %d aperture, %d in parallelo ===\n",
+           total, n_openings, jobs);
+    printf("A: depth=%d  null=%d lmr=%d futility=%d staged=%d\n",
+           s_depth_a, s_config_a.use_null_move, s_config_a.use_lmr,
+           s_config_a.use_futility, s_config_a.use_staged_gen);
+    printf("B: depth=%d  null=%d lmr=%d futility=%d staged=%d\n\n",
+           s_depth_b, s_config_b.use_null_move, s_config_b.use_lmr,
+           s_config_b.use_futility, s_config_b.use_staged_gen);
+
+    long t_start = monotonic_ms();
+
+    /* Scheduling: al più 'jobs' figli vivi; la partita g gioca l'apertura
+       g/2, con A Bianco nelle partite pari e Nero nelle dispari */
+    int launched = 0;
+    int finished = 0;
+    int active = 0;
+    int wins_a = 0, draws = 0, wins_b = 0, errors = 0;
+    unsigned long nodes_a = 0, nodes_b = 0;
+    long ms_a = 0, ms_b = 0;
+    double sum_points = 0.0, sum_points_sq = 0.0;
+
+    while (finished < total) {
+        while (active < jobs && launched < total) {
+            int g = launched++;
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                launched--;
+                break; /* si riprova quando un figlio termina */
+            }
+            if (pid == 0) {
+                /* FIGLIO: una partita, una riga di esito, fine */
+                close(pipe_fd[0]);
+                int a_white = ((g % 2) == 0);
+                chess_record_t *crec = NULL;
+                if (s_record_dir) {
+                    char path[512];
+                    snprintf(path, sizeof(path), "%s/partita_%03d.crec",
+                             s_record_dir, g);
+                    crec = chess_record_create(path,
+                                               a_white ? "A" : "B",
+                                               a_white ? "B" : "A",
+                                               openings[g / 2].fen);
+                }
+                game_record_t rec;
+                play_game(gd, &openings[g / 2], a_white, &rec, crec);
+                if (crec) {
+                    chess_record_close(crec, record_result(&rec, a_white));
+                }
+                char line[160];
+                int len = snprintf(line, sizeof(line),
+                                   "%d %c %c %d %lu %ld %lu %ld\n",
+                                   g, rec.result, rec.term, rec.plies,
+                                   rec.nodes_a, rec.ms_a, rec.nodes_b, rec.ms_b);
+                if (write(pipe_fd[1], line, (size_t)len) != len) {
+                    _exit(1);
+                }
+                _exit(0);
+            }
+            active++;
+        }
+
+        if (active == 0) {
+            printf("Nessun figlio avviabile, interrompo\n");
+            break;
+        }
+
+        /* Un figlio termina => la sua riga è già nella pipe */
+        int status = 0;
+        if (waitpid(-1, &status, 0) < 0) {
+            perror("waitpid");
+            break;
+        }
+        active--;
+
+        char line[160];
+        if (!fgets(line, sizeof(line), results_in)) {
+            printf("Esito mancante da un figlio, interrompo\n");
+            break;
+        }
+        game_record_t rec;
+        int g = -1;
+        if (sscanf(line, "%d %c %c %d %lu %ld %lu %ld",
+                   &g, &rec.result, &rec.term, &rec.plies,
+                   &rec.nodes_a, &rec.ms_a, &rec.nodes_b, &rec.ms_b) != 8) {
+            printf("Esito non interpretabile: %s", line);
+            break;
+        }
+        finished++;
+
+        const char *verdict = (rec.result == 'A') ? "vince A"
+                            : (rec.result == 'B') ? "vince B"
+                            : (rec.result == 'D') ? "patta  " : "ERRORE ";
+        printf("[%3d/%d] %-12s A=%-6s %s  %3d semimosse (%s)\n",
+               finished, total, openings[g / 2].name,
+               (g % 2 == 0) ? "Bianco" : "Nero",
+               verdict, rec.plies, term_description(rec.term));
+
+        if (rec.result == '?') {
+            errors++;
+            continue;
+        }
+        double points = (rec.result == 'A') ? 1.0
+                      : (rec.result == 'D') ? 0.5 : 0.0;
+        if (rec.result == 'A') wins_a++;
+        else if (rec.result == 'B') wins_b++;
+        else draws++;
+        sum_points += points;
+        sum_points_sq += points * points;
+        nodes_a += rec.nodes_a;
+        nodes_b += rec.nodes_b;
+        ms_a += rec.ms_a;
+        ms_b += rec.ms_b;
+    }
+    close(pipe_fd[1]);
+    fclose(results_in);
+
+    long elapsed = monotonic_ms() - t_start;
+    int valid = wins_a + draws + wins_b;
+    if (valid == 0) {
+        printf("\nNessuna partita valida (%d errori)\n", errors);
+        free(gd);
+        return 1;
+    }
+
+    /* Punteggio di A con intervallo di confidenza al 95% (approssimazione
+       normale sulla varianza campionaria dei punti per partita) */
+    double p = sum_points / (double)valid;
+    double half = 0.0;
+    if (valid > 1) {
+        double var = (sum_points_sq - (double)valid * p * p) / (double)(valid - 1);
+        if (var < 0.0) var = 0.0;
+        half = 1.96 * sqrt(var / (double)valid);
+    }
+    double p_lo = (p - half < 0.0) ? 0.0 : p - half;
+    double p_hi = (p + half > 1.0) ? 1.0 : p + half;
+
+    double nps_a = (ms_a > 0) ? (double)nodes_a * 1000.0 / (double)ms_a : 0.0;
+    double nps_b = (ms_b > 0) ? (double)nodes_b * 1000.0 / (double)ms_b : 0.0;
+
+    printf("\n=== Risultato: A +%d =%d -%d su %d partite", wins_a, draws, wins_b, valid);
+    if (errors > 0) {
+        printf(" (%d errori)", errors);
+    }
+    printf(" in %ld s ===\n", elapsed / 1000);
+    printf("punteggio A = %.3f  IC95%% [%.3f, %.3f]  diff. Elo = %+.0f [%+.0f, %+.0f]\n",
+           p, p_lo, p_hi,
+           elo_from_score(p), elo_from_score(p_lo), elo_from_score(p_hi));
+    printf("NPS aggregato: A %.0f nodi/s (%lu nodi, %ld ms)  B %.0f nodi/s (%lu nodi, %ld ms)\n\n",
+           nps_a, nodes_a, ms_a, nps_b, nodes_b, ms_b);
+
+    /* Record macchina, nello stile di chess_bench: una riga per
+       configurazione, confrontabile tra run con un diff */
+    printf("config,depth,partite,vittorie,patte,sconfitte,punti,ci_lo,ci_hi,nodi,ms,nps\n");
+    printf("A,%d,%d,%d,%d,%d,%.3f,%.3f,%.3f,%lu,%ld,%.0f\n",
+           s_depth_a, valid, wins_a, draws, wins_b, p, p_lo, p_hi,
+           nodes_a, ms_a, nps_a);
+    printf("B,%d,%d,%d,%d,%d,%.3f,%.3f,%.3f,%lu,%ld,%.0f\n",
+           s_depth_b, valid, wins_b, draws, wins_a, 1.0 - p, 1.0 - p_hi, 1.0 - p_lo,
+           nodes_b, ms_b, nps_b);
+
+    free(gd);
+    return 0;
+}
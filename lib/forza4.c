@@ -2,11 +2,21 @@
  * @file forza4.c
  * @brief Gioco Forza 4 (Connect Four) con MiniMax e cache.
  *
- * ##VERSION## "forza4.c 1.1"
+ * ##VERSION## "forza4.c 1.2"
  *
  * Umano = 'X' (player=1), Computer = 'O' (player=-1).
  * Board di 6 righe × 7 colonne.
  * Algoritmo MiniMax con alpha-beta pruning e transposition table (cache).
+ *
+ * Rappresentazione bitboard standard del Connect Four: un uint64_t per
+ * giocatore, colonne da 7 bit (6 righe + una riga sentinella che separa le
+ * colonne), bit 0 = angolo in basso a sinistra. La sentinella fa sì che
+ * nessuna finestra di quattro possa scavalcare il bordo tra due colonne,
+ * quindi vittorie e pattern si riconoscono con pochi shift e AND, senza
+ * cicli sulla griglia; copia e confronto dello stato sono tre parole.
+ * Forza 4 è il gioco di carico della ricerca (alberi profondi, stati
+ * piccoli): con i bitboard il costo per nodo torna a essere dominato dal
+ * livello di ricerca, non dal gioco.
  */
 
 #include <stdio.h>
@@ -25,25 +35,31 @@
 #define C4_COLS 7
 #define C4_SIZE (C4_ROWS * C4_COLS)
 
+/* Colonna c, riga r (0 = fondo): bit c*7 + r */
+#define C4_BIT(c, r) (1ULL << ((c) * 7 + (r)))
+
+/* Maschera delle 42 caselle valide (righe 0-5 di ogni colonna) */
+#define C4_BOARD_MASK 0xFDFBF7EFDFBFULL
+
 typedef struct {
-    int board[C4_SIZE];
+    uint64_t bits[2];  /* bits[0] = X (player 1), bits[1] = O (player -1) */
     int next_player;   /* 1=umano(X), -1=computer(O) */
 } C4_State;
 
 typedef int C4_Move;
 
-#define AT(st, r, c)  ((st)->board[(r)*C4_COLS + (c)])
+/* Indice nel vettore bits[] del giocatore p (1 -> 0, -1 -> 1) */
+#define C4_SIDE(p) ((p) == 1 ? 0 : 1)
 
-/* Funzione di hashing per la cache (FNV-1a) */
+/* Funzione di hashing per la cache (mix alla splitmix64 delle tre parole) */
 static uint64_t c4_hash_state(const void *state) {
     const C4_State *st = (const C4_State*) state;
-    uint64_t h = 14695981039346656037ULL; // FNV offset basis
-    for (int i = 0; i < C4_SIZE; i++) {
-        h ^= (st->board[i] + 2);
-        h *= 1099511628211ULL; // FNV prime
-    }
-    h ^= (st->next_player & 0x0F);
-    h *= 1099511628211ULL;
+    uint64_t h = st->bits[0];
+    h ^= st->bits[1] + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    h ^= (uint64_t)(st->next_player & 0x0F) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27; h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
     return h;
 }
 
@@ -51,41 +67,85 @@ static uint64_t c4_hash_state(const void *state) {
 static int c4_equals_state(const void *stateA, const void *stateB) {
     const C4_State *a = (const C4_State*) stateA;
     const C4_State *b = (const C4_State*) stateB;
-    for (int i = 0; i < C4_SIZE; i++) {
-        if (a->board[i] != b->board[i]) return 0;
-    }
-    return (a->next_player == b->next_player);
+    return a->bits[0] == b->bits[0] &&
+           a->bits[1] == b->bits[1] &&
+           a->next_player == b->next_player;
 }
 
-/* Funzione ausiliaria per valutare una finestra di quattro celle */
-static int evaluate_window(int a, int b, int c, int d) {
-    int window[4] = {a, b, c, d};
-    int count_X = 0, count_O = 0;
-    for (int i = 0; i < 4; i++) {
-        if (window[i] == 1) count_X++;
-        else if (window[i] == -1) count_O++;
-    }
+/* Altezza di una colonna: le pedine riempiono la colonna dal basso senza
+   buchi, quindi il popcount dei suoi 6 bit è la prima riga libera */
+static int c4_col_height(const C4_State *st, int c) {
+    uint64_t col = ((st->bits[0] | st->bits[1]) >> (c * 7)) & 0x3FULL;
+    return __builtin_popcountll(col);
+}
+
+/* Verifica se una colonna è piena */
+static int is_col_full(const C4_State *st, int c) {
+    return c4_col_height(st, c) >= C4_ROWS;
+}
+
+/*
+ * Quattro in fila per il bitboard \p bb: per ogni direzione si comprime la
+ * finestra con due AND (coppie adiacenti, poi coppie di coppie). Gli shift
+ * sono 1 = verticale, 7 = orizzontale, 6 e 8 = diagonali; la riga
+ * sentinella garantisce che nessuna finestra attraversi il bordo.
+ */
+static int c4_has_four(uint64_t bb) {
+    uint64_t m;
+    m = bb & (bb >> 1);  if (m & (m >> 2))  return 1;  /* verticale    */
+    m = bb & (bb >> 7);  if (m & (m >> 14)) return 1;  /* orizzontale  */
+    m = bb & (bb >> 6);  if (m & (m >> 12)) return 1;  /* diagonale \  */
+    m = bb & (bb >> 8);  if (m & (m >> 16)) return 1;  /* diagonale /  */
+    return 0;
+}
+
+/* Controlla se c'è un vincitore */
+static int check_winner(const C4_State *st) {
+    if (c4_has_four(st->bits[0])) return 1;
+    if (c4_has_four(st->bits[1])) return -1;
+    return 0;
+}
+
+/*
+ * Punteggio delle finestre aperte di un giocatore: per ogni direzione e per
+ * ogni ripartizione della finestra di quattro celle (quali piene, quali
+ * vuote), un AND di quattro bitboard shiftati marca le ancore delle
+ * finestre che la realizzano e un popcount le conta. Pesi come nella
+ * versione a griglia: 3 pedine + 1 vuota = 5, 2 pedine + 2 vuote = 2.
+ */
+static int c4_open_windows(uint64_t p, uint64_t empty) {
+    static const int shifts[4] = { 1, 7, 6, 8 };
     int score = 0;
-    if (count_X == 4) score += 100;
-    else if (count_X == 3 && count_O == 0) score += 5;
-    else if (count_X == 2 && count_O == 0) score += 2;
-    
-    if (count_O == 4) score -= 100;
-    else if (count_O == 3 && count_X == 0) score -= 5;
-    else if (count_O == 2 && count_X == 0) score -= 2;
-    
+
+    for (int d = 0; d < 4; d++) {
+        int s = shifts[d];
+        /* subset: bit j a 1 = cella j-esima della finestra piena */
+        for (int subset = 0; subset < 16; subset++) {
+            int filled = __builtin_popcountll((unsigned long long)subset);
+            int weight = (filled == 3) ? 5 : (filled == 2) ? 2 : 0;
+            if (weight == 0) {
+                continue;
+            }
+            uint64_t w = ~0ULL;
+            for (int j = 0; j < 4; j++) {
+                uint64_t cell = (subset >> j & 1) ? p : empty;
+                w &= cell >> (j * s);
+            }
+            score += weight * __builtin_popcountll(w);
+        }
+    }
     return score;
 }
 
 /* Stampa la board */
 static void print_board(const C4_State *st) {
     printf("\n");
-    for (int r = 0; r < C4_ROWS; r++) {
+    for (int r = C4_ROWS - 1; r >= 0; r--) {
         printf("|");
         for (int c = 0; c < C4_COLS; c++) {
             char ch = ' ';
-            if (AT(st, r, c) == 1) ch = 'X';
-            else if (AT(st, r, c) == -1) ch = 'O';
+            if (st->bits[0] & C4_BIT(c, r)) ch = 'X';
+            else if (st->bits[1] & C4_BIT(c, r)) ch = 'O';
             printf("%c|", ch);
         }
         printf("\n");
@@ -93,70 +153,23 @@ static void print_board(const C4_State *st) {
     printf(" 0 1 2 3 4 5 6  (colonne)\n\n");
 }
 
-/* Verifica se una colonna è piena */
-static int is_col_full(const C4_State *st, int c) {
-    return (AT(st, 0, c) != 0);
-}
-
-/* Trova la riga libera più bassa in una colonna */
-static int find_free_row(const C4_State *st, int c) {
-    for (int r = C4_ROWS-1; r >= 0; r--) {
-        if (AT(st, r, c) == 0) return r;
-    }
-    return -1;
-}
-
-/* Controlla se c'è un vincitore */
-static int check_winner(const C4_State *st) {
-    // Orizzontale
-    for (int r=0; r<C4_ROWS; r++) {
-        for (int c=0; c<C4_COLS-3; c++) {
-            int sum = AT(st,r,c) + AT(st,r,c+1) + AT(st,r,c+2) + AT(st,r,c+3);
-            if (sum == 4) return 1;
-            if (sum == -4) return -1;
-        }
-    }
-    // Verticale
-    for (int r=0; r<C4_ROWS-3; r++) {
-        for (int c=0; c<C4_COLS; c++) {
-            int sum = AT(st,r,c) + AT(st,r+1,c) + AT(st,r+2,c) + AT(st,r+3,c);
-            if (sum == 4) return 1;
-            if (sum == -4) return -1;
-        }
-    }
-    // Diagonale discendente
-    for (int r=0; r<C4_ROWS-3; r++) {
-        for (int c=0; c<C4_COLS-3; c++) {
-            int sum = AT(st,r,c) + AT(st,r+1,c+1) + AT(st,r+2,c+2) + AT(st,r+3,c+3);
-            if (sum == 4) return 1;
-            if (sum == -4) return -1;
-        }
-    }
-    // Diagonale ascendente
-    for (int r=3; r<C4_ROWS; r++) {
-        for (int c=0; c<C4_COLS-3; c++) {
-            int sum = AT(st,r,c) + AT(st,r-1,c+1) + AT(st,r-2,c+2) + AT(st,r-3,c+3);
-            if (sum == 4) return 1;
-            if (sum == -4) return -1;
-        }
-    }
-    return 0;
-}
+/* Free-list per-thread per gli stati (vedi obj_mem.h): gli stati liberati
+   vengono riciclati dalla prossima copia senza passare da malloc/free */
+static __thread obj_mem_freelist_t c4_state_freelist =
+    OBJ_MEM_FREELIST_INIT(sizeof(C4_State), 64);
 
 /* Callback: copia profonda dello stato */
 static void* c4_copy_state(const void *state) {
-    const C4_State *st = (const C4_State*) state;
-    C4_State *copy = (C4_State*) malloc(sizeof(C4_State));
+    C4_State *copy = (C4_State*) obj_mem_freelist_alloc(&c4_state_freelist);
     if (copy) {
-        memcpy(copy->board, st->board, C4_SIZE*sizeof(int));
-        copy->next_player = st->next_player;
+        *copy = *(const C4_State*) state;
     }
     return copy;
 }
 
 /* Callback: libera lo stato */
 static void c4_free_state(void *state) {
-    free(state);
+    obj_mem_freelist_free(&c4_state_freelist, state);
 }
 
 /* Callback: genera mosse disponibili */
@@ -215,15 +228,15 @@ static void* c4_apply_move(const void *state, const void *move) {
     const C4_State *st = (const C4_State*) state;
     const int *col = (const int*) move;
 
-    C4_State *new_st = (C4_State*) malloc(sizeof(C4_State));
+    C4_State *new_st = (C4_State*) obj_mem_freelist_alloc(&c4_state_freelist);
     if (!new_st) return NULL;
 
-    memcpy(new_st->board, st->board, C4_SIZE*sizeof(int));
+    *new_st = *st;
     new_st->next_player = -st->next_player;
 
-    int r = find_free_row(st, *col);
-    if (r >= 0) {
-        new_st->board[r*C4_COLS + (*col)] = st->next_player;
+    int h = c4_col_height(st, *col);
+    if (h < C4_ROWS) {
+        new_st->bits[C4_SIDE(st->next_player)] |= C4_BIT(*col, h);
     }
     return new_st;
 }
@@ -231,58 +244,28 @@ static void* c4_apply_move(const void *state, const void *move) {
 /* Callback: verifica se lo stato è terminale */
 static int c4_is_terminal(const void *state) {
     const C4_State *st = (const C4_State*) state;
-    int w = check_winner(st);
-    if (w != 0) return 1;
-    for (int c=0; c<C4_COLS; c++) {
-        if (!is_col_full(st, c)) return 0;
-    }
-    return 1;
+    if (check_winner(st) != 0) return 1;
+    /* board piena: tutte le 42 caselle occupate */
+    return (st->bits[0] | st->bits[1]) == C4_BOARD_MASK;
 }
 
 /* Callback: valuta lo stato */
 static int c4_evaluate(const void *state) {
     const C4_State *st = (const C4_State*) state;
-    int score = 0;
+
     int w = check_winner(st);
-    
     if (w == 1) return +100;
     if (w == -1) return -100;
-    
-    // Orizzontale
-    for (int r = 0; r < C4_ROWS; r++) {
-        for (int c = 0; c < C4_COLS - 3; c++) {
-            score += evaluate_window(AT(st, r, c), AT(st, r, c+1), AT(st, r, c+2), AT(st, r, c+3));
-        }
-    }
-    
-    // Verticale
-    for (int c = 0; c < C4_COLS; c++) {
-        for (int r = 0; r < C4_ROWS - 3; r++) {
-            score += evaluate_window(AT(st, r, c), AT(st, r+1, c), AT(st, r+2, c), AT(st, r+3, c));
-        }
-    }
-    
-    // Diagonale Discendente
-    for (int r = 0; r < C4_ROWS - 3; r++) {
-        for (int c = 0; c < C4_COLS - 3; c++) {
-            score += evaluate_window(AT(st, r, c), AT(st, r+1, c+1), AT(st, r+2, c+2), AT(st, r+3, c+3));
-        }
-    }
-    
-    // Diagonale Ascendente
-    for (int r = 3; r < C4_ROWS; r++) {
-        for (int c = 0; c < C4_COLS - 3; c++) {
-            score += evaluate_window(AT(st, r, c), AT(st, r-1, c+1), AT(st, r-2, c+2), AT(st, r-3, c+3));
-        }
-    }
-    
-    // Preferenza per il centro
-    int center_col = C4_COLS / 2;
-    for (int r = 0; r < C4_ROWS; r++) {
-        if (AT(st, r, center_col) == 1) score += 3;
-        else if (AT(st, r, center_col) == -1) score -= 3;
-    }
-    
+
+    uint64_t empty = C4_BOARD_MASK & ~(st->bits[0] | st->bits[1]);
+    int score = c4_open_windows(st->bits[0], empty)
+              - c4_open_windows(st->bits[1], empty);
+
+    /* Preferenza per il centro */
+    uint64_t center = 0x3FULL << ((C4_COLS / 2) * 7);
+    score += 3 * __builtin_popcountll(st->bits[0] & center);
+    score -= 3 * __builtin_popcountll(st->bits[1] & center);
+
     return score;
 }
 
@@ -313,9 +296,10 @@ int main(void) {
     gd.player_to_move= c4_player_to_move;
     gd.hash_state    = c4_hash_state;    // Usa la cache
     gd.equals_state  = c4_equals_state;
+    gd.state_size    = sizeof(C4_State); // cache by-value
 
-    /* Creazione della cache */
-    generic_hash_table_t *cache = cache_create(gd.hash_state, gd.equals_state);
+    /* Creazione della cache (by-value: copia gli stati-chiave al suo interno) */
+    generic_hash_table_t *cache = minimax_cache_create(&gd);
     if (!cache) {
         fprintf(stderr, "Avviso: impossibile creare la cache, si prosegue senza.\n");
     }
@@ -326,9 +310,8 @@ int main(void) {
         fprintf(stderr, "Errore: impossibile allocare lo stato iniziale.\n");
         return 1;
     }
-    for (int i=0; i<C4_SIZE; i++) {
-        initial->board[i] = 0;
-    }
+    initial->bits[0] = 0;
+    initial->bits[1] = 0;
     initial->next_player = 1; // X umano
 
     printf("===== FORZA 4 (MiniMax con Cache) =====\n");
@@ -1,5 +1,5 @@
 /**
- * ##VERSION## "minimax.c 1.1"
+ * ##VERSION## "minimax.c 2.2"
  */
 
  /******************************************************************************
@@ -10,10 +10,176 @@
   ******************************************************************************/
 
 #include "minimax.h"
+#include "minimax_tt.h"     // Transposition table compatta dedicata
 #include "obj_trace.h"      // Inclusione della libreria di tracing
 #include <stdlib.h>         // per malloc, free
 #include <string.h>         // per eventuali operazioni di copia in get_best_move
 #include <limits.h>         // per INT_MIN, INT_MAX
+#include <time.h>           // per clock_gettime (gestione del tempo)
+#include <pthread.h>        // per i worker della ricerca parallela
+
+/******************************************************************************
+ * Gestione del budget di tempo per get_best_move_timed.
+ *
+ * Lo stato del "cronometro" è condiviso tra il driver e la ricorsione di
+ * minimax_ab: quando la scadenza dura viene superata, il flag aborted viene
+ * alzato e la ricorsione rientra il più in fretta possibile, senza
+ * memorizzare in cache risultati parziali.
+ ******************************************************************************/
+typedef struct {
+    int           active;            /* 1 se una ricerca interrompibile è in corso */
+    int           aborted;           /* 1 se la scadenza dura è stata superata */
+    unsigned long nodes;             /* nodi visitati dall'avvio della ricerca */
+    long          hard_deadline_ms;  /* scadenza dura (tempo monotono, ms), 0 = nessuna */
+    volatile int *stop_flag;         /* stop esterno (pondering), o NULL */
+} search_clock_t;
+
+/* Thread-local: ogni worker della ricerca parallela ha il proprio cronometro */
+static __thread search_clock_t search_clock = { 0, 0, 0, 0, NULL };
+
+/*
+ * Restituisce il tempo monotono corrente in millisecondi.
+ */
+static long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/*
+ * Controllo a basso costo della scadenza: incrementa il contatore dei nodi
+ * e, solo ogni TIME_CHECK_INTERVAL nodi, confronta il tempo corrente con la
+ * scadenza dura e legge l'eventuale flag di stop esterno (usato dal
+ * pondering per interrompere la ricerca in background). Ritorna 1 se la
+ * ricerca deve essere abortita.
+ */
+static int search_should_abort(void) {
+    if (!search_clock.active) {
+        return 0;
+    }
+    if (search_clock.aborted) {
+        return 1;
+    }
+    search_clock.nodes++;
+    if ((search_clock.nodes & (TIME_CHECK_INTERVAL - 1)) == 0) {
+        if (search_clock.stop_flag != NULL && *search_clock.stop_flag) {
+            TRACE_DEBUG(&stdtrace, "External stop after %lu nodes",
+                        search_clock.nodes);
+            search_clock.aborted = 1;
+        }
+        else if (search_clock.hard_deadline_ms != 0 &&
+                 monotonic_ms() >= search_clock.hard_deadline_ms) {
+            TRACE_DEBUG(&stdtrace, "Hard deadline reached after %lu nodes",
+                        search_clock.nodes);
+            search_clock.aborted = 1;
+        }
+    }
+    return search_clock.aborted;
+}
+
+/******************************************************************************
+ * Configurazione delle potature (null-move, LMR, futility).
+ *
+ * Globale e condivisa da tutti i worker: va impostata prima di avviare una
+ * ricerca e durante la ricerca viene solo letta.
+ ******************************************************************************/
+static const search_config_t default_search_config = {
+    1,      /* use_null_move */
+    2,      /* null_move_reduction (R) */
+    1,      /* use_lmr */
+    3,      /* lmr_full_moves */
+    1,      /* lmr_reduction */
+    0,      /* use_futility (prudente: disattivata di default) */
+    150,    /* futility_margin */
+    1       /* use_staged_gen */
+};
+
+static search_config_t search_config = {
+    1, 2, 1, 3, 1, 0, 150, 1
+};
+
+void minimax_set_search_config(const search_config_t *config) {
+    search_config = config ? *config : default_search_config;
+}
+
+search_config_t minimax_get_search_config(void) {
+    return search_config;
+}
+
+/******************************************************************************
+ * Transposition table compatta (minimax_tt).
+ *
+ * Come la configurazione delle potature: globale, impostata prima di avviare
+ * una ricerca e solo letta durante. Quando è impostata, la ricerca la usa al
+ * posto della cache generica passata come cache_handle — voci da 16 byte in
+ * un array contiguo invece di nodi malloc'ati con lo stato come chiave.
+ * Richiede la callback hash_state; la callback move_index (se presente)
+ * permette di memorizzare anche la mossa migliore del nodo.
+ ******************************************************************************/
+static minimax_tt_t *search_ttable = NULL;
+
+void minimax_set_ttable(minimax_tt_t *tt) {
+    search_ttable = tt;
+}
+
+minimax_tt_t* minimax_get_ttable(void) {
+    return search_ttable;
+}
+
+/******************************************************************************
+ * Statistiche della ricerca.
+ *
+ * Contatori thread-local sempre attivi (costo: un incremento per evento),
+ * azzerati all'avvio di ogni driver e letti con minimax_get_search_stats.
+ ******************************************************************************/
+static __thread search_stats_t search_stats;
+static __thread int stats_root_depth = 0;  /* profondità nominale dell'iterazione corrente */
+
+search_stats_t minimax_get_search_stats(void) {
+    return search_stats;
+}
+
+/*
+ * Azzera le statistiche: va chiamata all'inizio di ogni nuova ricerca.
+ */
+static void reset_search_stats(void) {
+    memset(&search_stats, 0, sizeof(search_stats));
+    stats_root_depth = 0;
+}
+
+/*
+ * Chiude le statistiche a fine ricerca: durata e nodi al secondo.
+ */
+static void finalize_search_stats(long start_ms) {
+    search_stats.elapsed_ms = monotonic_ms() - start_ms;
+    unsigned long total = search_stats.nodes + search_stats.qnodes;
+    if (search_stats.elapsed_ms > 0) {
+        search_stats.nps = (double)total * 1000.0 / (double)search_stats.elapsed_ms;
+    } else {
+        search_stats.nps = (double)total * 1000.0; /* sotto il millisecondo */
+    }
+}
+
+/*
+ * Callback di progresso: registrata per-thread come le statistiche, viene
+ * invocata dai driver con iterative deepening a ogni iterazione completata.
+ */
+static __thread search_progress_fn progress_callback = NULL;
+static __thread void *progress_user_data = NULL;
+
+void minimax_set_progress_callback(search_progress_fn fn, void *user_data) {
+    progress_callback = fn;
+    progress_user_data = user_data;
+}
+
+/*
+ * Aggiorna la profondità massima raggiunta (ply dalla radice).
+ */
+static void stats_note_ply(int ply) {
+    if (ply > search_stats.max_ply) {
+        search_stats.max_ply = ply;
+    }
+}
 
 /******************************************************************************
  * Struttura memorizzata nella cache per ogni stato.
@@ -32,272 +198,2732 @@ typedef struct {
 } minimax_cache_entry_t;
 
 /******************************************************************************
- * Funzione: minimax_ab
+ * Funzione: minimax_cache_create
+ ******************************************************************************/
+generic_hash_table_t* minimax_cache_create(const game_descriptor_t *gd)
+{
+    if (gd == NULL || gd->hash_state == NULL || gd->equals_state == NULL) {
+        return NULL;
+    }
+    if (gd->state_size > 0) {
+        /* Modalità by-value: la tabella copia lo stato-chiave e la voce,
+         * quindi lo store può ricevere il buffer di stato riutilizzato
+         * della ricerca e una entry di stack senza lasciare voci pendenti */
+        return cache_create_ex(gd->hash_state, gd->equals_state,
+                               gd->state_size, sizeof(minimax_cache_entry_t));
+    }
+    return cache_create(gd->hash_state, gd->equals_state);
+}
+
+/******************************************************************************
+ * Euristiche di ordinamento delle mosse (killer + history).
+ *
+ * Le tabelle sono thread-local: ogni worker della ricerca parallela mantiene
+ * le proprie. I killer slot memorizzano, per livello di profondità, l'indice
+ * compatto (move_index) delle ultime due mosse "tranquille" che hanno
+ * prodotto un taglio beta; la history table accumula un punteggio per ogni
+ * indice di mossa, premiando le mosse che tagliano a profondità elevata.
+ *
+ * Ordine di esame risultante: catture, killer del livello, mosse con history
+ * alta, tutto il resto. Entrambe le euristiche sono attive solo se il gioco
+ * fornisce le callback opzionali is_capture / move_index.
+ ******************************************************************************/
+#define SCORE_TT       3000000  /* la mossa migliore memorizzata in TT per il nodo */
+#define SCORE_PV       2000000  /* la mossa della variante principale viene prima di tutto */
+#define SCORE_CAPTURE  1000000  /* le catture vengono provate per prime */
+#define SCORE_KILLER0   500000  /* primo killer slot del livello */
+#define SCORE_KILLER1   400000  /* secondo killer slot del livello */
+
+static __thread int killer_idx[MAX_SEARCH_PLY][2]; /* indici killer per livello */
+static __thread int history_tab[2][HISTORY_SIZE];  /* punteggi history per giocatore */
+static __thread int pv_hint[MAX_SEARCH_PLY];       /* move_index della PV per profondità residua */
+static __thread int order_tables_ready = 0;        /* 1 dopo la prima inizializzazione */
+
+/*
+ * Azzera killer e history: va chiamata all'inizio di ogni nuova ricerca
+ * dalla radice, per non trascinarsi punteggi di posizioni ormai lontane.
+ */
+static void reset_order_tables(void) {
+    for (int d = 0; d < MAX_SEARCH_PLY; d++) {
+        killer_idx[d][0] = -1;
+        killer_idx[d][1] = -1;
+        pv_hint[d] = -1;
+    }
+    memset(history_tab, 0, sizeof(history_tab));
+    order_tables_ready = 1;
+}
+
+/******************************************************************************
+ * Variante principale (PV).
+ *
+ * Ogni nodo della ricerca può raccogliere la propria linea principale in una
+ * pv_line_t ("array triangolare"): la mossa migliore del nodo seguita dalla
+ * linea principale del figlio corrispondente. Le mosse sono copie profonde
+ * (copy_move) di proprietà della linea.
+ ******************************************************************************/
+typedef struct {
+    void *moves[MAX_SEARCH_PLY]; /* copie profonde delle mosse della linea */
+    int   length;                /* numero di mosse valide in moves[] */
+} pv_line_t;
+
+/*
+ * Libera le mosse di una linea e la azzera.
+ */
+static void pv_line_reset(const game_descriptor_t *gd, pv_line_t *line) {
+    for (int i = 0; i < line->length; i++) {
+        gd->free_move(line->moves[i]);
+    }
+    line->length = 0;
+}
+
+/*
+ * Ritorna 1 se il descrittore fornisce la coppia make/unmake ed è quindi
+ * possibile eseguire le mosse in place su un unico buffer di stato,
+ * evitando la coppia malloc/free di apply_move/free_state in ogni nodo.
+ */
+static int use_make_unmake(const game_descriptor_t *gd) {
+    return gd->make_move != NULL && gd->unmake_move != NULL &&
+           gd->undo_size > 0 && gd->undo_size <= MAX_UNDO_SIZE;
+}
+
+/*
+ * Ritorna 1 se il descrittore fornisce la generazione in buffer del
+ * chiamante: le mosse del nodo vengono scritte in un array sullo stack
+ * invece che in un dynamic_vector_t, eliminando anche il passaggio dal
+ * pool di vettori e la coppia get_moves/free_moves per nodo.
+ */
+static int use_move_buffer(const game_descriptor_t *gd) {
+    return gd->generate_moves != NULL &&
+           gd->move_size > 0 && gd->move_size <= MAX_MOVE_SIZE;
+}
+
+/*
+ * Registra la PV dell'iterazione appena completata come suggerimento di
+ * ordinamento per l'iterazione successiva: la mossa i-esima della linea
+ * corrisponde alla profondità residua (depth - i) e verrà esaminata per
+ * prima a quel livello (punteggio SCORE_PV in order_moves).
+ */
+static void set_pv_hints(const game_descriptor_t *gd, const pv_line_t *line, int depth) {
+    if (!gd->move_index) {
+        return;
+    }
+    for (int i = 0; i < line->length; i++) {
+        int d = depth - i;
+        if (d < 0 || d >= MAX_SEARCH_PLY) {
+            continue;
+        }
+        pv_hint[d] = gd->move_index(line->moves[i]);
+    }
+}
+
+/*
+ * Consegna alla callback di progresso (se registrata) la fotografia
+ * dell'iterazione appena completata. `line` può essere NULL nei driver che
+ * non raccolgono la PV.
+ */
+static void report_search_progress(int depth, int value,
+                                   const pv_line_t *line, long start_ms) {
+    if (progress_callback == NULL) {
+        return;
+    }
+
+    search_progress_t progress;
+    progress.depth = depth;
+    progress.value = value;
+    progress.pv_moves = (line != NULL) ? (const void *const *)line->moves : NULL;
+    progress.pv_length = (line != NULL) ? line->length : 0;
+    progress.nodes = search_stats.nodes + search_stats.qnodes;
+    progress.elapsed_ms = monotonic_ms() - start_ms;
+    if (progress.elapsed_ms > 0) {
+        progress.nps = (double)progress.nodes * 1000.0 / (double)progress.elapsed_ms;
+    } else {
+        progress.nps = (double)progress.nodes * 1000.0; /* sotto il millisecondo */
+    }
+
+    progress_callback(&progress, progress_user_data);
+}
+
+/*
+ * Registra un taglio beta prodotto da una mossa "tranquilla" (non cattura):
+ * aggiorna i killer slot del livello e la history table del giocatore.
+ */
+static void record_beta_cutoff(const game_descriptor_t *gd,
+                               const void *state,
+                               const void *move,
+                               int depth) {
+    if (!gd->move_index) {
+        return;
+    }
+    if (gd->is_capture && gd->is_capture(state, move)) {
+        return; /* le catture sono già ordinate per prime */
+    }
+
+    int idx = gd->move_index(move);
+    if (idx < 0 || idx >= HISTORY_SIZE) {
+        return;
+    }
+
+    /* Killer slot del livello (shift del primo slot sul secondo) */
+    int d = (depth < MAX_SEARCH_PLY) ? depth : (MAX_SEARCH_PLY - 1);
+    if (d >= 0 && killer_idx[d][0] != idx) {
+        killer_idx[d][1] = killer_idx[d][0];
+        killer_idx[d][0] = idx;
+    }
+
+    /* History: il peso cresce col quadrato della profondità */
+    int side = (gd->player_to_move(state) == 1) ? 0 : 1;
+    history_tab[side][idx] += depth * depth;
+    if (history_tab[side][idx] >= SCORE_KILLER1) {
+        /* Evita che la history superi i killer: dimezza tutta la tabella */
+        for (int i = 0; i < HISTORY_SIZE; i++) {
+            history_tab[side][i] /= 2;
+        }
+    }
+}
+
+/*
+ * Fast-path per l'accesso alle mosse: se il vettore è "per valore"
+ * (dv_create_sized, come quelli del modulo scacchi) le mosse vivono nel
+ * buffer contiguo di dv_data e l'elemento i-esimo si raggiunge con la sola
+ * aritmetica dei puntatori. Altrimenti (vettore per puntatore) si passa
+ * dalla callback del gioco. A milioni di iterazioni al secondo le due
+ * chiamate indirette per elemento (get_move_at -> dv_get, ognuna con i suoi
+ * controlli NULL/range) sono puro overhead nei cicli stretti.
+ *
+ * moves_flat_base ritorna il buffer piatto (o NULL) e scrive lo stride;
+ * move_at usa il buffer se disponibile, la callback in caso contrario.
+ */
+static const char* moves_flat_base(const dynamic_vector_t *moves_vec,
+                                   size_t *stride_out) {
+    size_t stride = dv_elem_size(moves_vec);
+    *stride_out = stride;
+    return (stride > 0) ? (const char*)dv_data(moves_vec) : NULL;
+}
+
+static inline void* move_at(const game_descriptor_t *gd,
+                            const dynamic_vector_t *moves_vec,
+                            const char *flat, size_t stride, int i) {
+    if (flat != NULL) {
+        return (void*)(flat + (size_t)i * stride);
+    }
+    return gd->get_move_at(moves_vec, i);
+}
+
+/*
+ * Chiave a 16 bit della mossa per la transposition table: pack_move se il
+ * gioco la fornisce (codifica reversibile, distingue ad esempio le quattro
+ * promozioni della stessa casella), altrimenti move_index.
+ */
+static inline int tt_move_key(const game_descriptor_t *gd, const void *move) {
+    if (gd->pack_move) {
+        return gd->pack_move(move);
+    }
+    if (gd->move_index) {
+        return gd->move_index(move);
+    }
+    return -1;
+}
+
+/*
+ * Ordina le mosse del nodo in ordine decrescente di punteggio euristico,
+ * scrivendo i puntatori ordinati in ordered_out. Ritorna 1 se l'ordinamento
+ * è stato eseguito, 0 se va usato l'ordine originale del vettore.
+ *
+ * Le mosse arrivano dal chiamante come base piatta mv_flat/mv_stride (vettore
+ * per valore, o buffer di stack della generazione in buffer: in quel caso
+ * moves_vec è NULL); il vettore serve solo come fallback per i vettori per
+ * puntatore, dove mv_flat è NULL.
+ */
+static int order_moves(const game_descriptor_t *gd,
+                       const void *state,
+                       dynamic_vector_t *moves_vec,
+                       const char *mv_flat,
+                       size_t mv_stride,
+                       int num_moves,
+                       int depth,
+                       void **ordered_out) {
+    /* Senza callback di supporto (o con troppe mosse) niente ordinamento */
+    if ((!gd->is_capture && !gd->move_index) || num_moves > MAX_ORDERED_MOVES) {
+        return 0;
+    }
+    if (!order_tables_ready) {
+        reset_order_tables();
+    }
+
+    int scores[MAX_ORDERED_MOVES];
+    int d = (depth >= 0 && depth < MAX_SEARCH_PLY) ? depth : (MAX_SEARCH_PLY - 1);
+    int side = (gd->player_to_move(state) == 1) ? 0 : 1;
+
+    for (int i = 0; i < num_moves; i++) {
+        void *move = move_at(gd, moves_vec, mv_flat, mv_stride, i);
+        int score = 0;
+
+        int idx = gd->move_index ? gd->move_index(move) : -1;
+
+        if (idx >= 0 && idx == pv_hint[d]) {
+            /* Mossa della PV dell'iterazione precedente: prima di tutto */
+            score = SCORE_PV;
+        } else if (gd->is_capture && gd->is_capture(state, move)) {
+            score = SCORE_CAPTURE;
+        } else if (idx >= 0 && idx < HISTORY_SIZE) {
+            if (idx == killer_idx[d][0]) {
+                score = SCORE_KILLER0;
+            } else if (idx == killer_idx[d][1]) {
+                score = SCORE_KILLER1;
+            } else {
+                score = history_tab[side][idx];
+            }
+        }
+
+        /* Inserimento ordinato (insertion sort, vettori piccoli) */
+        int j = i;
+        while (j > 0 && scores[j - 1] < score) {
+            scores[j] = scores[j - 1];
+            ordered_out[j] = ordered_out[j - 1];
+            j--;
+        }
+        scores[j] = score;
+        ordered_out[j] = move;
+    }
+
+    return 1;
+}
+
+/*
+ * Supporto alla generazione a stadi (catture prima, tranquille su richiesta).
+ *
+ * order_captures: scrive in ordered_out i puntatori alle mosse del vettore
+ * delle catture, con l'eventuale mossa TT del nodo (indice compatto tt_idx)
+ * portata in testa. Ritorna il numero di mosse scritte, o -1 se il vettore
+ * eccede MAX_ORDERED_MOVES (il chiamante itera nell'ordine originale).
+ */
+static int order_captures(const game_descriptor_t *gd,
+                          dynamic_vector_t *moves_vec,
+                          const char *mv_flat,
+                          size_t mv_stride,
+                          int num_moves,
+                          int tt_idx,
+                          void **ordered_out) {
+    if (num_moves > MAX_ORDERED_MOVES) {
+        return -1;
+    }
+
+    int n = 0;
+    for (int i = 0; i < num_moves; i++) {
+        void *move = move_at(gd, moves_vec, mv_flat, mv_stride, i);
+        ordered_out[n++] = move;
+        if (tt_idx >= 0 && tt_move_key(gd, move) == tt_idx && n > 1) {
+            /* Mossa TT in testa, le altre scalano di uno */
+            void *tmp = ordered_out[n - 1];
+            memmove(&ordered_out[1], &ordered_out[0], (n - 1) * sizeof(void*));
+            ordered_out[0] = tmp;
+        }
+    }
+    return n;
+}
+
+/*
+ * order_quiet_moves: come order_moves ma sul vettore COMPLETO generato dopo
+ * lo stadio delle catture: le catture (già esaminate) vengono scartate e le
+ * sole mosse tranquille vengono ordinate per killer/history, con la mossa
+ * TT in testa. Ritorna il numero di mosse tranquille scritte in ordered_out,
+ * o -1 se l'ordinamento non è possibile (il chiamante itera il vettore
+ * completo scartando le catture una per una).
+ */
+static int order_quiet_moves(const game_descriptor_t *gd,
+                             const void *state,
+                             dynamic_vector_t *moves_vec,
+                             const char *mv_flat,
+                             size_t mv_stride,
+                             int num_moves,
+                             int depth,
+                             int tt_idx,
+                             void **ordered_out) {
+    if (!gd->is_capture || num_moves > MAX_ORDERED_MOVES) {
+        return -1;
+    }
+    if (!order_tables_ready) {
+        reset_order_tables();
+    }
+
+    int scores[MAX_ORDERED_MOVES];
+    int d = (depth >= 0 && depth < MAX_SEARCH_PLY) ? depth : (MAX_SEARCH_PLY - 1);
+    int side = (gd->player_to_move(state) == 1) ? 0 : 1;
+
+    int n = 0;
+    for (int i = 0; i < num_moves; i++) {
+        void *move = move_at(gd, moves_vec, mv_flat, mv_stride, i);
+        if (gd->is_capture(state, move)) {
+            continue; /* già esaminata nello stadio delle catture */
+        }
+
+        int score = 0;
+        int idx = gd->move_index ? gd->move_index(move) : -1;
+        if (tt_idx >= 0 && tt_move_key(gd, move) == tt_idx) {
+            score = SCORE_TT;
+        } else if (idx >= 0 && idx == pv_hint[d]) {
+            score = SCORE_PV;
+        } else if (idx >= 0 && idx < HISTORY_SIZE) {
+            if (idx == killer_idx[d][0]) {
+                score = SCORE_KILLER0;
+            } else if (idx == killer_idx[d][1]) {
+                score = SCORE_KILLER1;
+            } else {
+                score = history_tab[side][idx];
+            }
+        }
+
+        int j = n;
+        while (j > 0 && scores[j - 1] < score) {
+            scores[j] = scores[j - 1];
+            ordered_out[j] = ordered_out[j - 1];
+            j--;
+        }
+        scores[j] = score;
+        ordered_out[j] = move;
+        n++;
+    }
+
+    return n;
+}
+
+/******************************************************************************
+ * Funzione interna: quiescence
+ *
+ * Ricerca di quiescenza: raggiunta la profondità zero, invece di valutare
+ * subito la posizione, continuiamo a estendere le sole linee di cattura
+ * (e promozione) finché la posizione non è "tranquilla". Questo elimina
+ * l'effetto orizzonte a una frazione del costo di un livello pieno in più.
+ *
+ * Lo "stand pat" (valutazione statica) fa da limite inferiore/superiore:
+ * il giocatore di turno non è obbligato a catturare, quindi può sempre
+ * "fermarsi" al punteggio statico.
+ ******************************************************************************/
+static int quiescence(
+    const game_descriptor_t *gd,
+    const void *state,
+    int alpha,
+    int beta,
+    int qdepth
+) {
+    /* Controllo del budget di tempo anche nei nodi di quiescenza */
+    if (search_should_abort()) {
+        return alpha;
+    }
+
+    search_stats.qnodes++;
+    stats_note_ply(stats_root_depth + (MAX_QUIESCENCE_PLY - qdepth));
+
+    int stand_pat = gd->evaluate(state);
+    int player = gd->player_to_move(state);
+
+    /* Limite di sicurezza alla profondità della quiescenza */
+    if (qdepth <= 0) {
+        return stand_pat;
+    }
+
+    /* Lo stand pat può già produrre un taglio */
+    if (player == 1) {
+        if (stand_pat >= beta) {
+            return stand_pat;
+        }
+        if (stand_pat > alpha) {
+            alpha = stand_pat;
+        }
+    } else {
+        if (stand_pat <= alpha) {
+            return stand_pat;
+        }
+        if (stand_pat < beta) {
+            beta = stand_pat;
+        }
+    }
+
+    /* Generiamo le sole mosse di cattura */
+    dynamic_vector_t *captures = gd->get_capture_moves(state);
+    if (!captures) {
+        return stand_pat;
+    }
+    int num_captures = gd->get_num_moves(captures);
+
+    int best_value = stand_pat;
+
+    /* Esecuzione in place se il gioco fornisce make/unmake */
+    int in_place = use_make_unmake(gd);
+    unsigned char undo[MAX_UNDO_SIZE];
+
+    size_t mv_stride;
+    const char *mv_flat = moves_flat_base(captures, &mv_stride);
+
+    for (int i = 0; i < num_captures; i++) {
+        void *move = move_at(gd, captures, mv_flat, mv_stride, i);
+
+        int value;
+        if (in_place) {
+            if (!gd->make_move((void*)state, move, undo)) {
+                continue; /* cattura illegale (es. pezzo pinned) */
+            }
+            value = quiescence(gd, state, alpha, beta, qdepth - 1);
+            gd->unmake_move((void*)state, undo);
+        } else {
+            void *new_state = gd->apply_move(state, move);
+            if (new_state == NULL) {
+                continue; /* cattura illegale (es. pezzo pinned) */
+            }
+            value = quiescence(gd, new_state, alpha, beta, qdepth - 1);
+            gd->free_state(new_state);
+        }
+
+        if (player == 1) {
+            if (value > best_value) {
+                best_value = value;
+            }
+            if (best_value > alpha) {
+                alpha = best_value;
+            }
+        } else {
+            if (value < best_value) {
+                best_value = value;
+            }
+            if (best_value < beta) {
+                beta = best_value;
+            }
+        }
+
+        if (alpha >= beta) {
+            break; /* taglio anche in quiescenza */
+        }
+    }
+
+    gd->free_moves(captures);
+    return best_value;
+}
+
+/******************************************************************************
+ * Funzione interna: minimax_ab_pv
+ *
+ * Corpo di minimax_ab con raccolta opzionale della variante principale:
+ * se pline non è NULL, al ritorno contiene la mossa migliore del nodo
+ * seguita dalla linea principale del figlio corrispondente (schema ad
+ * array triangolare). La raccolta è attiva solo lungo i nodi PV, quindi
+ * il costo sulle altre diramazioni è nullo.
+ ******************************************************************************/
+static int minimax_ab_pv(
+    const game_descriptor_t *gd,
+    const void *state,
+    int depth,
+    int alpha,
+    int beta,
+    void *cache_handle,
+    pv_line_t *pline
+) {
+    int alpha_orig = alpha;
+    int beta_orig = beta;
+
+    if (pline) {
+        pline->length = 0;
+    }
+
+    /* 0. Controllo del budget di tempo (attivo solo in get_best_move_timed):
+     *    se la scadenza dura è stata superata rientriamo subito con un valore
+     *    qualsiasi; l'iterazione in corso verrà comunque scartata dal driver. */
+    if (search_should_abort()) {
+        return alpha;
+    }
+
+    search_stats.nodes++;
+    stats_note_ply(stats_root_depth - depth);
+
+    /* 0b. Patta per regolamento (es. triplice ripetizione), se il gioco sa
+     *     riconoscerla: il nodo vale 0 e il sottoalbero si chiude qui. Il
+     *     controllo sta PRIMA della cache e il valore NON viene memorizzato,
+     *     perché dipende dal cammino percorso e non solo dalla posizione. */
+    if (gd->is_draw != NULL && gd->is_draw(state)) {
+        return 0;
+    }
+
+    /* 1. Se abbiamo una cache, proviamo a recuperare un valore memorizzato.
+     *    Nei nodi PV (pline != NULL) il taglio da cache viene saltato: un
+     *    rientro anticipato troncherebbe la variante principale raccolta.
+     *    La transposition table compatta, se impostata, ha la precedenza
+     *    sulla cache generica; l'hash dello stato viene calcolato UNA volta
+     *    per nodo e riusato per lookup e store (le varianti _hashed), così
+     *    chess_hash_state non gira due volte sullo stesso stato. */
+    uint64_t state_hash = 0;
+    int have_hash = 0;
+    if (gd->hash_state != NULL &&
+        (search_ttable != NULL || cache_handle != NULL)) {
+        state_hash = gd->hash_state(state);
+        have_hash = 1;
+    }
+
+    int tt_move_idx = -1;  /* mossa migliore memorizzata per il nodo, se nota */
+    if (search_ttable != NULL && pline == NULL && state_hash != 0) {
+        minimax_tt_entry_t tte;
+        if (minimax_tt_probe(search_ttable, state_hash, &tte)) {
+            /* Anche quando la profondità memorizzata non basta per un
+               taglio, la mossa migliore del nodo resta un ottimo
+               suggerimento di ordinamento */
+            if (tte.best_move != MINIMAX_TT_NO_MOVE) {
+                tt_move_idx = (int)tte.best_move;
+            }
+            if (tte.depth >= depth) {
+                search_stats.cache_hits++;
+                TRACE_DEBUG(&stdtrace, "TT hit at depth %d: value=%d, type=%d",
+                            depth, tte.value, tte.type);
+                if (tte.type == MINIMAX_TT_EXACT) {
+                    return tte.value;
+                } else if (tte.type == MINIMAX_TT_LOWER_BOUND) {
+                    if (tte.value > alpha) {
+                        alpha = tte.value;
+                    }
+                } else if (tte.type == MINIMAX_TT_UPPER_BOUND) {
+                    if (tte.value < beta) {
+                        beta = tte.value;
+                    }
+                }
+                if (alpha >= beta) {
+                    return tte.value;
+                }
+            } else {
+                search_stats.cache_misses++;
+            }
+        } else {
+            search_stats.cache_misses++;
+        }
+    }
+    else if (cache_handle != NULL && pline == NULL) {
+        /* Lettura PER COPIA: il puntatore restituito da cache_lookup entra
+           nello slab interno della tabella, e con la cache condivisa dei
+           driver paralleli uno store concorrente può riallocarlo o
+           sovrascrivere lo slot mentre lo stiamo ancora leggendo. La copia
+           nel buffer locale avviene dentro il mutex della tabella. */
+        minimax_cache_entry_t cached_val;
+        int cache_hit = have_hash
+            ? cache_lookup_copy_hashed(cache_handle, state, &cached_val,
+                                       sizeof(cached_val), state_hash)
+            : cache_lookup_copy(cache_handle, state, &cached_val,
+                                sizeof(cached_val));
+        if (cache_hit && cached_val.depth >= depth) {
+            search_stats.cache_hits++;
+            TRACE_DEBUG(&stdtrace, "Cache hit at depth %d: value=%d, type=%d", depth, cached_val.value, cached_val.type);
+            if (cached_val.type == EXACT) {
+                return cached_val.value;
+            } else if (cached_val.type == LOWER_BOUND) {
+                if (cached_val.value > alpha) {
+                    alpha = cached_val.value;
+                }
+            } else if (cached_val.type == UPPER_BOUND) {
+                if (cached_val.value < beta) {
+                    beta = cached_val.value;
+                }
+            }
+            if (alpha >= beta) {
+                TRACE_DEBUG(&stdtrace, "Alpha-beta cutoff after cache retrieval: alpha=%d, beta=%d", alpha, beta);
+                return cached_val.value;
+            }
+        } else {
+            search_stats.cache_misses++;
+            TRACE_DEBUG(&stdtrace, "Cache miss at depth %d", depth);
+        }
+    }
+
+    /* 2. Se lo stato è terminale o abbiamo raggiunto la profondità massima, valuta e ritorna.
+     *    Se il gioco fornisce get_capture_moves, al posto della valutazione
+     *    statica a profondità zero viene eseguita la ricerca di quiescenza.
+     *
+     *    Con moves_imply_terminal il test esplicito viene saltato: i nodi
+     *    terminali emergono come lista di mosse vuota dalla generazione che
+     *    segue comunque (punto 3), senza pagarla due volte; a profondità
+     *    zero ci pensa la quiescenza, il cui stand pat su uno stato senza
+     *    catture coincide con la valutazione statica. */
+    int terminal = gd->moves_imply_terminal ? 0 : gd->is_terminal(state);
+    if (terminal || depth == 0) {
+        int eval;
+        int from_quiescence = 0;
+        if (!terminal && gd->get_capture_moves != NULL) {
+            eval = quiescence(gd, state, alpha, beta, MAX_QUIESCENCE_PLY);
+            from_quiescence = 1;
+        } else {
+            eval = gd->evaluate(state);
+        }
+
+        /* Memorizza in cache, se disponibile. La quiescenza è fail-soft:
+           stand pat e tagli restituiscono bound relativi alla finestra del
+           nodo, non punteggi esatti, quindi il valore va classificato
+           contro la finestra ORIGINALE come al punto 7 (un probe con
+           finestra diversa che lo rileggesse come EXACT corromperebbe la
+           ricerca). La valutazione statica invece non dipende dalla
+           finestra e resta EXACT. Mai a ricerca abortita: il rientro
+           d'emergenza della quiescenza non è un punteggio. */
+        NodeType leaf_type = EXACT;
+        if (from_quiescence) {
+            if (eval <= alpha_orig) {
+                leaf_type = UPPER_BOUND;
+            } else if (eval >= beta_orig) {
+                leaf_type = LOWER_BOUND;
+            }
+        }
+        if (search_ttable != NULL && state_hash != 0 && !search_clock.aborted) {
+            minimax_tt_store(search_ttable, state_hash, eval, depth,
+                             (int)leaf_type, -1);
+        }
+        else if (cache_handle != NULL && !search_clock.aborted) {
+            minimax_cache_entry_t entry;
+            entry.value = eval;
+            entry.depth = depth;
+            entry.type = leaf_type;
+            if (have_hash) {
+                cache_store_hashed(cache_handle, state, &entry, state_hash);
+            } else {
+                cache_store(cache_handle, state, &entry);
+            }
+            TRACE_DEBUG(&stdtrace, "Stored in cache at depth %d: value=%d, type=%d", depth, eval, leaf_type);
+        }
+        return eval;
+    }
+
+    /* 2b. Potatura null-move: regaliamo una mossa all'avversario e cerchiamo
+     *     a profondità ridotta con finestra nulla attorno al bound; se anche
+     *     così la posizione resta oltre il bound, il nodo può essere potato
+     *     senza generare le mosse. Mai nei nodi PV (troncherebbe la linea)
+     *     e solo se il gioco sa eseguire la mossa nulla in sicurezza. */
+    int player = gd->player_to_move(state);
+
+    if (search_config.use_null_move && pline == NULL &&
+        use_make_unmake(gd) && gd->make_null_move != NULL &&
+        depth > search_config.null_move_reduction + 1) {
+        unsigned char null_undo[MAX_UNDO_SIZE];
+        int ndepth = depth - 1 - search_config.null_move_reduction;
+
+        if (player == 1 && beta != INT_MAX) {
+            if (gd->make_null_move((void*)state, null_undo)) {
+                int nvalue = minimax_ab_pv(gd, state, ndepth, beta - 1, beta,
+                                           cache_handle, NULL);
+                gd->unmake_move((void*)state, null_undo);
+                if (nvalue >= beta && !search_clock.aborted) {
+                    TRACE_DEBUG(&stdtrace, "Null-move cutoff at depth %d: value=%d >= beta=%d",
+                                depth, nvalue, beta);
+                    return nvalue;
+                }
+            }
+        } else if (player == -1 && alpha != INT_MIN) {
+            if (gd->make_null_move((void*)state, null_undo)) {
+                int nvalue = minimax_ab_pv(gd, state, ndepth, alpha, alpha + 1,
+                                           cache_handle, NULL);
+                gd->unmake_move((void*)state, null_undo);
+                if (nvalue <= alpha && !search_clock.aborted) {
+                    TRACE_DEBUG(&stdtrace, "Null-move cutoff at depth %d: value=%d <= alpha=%d",
+                                depth, nvalue, alpha);
+                    return nvalue;
+                }
+            }
+        }
+    }
+
+    /* 3. Generazione delle mosse. Con la generazione a stadi (attiva nei
+     *    nodi non-PV quando il gioco fornisce get_capture_moves e
+     *    is_capture) il nodo esamina PRIMA le sole catture: se una di esse
+     *    produce il taglio — l'esito più frequente con un buon ordinamento —
+     *    le mosse tranquille non vengono mai generate. */
+    dynamic_vector_t *cap_vec = NULL;
+    dynamic_vector_t *moves_vec = NULL;
+    int num_moves = 0;          /* mosse dello stadio corrente */
+    int staged = (search_config.use_staged_gen && pline == NULL &&
+                  gd->get_capture_moves != NULL && gd->is_capture != NULL);
+
+    /* Generazione in buffer del chiamante: se il gioco la fornisce, le mosse
+     * vivono in questo array sullo stack del nodo e moves_vec resta NULL —
+     * niente vettore da acquisire né da restituire. */
+    int use_buf = use_move_buffer(gd);
+    unsigned char move_buf[MINIMAX_MAX_MOVES * MAX_MOVE_SIZE];
+
+    if (staged) {
+        cap_vec = gd->get_capture_moves(state);
+        int num_caps = cap_vec ? gd->get_num_moves(cap_vec) : 0;
+        if (num_caps > 0) {
+            num_moves = num_caps;
+        } else {
+            /* Nessuna cattura: tanto vale partire dal vettore completo */
+            if (cap_vec != NULL) {
+                gd->free_moves(cap_vec);
+                cap_vec = NULL;
+            }
+            staged = 0;
+        }
+    }
+    if (!staged) {
+        if (use_buf) {
+            num_moves = gd->generate_moves(state, move_buf, MINIMAX_MAX_MOVES);
+        }
+        if (!use_buf || num_moves < 0) {
+            /* Buffer non disponibile (o insufficiente): vettore classico */
+            moves_vec = gd->get_moves(state);
+            num_moves = gd->get_num_moves(moves_vec);
+        }
+    }
+
+    /* Se non ci sono mosse, consideriamo lo stato come terminale di fatto */
+    if (num_moves == 0) {
+        int eval = gd->evaluate(state);
+        if (search_ttable != NULL && state_hash != 0) {
+            minimax_tt_store(search_ttable, state_hash, eval, depth,
+                             MINIMAX_TT_EXACT, -1);
+        }
+        else if (cache_handle != NULL) {
+            minimax_cache_entry_t entry;
+            entry.value = eval;
+            entry.depth = depth;
+            entry.type = EXACT;
+            if (have_hash) {
+                cache_store_hashed(cache_handle, state, &entry, state_hash);
+            } else {
+                cache_store(cache_handle, state, &entry);
+            }
+            TRACE_DEBUG(&stdtrace, "Stored in cache at depth %d: value=%d, type=EXACT (no available moves)", depth, eval);
+        }
+        /* Non dimentichiamo di liberare il vettore (se c'è: con la
+         * generazione in buffer non ne è mai esistito uno) */
+        if (moves_vec != NULL) {
+            gd->free_moves(moves_vec);
+        }
+        return eval;
+    }
+
+    /* 4. Il giocatore è massimizzatore (1) o minimizzatore (-1) */
+    int best_value = (player == 1) ? INT_MIN : INT_MAX;
+
+    /* 4b. Fase di ordinamento dello stadio corrente: per le catture basta
+     *     portare in testa l'eventuale mossa TT; per il vettore completo
+     *     vale l'ordinamento classico (catture, killer, history).
+     *     num_ordered: mosse in ordered[], o -1 per iterare il vettore. */
+    void *ordered[MAX_ORDERED_MOVES];
+    int num_ordered;
+    size_t mv_stride;
+    const char *mv_flat;
+    dynamic_vector_t *stage_vec;
+    int stage_is_captures = staged;
+
+    if (staged) {
+        mv_flat = moves_flat_base(cap_vec, &mv_stride);
+        num_ordered = order_captures(gd, cap_vec, mv_flat, mv_stride,
+                                     num_moves, tt_move_idx, ordered);
+        stage_vec = cap_vec;
+    } else {
+        if (moves_vec != NULL) {
+            mv_flat = moves_flat_base(moves_vec, &mv_stride);
+        } else {
+            /* Mosse nel buffer di stack: base piatta, stride del gioco */
+            mv_flat = (const char*)move_buf;
+            mv_stride = gd->move_size;
+        }
+        num_ordered = order_moves(gd, state, moves_vec, mv_flat, mv_stride,
+                                  num_moves, depth, ordered)
+                      ? num_moves : -1;
+        stage_vec = moves_vec;
+    }
+
+    /* Esecuzione in place se il gioco fornisce make/unmake */
+    int in_place = use_make_unmake(gd);
+    unsigned char undo[MAX_UNDO_SIZE];
+
+    int searched = 0;           /* mosse effettivamente esaminate */
+    int static_eval = 0;        /* valutazione statica (lazy, per la futility) */
+    int static_eval_ready = 0;
+    int best_move_tt_idx = -1;  /* indice compatto della mossa migliore (per la TT) */
+
+    /* 5. Cicliamo sulle mosse, uno stadio alla volta */
+    int i = 0;
+    for (;;) {
+        if (i >= (num_ordered >= 0 ? num_ordered : num_moves)) {
+            if (!stage_is_captures) {
+                break; /* stadio finale esaurito */
+            }
+            /* Catture esaurite senza taglio: ORA generiamo la lista
+             * completa e proseguiamo sulle sole mosse tranquille */
+            stage_is_captures = 0;
+            int total = -1;
+            if (use_buf) {
+                total = gd->generate_moves(state, move_buf, MINIMAX_MAX_MOVES);
+            }
+            if (total >= 0) {
+                mv_flat = (const char*)move_buf;
+                mv_stride = gd->move_size;
+            } else {
+                moves_vec = gd->get_moves(state);
+                total = gd->get_num_moves(moves_vec);
+                mv_flat = moves_flat_base(moves_vec, &mv_stride);
+            }
+            num_ordered = order_quiet_moves(gd, state, moves_vec, mv_flat,
+                                            mv_stride, total, depth,
+                                            tt_move_idx, ordered);
+            num_moves = total;
+            stage_vec = moves_vec; /* NULL se le mosse vivono nel buffer */
+            i = 0;
+            continue;
+        }
+
+        /* Otteniamo la mossa i-esima (secondo l'ordine euristico, se attivo) */
+        void *move = (num_ordered >= 0)
+                     ? ordered[i]
+                     : move_at(gd, stage_vec, mv_flat, mv_stride, i);
+
+        /* Fallback senza ordinamento nello stadio delle tranquille: le
+         * catture del vettore completo sono già state esaminate */
+        if (staged && !stage_is_captures && num_ordered < 0 &&
+            gd->is_capture(state, move)) {
+            i++;
+            continue;
+        }
+        i++; /* la mossa è consumata anche se un filtro sotto fa continue */
+
+        /* Mossa "tranquilla": serve is_capture per riconoscerla */
+        int quiet = (gd->is_capture != NULL) && !gd->is_capture(state, move);
+
+        /* 5a. Potatura futility: all'ultimo livello le mosse tranquille che
+         *     non possono riportare la valutazione statica dentro la finestra
+         *     vengono saltate del tutto (mai la prima mossa esaminata). */
+        if (search_config.use_futility && depth == 1 && quiet && searched > 0) {
+            if (!static_eval_ready) {
+                static_eval = gd->evaluate(state);
+                static_eval_ready = 1;
+            }
+            if (player == 1
+                    ? (static_eval + search_config.futility_margin <= alpha)
+                    : (static_eval - search_config.futility_margin >= beta)) {
+                continue;
+            }
+        }
+
+        /* 5b. Late-move reduction: le mosse tranquille dopo le prime
+         *     lmr_full_moves vengono cercate a profondità ridotta; se il
+         *     risultato ridotto minaccia di migliorare la finestra, la mossa
+         *     viene ricercata a profondità piena. Mai nei nodi PV. */
+        int reduction = 0;
+        if (search_config.use_lmr && pline == NULL && depth >= 3 && quiet &&
+            searched >= search_config.lmr_full_moves) {
+            reduction = search_config.lmr_reduction;
+            if (reduction > depth - 2) {
+                reduction = depth - 2;
+            }
+        }
+
+        /* Ricorsione (con raccolta della linea del figlio nei nodi PV):
+         * con make/unmake la mossa viene eseguita e poi disfatta sullo
+         * stesso buffer di stato, senza allocazioni per nodo.
+         *
+         * Nei nodi PV solo la PRIMA mossa viene cercata raccogliendo la
+         * linea: estendere lo status di nodo PV a tutti i figli
+         * disattiverebbe cache e potature sull'intero albero. Se una mossa
+         * successiva migliora, la sua linea viene raccolta con una breve
+         * ricerca ripetuta (rara: l'ordinamento mette quasi sempre la
+         * mossa migliore per prima, e la ripetizione gira sulla cache
+         * appena riempita). */
+        int collect = (pline != NULL && searched == 0);
+        pv_line_t child_line;
+        child_line.length = 0;
+        int value;
+
+        if (in_place) {
+            if (!gd->make_move((void*)state, move, undo)) {
+                continue; /* mossa illegale: si passa alla successiva */
+            }
+            value = minimax_ab_pv(gd, state, depth - 1 - reduction, alpha, beta,
+                                  cache_handle, collect ? &child_line : NULL);
+            if (reduction > 0 &&
+                ((player == 1 && value > alpha) || (player == -1 && value < beta))) {
+                /* La mossa ridotta sembra buona: ricerca a profondità piena */
+                value = minimax_ab_pv(gd, state, depth - 1, alpha, beta,
+                                      cache_handle, NULL);
+            }
+            if (pline != NULL && !collect &&
+                ((player == 1 && value > best_value) ||
+                 (player == -1 && value < best_value))) {
+                /* Nuova miglior mossa in un nodo PV: raccogline la linea */
+                value = minimax_ab_pv(gd, state, depth - 1, alpha, beta,
+                                      cache_handle, &child_line);
+                collect = 1;
+            }
+            gd->unmake_move((void*)state, undo);
+        } else {
+            /* Applichiamo la mossa per ottenere un nuovo stato */
+            void *new_state = gd->apply_move(state, move);
+            if (new_state == NULL) {
+                TRACE_ERROR(&stdtrace, "Failed to apply move at index %d", i);
+                continue; /* Salta questa mossa in caso di errore */
+            }
+            value = minimax_ab_pv(gd, new_state, depth - 1 - reduction, alpha, beta,
+                                  cache_handle, collect ? &child_line : NULL);
+            if (reduction > 0 &&
+                ((player == 1 && value > alpha) || (player == -1 && value < beta))) {
+                value = minimax_ab_pv(gd, new_state, depth - 1, alpha, beta,
+                                      cache_handle, NULL);
+            }
+            if (pline != NULL && !collect &&
+                ((player == 1 && value > best_value) ||
+                 (player == -1 && value < best_value))) {
+                value = minimax_ab_pv(gd, new_state, depth - 1, alpha, beta,
+                                      cache_handle, &child_line);
+                collect = 1;
+            }
+            /* Libera lo stato generato */
+            gd->free_state(new_state);
+        }
+        searched++;
+
+        int improved = 0;
+
+        /* Aggiorna best_value e alpha/beta in base al tipo di giocatore */
+        if (player == 1) {
+            /* Massimizzatore */
+            if (value > best_value) {
+                best_value = value;
+                improved = 1;
+                TRACE_DEBUG(&stdtrace, "New best_value for MAX: %d", best_value);
+            }
+            if (best_value > alpha) {
+                alpha = best_value;
+                TRACE_DEBUG(&stdtrace, "Updated alpha to %d", alpha);
+            }
+        } else {
+            /* Minimizatore */
+            if (value < best_value) {
+                best_value = value;
+                improved = 1;
+                TRACE_DEBUG(&stdtrace, "New best_value for MIN: %d", best_value);
+            }
+            if (best_value < beta) {
+                beta = best_value;
+                TRACE_DEBUG(&stdtrace, "Updated beta to %d", beta);
+            }
+        }
+
+        if (improved) {
+            best_move_tt_idx = tt_move_key(gd, move);
+        }
+
+        /* Nei nodi PV la mossa migliore e la linea del figlio compongono
+         * la linea di questo nodo; la proprietà delle copie passa a pline. */
+        if (pline) {
+            if (improved) {
+                pv_line_reset(gd, pline);
+                pline->moves[0] = gd->copy_move(move);
+                pline->length = 1;
+                for (int k = 0; k < child_line.length &&
+                                pline->length < MAX_SEARCH_PLY; k++) {
+                    pline->moves[pline->length++] = child_line.moves[k];
+                    child_line.moves[k] = NULL;
+                }
+                /* le mosse rimaste (oltre MAX_SEARCH_PLY) vanno liberate */
+                for (int k = pline->length - 1; k < child_line.length; k++) {
+                    if (child_line.moves[k]) {
+                        gd->free_move(child_line.moves[k]);
+                    }
+                }
+                child_line.length = 0;
+            } else {
+                pv_line_reset(gd, &child_line);
+            }
+        }
+
+        /* Potatura */
+        if (alpha >= beta) {
+            TRACE_DEBUG(&stdtrace, "Alpha-beta cutoff: alpha=%d, beta=%d", alpha, beta);
+            search_stats.beta_cutoffs++;
+            if (searched == 1) {
+                search_stats.first_move_cutoffs++;
+            }
+            /* Aggiorna killer e history con la mossa che ha tagliato */
+            record_beta_cutoff(gd, state, move, depth);
+            break; /* esci dal ciclo: non serve analizzare altre mosse */
+        }
+    }
+
+    /* 6. Libera i vettori degli stadi generati (le tranquille possono non
+     *    esserlo mai state, se le catture hanno prodotto il taglio) */
+    if (cap_vec != NULL) {
+        gd->free_moves(cap_vec);
+    }
+    if (moves_vec != NULL) {
+        gd->free_moves(moves_vec);
+    }
+
+    /* 7. Determina il tipo di nodo per la cache */
+    NodeType node_type;
+    if (best_value <= alpha_orig) {
+        node_type = UPPER_BOUND;
+    } else if (best_value >= beta_orig) {
+        node_type = LOWER_BOUND;
+    } else {
+        node_type = EXACT;
+    }
+
+    /* 8. Memorizza in cache il risultato, se possibile.
+     *    Se la ricerca è stata abortita per scadenza del tempo, best_value è
+     *    frutto di sottoalberi incompleti e NON deve inquinare la cache. */
+    if (search_ttable != NULL && state_hash != 0 && !search_clock.aborted) {
+        minimax_tt_store(search_ttable, state_hash, best_value,
+                         depth, (int)node_type, best_move_tt_idx);
+    }
+    else if (cache_handle != NULL && !search_clock.aborted) {
+        minimax_cache_entry_t entry;
+        entry.value = best_value;
+        entry.depth = depth;
+        entry.type = node_type;
+        if (have_hash) {
+            cache_store_hashed(cache_handle, state, &entry, state_hash);
+        } else {
+            cache_store(cache_handle, state, &entry);
+        }
+        TRACE_DEBUG(&stdtrace, "Stored in cache at depth %d: value=%d, type=%d", depth, best_value, node_type);
+    }
+
+    return best_value;
+}
+
+/******************************************************************************
+ * Funzione: minimax_ab
+ ******************************************************************************/
+int minimax_ab(
+    const game_descriptor_t *gd,
+    const void *state,
+    int depth,
+    int alpha,
+    int beta,
+    void *cache_handle
+) {
+    /* Interfaccia storica: nessuna raccolta della variante principale */
+    return minimax_ab_pv(gd, state, depth, alpha, beta, cache_handle, NULL);
+}
+
+/******************************************************************************
+ * Funzione interna: search_root
+ *
+ * Esegue la ricerca al livello radice con la finestra [alpha, beta] indicata:
+ * per ogni mossa applica lo stato risultante e scende con minimax_ab.
+ * Restituisce il valore della posizione e, tramite best_move_out, una copia
+ * profonda della mossa migliore (o NULL se non ci sono mosse).
+ *
+ * È il "motore" comune a get_best_move e al driver di iterative deepening:
+ * quest'ultimo la invoca più volte con finestre di aspirazione strette.
+ ******************************************************************************/
+static int search_root(
+    const game_descriptor_t *gd,
+    const void *state,
+    int depth,
+    int alpha,
+    int beta,
+    void *cache_handle,
+    void **best_move_out,
+    pv_line_t *pline
+) {
+    *best_move_out = NULL;
+    if (pline) {
+        pline->length = 0;
+    }
+
+    /* Otteniamo il vettore di mosse disponibili */
+    dynamic_vector_t *moves_vec = gd->get_moves(state);
+    int num_moves = gd->get_num_moves(moves_vec);
+
+    if (num_moves == 0) {
+        /* Nessuna mossa disponibile => stato terminale di fatto */
+        TRACE_INFO(&stdtrace, "No available moves found in search_root.");
+        gd->free_moves(moves_vec);
+        return gd->evaluate(state);
+    }
+
+    /* Determiniamo il giocatore */
+    int player = gd->player_to_move(state);
+    int best_value = (player == 1) ? INT_MIN : INT_MAX;
+
+    /* Puntatore alla miglior mossa trovata */
+    void *best_move = NULL;
+
+    /* Fase di ordinamento anche alla radice */
+    void *ordered[MAX_ORDERED_MOVES];
+    size_t mv_stride;
+    const char *mv_flat = moves_flat_base(moves_vec, &mv_stride);
+    int use_ordered = order_moves(gd, state, moves_vec, mv_flat, mv_stride,
+                                  num_moves, depth, ordered);
+
+    /* Analizziamo ciascuna mossa */
+    for (int i = 0; i < num_moves; i++) {
+        /* Prendiamo la mossa i-esima (secondo l'ordine euristico, se attivo) */
+        void *move = use_ordered ? ordered[i] : move_at(gd, moves_vec, mv_flat, mv_stride, i);
+
+        /* Generiamo lo stato risultante */
+        void *new_state = gd->apply_move(state, move);
+        if (new_state == NULL) {
+            TRACE_ERROR(&stdtrace, "Failed to apply move at index %d in search_root.", i);
+            continue; /* Salta questa mossa in caso di errore */
+        }
+
+        /* Calcoliamo il valore con minimax (raccogliendo la linea del figlio
+         * se il chiamante ha richiesto la variante principale). Come nei
+         * nodi interni, solo la prima mossa viene cercata da nodo PV: per
+         * le successive la linea viene raccolta con una ricerca ripetuta
+         * solo quando migliorano davvero. */
+        int collect = (pline != NULL && best_move == NULL);
+        pv_line_t child_line;
+        child_line.length = 0;
+        int value = minimax_ab_pv(gd, new_state, depth - 1, alpha, beta,
+                                  cache_handle, collect ? &child_line : NULL);
+        if (pline != NULL && !collect &&
+            ((player == 1 && value > best_value) ||
+             (player == -1 && value < best_value))) {
+            value = minimax_ab_pv(gd, new_state, depth - 1, alpha, beta,
+                                  cache_handle, &child_line);
+        }
+        TRACE_INFO(&stdtrace, " - Move %d applied, minimax value=%d", i, value);
+
+        /* Libera lo stato transitorio */
+        gd->free_state(new_state);
+
+        int improved = 0;
+
+        /* Controlliamo se è migliore per il giocatore in questione */
+        if (player == 1) {
+            /* Massimizzatore */
+            if (value > best_value || best_move == NULL) {
+                best_value = value;
+                improved = 1;
+                /* Libera eventuale best_move precedente */
+                if (best_move) {
+                    gd->free_move(best_move);
+                }
+                /* Copia profonda della mossa corrente */
+                best_move = gd->copy_move(move);
+                TRACE_DEBUG(&stdtrace, "New best_move for MAX with value=%d", best_value);
+            }
+            if (best_value > alpha) {
+                alpha = best_value;
+                TRACE_DEBUG(&stdtrace, "Updated alpha to %d in search_root", alpha);
+            }
+        } else {
+            /* Minimizatore */
+            if (value < best_value || best_move == NULL) {
+                best_value = value;
+                improved = 1;
+                /* Libera eventuale best_move precedente */
+                if (best_move) {
+                    gd->free_move(best_move);
+                }
+                /* Copia profonda della mossa corrente */
+                best_move = gd->copy_move(move);
+                TRACE_DEBUG(&stdtrace, "New best_move for MIN with value=%d", best_value);
+            }
+            if (best_value < beta) {
+                beta = best_value;
+                TRACE_DEBUG(&stdtrace, "Updated beta to %d in search_root", beta);
+            }
+        }
+
+        /* Composizione della variante principale alla radice */
+        if (pline) {
+            if (improved) {
+                pv_line_reset(gd, pline);
+                pline->moves[0] = gd->copy_move(move);
+                pline->length = 1;
+                for (int k = 0; k < child_line.length &&
+                                pline->length < MAX_SEARCH_PLY; k++) {
+                    pline->moves[pline->length++] = child_line.moves[k];
+                    child_line.moves[k] = NULL;
+                }
+                for (int k = pline->length - 1; k < child_line.length; k++) {
+                    if (child_line.moves[k]) {
+                        gd->free_move(child_line.moves[k]);
+                    }
+                }
+                child_line.length = 0;
+            } else {
+                pv_line_reset(gd, &child_line);
+            }
+        }
+
+        /* Potatura */
+        if (alpha >= beta) {
+            TRACE_DEBUG(&stdtrace, "Alpha-beta cutoff in search_root: alpha=%d, beta=%d", alpha, beta);
+            break;
+        }
+    }
+
+    /* Libera il vettore di mosse */
+    gd->free_moves(moves_vec);
+
+    *best_move_out = best_move;
+    return best_value;
+}
+
+/******************************************************************************
+ * Sonda del libro di aperture.
+ *
+ * Se il descrittore espone la callback opzionale get_book_move, la consulta
+ * prima di avviare qualunque ricerca: su hit il driver restituisce la mossa
+ * (già allocata, di proprietà del chiamante) senza toccare tabelle né thread.
+ * `who` identifica il driver nella traccia.
+ ******************************************************************************/
+static void* probe_opening_book(
+    const game_descriptor_t *gd,
+    const void *state,
+    const char *who
+) {
+    if (gd->get_book_move == NULL) {
+        return NULL;
+    }
+    void *book_move = gd->get_book_move(state);
+    if (book_move != NULL) {
+        TRACE_INFO(&stdtrace, "%s: mossa dal libro di aperture, ricerca evitata", who);
+    }
+    return book_move;
+}
+
+/******************************************************************************
+ * Funzione: get_best_move
+ ******************************************************************************/
+void* get_best_move(
+    const game_descriptor_t *gd,
+    const void *state,
+    int depth,
+    void *cache_handle
+) {
+    /* Se lo stato è terminale, non ci sono mosse da restituire */
+    if (gd->is_terminal(state)) {
+        TRACE_INFO(&stdtrace, "get_best_move called on terminal state.");
+        return NULL;
+    }
+
+    /* Libro di aperture: su hit niente ricerca */
+    void *book_move = probe_opening_book(gd, state, "get_best_move");
+    if (book_move != NULL) {
+        return book_move;
+    }
+
+    /* Nuova ricerca dalla radice: azzera killer, history e statistiche
+     * e apri una nuova generazione nella transposition table */
+    reset_order_tables();
+    reset_search_stats();
+    minimax_tt_new_search(search_ttable);
+    long stats_start_ms = monotonic_ms();
+    stats_root_depth = depth;
+
+    /* Ricerca al livello radice con finestra piena */
+    void *best_move = NULL;
+    int best_value = search_root(gd, state, depth, INT_MIN, INT_MAX,
+                                 cache_handle, &best_move, NULL);
+
+    finalize_search_stats(stats_start_ms);
+
+    /* Restituisce la migliore mossa trovata (o NULL se non ci sono) */
+    if (best_move != NULL) {
+        TRACE_INFO(&stdtrace, "Best move found with value=%d", best_value);
+    } else {
+        TRACE_WARN(&stdtrace, "No best move found.");
+    }
+    return best_move;
+}
+
+/******************************************************************************
+ * Funzione: get_best_move_id_pv
+ *
+ * Driver di iterative deepening: esegue la ricerca a profondità crescente
+ * 1..max_depth, riutilizzando il punteggio dell'iterazione precedente per
+ * aprire una finestra di aspirazione stretta [guess-W, guess+W]. Se il valore
+ * reale cade fuori dalla finestra (fail-low / fail-high), la ricerca alla
+ * stessa profondità viene ripetuta con finestra piena.
+ *
+ * Le iterazioni poco profonde popolano la cache (transposition table), per
+ * cui le iterazioni successive risultano molto più veloci di una singola
+ * ricerca diretta alla profondità massima.
+ *
+ * Ogni iterazione raccoglie la propria variante principale: la PV viene
+ * usata come primo criterio di ordinamento nell'iterazione successiva
+ * (set_pv_hints) e, se pv_out non è NULL, quella dell'ultima iterazione
+ * completata viene restituita al chiamante.
+ ******************************************************************************/
+void* get_best_move_id_pv(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    void *cache_handle,
+    principal_variation_t *pv_out
+) {
+    if (pv_out) {
+        pv_out->length = 0;
+        pv_out->value = 0;
+    }
+
+    /* Se lo stato è terminale, non ci sono mosse da restituire */
+    if (gd->is_terminal(state)) {
+        TRACE_INFO(&stdtrace, "get_best_move_id_pv called on terminal state.");
+        return NULL;
+    }
+
+    /* Libro di aperture: su hit niente ricerca. La PV riportata è la sola
+     * mossa di libro (il libro non porta con sé la linea attesa). */
+    void *book_move = probe_opening_book(gd, state, "get_best_move_id_pv");
+    if (book_move != NULL) {
+        if (pv_out) {
+            pv_out->moves[0] = gd->copy_move(book_move);
+            pv_out->length = (pv_out->moves[0] != NULL) ? 1 : 0;
+        }
+        return book_move;
+    }
+
+    /* Nuova ricerca dalla radice: azzera killer, history, PV e statistiche
+     * e apri una nuova generazione nella transposition table */
+    reset_order_tables();
+    reset_search_stats();
+    minimax_tt_new_search(search_ttable);
+    long stats_start_ms = monotonic_ms();
+
+    void *best_move = NULL;   /* miglior mossa dell'ultima iterazione completata */
+    int   guess = 0;          /* punteggio dell'iterazione precedente */
+    int   have_guess = 0;     /* 1 dalla seconda iterazione in poi */
+
+    pv_line_t best_line;      /* PV dell'ultima iterazione completata */
+    best_line.length = 0;
+
+    for (int depth = 1; depth <= max_depth; depth++) {
+        int alpha, beta;
+        stats_root_depth = depth;
+
+        if (have_guess) {
+            /* Finestra di aspirazione centrata sul punteggio precedente */
+            alpha = guess - ASPIRATION_WINDOW;
+            beta  = guess + ASPIRATION_WINDOW;
+        } else {
+            /* Prima iterazione: finestra piena */
+            alpha = INT_MIN;
+            beta  = INT_MAX;
+        }
+
+        void *iter_move = NULL;
+        pv_line_t iter_line;
+        iter_line.length = 0;
+        int value = search_root(gd, state, depth, alpha, beta,
+                                cache_handle, &iter_move, &iter_line);
+
+        /* Fail-low o fail-high: il valore reale è fuori dalla finestra,
+         * ripetiamo la ricerca alla stessa profondità con finestra piena. */
+        if (have_guess && (value <= alpha || value >= beta)) {
+            TRACE_DEBUG(&stdtrace,
+                        "Aspiration re-search at depth %d: value=%d outside [%d, %d]",
+                        depth, value, alpha, beta);
+            if (iter_move) {
+                gd->free_move(iter_move);
+                iter_move = NULL;
+            }
+            pv_line_reset(gd, &iter_line);
+            value = search_root(gd, state, depth, INT_MIN, INT_MAX,
+                                cache_handle, &iter_move, &iter_line);
+        }
+
+        if (iter_move != NULL) {
+            /* L'iterazione ha prodotto una mossa: sostituisce la precedente */
+            if (best_move) {
+                gd->free_move(best_move);
+            }
+            best_move = iter_move;
+            guess = value;
+            have_guess = 1;
+
+            /* La PV completata guida l'ordinamento dell'iterazione successiva */
+            set_pv_hints(gd, &iter_line, depth);
+            pv_line_reset(gd, &best_line);
+            best_line = iter_line;
+            iter_line.length = 0; /* proprietà trasferita a best_line */
+
+            TRACE_INFO(&stdtrace, "Iteration depth=%d completed, value=%d", depth, value);
+            report_search_progress(depth, value, &best_line, stats_start_ms);
+        } else {
+            pv_line_reset(gd, &iter_line);
+        }
+    }
+
+    finalize_search_stats(stats_start_ms);
+
+    if (pv_out) {
+        /* La proprietà delle copie della PV passa al chiamante */
+        for (int i = 0; i < best_line.length; i++) {
+            pv_out->moves[i] = best_line.moves[i];
+        }
+        pv_out->length = best_line.length;
+        pv_out->value = guess;
+        best_line.length = 0;
+    } else {
+        pv_line_reset(gd, &best_line);
+    }
+
+    if (best_move == NULL) {
+        TRACE_WARN(&stdtrace, "No best move found in get_best_move_id_pv.");
+    }
+    return best_move;
+}
+
+/******************************************************************************
+ * Funzione: get_best_move_id
+ ******************************************************************************/
+void* get_best_move_id(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    void *cache_handle
+) {
+    /* Interfaccia storica: la PV viene comunque usata per l'ordinamento
+     * tra un'iterazione e l'altra, ma non restituita al chiamante. */
+    return get_best_move_id_pv(gd, state, max_depth, cache_handle, NULL);
+}
+
+/******************************************************************************
+ * Ricerca Multi-PV: le K migliori mosse radice in una sola passata
+ *
+ * Per i carichi di analisi servono le prime K mosse con punteggio e linea,
+ * non solo la migliore. Il trucco che rende la passata unica quasi gratuita
+ * rispetto a una ricerca normale è la soglia: finché i candidati sono meno
+ * di K ogni mossa va valutata esattamente, ma una volta pieno il "podio" la
+ * finestra di ogni mossa successiva parte dal punteggio del K-esimo
+ * classificato. Le mosse che non possono entrare in classifica falliscono
+ * la finestra quasi subito; solo quelle che la superano vengono ricercate
+ * una seconda volta con il collettore per raccoglierne la linea (economico:
+ * il sottoalbero è appena stato messo in cache).
+ ******************************************************************************/
+typedef struct {
+    int       value;  /* punteggio esatto del candidato */
+    pv_line_t line;   /* linea completa, mossa radice inclusa (moves[0]) */
+} multipv_entry_t;
+
+/*
+ * Inserisce un candidato nella classifica ordinata (migliore per primo dal
+ * punto di vista del giocatore di turno), scartando l'eventuale ultimo.
+ */
+static void multipv_insert(const game_descriptor_t *gd,
+                           multipv_entry_t *entries, int *count, int k,
+                           int player, int value, pv_line_t *line) {
+    int pos = *count;
+    while (pos > 0 &&
+           (player == 1 ? value > entries[pos - 1].value
+                        : value < entries[pos - 1].value)) {
+        pos--;
+    }
+    if (pos >= k) {
+        pv_line_reset(gd, line);
+        return;
+    }
+
+    if (*count == k) {
+        /* Classifica piena: l'ultimo esce */
+        pv_line_reset(gd, &entries[k - 1].line);
+    } else {
+        (*count)++;
+    }
+    for (int j = *count - 1; j > pos; j--) {
+        entries[j] = entries[j - 1];
+    }
+    entries[pos].value = value;
+    entries[pos].line = *line;
+    line->length = 0;  /* proprietà trasferita */
+}
+
+/*
+ * Una passata Multi-PV alla radice per una data profondità: riempie al più
+ * k voci in entries (ordinate) e ritorna il loro numero.
+ */
+static int multipv_root(
+    const game_descriptor_t *gd,
+    const void *state,
+    int depth,
+    int k,
+    void *cache_handle,
+    multipv_entry_t *entries
+) {
+    dynamic_vector_t *moves_vec = gd->get_moves(state);
+    int num_moves = gd->get_num_moves(moves_vec);
+    if (num_moves == 0) {
+        gd->free_moves(moves_vec);
+        return 0;
+    }
+
+    int player = gd->player_to_move(state);
+    int count = 0;
+
+    void *ordered[MAX_ORDERED_MOVES];
+    size_t mv_stride;
+    const char *mv_flat = moves_flat_base(moves_vec, &mv_stride);
+    int use_ordered = order_moves(gd, state, moves_vec, mv_flat, mv_stride,
+                                  num_moves, depth, ordered);
+
+    for (int i = 0; i < num_moves; i++) {
+        void *move = use_ordered ? ordered[i] : move_at(gd, moves_vec, mv_flat, mv_stride, i);
+
+        /* Finestra: piena finché il podio non è completo, poi delimitata dal
+         * punteggio del K-esimo (il candidato deve fare strettamente meglio) */
+        int alpha = INT_MIN;
+        int beta  = INT_MAX;
+        if (count == k) {
+            if (player == 1) {
+                alpha = entries[k - 1].value;
+            } else {
+                beta = entries[k - 1].value;
+            }
+        }
+
+        void *new_state = gd->apply_move(state, move);
+        if (new_state == NULL) {
+            TRACE_ERROR(&stdtrace, "multipv: apply_move fallita sulla mossa %d", i);
+            continue;
+        }
+
+        int value = minimax_ab_pv(gd, new_state, depth - 1, alpha, beta,
+                                  cache_handle, NULL);
+
+        int enters = (count < k) ||
+                     (player == 1 ? value > alpha : value < beta);
+
+        if (enters && !search_clock.aborted) {
+            /* Il candidato entra in classifica: seconda ricerca con il
+             * collettore per raccoglierne la linea (sulla cache calda) */
+            pv_line_t child_line;
+            child_line.length = 0;
+            value = minimax_ab_pv(gd, new_state, depth - 1, alpha, beta,
+                                  cache_handle, &child_line);
+
+            /* Il valore può assestarsi: dev'essere ancora da classifica */
+            if (count < k || (player == 1 ? value > alpha : value < beta)) {
+                pv_line_t full_line;
+                full_line.length = 0;
+                full_line.moves[0] = gd->copy_move(move);
+                full_line.length = 1;
+                for (int m = 0; m < child_line.length &&
+                                full_line.length < MAX_SEARCH_PLY; m++) {
+                    full_line.moves[full_line.length++] = child_line.moves[m];
+                    child_line.moves[m] = NULL;
+                }
+                for (int m = full_line.length - 1; m < child_line.length; m++) {
+                    if (child_line.moves[m]) {
+                        gd->free_move(child_line.moves[m]);
+                    }
+                }
+                child_line.length = 0;
+                multipv_insert(gd, entries, &count, k, player, value, &full_line);
+            } else {
+                pv_line_reset(gd, &child_line);
+            }
+        }
+
+        gd->free_state(new_state);
+
+        if (search_should_abort()) {
+            break;
+        }
+    }
+
+    gd->free_moves(moves_vec);
+    return count;
+}
+
+/******************************************************************************
+ * Funzione: get_best_move_multipv
+ ******************************************************************************/
+int get_best_move_multipv(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    int multipv,
+    void *cache_handle,
+    principal_variation_t *pv_out
+) {
+    if (pv_out == NULL || multipv <= 0) {
+        return 0;
+    }
+    if (gd->is_terminal(state)) {
+        TRACE_INFO(&stdtrace, "get_best_move_multipv called on terminal state.");
+        return 0;
+    }
+    if (max_depth <= 0) {
+        max_depth = MAX_DEPTH;
+    }
+    if (multipv > MAX_ORDERED_MOVES) {
+        multipv = MAX_ORDERED_MOVES;
+    }
+
+    multipv_entry_t *entries = (multipv_entry_t*)
+        malloc(multipv * sizeof(multipv_entry_t));
+    if (entries == NULL) {
+        TRACE_ERROR(&stdtrace, "get_best_move_multipv: allocazione fallita");
+        return 0;
+    }
+
+    reset_order_tables();
+    reset_search_stats();
+    minimax_tt_new_search(search_ttable);
+    long stats_start_ms = monotonic_ms();
+
+    int count = 0;
+
+    for (int depth = 1; depth <= max_depth; depth++) {
+        stats_root_depth = depth;
+
+        multipv_entry_t *iter_entries = (multipv_entry_t*)
+            malloc(multipv * sizeof(multipv_entry_t));
+        if (iter_entries == NULL) {
+            break;
+        }
+
+        int iter_count = multipv_root(gd, state, depth, multipv,
+                                      cache_handle, iter_entries);
+
+        if (iter_count > 0) {
+            /* L'iterazione completata sostituisce la precedente */
+            for (int i = 0; i < count; i++) {
+                pv_line_reset(gd, &entries[i].line);
+            }
+            free(entries);
+            entries = iter_entries;
+            count = iter_count;
+
+            /* La linea migliore guida l'ordinamento della prossima iterazione */
+            set_pv_hints(gd, &entries[0].line, depth);
+            TRACE_INFO(&stdtrace, "multipv: profondità %d, %d linee, migliore=%d",
+                       depth, count, entries[0].value);
+        } else {
+            free(iter_entries);
+        }
+    }
+
+    finalize_search_stats(stats_start_ms);
+
+    /* Trasferimento delle linee al chiamante (da liberare con pv_free) */
+    for (int i = 0; i < count; i++) {
+        pv_out[i].length = entries[i].line.length;
+        pv_out[i].value = entries[i].value;
+        for (int m = 0; m < entries[i].line.length; m++) {
+            pv_out[i].moves[m] = entries[i].line.moves[m];
+        }
+        entries[i].line.length = 0;
+    }
+    free(entries);
+
+    if (count == 0) {
+        TRACE_WARN(&stdtrace, "No lines found in get_best_move_multipv.");
+    }
+    return count;
+}
+
+/******************************************************************************
+ * Funzione: pv_free
+ ******************************************************************************/
+void pv_free(const game_descriptor_t *gd, principal_variation_t *pv) {
+    if (pv == NULL) {
+        return;
+    }
+    for (int i = 0; i < pv->length; i++) {
+        gd->free_move(pv->moves[i]);
+    }
+    pv->length = 0;
+}
+
+/******************************************************************************
+ * Funzione: get_best_move_timed
+ *
+ * Iterative deepening governato da due scadenze in millisecondi:
+ *  - soft_ms: superata la soglia non vengono avviate nuove iterazioni;
+ *  - hard_ms: superata la soglia la ricerca in corso viene abortita
+ *    (controllo ogni TIME_CHECK_INTERVAL nodi dentro minimax_ab).
+ *
+ * Viene restituita la mossa dell'ultima iterazione COMPLETATA; i risultati
+ * parziali di un'iterazione abortita vengono scartati.
+ ******************************************************************************/
+void* get_best_move_timed(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    long soft_ms,
+    long hard_ms,
+    void *cache_handle
+) {
+    /* Se lo stato è terminale, non ci sono mosse da restituire */
+    if (gd->is_terminal(state)) {
+        TRACE_INFO(&stdtrace, "get_best_move_timed called on terminal state.");
+        return NULL;
+    }
+
+    /* Libro di aperture: su hit niente ricerca (e niente budget consumato) */
+    void *book_move = probe_opening_book(gd, state, "get_best_move_timed");
+    if (book_move != NULL) {
+        return book_move;
+    }
+
+    /* Nuova ricerca dalla radice: azzera killer, history e statistiche
+     * e apri una nuova generazione nella transposition table */
+    reset_order_tables();
+    reset_search_stats();
+    minimax_tt_new_search(search_ttable);
+
+    if (max_depth <= 0) {
+        max_depth = MAX_DEPTH;
+    }
+    if (hard_ms < soft_ms) {
+        hard_ms = soft_ms;
+    }
+
+    /* Avvio del cronometro condiviso con minimax_ab */
+    long start_ms = monotonic_ms();
+    search_clock.active = 1;
+    search_clock.aborted = 0;
+    search_clock.nodes = 0;
+    search_clock.hard_deadline_ms = start_ms + hard_ms;
+    search_clock.stop_flag = NULL;
+
+    void *best_move = NULL;   /* miglior mossa dell'ultima iterazione completata */
+    int   guess = 0;          /* punteggio dell'iterazione precedente */
+    int   have_guess = 0;     /* 1 dalla seconda iterazione in poi */
+
+    for (int depth = 1; depth <= max_depth; depth++) {
+        int alpha, beta;
+        stats_root_depth = depth;
+
+        if (have_guess) {
+            alpha = guess - ASPIRATION_WINDOW;
+            beta  = guess + ASPIRATION_WINDOW;
+        } else {
+            alpha = INT_MIN;
+            beta  = INT_MAX;
+        }
+
+        void *iter_move = NULL;
+        pv_line_t iter_line;
+        iter_line.length = 0;
+        int value = search_root(gd, state, depth, alpha, beta,
+                                cache_handle, &iter_move, &iter_line);
+
+        /* Fail-low / fail-high: ripetiamo con finestra piena (se c'è tempo) */
+        if (!search_clock.aborted && have_guess &&
+            (value <= alpha || value >= beta)) {
+            TRACE_DEBUG(&stdtrace,
+                        "Aspiration re-search at depth %d: value=%d outside [%d, %d]",
+                        depth, value, alpha, beta);
+            if (iter_move) {
+                gd->free_move(iter_move);
+                iter_move = NULL;
+            }
+            pv_line_reset(gd, &iter_line);
+            value = search_root(gd, state, depth, INT_MIN, INT_MAX,
+                                cache_handle, &iter_move, &iter_line);
+        }
+
+        if (search_clock.aborted) {
+            /* Iterazione incompleta: scartiamo tutto ciò che ha prodotto */
+            if (iter_move) {
+                gd->free_move(iter_move);
+            }
+            pv_line_reset(gd, &iter_line);
+            TRACE_INFO(&stdtrace,
+                       "Search aborted at depth %d after %ld ms (%lu nodes)",
+                       depth, monotonic_ms() - start_ms, search_clock.nodes);
+            break;
+        }
+
+        if (iter_move != NULL) {
+            if (best_move) {
+                gd->free_move(best_move);
+            }
+            best_move = iter_move;
+            guess = value;
+            have_guess = 1;
+
+            /* La PV completata guida l'ordinamento dell'iterazione successiva */
+            set_pv_hints(gd, &iter_line, depth);
+            TRACE_INFO(&stdtrace, "Iteration depth=%d completed, value=%d", depth, value);
+            report_search_progress(depth, value, &iter_line, start_ms);
+        }
+        pv_line_reset(gd, &iter_line);
+
+        /* Scadenza morbida: non avviamo una nuova iterazione */
+        if (monotonic_ms() - start_ms >= soft_ms) {
+            TRACE_INFO(&stdtrace,
+                       "Soft deadline reached after depth %d (%ld ms elapsed)",
+                       depth, monotonic_ms() - start_ms);
+            break;
+        }
+    }
+
+    /* Arresto del cronometro */
+    search_clock.active = 0;
+    search_clock.aborted = 0;
+
+    finalize_search_stats(start_ms);
+
+    if (best_move == NULL) {
+        TRACE_WARN(&stdtrace, "No best move found in get_best_move_timed.");
+    }
+    return best_move;
+}
+
+/******************************************************************************
+ * Funzione: get_best_move_stoppable
+ *
+ * Iterative deepening interrompibile da un flag esterno: stessa struttura di
+ * get_best_move_timed ma senza scadenze temporali — il cronometro condiviso
+ * con minimax_ab legge solo stop_flag (ogni TIME_CHECK_INTERVAL nodi).
+ * Pensata per ospitare la ricerca in un thread worker: il thread
+ * dell'interfaccia alza il flag e la funzione ritorna in pochi millisecondi
+ * con la mossa dell'ultima iterazione completata.
+ ******************************************************************************/
+void* get_best_move_stoppable(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    volatile int *stop_flag,
+    void *cache_handle
+) {
+    /* Se lo stato è terminale, non ci sono mosse da restituire */
+    if (gd->is_terminal(state)) {
+        TRACE_INFO(&stdtrace, "get_best_move_stoppable called on terminal state.");
+        return NULL;
+    }
+
+    /* Libro di aperture: su hit niente ricerca */
+    void *book_move = probe_opening_book(gd, state, "get_best_move_stoppable");
+    if (book_move != NULL) {
+        return book_move;
+    }
+
+    /* Nuova ricerca dalla radice: azzera killer, history e statistiche
+     * e apri una nuova generazione nella transposition table */
+    reset_order_tables();
+    reset_search_stats();
+    minimax_tt_new_search(search_ttable);
+
+    if (max_depth <= 0) {
+        max_depth = MAX_DEPTH;
+    }
+
+    /* Cronometro condiviso con minimax_ab: solo flag esterno, nessuna
+     * scadenza temporale */
+    long start_ms = monotonic_ms();
+    search_clock.active = 1;
+    search_clock.aborted = 0;
+    search_clock.nodes = 0;
+    search_clock.hard_deadline_ms = 0;
+    search_clock.stop_flag = stop_flag;
+
+    void *best_move = NULL;   /* miglior mossa dell'ultima iterazione completata */
+    int   guess = 0;          /* punteggio dell'iterazione precedente */
+    int   have_guess = 0;     /* 1 dalla seconda iterazione in poi */
+
+    for (int depth = 1; depth <= max_depth; depth++) {
+        int alpha, beta;
+        stats_root_depth = depth;
+
+        if (have_guess) {
+            alpha = guess - ASPIRATION_WINDOW;
+            beta  = guess + ASPIRATION_WINDOW;
+        } else {
+            alpha = INT_MIN;
+            beta  = INT_MAX;
+        }
+
+        void *iter_move = NULL;
+        pv_line_t iter_line;
+        iter_line.length = 0;
+        int value = search_root(gd, state, depth, alpha, beta,
+                                cache_handle, &iter_move, &iter_line);
+
+        /* Fail-low / fail-high: ripetiamo con finestra piena */
+        if (!search_clock.aborted && have_guess &&
+            (value <= alpha || value >= beta)) {
+            TRACE_DEBUG(&stdtrace,
+                        "Aspiration re-search at depth %d: value=%d outside [%d, %d]",
+                        depth, value, alpha, beta);
+            if (iter_move) {
+                gd->free_move(iter_move);
+                iter_move = NULL;
+            }
+            pv_line_reset(gd, &iter_line);
+            value = search_root(gd, state, depth, INT_MIN, INT_MAX,
+                                cache_handle, &iter_move, &iter_line);
+        }
+
+        if (search_clock.aborted) {
+            /* Iterazione incompleta: scartiamo tutto ciò che ha prodotto */
+            if (iter_move) {
+                gd->free_move(iter_move);
+            }
+            pv_line_reset(gd, &iter_line);
+            TRACE_INFO(&stdtrace,
+                       "Search stopped at depth %d after %ld ms (%lu nodes)",
+                       depth, monotonic_ms() - start_ms, search_clock.nodes);
+            break;
+        }
+
+        if (iter_move != NULL) {
+            if (best_move) {
+                gd->free_move(best_move);
+            }
+            best_move = iter_move;
+            guess = value;
+            have_guess = 1;
+
+            /* La PV completata guida l'ordinamento dell'iterazione successiva */
+            set_pv_hints(gd, &iter_line, depth);
+            TRACE_INFO(&stdtrace, "Iteration depth=%d completed, value=%d", depth, value);
+            report_search_progress(depth, value, &iter_line, start_ms);
+        }
+        pv_line_reset(gd, &iter_line);
+    }
+
+    /* Arresto del cronometro */
+    search_clock.active = 0;
+    search_clock.aborted = 0;
+    search_clock.stop_flag = NULL;
+
+    finalize_search_stats(start_ms);
+
+    if (best_move == NULL) {
+        TRACE_WARN(&stdtrace, "No best move found in get_best_move_stoppable.");
+    }
+    return best_move;
+}
+
+/******************************************************************************
+ * Ricerca parallela "Lazy SMP"
+ *
+ * Tutti i worker cercano la STESSA posizione radice a profondità scaglionate,
+ * condividendo la transposition table: i worker di supporto non producono
+ * direttamente la mossa, ma riempiono la cache di risultati che accelerano
+ * il worker principale. Il worker 0 esegue il normale iterative deepening e
+ * il suo risultato è quello restituito; al suo completamento viene alzato un
+ * flag di stop che i worker di supporto controllano tra un'iterazione e
+ * l'altra.
+ ******************************************************************************/
+typedef struct {
+    const game_descriptor_t *gd;           /* descrittore di gioco condiviso */
+    void                    *state;        /* copia privata dello stato radice */
+    int                      max_depth;    /* profondità massima di ricerca */
+    int                      worker_id;    /* 0 = principale, >0 = supporto */
+    void                    *cache_handle; /* transposition table condivisa */
+    volatile int            *stop;         /* flag di stop condiviso */
+    void                    *best_move;    /* risultato (solo worker 0) */
+} smp_worker_t;
+
+static void* smp_worker_main(void *arg) {
+    smp_worker_t *w = (smp_worker_t*)arg;
+    const game_descriptor_t *gd = w->gd;
+
+    /* Tabelle di ordinamento thread-local: vanno azzerate per ogni worker */
+    reset_order_tables();
+
+    /* Scaglionamento: i worker dispari partono una profondità più avanti,
+     * così i livelli vengono riempiti in cache in ordine leggermente diverso
+     * e i worker non ripetono tutti lo stesso lavoro nello stesso istante. */
+    int start_depth = 1 + (w->worker_id % 2);
+
+    int guess = 0;
+    int have_guess = 0;
+
+    for (int depth = start_depth; depth <= w->max_depth; depth++) {
+        if (*(w->stop)) {
+            break;
+        }
+
+        int alpha, beta;
+        if (have_guess) {
+            alpha = guess - ASPIRATION_WINDOW;
+            beta  = guess + ASPIRATION_WINDOW;
+        } else {
+            alpha = INT_MIN;
+            beta  = INT_MAX;
+        }
+
+        void *iter_move = NULL;
+        int value = search_root(gd, w->state, depth, alpha, beta,
+                                w->cache_handle, &iter_move, NULL);
+
+        if (have_guess && (value <= alpha || value >= beta)) {
+            if (iter_move) {
+                gd->free_move(iter_move);
+                iter_move = NULL;
+            }
+            value = search_root(gd, w->state, depth, INT_MIN, INT_MAX,
+                                w->cache_handle, &iter_move, NULL);
+        }
+
+        if (iter_move != NULL) {
+            if (w->worker_id == 0) {
+                /* Solo il worker principale conserva la mossa migliore */
+                if (w->best_move) {
+                    gd->free_move(w->best_move);
+                }
+                w->best_move = iter_move;
+            } else {
+                gd->free_move(iter_move);
+            }
+            guess = value;
+            have_guess = 1;
+        }
+    }
+
+    /* Il completamento del worker principale ferma anche i worker di supporto */
+    if (w->worker_id == 0) {
+        *(w->stop) = 1;
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * Funzione: get_best_move_parallel
+ ******************************************************************************/
+void* get_best_move_parallel(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    int num_threads,
+    void *cache_handle
+) {
+    /* Se lo stato è terminale, non ci sono mosse da restituire */
+    if (gd->is_terminal(state)) {
+        TRACE_INFO(&stdtrace, "get_best_move_parallel called on terminal state.");
+        return NULL;
+    }
+
+    /* Libro di aperture: su hit niente ricerca (e niente worker da avviare) */
+    void *book_move = probe_opening_book(gd, state, "get_best_move_parallel");
+    if (book_move != NULL) {
+        return book_move;
+    }
+
+    if (num_threads <= 1) {
+        /* Con un solo thread la modalità parallela coincide con l'ID seriale */
+        return get_best_move_id(gd, state, max_depth, cache_handle);
+    }
+
+    /* La cache condivisa DEVE essere in modalità thread-safe */
+    if (cache_handle != NULL) {
+        cache_set_thread_safe((generic_hash_table_t*)cache_handle, 1);
+    }
+
+    volatile int stop = 0;
+
+    smp_worker_t *workers = (smp_worker_t*) malloc(num_threads * sizeof(smp_worker_t));
+    pthread_t *threads = (pthread_t*) malloc(num_threads * sizeof(pthread_t));
+    if (!workers || !threads) {
+        TRACE_ERROR(&stdtrace, "get_best_move_parallel: allocazione worker fallita");
+        free(workers);
+        free(threads);
+        return get_best_move_id(gd, state, max_depth, cache_handle);
+    }
+
+    int started = 0;
+    for (int i = 0; i < num_threads; i++) {
+        workers[i].gd = gd;
+        workers[i].state = gd->copy_state(state);  /* copia privata per thread */
+        workers[i].max_depth = max_depth;
+        workers[i].worker_id = i;
+        workers[i].cache_handle = cache_handle;
+        workers[i].stop = &stop;
+        workers[i].best_move = NULL;
+
+        if (workers[i].state == NULL ||
+            pthread_create(&threads[i], NULL, smp_worker_main, &workers[i]) != 0) {
+            TRACE_ERROR(&stdtrace, "get_best_move_parallel: avvio worker %d fallito", i);
+            if (workers[i].state) {
+                gd->free_state(workers[i].state);
+            }
+            break;
+        }
+        started++;
+    }
+
+    /* Attesa di tutti i worker avviati */
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* Il risultato è quello del worker principale */
+    void *best_move = (started > 0) ? workers[0].best_move : NULL;
+
+    for (int i = 0; i < started; i++) {
+        gd->free_state(workers[i].state);
+    }
+    free(workers);
+    free(threads);
+
+    if (best_move == NULL) {
+        TRACE_WARN(&stdtrace, "No best move found in get_best_move_parallel.");
+        /* Nessun worker avviato: ripieghiamo sulla ricerca seriale */
+        if (started == 0) {
+            return get_best_move_id(gd, state, max_depth, cache_handle);
+        }
+    }
+    return best_move;
+}
+
+/******************************************************************************
+ * Parallelismo YBWC ("young brothers wait") alla radice
+ *
+ * A differenza della modalità Lazy SMP — dove ogni worker ripete l'intera
+ * ricerca e la condivisione avviene solo attraverso la cache — qui l'albero
+ * viene davvero spartito. Lo schema segue il principio YBWC applicato al
+ * nodo radice:
+ *
+ *  1. la PRIMA mossa (il "fratello maggiore") viene cercata serialmente a
+ *     finestra piena: stabilisce un buon valore di alpha, senza il quale i
+ *     fratelli verrebbero cercati con finestre inutilmente larghe;
+ *  2. le mosse rimanenti vengono pubblicate come split point: un contatore
+ *     protetto da mutex da cui i worker "rubano" la prossima mossa da
+ *     cercare, leggendo la finestra (alpha, beta) condivisa più stretta
+ *     disponibile in quel momento;
+ *  3. un fail-high alla radice (possibile con le finestre di aspirazione)
+ *     alza un flag di stop che i worker leggono ogni TIME_CHECK_INTERVAL
+ *     nodi tramite il cronometro thread-local: il lavoro rubato viene
+ *     abortito invece di completare sottoalberi ormai inutili.
+ *
+ * Ogni worker lavora su una copia privata dello stato radice (copy_state)
+ * con killer/history thread-local propri; la transposition table è l'unica
+ * struttura condivisa con la ricerca e viene messa in modalità thread-safe.
  ******************************************************************************/
-int minimax_ab(
-    const game_descriptor_t *gd,
-    const void *state,
-    int depth,
-    int alpha,
-    int beta,
-    void *cache_handle
-) {
-    int alpha_orig = alpha;
-    int beta_orig = beta;
+typedef struct {
+    const game_descriptor_t *gd;          /* descrittore di gioco condiviso */
+    void            *root_state;          /* copia privata dello stato radice */
+    void           **moves;               /* mosse della radice (condivise, sola lettura) */
+    int              num_moves;           /* numero di mosse pubblicate */
+    int              depth;               /* profondità di ricerca dell'iterazione */
+    int              player;              /* giocatore alla radice */
+    void            *cache_handle;        /* transposition table condivisa */
+    pthread_mutex_t *lock;                /* protegge indice, finestra e risultato */
+    int             *next_index;          /* prossima mossa da rubare */
+    int             *alpha;               /* finestra condivisa (sotto lock) */
+    int             *beta;
+    int             *best_value;          /* miglior valore trovato (sotto lock) */
+    int             *best_index;          /* indice della mossa migliore (sotto lock) */
+    volatile int    *stop;                /* propagazione del taglio */
+} ybwc_split_t;
 
-    /* 1. Se abbiamo una cache, proviamo a recuperare un valore memorizzato */
-    if (cache_handle != NULL) {
-        minimax_cache_entry_t *cached_val = (minimax_cache_entry_t*) cache_lookup(cache_handle, state);
-        if (cached_val != NULL && cached_val->depth >= depth) {
-            TRACE_DEBUG(&stdtrace, "Cache hit at depth %d: value=%d, type=%d", depth, cached_val->value, cached_val->type);
-            if (cached_val->type == EXACT) {
-                return cached_val->value;
-            } else if (cached_val->type == LOWER_BOUND) {
-                if (cached_val->value > alpha) {
-                    alpha = cached_val->value;
-                }
-            } else if (cached_val->type == UPPER_BOUND) {
-                if (cached_val->value < beta) {
-                    beta = cached_val->value;
-                }
+/*
+ * Ciclo di "furto" delle mosse dello split point: preleva la prossima mossa
+ * sotto lock insieme a uno snapshot della finestra corrente, la cerca, e
+ * riporta il risultato sotto lock aggiornando finestra e miglior mossa.
+ * Usato sia dai worker sia dal thread principale (che partecipa al furto
+ * invece di restare in attesa).
+ */
+static void ybwc_steal_loop(ybwc_split_t *sp) {
+    const game_descriptor_t *gd = sp->gd;
+
+    for (;;) {
+        int idx, a, b;
+
+        pthread_mutex_lock(sp->lock);
+        if (*(sp->stop) || *(sp->next_index) >= sp->num_moves) {
+            pthread_mutex_unlock(sp->lock);
+            return;
+        }
+        idx = (*(sp->next_index))++;
+        a = *(sp->alpha);
+        b = *(sp->beta);
+        pthread_mutex_unlock(sp->lock);
+
+        void *new_state = gd->apply_move(sp->root_state, sp->moves[idx]);
+        if (new_state == NULL) {
+            TRACE_ERROR(&stdtrace, "ybwc: apply_move fallita sulla mossa %d", idx);
+            continue;
+        }
+        int value = minimax_ab_pv(gd, new_state, sp->depth - 1, a, b,
+                                  sp->cache_handle, NULL);
+        gd->free_state(new_state);
+
+        /* Un sottoalbero abortito (stop o scadenza) non produce un valore
+         * affidabile: non deve toccare il risultato condiviso */
+        if (search_clock.aborted) {
+            return;
+        }
+
+        pthread_mutex_lock(sp->lock);
+        if (sp->player == 1) {
+            if (value > *(sp->best_value)) {
+                *(sp->best_value) = value;
+                *(sp->best_index) = idx;
             }
-            if (alpha >= beta) {
-                TRACE_DEBUG(&stdtrace, "Alpha-beta cutoff after cache retrieval: alpha=%d, beta=%d", alpha, beta);
-                return cached_val->value;
+            if (*(sp->best_value) > *(sp->alpha)) {
+                *(sp->alpha) = *(sp->best_value);
             }
         } else {
-            TRACE_DEBUG(&stdtrace, "Cache miss at depth %d", depth);
+            if (value < *(sp->best_value)) {
+                *(sp->best_value) = value;
+                *(sp->best_index) = idx;
+            }
+            if (*(sp->best_value) < *(sp->beta)) {
+                *(sp->beta) = *(sp->best_value);
+            }
         }
+        if (*(sp->alpha) >= *(sp->beta)) {
+            /* Taglio alla radice: ferma anche il lavoro già rubato */
+            *(sp->stop) = 1;
+        }
+        pthread_mutex_unlock(sp->lock);
     }
+}
 
-    /* 2. Se lo stato è terminale o abbiamo raggiunto la profondità massima, valuta e ritorna. */
-    if (gd->is_terminal(state) || depth == 0) {
-        int eval = gd->evaluate(state);
+static void* ybwc_worker_main(void *arg) {
+    ybwc_split_t *sp = (ybwc_split_t*)arg;
 
-        /* Memorizza in cache, se disponibile */
-        if (cache_handle != NULL) {
-            minimax_cache_entry_t entry;
-            entry.value = eval;
-            entry.depth = depth;
-            entry.type = EXACT;
-            cache_store(cache_handle, state, &entry);
-            TRACE_DEBUG(&stdtrace, "Stored in cache at depth %d: value=%d, type=EXACT", depth, eval);
-        }
-        return eval;
-    }
+    /* Tabelle di ordinamento e cronometro propri del worker */
+    reset_order_tables();
+    search_clock.active = 1;
+    search_clock.aborted = 0;
+    search_clock.nodes = 0;
+    search_clock.hard_deadline_ms = 0;
+    search_clock.stop_flag = sp->stop;
+
+    ybwc_steal_loop(sp);
+
+    search_clock.active = 0;
+    search_clock.aborted = 0;
+    search_clock.stop_flag = NULL;
+    return NULL;
+}
+
+/*
+ * Una singola iterazione YBWC: primo fratello seriale, poi split point
+ * sulle mosse rimanenti. Ritorna il valore della radice e scrive in
+ * *best_move_out la copia della mossa migliore (o NULL).
+ */
+static int ybwc_search_iteration(
+    const game_descriptor_t *gd,
+    const void *state,
+    int depth,
+    int alpha0,
+    int beta0,
+    int num_threads,
+    void *cache_handle,
+    void **best_move_out
+) {
+    *best_move_out = NULL;
 
-    /* 3. Otteniamo il vettore dinamico di mosse disponibili */
     dynamic_vector_t *moves_vec = gd->get_moves(state);
     int num_moves = gd->get_num_moves(moves_vec);
-
-    /* Se non ci sono mosse, consideriamo lo stato come terminale di fatto */
     if (num_moves == 0) {
-        int eval = gd->evaluate(state);
-        if (cache_handle != NULL) {
-            minimax_cache_entry_t entry;
-            entry.value = eval;
-            entry.depth = depth;
-            entry.type = EXACT;
-            cache_store(cache_handle, state, &entry);
-            TRACE_DEBUG(&stdtrace, "Stored in cache at depth %d: value=%d, type=EXACT (no available moves)", depth, eval);
-        }
-        /* Non dimentichiamo di liberare il vettore */
         gd->free_moves(moves_vec);
-        return eval;
+        return gd->evaluate(state);
     }
 
-    /* 4. Determiniamo se il giocatore è massimizzatore (1) o minimizzatore (-1) */
     int player = gd->player_to_move(state);
-    int best_value = (player == 1) ? INT_MIN : INT_MAX;
 
-    /* 5. Cicliamo sulle mosse */
-    for (int i = 0; i < num_moves; i++) {
-        /* Otteniamo la mossa i-esima */
-        void *move = gd->get_move_at(moves_vec, i);
+    /* Ordinamento alla radice: il fratello maggiore deve essere la mossa
+     * più promettente, o la finestra condivisa parte male */
+    void *ordered[MAX_ORDERED_MOVES];
+    size_t mv_stride;
+    const char *mv_flat = moves_flat_base(moves_vec, &mv_stride);
+    int use_ordered = order_moves(gd, state, moves_vec, mv_flat, mv_stride,
+                                  num_moves, depth, ordered);
+    void *moves_flat[MAX_ORDERED_MOVES];
+    int flat_count = (num_moves < MAX_ORDERED_MOVES) ? num_moves : MAX_ORDERED_MOVES;
+    for (int i = 0; i < flat_count; i++) {
+        moves_flat[i] = use_ordered ? ordered[i] : move_at(gd, moves_vec, mv_flat, mv_stride, i);
+    }
 
-        /* Applichiamo la mossa per ottenere un nuovo stato */
-        void *new_state = gd->apply_move(state, move);
-        if (new_state == NULL) {
-            TRACE_ERROR(&stdtrace, "Failed to apply move at index %d", i);
-            continue; /* Salta questa mossa in caso di errore */
+    int alpha = alpha0;
+    int beta  = beta0;
+    int best_value = (player == 1) ? INT_MIN : INT_MAX;
+    int best_index = -1;
+
+    /* 1. Il fratello maggiore viene cercato serialmente dal chiamante */
+    {
+        void *new_state = gd->apply_move(state, moves_flat[0]);
+        if (new_state != NULL) {
+            int value = minimax_ab_pv(gd, new_state, depth - 1, alpha, beta,
+                                      cache_handle, NULL);
+            gd->free_state(new_state);
+            best_value = value;
+            best_index = 0;
+            if (player == 1) {
+                if (value > alpha) alpha = value;
+            } else {
+                if (value < beta) beta = value;
+            }
         }
+    }
 
-        /* Ricorsione */
-        int value = minimax_ab(gd, new_state, depth - 1, alpha, beta, cache_handle);
+    /* 2. Split point sulle mosse rimanenti (se ce ne sono e il fratello
+     *    maggiore non ha già prodotto un taglio) */
+    if (flat_count > 1 && alpha < beta) {
+        pthread_mutex_t lock;
+        pthread_mutex_init(&lock, NULL);
 
-        /* Libera lo stato generato */
-        gd->free_state(new_state);
+        volatile int stop = 0;
+        int next_index = 1;
 
-        /* Aggiorna best_value e alpha/beta in base al tipo di giocatore */
-        if (player == 1) {
-            /* Massimizzatore */
-            if (value > best_value) {
-                best_value = value;
-                /* Libera eventuale best_move precedente */
-                if (best_value != INT_MIN) { /* Condizione per evitare free(NULL) */
-                    /* Nota: best_move è gestito nella funzione get_best_move, non qui */
-                }
-                TRACE_DEBUG(&stdtrace, "New best_value for MAX: %d", best_value);
-            }
-            if (best_value > alpha) {
-                alpha = best_value;
-                TRACE_DEBUG(&stdtrace, "Updated alpha to %d", alpha);
+        int helpers = num_threads - 1;
+        if (helpers > flat_count - 1) {
+            helpers = flat_count - 1;
+        }
+
+        ybwc_split_t *splits = (ybwc_split_t*) malloc((helpers + 1) * sizeof(ybwc_split_t));
+        pthread_t *threads = (pthread_t*) malloc((helpers > 0 ? helpers : 1) * sizeof(pthread_t));
+        int started = 0;
+
+        if (splits && threads) {
+            for (int i = 0; i <= helpers; i++) {
+                splits[i].gd = gd;
+                /* lo slot 0 è del thread principale e usa lo stato originale */
+                splits[i].root_state = (i == 0) ? (void*)state : gd->copy_state(state);
+                splits[i].moves = moves_flat;
+                splits[i].num_moves = flat_count;
+                splits[i].depth = depth;
+                splits[i].player = player;
+                splits[i].cache_handle = cache_handle;
+                splits[i].lock = &lock;
+                splits[i].next_index = &next_index;
+                splits[i].alpha = &alpha;
+                splits[i].beta = &beta;
+                splits[i].best_value = &best_value;
+                splits[i].best_index = &best_index;
+                splits[i].stop = &stop;
             }
-        } else {
-            /* Minimizatore */
-            if (value < best_value) {
-                best_value = value;
-                /* Libera eventuale best_move precedente */
-                if (best_value != INT_MAX) { /* Condizione per evitare free(NULL) */
-                    /* Nota: best_move è gestito nella funzione get_best_move, non qui */
+            for (int i = 1; i <= helpers; i++) {
+                if (splits[i].root_state == NULL ||
+                    pthread_create(&threads[started], NULL, ybwc_worker_main,
+                                   &splits[i]) != 0) {
+                    TRACE_ERROR(&stdtrace, "ybwc: avvio worker %d fallito", i);
+                    if (splits[i].root_state) {
+                        gd->free_state(splits[i].root_state);
+                        splits[i].root_state = NULL;
+                    }
+                    continue;
                 }
-                TRACE_DEBUG(&stdtrace, "New best_value for MIN: %d", best_value);
+                started++;
             }
-            if (best_value < beta) {
-                beta = best_value;
-                TRACE_DEBUG(&stdtrace, "Updated beta to %d", beta);
+
+            /* Anche il thread principale ruba mosse invece di aspettare.
+             * Il suo cronometro resta quello della ricerca in corso: così
+             * un'eventuale scadenza temporale continua a valere, e il flag
+             * di stop dello split viene controllato nel ciclo di furto. */
+            volatile int *saved_stop_flag = search_clock.stop_flag;
+            search_clock.stop_flag = &stop;
+            int saved_active = search_clock.active;
+            search_clock.active = 1;
+            ybwc_steal_loop(&splits[0]);
+            search_clock.stop_flag = saved_stop_flag;
+            search_clock.active = saved_active;
+            if (search_clock.aborted && saved_stop_flag == NULL &&
+                search_clock.hard_deadline_ms == 0) {
+                /* L'abort era dovuto solo allo stop dello split */
+                search_clock.aborted = 0;
             }
-        }
 
-        /* Potatura */
-        if (alpha >= beta) {
-            TRACE_DEBUG(&stdtrace, "Alpha-beta cutoff: alpha=%d, beta=%d", alpha, beta);
-            break; /* esci dal ciclo: non serve analizzare altre mosse */
+            for (int i = 0; i < started; i++) {
+                pthread_join(threads[i], NULL);
+            }
+            for (int i = 1; i <= helpers; i++) {
+                if (splits[i].root_state) {
+                    gd->free_state(splits[i].root_state);
+                }
+            }
+        } else {
+            TRACE_ERROR(&stdtrace, "ybwc: allocazione split point fallita");
         }
+        free(splits);
+        free(threads);
+        pthread_mutex_destroy(&lock);
     }
 
-    /* 6. Libera il vettore di mosse */
-    gd->free_moves(moves_vec);
-
-    /* 7. Determina il tipo di nodo per la cache */
-    NodeType node_type;
-    if (best_value <= alpha_orig) {
-        node_type = UPPER_BOUND;
-    } else if (best_value >= beta_orig) {
-        node_type = LOWER_BOUND;
-    } else {
-        node_type = EXACT;
-    }
-
-    /* 8. Memorizza in cache il risultato, se possibile */
-    if (cache_handle != NULL) {
-        minimax_cache_entry_t entry;
-        entry.value = best_value;
-        entry.depth = depth;
-        entry.type = node_type;
-        cache_store(cache_handle, state, &entry);
-        TRACE_DEBUG(&stdtrace, "Stored in cache at depth %d: value=%d, type=%d", depth, best_value, node_type);
+    if (best_index >= 0) {
+        *best_move_out = gd->copy_move(moves_flat[best_index]);
     }
-
+    gd->free_moves(moves_vec);
     return best_value;
 }
 
 /******************************************************************************
- * Funzione: get_best_move
+ * Funzione: get_best_move_ybwc
  ******************************************************************************/
-void* get_best_move(
+void* get_best_move_ybwc(
     const game_descriptor_t *gd,
     const void *state,
-    int depth,
+    int max_depth,
+    int num_threads,
     void *cache_handle
 ) {
-    /* Se lo stato è terminale, non ci sono mosse da restituire */
     if (gd->is_terminal(state)) {
-        TRACE_INFO(&stdtrace, "get_best_move called on terminal state.");
+        TRACE_INFO(&stdtrace, "get_best_move_ybwc called on terminal state.");
         return NULL;
     }
 
-    /* Otteniamo il vettore di mosse disponibili */
-    dynamic_vector_t *moves_vec = gd->get_moves(state);
-    int num_moves = gd->get_num_moves(moves_vec);
+    /* Libro di aperture: su hit niente ricerca (e niente worker da avviare) */
+    void *book_move = probe_opening_book(gd, state, "get_best_move_ybwc");
+    if (book_move != NULL) {
+        return book_move;
+    }
 
-    if (num_moves == 0) {
-        /* Nessuna mossa disponibile => stato terminale di fatto */
-        TRACE_INFO(&stdtrace, "No available moves found in get_best_move.");
-        gd->free_moves(moves_vec);
-        return NULL;
+    if (num_threads <= 1) {
+        return get_best_move_id(gd, state, max_depth, cache_handle);
+    }
+    if (max_depth <= 0) {
+        max_depth = MAX_DEPTH;
     }
 
-    /* Determiniamo il giocatore */
-    int player = gd->player_to_move(state);
+    /* La cache è condivisa tra i worker dello split point */
+    if (cache_handle != NULL) {
+        cache_set_thread_safe((generic_hash_table_t*)cache_handle, 1);
+    }
 
-    /* Inizializziamo best_value e i parametri alpha/beta */
-    int best_value = (player == 1) ? INT_MIN : INT_MAX;
-    int alpha = INT_MIN;
-    int beta  = INT_MAX;
+    reset_order_tables();
+    reset_search_stats();
+    minimax_tt_new_search(search_ttable);
+    long stats_start_ms = monotonic_ms();
 
-    /* Puntatore alla miglior mossa trovata */
     void *best_move = NULL;
+    int guess = 0;
+    int have_guess = 0;
 
-    /* Analizziamo ciascuna mossa */
-    for (int i = 0; i < num_moves; i++) {
-        /* Prendiamo la mossa i-esima */
-        void *move = gd->get_move_at(moves_vec, i);
+    for (int depth = 1; depth <= max_depth; depth++) {
+        int alpha, beta;
+        stats_root_depth = depth;
 
-        /* Generiamo lo stato risultante */
-        void *new_state = gd->apply_move(state, move);
-        if (new_state == NULL) {
-            TRACE_ERROR(&stdtrace, "Failed to apply move at index %d in get_best_move.", i);
-            continue; /* Salta questa mossa in caso di errore */
+        if (have_guess) {
+            alpha = guess - ASPIRATION_WINDOW;
+            beta  = guess + ASPIRATION_WINDOW;
+        } else {
+            alpha = INT_MIN;
+            beta  = INT_MAX;
         }
 
-        /* Calcoliamo il valore con minimax */
-        int value = minimax_ab(gd, new_state, depth - 1, alpha, beta, cache_handle);
-        TRACE_INFO(&stdtrace, " - Move %d applied, minimax value=%d", i, value);
-
-        /* Libera lo stato transitorio */
-        gd->free_state(new_state);
+        void *iter_move = NULL;
+        int value = ybwc_search_iteration(gd, state, depth, alpha, beta,
+                                          num_threads, cache_handle, &iter_move);
 
-        /* Controlliamo se è migliore per il giocatore in questione */
-        if (player == 1) {
-            /* Massimizzatore */
-            if (value > best_value) {
-                best_value = value;
-                /* Libera eventuale best_move precedente */
-                if (best_move) {
-                    gd->free_move(best_move);
-                }
-                /* Copia profonda della mossa corrente */
-                best_move = gd->copy_move(move);
-                TRACE_DEBUG(&stdtrace, "New best_move for MAX: column=%d with value=%d", *(int*)move, best_value);
+        /* Fail-low o fail-high sulla finestra di aspirazione: come nel
+         * driver seriale, si ripete l'iterazione a finestra piena */
+        if (have_guess && (value <= alpha || value >= beta)) {
+            TRACE_DEBUG(&stdtrace,
+                        "ybwc: aspirazione fallita a profondità %d (valore=%d)",
+                        depth, value);
+            if (iter_move) {
+                gd->free_move(iter_move);
+                iter_move = NULL;
             }
-            if (best_value > alpha) {
-                alpha = best_value;
-                TRACE_DEBUG(&stdtrace, "Updated alpha to %d in get_best_move", alpha);
+            value = ybwc_search_iteration(gd, state, depth, INT_MIN, INT_MAX,
+                                          num_threads, cache_handle, &iter_move);
+        }
+
+        if (iter_move != NULL) {
+            if (best_move) {
+                gd->free_move(best_move);
             }
+            best_move = iter_move;
+            guess = value;
+            have_guess = 1;
+
+            /* Lo split point non raccoglie la linea: PV assente */
+            report_search_progress(depth, value, NULL, stats_start_ms);
+        }
+    }
+
+    finalize_search_stats(stats_start_ms);
+
+    if (best_move == NULL) {
+        TRACE_WARN(&stdtrace, "No best move found in get_best_move_ybwc.");
+    }
+    return best_move;
+}
+
+/******************************************************************************
+ * Pondering: ricerca sul tempo dell'avversario
+ *
+ * Dopo aver restituito la propria mossa, il motore resterebbe fermo mentre
+ * l'avversario riflette. Il pondering avvia invece un thread che cerca la
+ * posizione attesa DOPO la risposta prevista dell'avversario (la seconda
+ * mossa della PV), riempiendo la stessa transposition table della ricerca
+ * normale. Quando la mossa reale arriva:
+ *  - ponder hit  (mossa prevista): la ricerca successiva trova in cache
+ *    risultati profondi proprio per la posizione da cercare;
+ *  - ponder miss: il lavoro non è sprecato del tutto (molte trasposizioni
+ *    restano valide), ma la ricerca riparte "quasi" a freddo.
+ * In entrambi i casi il thread va fermato con ponder_stop: il flag di stop
+ * viene letto dalla ricorsione ogni TIME_CHECK_INTERVAL nodi, quindi
+ * l'interruzione costa al più qualche millisecondo.
+ ******************************************************************************/
+struct ponder_session {
+    const game_descriptor_t *gd;              /* descrittore di gioco */
+    void                    *ponder_state;    /* posizione su cui si pondera */
+    void                    *base_state;      /* posizione prima della risposta prevista */
+    int                      has_prediction;  /* 1 se ponder_state = base + mossa prevista */
+    int                      max_depth;       /* tetto dell'iterative deepening */
+    void                    *cache_handle;    /* transposition table condivisa */
+    volatile int             stop;            /* flag di stop letto dalla ricerca */
+    pthread_t                thread;          /* thread di ricerca in background */
+};
+
+/*
+ * Corpo del thread di pondering: iterative deepening con finestre di
+ * aspirazione sulla posizione prevista, identico a un worker Lazy SMP ma
+ * governato dal flag di stop della sessione (nessuna scadenza temporale:
+ * si pondera finché l'avversario non muove o la profondità massima non è
+ * raggiunta). Le mosse prodotte vengono scartate: il valore del pondering
+ * sta nelle voci che deposita nella transposition table condivisa.
+ */
+static void* ponder_main(void *arg) {
+    ponder_session_t *ps = (ponder_session_t*)arg;
+    const game_descriptor_t *gd = ps->gd;
+
+    /* Tabelle di ordinamento e cronometro thread-local del nuovo thread */
+    reset_order_tables();
+    search_clock.active = 1;
+    search_clock.aborted = 0;
+    search_clock.nodes = 0;
+    search_clock.hard_deadline_ms = 0;       /* nessuna scadenza */
+    search_clock.stop_flag = &ps->stop;
+
+    int guess = 0;
+    int have_guess = 0;
+
+    for (int depth = 1; depth <= ps->max_depth && !ps->stop; depth++) {
+        int alpha, beta;
+        if (have_guess) {
+            alpha = guess - ASPIRATION_WINDOW;
+            beta  = guess + ASPIRATION_WINDOW;
         } else {
-            /* Minimizatore */
-            if (value < best_value) {
-                best_value = value;
-                /* Libera eventuale best_move precedente */
-                if (best_move) {
-                    gd->free_move(best_move);
-                }
-                /* Copia profonda della mossa corrente */
-                best_move = gd->copy_move(move);
-                TRACE_DEBUG(&stdtrace, "New best_move for MIN: column=%d with value=%d", *(int*)move, best_value);
+            alpha = INT_MIN;
+            beta  = INT_MAX;
+        }
+
+        void *iter_move = NULL;
+        int value = search_root(gd, ps->ponder_state, depth, alpha, beta,
+                                ps->cache_handle, &iter_move, NULL);
+
+        if (have_guess && (value <= alpha || value >= beta) && !ps->stop) {
+            if (iter_move) {
+                gd->free_move(iter_move);
+                iter_move = NULL;
             }
-            if (best_value < beta) {
-                beta = best_value;
-                TRACE_DEBUG(&stdtrace, "Updated beta to %d in get_best_move", beta);
+            value = search_root(gd, ps->ponder_state, depth, INT_MIN, INT_MAX,
+                                ps->cache_handle, &iter_move, NULL);
+        }
+
+        if (iter_move != NULL) {
+            gd->free_move(iter_move);
+            if (!search_clock.aborted) {
+                guess = value;
+                have_guess = 1;
             }
         }
 
-        /* Potatura */
-        if (alpha >= beta) {
-            TRACE_DEBUG(&stdtrace, "Alpha-beta cutoff in get_best_move: alpha=%d, beta=%d", alpha, beta);
-            break;
+        if (search_clock.aborted) {
+            break;   /* stop esterno arrivato a metà iterazione */
         }
+        TRACE_DEBUG(&stdtrace, "ponder: profondità %d completata (valore=%d)",
+                    depth, value);
     }
 
-    /* Libera il vettore di mosse */
-    gd->free_moves(moves_vec);
+    search_clock.active = 0;
+    search_clock.aborted = 0;
+    search_clock.stop_flag = NULL;
+    return NULL;
+}
 
-    /* Restituisce la migliore mossa trovata (o NULL se non ci sono) */
-    if (best_move != NULL) {
-        TRACE_INFO(&stdtrace, "Best move found: column=%d with value=%d", *(int*)best_move, best_value);
+/******************************************************************************
+ * Funzione: ponder_start
+ ******************************************************************************/
+ponder_session_t* ponder_start(
+    const game_descriptor_t *gd,
+    const void *state,
+    const void *predicted_move,
+    int max_depth,
+    void *cache_handle
+) {
+    if (gd->is_terminal(state)) {
+        TRACE_INFO(&stdtrace, "ponder_start called on terminal state.");
+        return NULL;
+    }
+    if (max_depth <= 0) {
+        max_depth = MAX_DEPTH;
+    }
+
+    ponder_session_t *ps = (ponder_session_t*) malloc(sizeof(ponder_session_t));
+    if (!ps) {
+        TRACE_ERROR(&stdtrace, "ponder_start: allocazione sessione fallita");
+        return NULL;
+    }
+
+    ps->gd = gd;
+    ps->base_state = gd->copy_state(state);
+    ps->max_depth = max_depth;
+    ps->cache_handle = cache_handle;
+    ps->stop = 0;
+
+    if (predicted_move != NULL) {
+        /* Si pondera la posizione DOPO la risposta prevista */
+        ps->ponder_state = gd->apply_move(state, predicted_move);
+        ps->has_prediction = 1;
     } else {
-        TRACE_WARN(&stdtrace, "No best move found.");
+        /* Nessuna previsione: si pondera la posizione dell'avversario
+         * stessa, riempiendo la cache per qualunque sua risposta. */
+        ps->ponder_state = gd->copy_state(state);
+        ps->has_prediction = 0;
     }
-    return best_move;
+
+    if (ps->base_state == NULL || ps->ponder_state == NULL) {
+        TRACE_ERROR(&stdtrace, "ponder_start: copia dello stato fallita");
+        if (ps->base_state)   gd->free_state(ps->base_state);
+        if (ps->ponder_state) gd->free_state(ps->ponder_state);
+        free(ps);
+        return NULL;
+    }
+
+    /* La cache è condivisa tra il thread di ponder e le ricerche del
+     * chiamante: DEVE essere in modalità thread-safe */
+    if (cache_handle != NULL) {
+        cache_set_thread_safe((generic_hash_table_t*)cache_handle, 1);
+    }
+
+    if (pthread_create(&ps->thread, NULL, ponder_main, ps) != 0) {
+        TRACE_ERROR(&stdtrace, "ponder_start: avvio del thread fallito");
+        gd->free_state(ps->base_state);
+        gd->free_state(ps->ponder_state);
+        free(ps);
+        return NULL;
+    }
+
+    TRACE_DEBUG(&stdtrace, "ponder: avviato (max_depth=%d, previsione=%s)",
+                max_depth, predicted_move ? "sì" : "no");
+    return ps;
+}
+
+/******************************************************************************
+ * Funzione: ponder_hit
+ ******************************************************************************/
+int ponder_hit(const ponder_session_t *ps, const void *actual_move) {
+    if (ps == NULL || actual_move == NULL || !ps->has_prediction) {
+        return 0;
+    }
+
+    /* Non esiste una callback di confronto tra mosse, ma non serve: due
+     * mosse sono "la stessa" se producono lo stesso stato. Applichiamo la
+     * mossa reale alla posizione di partenza e confrontiamo con lo stato
+     * ponderato usando equals_state (la stessa callback della cache). */
+    const game_descriptor_t *gd = ps->gd;
+    void *actual_state = gd->apply_move(ps->base_state, actual_move);
+    if (actual_state == NULL) {
+        return 0;
+    }
+
+    int hit = gd->equals_state(actual_state, ps->ponder_state);
+    gd->free_state(actual_state);
+    return hit;
+}
+
+/******************************************************************************
+ * Funzione: ponder_stop
+ ******************************************************************************/
+void ponder_stop(ponder_session_t *ps) {
+    if (ps == NULL) {
+        return;
+    }
+
+    ps->stop = 1;
+    pthread_join(ps->thread, NULL);
+
+    ps->gd->free_state(ps->base_state);
+    ps->gd->free_state(ps->ponder_state);
+    free(ps);
 }
@@ -2,7 +2,7 @@
  * @file
  * @brief Libreria per l'algoritmo MiniMax con alpha-beta pruning e cache opzionale.
  *
- * ##VERSION## "minimax.h 1.0"
+ * ##VERSION## "minimax.h 1.8"
  *
  * Questo file definisce il descrittore di gioco (\ref game_descriptor_t) e le funzioni
  * di MiniMax (\ref minimax_ab e \ref get_best_move). In particolare, supporta:
@@ -27,6 +27,7 @@
 #include <stddef.h>   // per size_t, NULL
 #include <limits.h>   // per INT_MAX, INT_MIN
 #include <stdint.h>   // per uint64_t
+#include <stddef.h>   // per size_t
 
 /**
  * @def MAX_DEPTH
@@ -36,6 +37,96 @@
 #define MAX_DEPTH 10
 #endif
 
+/**
+ * @def ASPIRATION_WINDOW
+ * Semi-ampiezza della finestra di aspirazione usata da \ref get_best_move_id.
+ * Il valore va tarato sulla scala della funzione di valutazione del gioco
+ * (per gli scacchi: centesimi di pedone).
+ */
+#ifndef ASPIRATION_WINDOW
+#define ASPIRATION_WINDOW 50
+#endif
+
+/**
+ * @def TIME_CHECK_INTERVAL
+ * Numero di nodi visitati tra due controlli consecutivi della scadenza
+ * temporale in \ref get_best_move_timed. Deve essere una potenza di due:
+ * il controllo avviene con una semplice maschera sul contatore dei nodi,
+ * quindi il costo per nodo è trascurabile.
+ */
+#ifndef TIME_CHECK_INTERVAL
+#define TIME_CHECK_INTERVAL 4096
+#endif
+
+/**
+ * @def MAX_SEARCH_PLY
+ * Numero massimo di livelli per i quali vengono mantenuti i killer slot.
+ */
+#ifndef MAX_SEARCH_PLY
+#define MAX_SEARCH_PLY 64
+#endif
+
+/**
+ * @def HISTORY_SIZE
+ * Dimensione della history table per l'ordinamento delle mosse: gli indici
+ * prodotti da \ref move_index_fn devono essere inferiori a questo valore
+ * (per gli scacchi from*64+to richiede 4096 celle).
+ */
+#ifndef HISTORY_SIZE
+#define HISTORY_SIZE 4096
+#endif
+
+/**
+ * @def MAX_QUIESCENCE_PLY
+ * Limite di sicurezza alla profondità della ricerca di quiescenza:
+ * le catene di catture reali si esauriscono molto prima.
+ */
+#ifndef MAX_QUIESCENCE_PLY
+#define MAX_QUIESCENCE_PLY 32
+#endif
+
+/**
+ * @def MAX_ORDERED_MOVES
+ * Numero massimo di mosse per nodo gestite dalla fase di ordinamento:
+ * oltre questa soglia le mosse vengono esaminate nell'ordine originale.
+ */
+#ifndef MAX_ORDERED_MOVES
+#define MAX_ORDERED_MOVES 256
+#endif
+
+/**
+ * @def MAX_UNDO_SIZE
+ * Dimensione massima (in byte) del record di undo usato dalla coppia
+ * make_move/unmake_move: la ricerca alloca il record sullo stack di ogni
+ * nodo, quindi il descrittore di gioco deve dichiarare in \c undo_size un
+ * valore non superiore a questa soglia perché la coppia venga usata.
+ */
+#ifndef MAX_UNDO_SIZE
+#define MAX_UNDO_SIZE 256
+#endif
+
+/**
+ * @def MINIMAX_MAX_MOVES
+ * Capienza (in mosse) del buffer di generazione sullo stack di ogni nodo,
+ * usato quando il gioco fornisce \ref generate_moves_fn. Per gli scacchi il
+ * massimo teorico di mosse legali è 218, quindi 256 basta sempre; un gioco
+ * che può superare la soglia ritorna -1 e la ricerca ripiega sul vettore.
+ */
+#ifndef MINIMAX_MAX_MOVES
+#define MINIMAX_MAX_MOVES 256
+#endif
+
+/**
+ * @def MAX_MOVE_SIZE
+ * Dimensione massima (in byte) di una singola mossa perché la generazione
+ * in buffer venga usata: come per \ref MAX_UNDO_SIZE, il buffer vive sullo
+ * stack di ogni nodo e il descrittore deve dichiarare in \c move_size un
+ * valore non superiore a questa soglia.
+ */
+#ifndef MAX_MOVE_SIZE
+#define MAX_MOVE_SIZE 16
+#endif
+
 /**
  * @brief Header per la cache generica.
  *
@@ -132,6 +223,56 @@ typedef void  (*free_move_fn)(void *move);
  */
 typedef void*  (*apply_move_fn)(const void *state, const void *move);
 
+/**
+ * @typedef make_move_fn
+ * @brief Funzione di callback (opzionale) per applicare una mossa IN PLACE.
+ *
+ * Alternativa a \ref apply_move_fn senza allocazione: la mossa viene eseguita
+ * direttamente su \p state e le informazioni necessarie a disfarla vengono
+ * scritte nel record \p undo (un buffer di \c undo_size byte fornito dal
+ * chiamante, tipicamente sullo stack). Se la mossa risulta illegale, lo stato
+ * deve restare invariato.
+ *
+ * Se il descrittore fornisce sia \c make_move sia \c unmake_move (con
+ * \c undo_size <= \ref MAX_UNDO_SIZE), la ricerca li usa al posto di
+ * apply_move/free_state, eliminando una coppia malloc/free per nodo.
+ *
+ * @param[in,out] state Stato su cui eseguire la mossa.
+ * @param[in]     move  Mossa da applicare.
+ * @param[out]    undo  Record di undo da riempire (almeno \c undo_size byte).
+ * @return 1 se la mossa è stata applicata, 0 se è illegale (stato invariato).
+ */
+typedef int (*make_move_fn)(void *state, const void *move, void *undo);
+
+/**
+ * @typedef unmake_move_fn
+ * @brief Funzione di callback (opzionale) per disfare una mossa eseguita
+ *        con \ref make_move_fn, ripristinando esattamente lo stato precedente.
+ *
+ * @param[in,out] state Stato da ripristinare.
+ * @param[in]     undo  Record di undo riempito dalla make_move corrispondente.
+ */
+typedef void (*unmake_move_fn)(void *state, const void *undo);
+
+/**
+ * @typedef make_null_move_fn
+ * @brief Funzione di callback (opzionale) per eseguire la "mossa nulla".
+ *
+ * Passa il turno all'avversario senza muovere alcun pezzo, riempiendo un
+ * record di undo compatibile con \ref unmake_move_fn. Usata dalla potatura
+ * null-move: se anche regalando una mossa all'avversario la posizione resta
+ * sopra beta, il sottoalbero può essere potato a profondità ridotta.
+ *
+ * La callback deve rifiutare la mossa nulla (ritorno 0) quando non è sicura:
+ * tipicamente se il giocatore di turno è sotto scacco o in posizioni a
+ * rischio zugzwang (es. solo re e pedoni).
+ *
+ * @param[in,out] state Stato su cui passare il turno.
+ * @param[out]    undo  Record di undo da riempire (almeno \c undo_size byte).
+ * @return 1 se la mossa nulla è stata eseguita, 0 se va evitata.
+ */
+typedef int (*make_null_move_fn)(void *state, void *undo);
+
 /**
  * @typedef is_terminal_fn
  * @brief Funzione di callback per verificare se lo stato è terminale (nessuna mossa o vittoria/sconfitta).
@@ -140,6 +281,36 @@ typedef void*  (*apply_move_fn)(const void *state, const void *move);
  */
 typedef int    (*is_terminal_fn)(const void *state);
 
+/**
+ * @typedef is_draw_fn
+ * @brief Callback opzionale: la posizione è patta per regolamento lungo il
+ *        cammino corrente (es. triplice ripetizione).
+ *
+ * A differenza di is_terminal può dipendere dal CAMMINO che ha portato allo
+ * stato, non solo dallo stato stesso: la ricerca la consulta a ogni nodo e
+ * chiude subito il sottoalbero con valore 0, senza memorizzare il risultato
+ * in cache (un valore dipendente dal cammino inquinerebbe la transposition
+ * table).
+ * @param[in] state Stato da verificare.
+ * @return 1 se la posizione è patta per regolamento, 0 altrimenti.
+ */
+typedef int    (*is_draw_fn)(const void *state);
+
+/**
+ * @typedef get_book_move_fn
+ * @brief Callback opzionale: mossa "di libro" pronta per lo stato, se esiste.
+ *
+ * I driver get_best_move* la consultano PRIMA di lanciare qualunque ricerca:
+ * su hit la mossa restituita (allocata, di proprietà del chiamante come il
+ * risultato di get_best_move) viene ritornata immediatamente, senza toccare
+ * iterative deepening, thread o transposition table. Tipico uso: libro di
+ * aperture indicizzato per hash (vedi chess_book.h). La callback deve
+ * restituire solo mosse legali nello stato corrente.
+ * @param[in] state Stato corrente.
+ * @return Mossa allocata, oppure NULL se il libro non ha nulla da dire.
+ */
+typedef void*  (*get_book_move_fn)(const void *state);
+
 /**
  * @typedef evaluate_fn
  * @brief Funzione di callback per calcolare il punteggio/euristica di uno stato.
@@ -156,6 +327,87 @@ typedef int    (*evaluate_fn)(const void *state);
  */
 typedef int    (*player_to_move_fn)(const void *state);
 
+/* --------------------------------------------------------------------------
+ * CALLBACK (opzionali) per l'ordinamento delle mosse
+ * --------------------------------------------------------------------------
+ */
+
+/**
+ * @typedef is_capture_fn
+ * @brief Funzione di callback (opzionale) che indica se una mossa è una cattura.
+ *
+ * Usata dalla fase di ordinamento delle mosse per provare le catture per prime:
+ * negli algoritmi alpha-beta le catture producono la maggior parte dei tagli.
+ *
+ * @param[in] state Stato corrente (PRIMA della mossa).
+ * @param[in] move  Mossa da classificare.
+ * @return 1 se la mossa è una cattura (o una promozione), 0 altrimenti.
+ */
+typedef int (*is_capture_fn)(const void *state, const void *move);
+
+/**
+ * @typedef get_capture_moves_fn
+ * @brief Funzione di callback (opzionale) per ottenere le sole mosse di cattura.
+ *
+ * Se fornita, abilita la ricerca di quiescenza: raggiunta la profondità zero,
+ * MiniMax continua a estendere le sole linee di cattura/promozione finché la
+ * posizione non diventa "tranquilla", eliminando l'effetto orizzonte.
+ *
+ * @param[in] state Stato corrente da cui generare le catture.
+ * @return Un \c dynamic_vector_t* contenente le sole mosse di cattura
+ *         (stesso formato e stessa gestione della memoria di \ref get_moves_fn).
+ */
+typedef dynamic_vector_t* (*get_capture_moves_fn)(const void *state);
+
+/**
+ * @typedef generate_moves_fn
+ * @brief Funzione di callback (opzionale) che genera le mosse in un buffer
+ *        fornito dal chiamante.
+ *
+ * Alternativa a \ref get_moves_fn senza vettore dinamico: le mosse legali
+ * vengono scritte una dopo l'altra (elementi di \c move_size byte) nel
+ * buffer \p out_moves, che la ricerca alloca sullo stack di ogni nodo
+ * (\ref MINIMAX_MAX_MOVES slot). Se il gioco la fornisce insieme a una
+ * \c move_size valida (> 0, <= \ref MAX_MOVE_SIZE), la ricerca la preferisce
+ * a \c get_moves nei nodi interni.
+ *
+ * @param[in]  state     Stato corrente da cui generare le mosse.
+ * @param[out] out_moves Buffer del chiamante (almeno \p max_moves elementi).
+ * @param[in]  max_moves Capienza del buffer in mosse.
+ * @return Il numero di mosse legali scritte (anche 0), oppure -1 se le mosse
+ *         non entrano nel buffer: il chiamante ripiega su \c get_moves.
+ */
+typedef int (*generate_moves_fn)(const void *state, void *out_moves, int max_moves);
+
+/**
+ * @typedef move_index_fn
+ * @brief Funzione di callback (opzionale) che mappa una mossa su un indice compatto.
+ *
+ * L'indice identifica la mossa nella history table e nei killer slot:
+ * deve essere stabile (stessa mossa => stesso indice) e compreso in
+ * [0, \ref HISTORY_SIZE). Per gli scacchi l'indice naturale è from*64+to.
+ *
+ * @param[in] move Mossa da mappare.
+ * @return Indice in [0, \ref HISTORY_SIZE), oppure -1 se non disponibile.
+ */
+typedef int (*move_index_fn)(const void *move);
+
+/**
+ * @typedef pack_move_fn
+ * @brief Funzione di callback (opzionale) che impacca una mossa in 16 bit.
+ *
+ * A differenza di \ref move_index_fn la codifica deve essere REVERSIBILE
+ * (due mosse diverse non possono condividere il valore: per gli scacchi
+ * l'indice from*64+to confonde le quattro promozioni della stessa casella).
+ * È il formato con cui la mossa migliore del nodo viene memorizzata per
+ * valore nella transposition table e confrontata con le mosse generate.
+ *
+ * @param[in] move Mossa da impaccare.
+ * @return Valore in [0, 0xFFFF) — 0xFFFF è riservato a "nessuna mossa" —
+ *         oppure -1 se non disponibile.
+ */
+typedef int (*pack_move_fn)(const void *move);
+
 /* --------------------------------------------------------------------------
  * CALLBACK per l'hashing e il confronto di stati
  * --------------------------------------------------------------------------
@@ -208,8 +460,241 @@ typedef struct game_descriptor {
     /* Hashing e confronto dello stato (per la cache) */
     hash_state_fn     hash_state;    /**< Callback per calcolare l'hash dello stato */
     equals_state_fn   equals_state;  /**< Callback per confrontare due stati */
+
+    /* Ordinamento delle mosse (opzionali: possono essere NULL) */
+    is_capture_fn     is_capture;    /**< Callback per riconoscere le catture (o NULL) */
+    move_index_fn     move_index;    /**< Callback per l'indice history/killer (o NULL) */
+    pack_move_fn      pack_move;     /**< Callback per la codifica a 16 bit della
+                                          mossa TT (o NULL: ripiega su move_index) */
+
+    /* Ricerca di quiescenza (opzionale: può essere NULL) */
+    get_capture_moves_fn get_capture_moves; /**< Callback per le sole catture (o NULL) */
+
+    /* Generazione in buffer del chiamante (opzionale: richiede move_size) */
+    generate_moves_fn generate_moves;/**< Callback per generare nel buffer del
+                                          chiamante (o NULL: si usa get_moves) */
+    size_t            move_size;     /**< sizeof di una mossa (<= MAX_MOVE_SIZE) */
+
+    /* Contratto del generatore (opzionale). Con il flag a 1 il gioco
+     * garantisce che get_moves/generate_moves producono SOLO mosse legali:
+     * lista vuota <=> stato terminale. La ricerca allora deduce la
+     * terminalità dal risultato della generazione che deve comunque
+     * eseguire, invece di richiamare is_terminal — che tipicamente rigenera
+     * le stesse mosse — a ogni nodo interno. */
+    int               moves_imply_terminal; /**< 1 se lista vuota <=> terminale */
+
+    /* Patte per regolamento (opzionale: può essere NULL). Il gioco la
+     * implementa quando sa riconoscere una patta dipendente dal cammino
+     * (triplice ripetizione): il nodo vale 0 immediatamente, tagliando i
+     * sottoalberi dove i pezzi si limitano a fare la spola. */
+    is_draw_fn        is_draw;       /**< Callback patta per regolamento (o NULL) */
+
+    /* Libro di aperture (opzionale: può essere NULL). Consultato dai driver
+     * get_best_move* prima di avviare la ricerca: su hit la mossa di libro
+     * viene restituita subito. */
+    get_book_move_fn  get_book_move; /**< Callback mossa di libro (o NULL) */
+
+    /* Make/unmake in place (opzionali: entrambe NULL oppure entrambe valide) */
+    make_move_fn      make_move;     /**< Callback per eseguire una mossa in place (o NULL) */
+    unmake_move_fn    unmake_move;   /**< Callback per disfare la mossa (o NULL) */
+    size_t            undo_size;     /**< Dimensione in byte del record di undo (<= MAX_UNDO_SIZE) */
+
+    /* Potatura null-move (opzionale: richiede anche make/unmake) */
+    make_null_move_fn make_null_move;/**< Callback per la mossa nulla (o NULL) */
+
+    /* Dimensione dello stato (opzionale: 0 se sconosciuta). Permette alla
+     * cache della ricerca di memorizzare gli stati PER COPIA invece che per
+     * riferimento (vedi \ref minimax_cache_create). */
+    size_t            state_size;    /**< sizeof dello stato di gioco (o 0) */
 } game_descriptor_t;
 
+/**
+ * @brief Crea la cache di ricerca adatta al descrittore di gioco.
+ *
+ * Se il gioco dichiara \c state_size, la cache viene creata in modalità
+ * by-value (\ref cache_create_ex): ogni store copia lo stato-chiave e la
+ * voce di valutazione negli slab interni della tabella, quindi la ricerca
+ * può passare il proprio buffer di stato riutilizzato (make/unmake) o
+ * variabili di stack senza che le voci diventino pendenti. Con
+ * \c state_size a 0 equivale a \c cache_create(gd->hash_state,
+ * gd->equals_state), con i limiti di vita dei puntatori che ne conseguono.
+ *
+ * @param[in] gd Descrittore del gioco (servono \c hash_state ed \c equals_state).
+ * @return La cache creata (da liberare con \c cache_destroy), o \c NULL.
+ */
+generic_hash_table_t* minimax_cache_create(const game_descriptor_t *gd);
+
+/* --------------------------------------------------------------------------
+ * CONFIGURAZIONE DELLE POTATURE
+ * --------------------------------------------------------------------------
+ */
+
+/**
+ * @struct search_config
+ * @brief Parametri di potatura della ricerca, regolabili per deployment.
+ *
+ * Le tre tecniche sono indipendenti e tutte "speculative": riducono i nodi
+ * visitati a parità di profondità nominale, al prezzo di un piccolo rischio
+ * di potare linee rilevanti. I default (null-move R=2, LMR dopo 3 mosse,
+ * futility disattivata) sono prudenti; per servizi con vincoli di latenza
+ * stretti conviene alzare l'aggressività e misurare sul proprio carico.
+ *
+ * Le potature si attivano solo se il gioco fornisce le callback necessarie:
+ * null-move richiede \c make_null_move (più make/unmake), LMR e futility
+ * richiedono \c is_capture per distinguere le mosse tranquille, la
+ * generazione a stadi richiede \c get_capture_moves e \c is_capture. I
+ * giochi che non le forniscono mantengono il comportamento esatto di sempre.
+ */
+typedef struct search_config {
+    int use_null_move;       /**< 1 abilita la potatura null-move */
+    int null_move_reduction; /**< Riduzione R della null-move (tipicamente 2 o 3) */
+    int use_lmr;             /**< 1 abilita le late-move reductions */
+    int lmr_full_moves;      /**< Mosse esaminate a profondità piena prima di ridurre */
+    int lmr_reduction;       /**< Riduzione applicata alle mosse tranquille tardive */
+    int use_futility;        /**< 1 abilita la potatura futility a profondità 1 */
+    int futility_margin;     /**< Margine futility (scala della funzione di valutazione) */
+    int use_staged_gen;      /**< 1 abilita la generazione a stadi (catture
+                                  subito, mosse tranquille solo se il nodo
+                                  non taglia sulle catture) */
+} search_config_t;
+
+/**
+ * @brief Imposta i parametri di potatura usati dalle ricerche successive.
+ *
+ * La configurazione è globale e va impostata PRIMA di avviare una ricerca
+ * (anche parallela: i worker la leggono soltanto).
+ *
+ * @param[in] config Nuova configurazione, oppure \c NULL per i default.
+ */
+void minimax_set_search_config(const search_config_t *config);
+
+/**
+ * @brief Restituisce la configurazione di potatura corrente.
+ */
+search_config_t minimax_get_search_config(void);
+
+/* --------------------------------------------------------------------------
+ * TRANSPOSITION TABLE COMPATTA
+ * --------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Header della transposition table dedicata (voci compatte da 16 byte).
+ */
+#include "minimax_tt.h"
+
+/**
+ * @brief Imposta la transposition table compatta usata dalle ricerche successive.
+ *
+ * Quando impostata, la ricerca la usa AL POSTO della cache generica passata
+ * come \c cache_handle: ogni probe diventa un accesso a un array contiguo
+ * (una linea di cache) invece di una scansione di bucket con chiavi
+ * deep-copy. Richiede la callback \c hash_state nel descrittore di gioco.
+ *
+ * Come \ref minimax_set_search_config, l'impostazione è globale e va fatta
+ * PRIMA di avviare una ricerca. Con \c NULL si torna alla cache generica.
+ *
+ * @param[in] tt Tavola creata con \ref minimax_tt_create, oppure \c NULL.
+ */
+void minimax_set_ttable(minimax_tt_t *tt);
+
+/**
+ * @brief Restituisce la transposition table compatta corrente (o \c NULL).
+ */
+minimax_tt_t* minimax_get_ttable(void);
+
+/* --------------------------------------------------------------------------
+ * STATISTICHE DELLA RICERCA
+ * --------------------------------------------------------------------------
+ */
+
+/**
+ * @struct search_stats
+ * @brief Contatori raccolti durante l'ultima ricerca del thread corrente.
+ *
+ * I contatori sono semplici incrementi su variabili thread-local, quindi il
+ * costo per nodo è trascurabile e la raccolta è sempre attiva. Vengono
+ * azzerati all'avvio di ogni driver di ricerca (\ref get_best_move,
+ * \ref get_best_move_id, \ref get_best_move_timed) e si leggono a ricerca
+ * conclusa con \ref minimax_get_search_stats.
+ *
+ * Il rapporto first_move_cutoffs/beta_cutoffs misura la qualità
+ * dell'ordinamento delle mosse: più è vicino a 1, prima vengono esaminate
+ * le mosse che producono il taglio.
+ */
+typedef struct search_stats {
+    unsigned long nodes;              /**< Nodi minimax visitati */
+    unsigned long qnodes;             /**< Nodi di quiescenza visitati */
+    unsigned long cache_hits;         /**< Lookup in cache andati a segno (profondità sufficiente) */
+    unsigned long cache_misses;       /**< Lookup in cache falliti o troppo superficiali */
+    unsigned long beta_cutoffs;       /**< Tagli alpha-beta prodotti */
+    unsigned long first_move_cutoffs; /**< Tagli prodotti dalla PRIMA mossa esaminata */
+    int           max_ply;            /**< Profondità massima raggiunta (quiescenza inclusa) */
+    long          elapsed_ms;         /**< Durata della ricerca in millisecondi */
+    double        nps;                /**< Nodi al secondo (minimax + quiescenza) */
+} search_stats_t;
+
+/**
+ * @brief Restituisce le statistiche dell'ultima ricerca del thread corrente.
+ *
+ * Le statistiche sono per-thread: per la ricerca parallela riflettono solo
+ * il lavoro del thread chiamante, non quello dei worker di supporto.
+ */
+search_stats_t minimax_get_search_stats(void);
+
+/* --------------------------------------------------------------------------
+ * PROGRESSO DELLA RICERCA
+ * --------------------------------------------------------------------------
+ */
+
+/**
+ * @struct search_progress
+ * @brief Fotografia della ricerca al completamento di un'iterazione.
+ *
+ * Consegnata alla callback di progresso registrata con
+ * \ref minimax_set_progress_callback al termine di ogni iterazione di
+ * iterative deepening andata a buon fine. Oltre al feedback per
+ * l'interfaccia (profondità, punteggio, linea principale), il campo
+ * \c nps letto in diretta permette di accorgersi di host rallentati
+ * (throttling termico, scheduling sbagliato) PRIMA che la ricerca finisca.
+ */
+typedef struct search_progress {
+    int depth;                   /**< Profondità dell'iterazione completata */
+    int value;                   /**< Punteggio dell'iterazione */
+    const void *const *pv_moves; /**< Mosse della PV (in prestito: valide SOLO
+                                      durante la callback, da copiare se
+                                      servono dopo); \c NULL se il driver non
+                                      raccoglie la linea */
+    int pv_length;               /**< Numero di mosse in pv_moves */
+    unsigned long nodes;         /**< Nodi visitati finora (minimax + quiescenza) */
+    long elapsed_ms;             /**< Millisecondi dall'avvio della ricerca */
+    double nps;                  /**< Nodi al secondo finora */
+} search_progress_t;
+
+/**
+ * @typedef search_progress_fn
+ * @brief Callback di progresso: invocata sul thread che esegue la ricerca.
+ *
+ * Deve essere rapida (la ricerca è ferma durante la chiamata) e non può
+ * trattenere i puntatori di \c pv_moves oltre il proprio ritorno.
+ */
+typedef void (*search_progress_fn)(const search_progress_t *progress, void *user_data);
+
+/**
+ * @brief Registra la callback di progresso per il thread corrente.
+ *
+ * La registrazione è thread-local, come le statistiche: vale per le ricerche
+ * avviate da QUESTO thread nei driver con iterative deepening
+ * (\ref get_best_move_id, \ref get_best_move_id_pv, \ref get_best_move_timed,
+ * \ref get_best_move_stoppable, \ref get_best_move_ybwc). I worker di
+ * \ref get_best_move_parallel non la ereditano.
+ *
+ * @param[in] fn        Callback da invocare a fine iterazione (\c NULL per
+ *                      disattivare).
+ * @param[in] user_data Puntatore opaco ripassato alla callback.
+ */
+void minimax_set_progress_callback(search_progress_fn fn, void *user_data);
+
 /* --------------------------------------------------------------------------
  * FIRME DELLE FUNZIONI MINIMAX
  * --------------------------------------------------------------------------
@@ -259,4 +744,329 @@ void* get_best_move(
     void *cache_handle
 );
 
+/**
+ * @brief Determina la mossa migliore con iterative deepening e finestre di aspirazione.
+ *
+ * Esegue ricerche a profondità crescente 1..\p max_depth. A partire dalla seconda
+ * iterazione la ricerca usa una finestra stretta [guess - \ref ASPIRATION_WINDOW,
+ * guess + \ref ASPIRATION_WINDOW] centrata sul punteggio dell'iterazione
+ * precedente; in caso di fail-low o fail-high la ricerca viene ripetuta con
+ * finestra piena.
+ *
+ * Le iterazioni poco profonde popolano la transposition table, rendendo le
+ * iterazioni profonde molto più economiche di una ricerca diretta a \p max_depth.
+ *
+ * @param[in]  gd           Puntatore al descrittore di gioco.
+ * @param[in]  state        Stato di gioco corrente.
+ * @param[in]  max_depth    Profondità massima di ricerca.
+ * @param[in]  cache_handle Puntatore alla struttura della cache (o \c NULL se non si usa la cache).
+ * @return La mossa selezionata (allocata dinamicamente con \c copy_move).
+ *
+ * @note L'oggetto restituito deve essere liberato dall'utente con \c free_move
+ *       quando non serve più.
+ *
+ * @note Se lo stato è terminale o non ci sono mosse, la funzione restituisce \c NULL.
+ */
+void* get_best_move_id(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    void *cache_handle
+);
+
+/**
+ * @brief Variante principale (PV) prodotta da una ricerca.
+ *
+ * Sequenza delle mosse che la ricerca si aspetta vengano giocate da entrambi
+ * i giocatori a partire dalla radice ("linea principale"), raccolta con lo
+ * schema ad array triangolare. Le mosse sono copie profonde create con
+ * \c copy_move: vanno liberate con \ref pv_free.
+ */
+typedef struct {
+    void *moves[MAX_SEARCH_PLY]; /**< Mosse della linea, dalla radice in giù */
+    int   length;                /**< Numero di mosse valide in moves[] */
+    int   value;                 /**< Punteggio dell'ultima iterazione completata */
+} principal_variation_t;
+
+/**
+ * @brief Come \ref get_best_move_id, ma restituisce anche la variante principale.
+ *
+ * Oltre al comportamento di \ref get_best_move_id, ogni iterazione raccoglie
+ * la propria linea principale e la usa come primo criterio di ordinamento
+ * delle mosse nell'iterazione successiva (prima ancora delle catture): la PV
+ * dell'iterazione precedente è quasi sempre la miglior predizione disponibile
+ * e ordinare per prima la sua mossa massimizza i tagli alpha-beta.
+ *
+ * @param[in]  gd           Puntatore al descrittore di gioco.
+ * @param[in]  state        Stato di gioco corrente.
+ * @param[in]  max_depth    Profondità massima di ricerca.
+ * @param[in]  cache_handle Puntatore alla struttura della cache (o \c NULL).
+ * @param[out] pv_out       Se non \c NULL, riceve la PV dell'ultima iterazione
+ *                          completata (da liberare con \ref pv_free).
+ * @return La mossa selezionata (allocata dinamicamente con \c copy_move),
+ *         oppure \c NULL se lo stato è terminale o non ci sono mosse.
+ *
+ * @note L'ordinamento PV-first richiede la callback opzionale \c move_index;
+ *       in sua assenza la PV viene comunque raccolta e restituita.
+ */
+void* get_best_move_id_pv(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    void *cache_handle,
+    principal_variation_t *pv_out
+);
+
+/**
+ * @brief Ricerca Multi-PV: le migliori \p multipv mosse radice in una passata.
+ *
+ * Per i carichi di analisi che vogliono le prime K mosse con punteggio e
+ * variante, una sola ricerca con iterative deepening sostituisce K ricerche
+ * complete. Il costo aggiuntivo rispetto a una ricerca normale è contenuto:
+ * quando la classifica dei K candidati è piena, ogni altra mossa radice viene
+ * cercata con una finestra delimitata dal punteggio del K-esimo e fallisce
+ * rapidamente se non può entrare; solo i candidati che superano la soglia
+ * vengono ricercati di nuovo per raccoglierne la linea.
+ *
+ * @param[in]  gd           Puntatore al descrittore di gioco.
+ * @param[in]  state        Stato di gioco corrente.
+ * @param[in]  max_depth    Profondità massima (<= 0 per usare \ref MAX_DEPTH).
+ * @param[in]  multipv      Numero K di linee richieste (>= 1).
+ * @param[in]  cache_handle Puntatore alla struttura della cache (o \c NULL).
+ * @param[out] pv_out       Array di almeno \p multipv elementi: riceve le
+ *                          linee in ordine dalla migliore, ciascuna con la
+ *                          mossa radice in moves[0] e il punteggio in value.
+ *                          Ogni linea va liberata con \ref pv_free.
+ * @return Numero di linee effettivamente scritte in \p pv_out (può essere
+ *         inferiore a \p multipv se la posizione ha meno mosse; 0 su stato
+ *         terminale).
+ */
+int get_best_move_multipv(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    int multipv,
+    void *cache_handle,
+    principal_variation_t *pv_out
+);
+
+/**
+ * @brief Libera le mosse contenute in una \ref principal_variation_t.
+ *
+ * @param[in]     gd Puntatore al descrittore di gioco (per \c free_move).
+ * @param[in,out] pv Variante principale da svuotare (length viene azzerata).
+ */
+void pv_free(const game_descriptor_t *gd, principal_variation_t *pv);
+
+/**
+ * @brief Determina la mossa migliore entro un budget di tempo (soft/hard).
+ *
+ * Esegue iterative deepening come \ref get_best_move_id, ma governato da due
+ * scadenze in millisecondi:
+ * - \p soft_ms: superata questa soglia non vengono avviate nuove iterazioni;
+ * - \p hard_ms: superata questa soglia la ricerca in corso viene abortita
+ *   (il controllo avviene ogni \ref TIME_CHECK_INTERVAL nodi dentro
+ *   \ref minimax_ab, quindi con costo per nodo trascurabile).
+ *
+ * La mossa restituita è sempre quella dell'ultima iterazione COMPLETATA:
+ * i risultati parziali di un'iterazione abortita vengono scartati e non
+ * vengono memorizzati in cache.
+ *
+ * @param[in]  gd           Puntatore al descrittore di gioco.
+ * @param[in]  state        Stato di gioco corrente.
+ * @param[in]  max_depth    Profondità massima (<= 0 per usare \ref MAX_DEPTH).
+ * @param[in]  soft_ms      Budget "morbido" in millisecondi.
+ * @param[in]  hard_ms      Budget "duro" in millisecondi (>= \p soft_ms).
+ * @param[in]  cache_handle Puntatore alla struttura della cache (o \c NULL).
+ * @return La mossa selezionata (allocata dinamicamente con \c copy_move),
+ *         oppure \c NULL se lo stato è terminale o non ci sono mosse.
+ *
+ * @note L'oggetto restituito deve essere liberato dall'utente con \c free_move.
+ */
+void* get_best_move_timed(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    long soft_ms,
+    long hard_ms,
+    void *cache_handle
+);
+
+/**
+ * @brief Determina la mossa migliore, interrompibile da un flag esterno.
+ *
+ * Esegue iterative deepening come \ref get_best_move_id, ma legge il flag
+ * \p stop_flag ogni \ref TIME_CHECK_INTERVAL nodi (lo stesso aggancio usato
+ * dalle scadenze di \ref get_best_move_timed e dal pondering): quando il
+ * chiamante lo alza da un altro thread, la ricerca rientra in pochi
+ * millisecondi. È il driver per chi ospita la ricerca in un thread worker
+ * (tipicamente una GUI che deve continuare a pompare eventi): il worker
+ * chiama questa funzione, il thread dell'interfaccia alza il flag per
+ * annullare.
+ *
+ * Come per \ref get_best_move_timed la mossa restituita è quella dell'ultima
+ * iterazione COMPLETATA; un flag già alzato alla chiamata restituisce
+ * comunque la mossa dell'iterazione a profondità 1 (praticamente immediata),
+ * così il chiamante distingue "annullata" (suo flag) da "nessuna mossa"
+ * (stato terminale).
+ *
+ * @param[in]  gd           Puntatore al descrittore di gioco.
+ * @param[in]  state        Stato di gioco corrente.
+ * @param[in]  max_depth    Profondità massima (<= 0 per usare \ref MAX_DEPTH).
+ * @param[in]  stop_flag    Flag di stop alzato dal chiamante (o \c NULL).
+ * @param[in]  cache_handle Puntatore alla struttura della cache (o \c NULL).
+ * @return La mossa selezionata (allocata dinamicamente con \c copy_move),
+ *         oppure \c NULL se lo stato è terminale o non ci sono mosse.
+ *
+ * @note L'oggetto restituito deve essere liberato dall'utente con \c free_move.
+ */
+void* get_best_move_stoppable(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    volatile int *stop_flag,
+    void *cache_handle
+);
+
+/**
+ * @brief Determina la mossa migliore con una ricerca parallela "Lazy SMP".
+ *
+ * Avvia \p num_threads worker che cercano tutti la stessa posizione radice a
+ * profondità scaglionate, condividendo la transposition table \p cache_handle
+ * (che viene automaticamente messa in modalità thread-safe con
+ * \ref cache_set_thread_safe). Ogni worker lavora su una copia privata dello
+ * stato ottenuta con \c copy_state; i worker di supporto servono solo a
+ * riempire la cache e vengono fermati quando il worker principale completa
+ * il proprio iterative deepening.
+ *
+ * @param[in]  gd           Puntatore al descrittore di gioco.
+ * @param[in]  state        Stato di gioco corrente.
+ * @param[in]  max_depth    Profondità massima di ricerca.
+ * @param[in]  num_threads  Numero di worker (<= 1 equivale a \ref get_best_move_id).
+ * @param[in]  cache_handle Transposition table condivisa (o \c NULL).
+ * @return La mossa selezionata (allocata dinamicamente con \c copy_move),
+ *         oppure \c NULL se lo stato è terminale o non ci sono mosse.
+ *
+ * @note L'oggetto restituito deve essere liberato dall'utente con \c free_move.
+ */
+void* get_best_move_parallel(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    int num_threads,
+    void *cache_handle
+);
+
+/**
+ * @brief Determina la mossa migliore con parallelismo YBWC alla radice.
+ *
+ * Applica il principio "young brothers wait" al nodo radice: per ogni
+ * iterazione dell'iterative deepening la prima mossa (nell'ordine euristico)
+ * viene cercata serialmente a stabilire la finestra, poi le mosse rimanenti
+ * vengono pubblicate come split point da cui i worker — e il thread
+ * chiamante stesso — prelevano lavoro, condividendo la finestra
+ * (alpha, beta) via mutex. Un fail-high alla radice propaga uno stop che
+ * abortisce anche i sottoalberi già rubati.
+ *
+ * A differenza di \ref get_best_move_parallel (Lazy SMP), l'albero viene
+ * davvero suddiviso: nessun nodo è cercato da due worker, quindi la
+ * modalità scala meglio sulle posizioni con molte mosse alla radice.
+ * La transposition table condivisa viene messa in modalità thread-safe.
+ *
+ * @param[in]  gd           Puntatore al descrittore di gioco.
+ * @param[in]  state        Stato di gioco corrente.
+ * @param[in]  max_depth    Profondità massima (<= 0 per usare \ref MAX_DEPTH).
+ * @param[in]  num_threads  Numero totale di thread (<= 1 equivale a
+ *                          \ref get_best_move_id).
+ * @param[in]  cache_handle Transposition table condivisa (o \c NULL).
+ * @return La mossa selezionata (allocata dinamicamente con \c copy_move),
+ *         oppure \c NULL se lo stato è terminale o non ci sono mosse.
+ *
+ * @note L'oggetto restituito deve essere liberato dall'utente con \c free_move.
+ */
+void* get_best_move_ybwc(
+    const game_descriptor_t *gd,
+    const void *state,
+    int max_depth,
+    int num_threads,
+    void *cache_handle
+);
+
+/* --------------------------------------------------------------------------
+ * PONDERING (ricerca sul tempo dell'avversario)
+ * --------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Sessione di pondering (opaca: definita in minimax.c).
+ *
+ * Incapsula il thread che cerca in background mentre l'avversario riflette
+ * e gli stati necessari al confronto ponder-hit/ponder-miss.
+ */
+typedef struct ponder_session ponder_session_t;
+
+/**
+ * @brief Avvia una ricerca in background sul tempo dell'avversario.
+ *
+ * Da chiamare subito dopo aver giocato la propria mossa: \p state è la
+ * posizione in cui tocca all'avversario e \p predicted_move la sua risposta
+ * prevista (tipicamente la seconda mossa della PV restituita da
+ * \ref get_best_move_id_pv). Il thread esegue iterative deepening sulla
+ * posizione risultante, depositando i risultati nella transposition table
+ * \p cache_handle: se l'avversario gioca davvero la mossa prevista, la
+ * ricerca successiva li trova già pronti. La cache viene automaticamente
+ * messa in modalità thread-safe.
+ *
+ * Con \p predicted_move \c NULL si pondera direttamente su \p state,
+ * riempiendo la cache per qualunque risposta (meno profondo ma mai "miss").
+ *
+ * Uso tipico:
+ * @code
+ *   ponder_session_t *ps = ponder_start(gd, state, pv.moves[1], depth, cache);
+ *   // ... arriva la mossa reale dell'avversario ...
+ *   int hit = ponder_hit(ps, actual);
+ *   ponder_stop(ps);                       // interruzione quasi immediata
+ *   apply della mossa reale, poi get_best_move_timed(...) con la stessa cache
+ * @endcode
+ *
+ * @param[in] gd             Puntatore al descrittore di gioco.
+ * @param[in] state          Posizione in cui muove l'avversario.
+ * @param[in] predicted_move Risposta prevista (o \c NULL).
+ * @param[in] max_depth      Profondità massima (<= 0 per usare \ref MAX_DEPTH).
+ * @param[in] cache_handle   Transposition table condivisa (o \c NULL).
+ * @return Sessione da chiudere con \ref ponder_stop, o \c NULL su errore
+ *         o stato terminale.
+ */
+ponder_session_t* ponder_start(
+    const game_descriptor_t *gd,
+    const void *state,
+    const void *predicted_move,
+    int max_depth,
+    void *cache_handle
+);
+
+/**
+ * @brief Verifica se la mossa reale dell'avversario coincide con quella prevista.
+ *
+ * Il confronto avviene per stati (via \c apply_move + \c equals_state), non
+ * per mosse: due codifiche diverse della stessa mossa contano come hit.
+ * Non ferma la ricerca in background.
+ *
+ * @param[in] ps          Sessione di pondering attiva.
+ * @param[in] actual_move Mossa effettivamente giocata dall'avversario.
+ * @return 1 in caso di ponder hit, 0 altrimenti (anche senza previsione).
+ */
+int ponder_hit(const ponder_session_t *ps, const void *actual_move);
+
+/**
+ * @brief Ferma il thread di pondering e libera la sessione.
+ *
+ * Il flag di stop viene letto dalla ricerca ogni \ref TIME_CHECK_INTERVAL
+ * nodi, quindi il join si completa in pochi millisecondi. I risultati già
+ * depositati nella transposition table restano disponibili.
+ *
+ * @param[in,out] ps Sessione restituita da \ref ponder_start (o \c NULL).
+ */
+void ponder_stop(ponder_session_t *ps);
+
 #endif /* MINIMAX_H */
@@ -0,0 +1,367 @@
+/**
+ * ##VERSION## "minimax_tt.c 1.4"
+*/
+
+/******************************************************************************
+ * File: minimax_tt.c
+ *
+ * Transposition table compatta a dimensione fissa per la ricerca minimax:
+ * array contiguo di voci da 16 byte indicizzato dai bit bassi della chiave
+ * Zobrist, con politica di rimpiazzo depth-preferred.
+ *
+ * Accesso concorrente lock-free: ogni voce è una coppia di parole a 64 bit
+ * (chiave XOR dati, dati) lette e scritte con operazioni atomiche rilassate.
+ * Una scrittura "strappata" da un altro thread (chiave di una voce, dati di
+ * un'altra) fallisce la verifica chiave^dati in lettura e viene trattata
+ * come un normale miss: N thread di ricerca condividono la tavola senza
+ * alcun mutex.
+ ******************************************************************************/
+
+#include "minimax_tt.h"
+#include "obj_trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Span di profilazione della pipeline di ricerca (attivi solo compilando
+   con -DTRACE_SPANS_ON, vedi obj_trace.h) */
+TRACE_SPAN_DEFINE(span_tt_probe, "minimax_tt_probe");
+TRACE_SPAN_DEFINE(span_tt_store, "minimax_tt_store");
+
+/*
+ * Rappresentazione interna di una voce: la parola `xkey` contiene la chiave
+ * Zobrist XOR i dati, la parola `data` impacchetta valore, mossa migliore,
+ * profondità e tipo di bound. La voce libera è la coppia (0, 0).
+ */
+typedef struct tt_slot {
+    uint64_t xkey;  /* chiave ^ data (0 con data==0 => voce libera) */
+    uint64_t data;  /* campi impacchettati, vedi tt_pack/tt_unpack */
+} tt_slot_t;
+
+struct minimax_tt {
+    tt_slot_t *slots;            /* array contiguo, num_entries voci */
+    size_t     num_entries;      /* potenza di due */
+    uint64_t   index_mask;       /* num_entries - 1 */
+    uint8_t    generation;       /* età della ricerca corrente (6 bit) */
+
+    /* Modalità mmap (minimax_tt_open_mmap): l'array di slot vive in un file
+     * mappato in memoria, preceduto da un header di controllo. */
+    void      *map_base;         /* base della mappatura (NULL = tavola heap) */
+    size_t     map_size;         /* dimensione totale del file mappato */
+    int        fd;               /* descrittore del file (-1 = tavola heap) */
+};
+
+/*
+ * Header del file su disco: permette di riconoscere al riavvio un file
+ * compatibile (stesso formato e stessa dimensione) e di riprendere la
+ * generazione da dove era rimasta. Gli slot seguono subito dopo.
+ */
+#define TT_FILE_MAGIC 0x314D4D5454ULL   /* "TTMM1" */
+
+typedef struct tt_file_header {
+    uint64_t magic;        /* TT_FILE_MAGIC */
+    uint64_t num_entries;  /* numero di slot nel file */
+    uint64_t generation;   /* generazione al momento dell'ultimo sync */
+    uint64_t reserved;     /* padding: l'header resta di 32 byte */
+} tt_file_header_t;
+
+/*
+ * Impacchetta i campi della voce in una parola a 64 bit:
+ *   bit  0..31  value (int32)
+ *   bit 32..47  best_move (uint16)
+ *   bit 48..55  depth (int8)
+ *   bit 56..57  type (2 bit: EXACT/LOWER/UPPER)
+ *   bit 58..63  generation (6 bit, vedi minimax_tt_new_search)
+ */
+#define TT_GEN_MASK 0x3Fu
+
+static uint64_t tt_pack(int32_t value, uint16_t best_move, int8_t depth,
+                        uint8_t type, uint8_t generation) {
+    return (uint64_t)(uint32_t)value
+         | ((uint64_t)best_move << 32)
+         | ((uint64_t)(uint8_t)depth << 48)
+         | ((uint64_t)(type & 0x3u) << 56)
+         | ((uint64_t)(generation & TT_GEN_MASK) << 58);
+}
+
+static void tt_unpack(uint64_t data, minimax_tt_entry_t *out) {
+    out->value     = (int32_t)(uint32_t)(data & 0xFFFFFFFFu);
+    out->best_move = (uint16_t)((data >> 32) & 0xFFFFu);
+    out->depth     = (int8_t)(uint8_t)((data >> 48) & 0xFFu);
+    out->type      = (uint8_t)((data >> 56) & 0x3u);
+}
+
+static uint8_t tt_generation_of(uint64_t data) {
+    return (uint8_t)((data >> 58) & TT_GEN_MASK);
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_create
+ ******************************************************************************/
+minimax_tt_t* minimax_tt_create(size_t size_mb)
+{
+    if (size_mb < 1) {
+        size_mb = 1;
+    }
+
+    /* Arrotonda il numero di voci per difetto alla potenza di due */
+    size_t wanted = (size_mb * 1024u * 1024u) / sizeof(tt_slot_t);
+    size_t num_entries = 1;
+    while (num_entries * 2 <= wanted) {
+        num_entries *= 2;
+    }
+
+    minimax_tt_t *tt = (minimax_tt_t*) malloc(sizeof(minimax_tt_t));
+    if (!tt) {
+        TRACE_ERROR(&stdtrace, "minimax_tt_create: allocazione struttura fallita");
+        return NULL;
+    }
+
+    /* calloc: tutte le voci partono libere (coppia 0,0) */
+    tt->slots = (tt_slot_t*) calloc(num_entries, sizeof(tt_slot_t));
+    if (!tt->slots) {
+        TRACE_ERROR(&stdtrace,
+                    "minimax_tt_create: allocazione di %zu voci fallita",
+                    num_entries);
+        free(tt);
+        return NULL;
+    }
+
+    tt->num_entries = num_entries;
+    tt->index_mask = (uint64_t)(num_entries - 1);
+    tt->generation = 0;
+    tt->map_base = NULL;
+    tt->map_size = 0;
+    tt->fd = -1;
+
+    TRACE_DEBUG(&stdtrace, "minimax_tt_create: %zu voci (%zu MiB richiesti)",
+                num_entries, size_mb);
+    return tt;
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_open_mmap
+ ******************************************************************************/
+minimax_tt_t* minimax_tt_open_mmap(const char *path, size_t size_mb)
+{
+    if (!path) {
+        return NULL;
+    }
+    if (size_mb < 1) {
+        size_mb = 1;
+    }
+
+    size_t wanted = (size_mb * 1024u * 1024u) / sizeof(tt_slot_t);
+    size_t num_entries = 1;
+    while (num_entries * 2 <= wanted) {
+        num_entries *= 2;
+    }
+    size_t map_size = sizeof(tt_file_header_t) + num_entries * sizeof(tt_slot_t);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        TRACE_ERROR(&stdtrace, "minimax_tt_open_mmap: open(%s) fallita", path);
+        return NULL;
+    }
+
+    /* Il file è riutilizzabile solo se header e dimensione coincidono:
+     * altrimenti (file nuovo, troncato o di un formato diverso) riparte
+     * da una tavola vuota. */
+    int warm = 0;
+    struct stat st;
+    tt_file_header_t hdr;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == map_size &&
+        read(fd, &hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr) &&
+        hdr.magic == TT_FILE_MAGIC && hdr.num_entries == (uint64_t)num_entries) {
+        warm = 1;
+    }
+
+    if (!warm &&
+        (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)map_size) != 0)) {
+        TRACE_ERROR(&stdtrace, "minimax_tt_open_mmap: ftruncate(%s, %zu) fallita",
+                    path, map_size);
+        close(fd);
+        return NULL;
+    }
+
+    void *base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        TRACE_ERROR(&stdtrace, "minimax_tt_open_mmap: mmap(%s) fallita", path);
+        close(fd);
+        return NULL;
+    }
+
+    minimax_tt_t *tt = (minimax_tt_t*) malloc(sizeof(minimax_tt_t));
+    if (!tt) {
+        TRACE_ERROR(&stdtrace, "minimax_tt_open_mmap: allocazione struttura fallita");
+        munmap(base, map_size);
+        close(fd);
+        return NULL;
+    }
+
+    tt_file_header_t *fhdr = (tt_file_header_t*) base;
+    if (!warm) {
+        /* ftruncate ha già azzerato gli slot: basta scrivere l'header */
+        fhdr->magic = TT_FILE_MAGIC;
+        fhdr->num_entries = (uint64_t)num_entries;
+        fhdr->generation = 0;
+        fhdr->reserved = 0;
+    }
+
+    tt->slots = (tt_slot_t*)((unsigned char*)base + sizeof(tt_file_header_t));
+    tt->num_entries = num_entries;
+    tt->index_mask = (uint64_t)(num_entries - 1);
+    tt->generation = (uint8_t)(fhdr->generation & TT_GEN_MASK);
+    tt->map_base = base;
+    tt->map_size = map_size;
+    tt->fd = fd;
+
+    TRACE_DEBUG(&stdtrace,
+                "minimax_tt_open_mmap: %s => %zu voci, %s",
+                path, num_entries, warm ? "warm start" : "tavola nuova");
+    return tt;
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_sync
+ ******************************************************************************/
+int minimax_tt_sync(minimax_tt_t *tt)
+{
+    if (!tt || tt->map_base == NULL) {
+        return 0;  /* tavola heap: niente da sincronizzare */
+    }
+
+    ((tt_file_header_t*)tt->map_base)->generation = tt->generation;
+    if (msync(tt->map_base, tt->map_size, MS_SYNC) != 0) {
+        TRACE_ERROR(&stdtrace, "minimax_tt_sync: msync fallita");
+        return -1;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_destroy
+ ******************************************************************************/
+void minimax_tt_destroy(minimax_tt_t *tt)
+{
+    if (!tt) {
+        return;
+    }
+    if (tt->map_base != NULL) {
+        /* Ultimo checkpoint, poi smonta la mappatura */
+        minimax_tt_sync(tt);
+        munmap(tt->map_base, tt->map_size);
+        close(tt->fd);
+    } else {
+        free(tt->slots);
+    }
+    free(tt);
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_clear
+ ******************************************************************************/
+void minimax_tt_clear(minimax_tt_t *tt)
+{
+    if (!tt) {
+        return;
+    }
+    /* Non atomico: da chiamare solo quando nessuna ricerca è in corso */
+    memset(tt->slots, 0, tt->num_entries * sizeof(tt_slot_t));
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_probe
+ ******************************************************************************/
+int minimax_tt_probe(const minimax_tt_t *tt, uint64_t key, minimax_tt_entry_t *out)
+{
+    if (!tt || key == 0) {
+        return 0;
+    }
+    TRACE_SPAN_SCOPE(span_tt_probe);
+
+    const tt_slot_t *slot = &tt->slots[key & tt->index_mask];
+    uint64_t data = __atomic_load_n(&slot->data, __ATOMIC_RELAXED);
+    uint64_t xkey = __atomic_load_n(&slot->xkey, __ATOMIC_RELAXED);
+
+    /* La verifica chiave^dati scarta sia gli slot liberi o di altre
+     * posizioni, sia le coppie strappate da uno store concorrente */
+    if ((xkey ^ data) != key) {
+        return 0;
+    }
+
+    out->key = key;
+    tt_unpack(data, out);
+    return 1;
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_store
+ ******************************************************************************/
+void minimax_tt_store(minimax_tt_t *tt, uint64_t key, int value, int depth,
+                      int type, int best_move)
+{
+    TRACE_SPAN_SCOPE(span_tt_store);
+    if (!tt || key == 0) {
+        /* key 0 è la marca di slot libero: la posizione (statisticamente
+         * impossibile) con hash 0 semplicemente non viene memorizzata */
+        return;
+    }
+
+    tt_slot_t *slot = &tt->slots[key & tt->index_mask];
+
+    /* Depth-preferred con invecchiamento: una voce profonda (costosa da
+     * ricalcolare) non viene scalzata da una superficiale — nemmeno per la
+     * STESSA posizione, o durante l'iterative deepening le rivisite poco
+     * profonde distruggerebbero i risultati delle iterazioni precedenti.
+     * Le voci di ricerche precedenti (generazione diversa) vengono invece
+     * sovrascritte sempre: a tavola piena è la spazzatura vecchia a uscire
+     * per prima, non i risultati vicini alla radice corrente.
+     * Il controllo e la scrittura non sono un'unica operazione atomica:
+     * nel raro caso di gara tra due store vince l'ultimo, un compromesso
+     * standard per le tavole lock-free. */
+    uint64_t old_data = __atomic_load_n(&slot->data, __ATOMIC_RELAXED);
+    uint64_t old_xkey = __atomic_load_n(&slot->xkey, __ATOMIC_RELAXED);
+    if ((old_xkey | old_data) != 0 &&
+        tt_generation_of(old_data) == tt->generation) {
+        int8_t old_depth = (int8_t)(uint8_t)((old_data >> 48) & 0xFFu);
+        if (old_depth > depth) {
+            return;
+        }
+    }
+
+    int8_t d8 = (int8_t)((depth > 127) ? 127 : (depth < -128 ? -128 : depth));
+    uint16_t bm = (best_move >= 0 && best_move < MINIMAX_TT_NO_MOVE)
+                  ? (uint16_t)best_move
+                  : (uint16_t)MINIMAX_TT_NO_MOVE;
+    uint64_t data = tt_pack((int32_t)value, bm, d8, (uint8_t)type,
+                            tt->generation);
+
+    __atomic_store_n(&slot->xkey, key ^ data, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->data, data, __ATOMIC_RELAXED);
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_new_search
+ ******************************************************************************/
+void minimax_tt_new_search(minimax_tt_t *tt)
+{
+    if (!tt) {
+        return;
+    }
+    /* 6 bit con wrap: dopo 64 ricerche una voce antica può tornare "giovane",
+     * ma a quel punto è quasi certamente già stata sovrascritta */
+    tt->generation = (uint8_t)((tt->generation + 1) & TT_GEN_MASK);
+}
+
+/******************************************************************************
+ * Funzione: minimax_tt_num_entries
+ ******************************************************************************/
+size_t minimax_tt_num_entries(const minimax_tt_t *tt)
+{
+    return tt ? tt->num_entries : 0;
+}
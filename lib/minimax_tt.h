@@ -0,0 +1,188 @@
+/******************************************************************************
+# ##VERSION## "minimax_tt.h 1.3"
+#
+# Nome Progetto  : ChessEngine
+# Versione       : 1.0
+# Data Creazione : 31/08/2026
+# Autore         : [Il tuo nome]
+#
+# Descrizione    : Transposition table dedicata alla ricerca: un unico array
+#                  contiguo di voci compatte da 16 byte (chiave Zobrist,
+#                  punteggio, profondità, tipo di bound, mossa migliore)
+#                  indicizzato dai bit bassi della chiave. Rispetto alla
+#                  cache generica (obj_cache) elimina il pointer-chasing sui
+#                  bucket, l'allocazione per ogni store e la copia profonda
+#                  dello stato come chiave: ogni probe tocca una sola linea
+#                  di cache e la memoria è fissata alla creazione.
+#
+#                  Probe e store sono lock-free (trucco chiave XOR dati con
+#                  letture/scritture atomiche rilassate): più thread di
+#                  ricerca possono condividere la stessa tavola senza mutex,
+#                  una scrittura strappata appare in lettura come un miss.
+#
+# Dipendenze     : stdint.h, stddef.h
+#
+# Uso:
+#   minimax_tt_t *tt = minimax_tt_create(64);        // 64 MiB
+#   minimax_set_ttable(tt);                           // la ricerca la usa
+#   ... get_best_move_id(...) ...
+#   minimax_set_ttable(NULL);
+#   minimax_tt_destroy(tt);
+#
+******************************************************************************/
+
+#ifndef MINIMAX_TT_H
+#define MINIMAX_TT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @def MINIMAX_TT_NO_MOVE
+ * Valore del campo best_move quando il nodo non ha una mossa migliore
+ * registrata (nodo fail-low, o gioco senza callback pack_move/move_index).
+ */
+#define MINIMAX_TT_NO_MOVE 0xFFFF
+
+/** Tipi di bound memorizzati (stessa semantica del NodeType della ricerca) */
+#define MINIMAX_TT_EXACT       0  /**< punteggio esatto */
+#define MINIMAX_TT_LOWER_BOUND 1  /**< punteggio >= value (fail-high) */
+#define MINIMAX_TT_UPPER_BOUND 2  /**< punteggio <= value (fail-low) */
+
+/**
+ * @struct minimax_tt_entry
+ * @brief Voce compatta della transposition table (16 byte esatti).
+ *
+ * La chiave Zobrist completa viene conservata per riconoscere le collisioni
+ * di indice: due posizioni diverse che condividono i bit bassi della chiave
+ * non vengono mai confuse (restano solo le collisioni dell'hash a 64 bit,
+ * statisticamente trascurabili).
+ */
+typedef struct minimax_tt_entry {
+    uint64_t key;       /**< chiave Zobrist completa (0 = voce libera) */
+    int32_t  value;     /**< punteggio del nodo */
+    uint16_t best_move; /**< mossa migliore per valore: codifica di pack_move
+                             se il gioco la fornisce, altrimenti l'indice
+                             compatto move_index, o \ref MINIMAX_TT_NO_MOVE */
+    int8_t   depth;     /**< profondità residua della ricerca che ha prodotto la voce */
+    uint8_t  type;      /**< MINIMAX_TT_EXACT / LOWER_BOUND / UPPER_BOUND
+                             (internamente il byte ospita anche la generazione,
+                             che il probe non espone) */
+} minimax_tt_entry_t;
+
+/**
+ * @brief Transposition table a dimensione fissa (opaca: definita in minimax_tt.c).
+ */
+typedef struct minimax_tt minimax_tt_t;
+
+/**
+ * @brief Crea una transposition table di circa \p size_mb mebibyte.
+ *
+ * Il numero di voci viene arrotondato per difetto alla potenza di due, così
+ * l'indicizzazione è una maschera sui bit bassi della chiave. La memoria
+ * viene azzerata e non cresce mai: a tavola piena lavora la politica di
+ * rimpiazzo (vedi \ref minimax_tt_store).
+ *
+ * @param[in] size_mb Dimensione richiesta in MiB (>= 1).
+ * @return La tavola creata, o \c NULL per errore di allocazione.
+ */
+minimax_tt_t* minimax_tt_create(size_t size_mb);
+
+/**
+ * @brief Apre (o crea) una transposition table persistente su file mmap.
+ *
+ * Gli slot vivono in un file mappato in memoria con MAP_SHARED: probe e
+ * store lavorano direttamente sulle pagine mappate, senza alcuna copia.
+ * Se \p path contiene già una tavola dello stesso formato e della stessa
+ * dimensione, il contenuto viene ripreso così com'è ("warm start": una
+ * sessione di analisi riparte dalla tavola della precedente); altrimenti
+ * il file viene (ri)creato azzerato. Il file inizia con un piccolo header
+ * di controllo (formato, numero di voci, generazione).
+ *
+ * La tavola restituita si usa esattamente come quella heap, compreso
+ * \ref minimax_tt_destroy che sincronizza e smonta la mappatura.
+ *
+ * @param[in] path    Percorso del file della tavola.
+ * @param[in] size_mb Dimensione richiesta in MiB (>= 1); per riprendere un
+ *                    file esistente deve coincidere con quella originale.
+ * @return La tavola mappata, o \c NULL per errore di I/O o allocazione.
+ */
+minimax_tt_t* minimax_tt_open_mmap(const char *path, size_t size_mb);
+
+/**
+ * @brief Forza il checkpoint su disco di una tavola mmap.
+ *
+ * Aggiorna la generazione nell'header e chiama msync: al ritorno il file
+ * riflette lo stato corrente della tavola. Sulle tavole heap è un no-op.
+ *
+ * @param[in] tt Tavola (può essere \c NULL).
+ * @return 0 in caso di successo (o no-op), -1 per errore di I/O.
+ */
+int minimax_tt_sync(minimax_tt_t *tt);
+
+/**
+ * @brief Distrugge la tavola e libera la memoria.
+ */
+void minimax_tt_destroy(minimax_tt_t *tt);
+
+/**
+ * @brief Svuota la tavola (tutte le voci tornano libere).
+ */
+void minimax_tt_clear(minimax_tt_t *tt);
+
+/**
+ * @brief Cerca la voce per la chiave \p key.
+ *
+ * Un solo accesso all'array (nessuna catena): la voce all'indice
+ * key & (num_voci - 1) è un hit solo se la chiave completa coincide.
+ * Sicuro da chiamare in parallelo a store di altri thread: una coppia
+ * chiave/dati strappata fallisce la verifica e conta come miss.
+ *
+ * @param[in]  tt  Tavola (può essere \c NULL: ritorna 0).
+ * @param[in]  key Chiave Zobrist della posizione.
+ * @param[out] out Copia della voce trovata.
+ * @return 1 se la voce esiste, 0 altrimenti.
+ */
+int minimax_tt_probe(const minimax_tt_t *tt, uint64_t key, minimax_tt_entry_t *out);
+
+/**
+ * @brief Memorizza (o aggiorna) la voce per la chiave \p key.
+ *
+ * Politica di rimpiazzo "depth-preferred": la voce viene scritta se lo slot
+ * è libero, se contiene già la stessa chiave, oppure se la nuova profondità
+ * è maggiore o uguale a quella memorizzata — i risultati profondi, i più
+ * costosi da ricalcolare, non vengono scalzati da visite superficiali.
+ * La protezione vale solo per le voci della generazione corrente: quelle
+ * di ricerche precedenti (vedi \ref minimax_tt_new_search) vengono
+ * sovrascritte sempre, qualunque sia la loro profondità.
+ * Senza mutex il controllo di profondità e la scrittura possono gareggiare
+ * tra thread: nel caso peggiore vince l'ultimo store, mai una voce corrotta.
+ *
+ * @param[in] tt        Tavola (può essere \c NULL: no-op).
+ * @param[in] key       Chiave Zobrist della posizione.
+ * @param[in] value     Punteggio del nodo.
+ * @param[in] depth     Profondità residua della ricerca.
+ * @param[in] type      MINIMAX_TT_EXACT / LOWER_BOUND / UPPER_BOUND.
+ * @param[in] best_move Indice compatto della mossa migliore, o -1.
+ */
+void minimax_tt_store(minimax_tt_t *tt, uint64_t key, int value, int depth,
+                      int type, int best_move);
+
+/**
+ * @brief Apre una nuova generazione di ricerca (invecchia le voci esistenti).
+ *
+ * Da chiamare (lo fanno già i driver get_best_move_*) all'inizio di ogni
+ * ricerca dalla radice: le voci delle generazioni precedenti restano
+ * leggibili ma perdono la protezione depth-preferred, quindi a tavola piena
+ * vengono sovrascritte per prime. Il contatore è a 6 bit con wrap.
+ *
+ * @param[in] tt Tavola (può essere \c NULL: no-op).
+ */
+void minimax_tt_new_search(minimax_tt_t *tt);
+
+/**
+ * @brief Numero di voci della tavola (potenza di due).
+ */
+size_t minimax_tt_num_entries(const minimax_tt_t *tt);
+
+#endif /* MINIMAX_TT_H */
@@ -1,5 +1,5 @@
 /**
- * ##VERSION## "obj_cache.c 1.1"
+ * ##VERSION## "obj_cache.c 1.6"
 */
 
 #include "obj_mem.h"
@@ -7,58 +7,224 @@
 #include "obj_cache.h"
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
 
-/* 
- * Struttura interna per memorizzare la singola voce (entry)
- * di una lista collegata in un bucket.
+/*
+ * Fattore di carico oltre il quale la tabella viene raddoppiata:
+ * con indirizzamento aperto le prestazioni degradano rapidamente
+ * sopra il 75% di occupazione.
+ */
+#define CACHE_MAX_LOAD_NUM 3
+#define CACHE_MAX_LOAD_DEN 4
+
+/*
+ * Slot della tabella a indirizzamento aperto (linear probing).
+ * key == NULL marca lo slot libero: cache_store rifiuta già le chiavi
+ * NULL, quindi il valore è disponibile come sentinella.
+ * L'hash viene conservato per evitare di richiamare la callback durante
+ * il rehashing e per scartare velocemente gli slot di altre chiavi.
  */
 struct hash_entry {
-    void *key;             /* chiave */
-    void *value;           /* valore associato */
-    struct hash_entry *next;
+    uint64_t hash;         /* hash completo della chiave */
+    void *key;             /* chiave (NULL = slot libero); in modalità
+                              by-value punta dentro key_slab */
+    void *value;           /* valore associato; in modalità by-value punta
+                              dentro value_slab */
 };
 
 /*
  * Struttura principale per la tabella hash:
- *  - array di puntatori a "hash_entry" (bucket)
- *  - dimensione attuale (capacity)
+ *  - array contiguo di slot (indirizzamento aperto, linear probing)
+ *  - capacity sempre potenza di due (indice = hash & (capacity-1))
+ *  - num_entries per il controllo del fattore di carico
  *  - callback di hash e di confronto
  */
 struct generic_hash_table {
-    struct hash_entry **buckets;  /* array di liste collegate */
-    size_t capacity;              /* dimensione dell'array buckets */
+    struct hash_entry *slots;     /* array contiguo di slot */
+    size_t capacity;              /* dimensione dell'array (potenza di due) */
+    size_t num_entries;           /* slot occupati */
+
+    /* Modalità by-value (cache_create_ex): chiavi e valori vengono copiati
+     * in due slab contigui paralleli all'array di slot, indicizzati con lo
+     * stesso indice dello slot. key_size == 0 indica la classica modalità
+     * per riferimento (la tabella conserva i puntatori del chiamante). */
+    unsigned char *key_slab;      /* capacity * key_size byte (o NULL) */
+    unsigned char *value_slab;    /* capacity * value_size byte (o NULL) */
+    size_t key_size;              /* dimensione di una chiave (0 = riferimento) */
+    size_t value_size;            /* dimensione di un valore */
 
     hash_func_t   hash_cb;        /* calcolo dell'hash */
     equals_func_t eq_cb;          /* confronto delle chiavi */
+
+    int             thread_safe;  /* 1 se lookup/store sono protetti dal mutex */
+    pthread_mutex_t lock;         /* mutex interno (valido se thread_safe=1) */
+
+    /* Contatori di introspezione (vedi cache_get_stats): aggiornati dentro
+     * le sezioni già protette dal lock, quindi coerenti anche in modalità
+     * thread-safe. L'istogramma delle lunghezze di probing registra quanti
+     * slot ha toccato ogni ricerca (l'ultimo bucket raccoglie le code). */
+    uint64_t lookups;             /* chiamate a cache_lookup */
+    uint64_t lookup_hits;         /* lookup che hanno trovato la chiave */
+    uint64_t stores;              /* chiamate a cache_store andate a buon fine */
+    uint64_t store_updates;       /* store su chiave già esistente */
+    uint64_t probe_hist[CACHE_PROBE_HIST_SIZE]; /* hist[i] = probe di i+1 slot */
+
+    uint64_t stats_interval;      /* ogni quanti lookup dumpare (0 = mai) */
 };
 
+/*
+ * Helper per prendere/rilasciare il mutex solo quando la modalità
+ * thread-safe è attiva: in modalità single-thread il costo è un if.
+ */
+static void cache_lock(generic_hash_table_t *cache) {
+    if (cache->thread_safe) {
+        pthread_mutex_lock(&cache->lock);
+    }
+}
+
+static void cache_unlock(generic_hash_table_t *cache) {
+    if (cache->thread_safe) {
+        pthread_mutex_unlock(&cache->lock);
+    }
+}
+
 /*
  * Struttura per l'iteratore esplicito
  */
 struct cache_iterator {
     generic_hash_table_t *cache;   /* tabella su cui stiamo iterando */
-    size_t current_bucket;         /* indice dell'array di bucket in cui siamo */
-    struct hash_entry *current_entry; /* puntatore all'entry nella lista corrente */
+    size_t current_slot;           /* prossimo indice dell'array da esaminare */
 };
 
 /*
- * Funzione di utilità: calcola l'indice del bucket
- * in base all'hash e alla capacity della tabella.
+ * Funzione di utilità: calcola l'indice dello slot iniziale
+ * in base all'hash e alla capacity (potenza di due) della tabella.
  */
-static size_t get_bucket_index(uint64_t hash, size_t capacity) {
-    return (size_t)(hash % capacity);
+static size_t get_slot_index(uint64_t hash, size_t capacity) {
+    return (size_t)(hash & (uint64_t)(capacity - 1));
 }
 
 /*
- * Crea la tabella hash con dimensione iniziale fissa (INITIAL_CAPACITY).
- * Non effettua rehashing dinamico in questo esempio.
+ * Cerca lo slot della chiave `key` (hash `h`) con scansione lineare.
+ * Ritorna lo slot che la contiene, oppure il primo slot libero della
+ * sequenza di probing (dove un eventuale inserimento va a finire).
+ * Da chiamare con il lock già acquisito.
+ */
+static struct hash_entry* find_slot(generic_hash_table_t *cache,
+                                    uint64_t h, const void *key) {
+    size_t index = get_slot_index(h, cache->capacity);
+    size_t probes = 1;
+
+    for (;;) {
+        struct hash_entry *slot = &cache->slots[index];
+        if (slot->key == NULL || (slot->hash == h && cache->eq_cb(slot->key, key))) {
+            /* Registra la lunghezza della sequenza di probing (per le
+             * statistiche: code lunghe = hash scadente o tabella piena) */
+            size_t bucket = (probes <= CACHE_PROBE_HIST_SIZE)
+                            ? probes - 1 : CACHE_PROBE_HIST_SIZE - 1;
+            cache->probe_hist[bucket]++;
+            return slot;
+        }
+        index = (index + 1) & (cache->capacity - 1);
+        probes++;
+    }
+}
+
+/*
+ * Raddoppia la capacity e reinserisce tutti gli slot occupati usando
+ * l'hash memorizzato (nessuna chiamata alla callback). Se l'allocazione
+ * fallisce la tabella vecchia resta in uso: le prestazioni degradano ma
+ * non si perde nulla. Da chiamare con il lock già acquisito.
+ */
+static void cache_grow(generic_hash_table_t *cache) {
+    size_t new_capacity = cache->capacity * 2;
+    struct hash_entry *new_slots =
+        (struct hash_entry*) calloc(new_capacity, sizeof(struct hash_entry));
+    if (!new_slots) {
+        TRACE_DEBUG(&stdtrace,
+                    "cache_grow: calloc fallita per %zu slot => mantengo capacity=%zu",
+                    new_capacity, cache->capacity);
+        return;
+    }
+
+    /* In modalità by-value crescono anche gli slab di chiavi e valori */
+    unsigned char *new_keys = NULL;
+    unsigned char *new_values = NULL;
+    if (cache->key_size > 0) {
+        new_keys   = (unsigned char*) malloc(new_capacity * cache->key_size);
+        new_values = (unsigned char*) malloc(new_capacity * cache->value_size);
+        if (!new_keys || !new_values) {
+            TRACE_DEBUG(&stdtrace,
+                        "cache_grow: allocazione slab fallita => mantengo capacity=%zu",
+                        cache->capacity);
+            free(new_keys);
+            free(new_values);
+            free(new_slots);
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < cache->capacity; i++) {
+        struct hash_entry *old_slot = &cache->slots[i];
+        if (old_slot->key == NULL) {
+            continue;
+        }
+        size_t index = get_slot_index(old_slot->hash, new_capacity);
+        while (new_slots[index].key != NULL) {
+            index = (index + 1) & (new_capacity - 1);
+        }
+        new_slots[index] = *old_slot;
+        if (cache->key_size > 0) {
+            /* Ricolloca la copia di chiave e valore all'indice nuovo */
+            memcpy(new_keys + index * cache->key_size,
+                   old_slot->key, cache->key_size);
+            memcpy(new_values + index * cache->value_size,
+                   old_slot->value, cache->value_size);
+            new_slots[index].key   = new_keys + index * cache->key_size;
+            new_slots[index].value = new_values + index * cache->value_size;
+        }
+    }
+
+    free(cache->slots);
+    cache->slots = new_slots;
+    cache->capacity = new_capacity;
+    if (cache->key_size > 0) {
+        free(cache->key_slab);
+        free(cache->value_slab);
+        cache->key_slab = new_keys;
+        cache->value_slab = new_values;
+    }
+
+    TRACE_DEBUG(&stdtrace, "cache_grow: capacity portata a %zu (%zu voci)",
+                new_capacity, cache->num_entries);
+}
+
+/*
+ * Crea la tabella hash con dimensione iniziale INITIAL_CAPACITY.
+ * La tabella cresce da sola (raddoppio) quando il fattore di carico
+ * supera CACHE_MAX_LOAD_NUM/CACHE_MAX_LOAD_DEN.
  */
 generic_hash_table_t* cache_create(hash_func_t hash_cb, equals_func_t eq_cb) {
+    return cache_create_ex(hash_cb, eq_cb, 0, 0);
+}
+
+/*
+ * Variante by-value: la tabella copia chiavi e valori (di dimensione fissa)
+ * in slab contigui propri, invece di conservare i puntatori del chiamante.
+ * cache_lookup restituisce un puntatore alla copia interna del valore.
+ */
+generic_hash_table_t* cache_create_ex(hash_func_t hash_cb, equals_func_t eq_cb,
+                                      size_t key_size, size_t value_size) {
     if (!hash_cb || !eq_cb) {
         TRACE_DEBUG(&stdtrace,
                     "cache_create: callback di hash o equals mancanti => ritorno NULL");
         return NULL; /* Callbacks obbligatorie */
     }
+    if (key_size > 0 && value_size == 0) {
+        TRACE_DEBUG(&stdtrace,
+                    "cache_create_ex: key_size senza value_size => ritorno NULL");
+        return NULL; /* modalità by-value: servono entrambe le dimensioni */
+    }
 
     TRACE_DEBUG(&stdtrace,
                 "cache_create: Alloco la struttura principale con capacity=%d",
@@ -71,19 +237,44 @@ generic_hash_table_t* cache_create(hash_func_t hash_cb, equals_func_t eq_cb) {
     }
 
     ht->capacity = INITIAL_CAPACITY;
+    ht->num_entries = 0;
     ht->hash_cb = hash_cb;
     ht->eq_cb   = eq_cb;
-
-    /* Alloca l'array di bucket */
-    ht->buckets = (struct hash_entry**) calloc(ht->capacity, sizeof(struct hash_entry*));
-    if (!ht->buckets) {
-        TRACE_DEBUG(&stdtrace, "cache_create: calloc fallita per l'array di bucket");
+    ht->thread_safe = 0;
+    ht->key_slab = NULL;
+    ht->value_slab = NULL;
+    ht->key_size = key_size;
+    ht->value_size = (key_size > 0) ? value_size : 0;
+    ht->lookups = 0;
+    ht->lookup_hits = 0;
+    ht->stores = 0;
+    ht->store_updates = 0;
+    memset(ht->probe_hist, 0, sizeof(ht->probe_hist));
+    ht->stats_interval = 0;
+
+    /* Alloca l'array di slot (tutti liberi: key == NULL) */
+    ht->slots = (struct hash_entry*) calloc(ht->capacity, sizeof(struct hash_entry));
+    if (!ht->slots) {
+        TRACE_DEBUG(&stdtrace, "cache_create: calloc fallita per l'array di slot");
         free(ht);
         return NULL;
     }
 
-    TRACE_DEBUG(&stdtrace, "cache_create: completato => ht=%p, buckets=%p",
-                (void*)ht, (void*)ht->buckets);
+    if (key_size > 0) {
+        ht->key_slab   = (unsigned char*) malloc(ht->capacity * key_size);
+        ht->value_slab = (unsigned char*) malloc(ht->capacity * value_size);
+        if (!ht->key_slab || !ht->value_slab) {
+            TRACE_DEBUG(&stdtrace, "cache_create_ex: allocazione slab fallita");
+            free(ht->key_slab);
+            free(ht->value_slab);
+            free(ht->slots);
+            free(ht);
+            return NULL;
+        }
+    }
+
+    TRACE_DEBUG(&stdtrace, "cache_create: completato => ht=%p, slots=%p",
+                (void*)ht, (void*)ht->slots);
     return ht;
 }
 
@@ -101,19 +292,17 @@ void cache_destroy(generic_hash_table_t *cache) {
 
     TRACE_DEBUG(&stdtrace, "cache_destroy: inizio => cache=%p", (void*)cache);
 
-    /* Svuota ciascun bucket */
-    for (size_t i = 0; i < cache->capacity; i++) {
-        struct hash_entry *entry = cache->buckets[i];
-        while (entry) {
-            struct hash_entry *tmp = entry;
-            entry = entry->next;
-            /* Non liberiamo key e value perché "owned" dall'utente */
-            free(tmp);
-        }
-    }
+    /* Gli slot sono un unico array: niente liste da svuotare.
+     * In modalità per riferimento key e value restano "owned" dall'utente;
+     * in modalità by-value le copie vivono negli slab. */
+    free(cache->key_slab);
+    free(cache->value_slab);
+    free(cache->slots);
 
-    /* Libera l'array di bucket */
-    free(cache->buckets);
+    /* Rilascia il mutex interno, se era stato inizializzato */
+    if (cache->thread_safe) {
+        pthread_mutex_destroy(&cache->lock);
+    }
 
     /* Infine libera la struttura principale */
     free(cache);
@@ -121,6 +310,29 @@ void cache_destroy(generic_hash_table_t *cache) {
     TRACE_DEBUG(&stdtrace, "cache_destroy: completato");
 }
 
+/*
+ * Abilita/disabilita la serializzazione di lookup e store con un mutex.
+ * Va chiamata PRIMA di condividere la cache tra più thread.
+ */
+void cache_set_thread_safe(generic_hash_table_t *cache, int enable) {
+    if (!cache) {
+        TRACE_DEBUG(&stdtrace, "cache_set_thread_safe: cache=NULL => esco");
+        return;
+    }
+
+    if (enable && !cache->thread_safe) {
+        pthread_mutex_init(&cache->lock, NULL);
+        cache->thread_safe = 1;
+        TRACE_DEBUG(&stdtrace, "cache_set_thread_safe: protezione ATTIVATA su cache=%p",
+                    (void*)cache);
+    } else if (!enable && cache->thread_safe) {
+        cache->thread_safe = 0;
+        pthread_mutex_destroy(&cache->lock);
+        TRACE_DEBUG(&stdtrace, "cache_set_thread_safe: protezione DISATTIVATA su cache=%p",
+                    (void*)cache);
+    }
+}
+
 /*
  * Ricerca la chiave `key` e restituisce il value associato, o NULL se non c'è.
  */
@@ -133,33 +345,100 @@ void* cache_lookup(generic_hash_table_t *cache, const void *key) {
         TRACE_DEBUG(&stdtrace, "cache_lookup: key=NULL => ritorno NULL");
         return NULL;
     }
+    return cache_lookup_hashed(cache, key, cache->hash_cb(key));
+}
 
-    /* Calcola l'hash e l'indice del bucket */
-    uint64_t h = cache->hash_cb(key);
-    size_t index = get_bucket_index(h, cache->capacity);
+/*
+ * Come cache_lookup, ma con l'hash della chiave già calcolato dal chiamante
+ * (DEVE essere lo stesso che produrrebbe la callback di hash della tabella).
+ */
+void* cache_lookup_hashed(generic_hash_table_t *cache, const void *key,
+                          uint64_t h) {
+    if (!cache || !key) {
+        return NULL;
+    }
 
     TRACE_DEBUG(&stdtrace,
-                "cache_lookup: cerco key=%p in bucket=%zu (hash=%llu)",
-                key, index, (unsigned long long)h);
-
-    /* Scorri la lista nel bucket */
-    struct hash_entry *entry = cache->buckets[index];
-    while (entry) {
-        if (cache->eq_cb(entry->key, key)) {
-            TRACE_DEBUG(&stdtrace, "cache_lookup: TROVATO => value=%p", entry->value);
-            return entry->value;
+                "cache_lookup: cerco key=%p a partire dallo slot=%zu (hash=%llu)",
+                key, get_slot_index(h, cache->capacity), (unsigned long long)h);
+
+    cache_lock(cache);
+    struct hash_entry *slot = find_slot(cache, h, key);
+    void *value = (slot->key != NULL) ? slot->value : NULL;
+    cache->lookups++;
+    if (value) {
+        cache->lookup_hits++;
+    }
+    int dump = (cache->stats_interval > 0 &&
+                cache->lookups % cache->stats_interval == 0);
+    cache_unlock(cache);
+
+    if (dump) {
+        cache_trace_stats(cache);
+    }
+
+    if (value) {
+        TRACE_DEBUG(&stdtrace, "cache_lookup: TROVATO => value=%p", value);
+    } else {
+        TRACE_DEBUG(&stdtrace, "cache_lookup: NON trovata la key=%p", key);
+    }
+    return value;
+}
+
+/*
+ * Come cache_lookup, ma copia il valore nel buffer del chiamante DENTRO la
+ * sezione protetta dal mutex: è la sola lettura sicura quando la tabella è
+ * condivisa in modalità thread-safe, perché uno store concorrente può
+ * riallocare lo slab dei valori (crescita) o sovrascrivere lo slot mentre
+ * il puntatore restituito da cache_lookup è ancora in mano al lettore.
+ */
+int cache_lookup_copy(generic_hash_table_t *cache, const void *key,
+                      void *out_value, size_t value_size) {
+    if (!cache || !key) {
+        return 0;
+    }
+    return cache_lookup_copy_hashed(cache, key, out_value, value_size,
+                                    cache->hash_cb(key));
+}
+
+int cache_lookup_copy_hashed(generic_hash_table_t *cache, const void *key,
+                             void *out_value, size_t value_size, uint64_t h) {
+    if (!cache || !key || !out_value) {
+        return 0;
+    }
+
+    cache_lock(cache);
+    struct hash_entry *slot = find_slot(cache, h, key);
+    int found = (slot->key != NULL);
+    if (found) {
+        size_t n = value_size;
+        if (cache->key_size > 0 && cache->value_size < n) {
+            n = cache->value_size; /* mai oltre la copia interna */
         }
-        entry = entry->next;
+        memcpy(out_value, slot->value, n);
+    }
+    cache->lookups++;
+    if (found) {
+        cache->lookup_hits++;
     }
+    int dump = (cache->stats_interval > 0 &&
+                cache->lookups % cache->stats_interval == 0);
+    cache_unlock(cache);
 
-    TRACE_DEBUG(&stdtrace, "cache_lookup: NON trovata la key=%p", key);
-    return NULL; /* non trovata */
+    if (dump) {
+        cache_trace_stats(cache);
+    }
+
+    TRACE_DEBUG(&stdtrace, "cache_lookup_copy: key=%p => %s", key,
+                found ? "copiato" : "non trovata");
+    return found;
 }
 
 /*
  * Inserisce o sostituisce la coppia (key, value) nella tabella hash.
  * - Se la chiave esiste già, aggiorna il value.
- * - Altrimenti, crea un nuovo nodo e lo inserisce in testa alla lista.
+ * - Altrimenti, occupa il primo slot libero della sequenza di probing,
+ *   raddoppiando prima la tabella se il fattore di carico è al limite.
  */
 void cache_store(generic_hash_table_t *cache, const void *key, const void *value) {
     if (!cache) {
@@ -170,42 +449,173 @@ void cache_store(generic_hash_table_t *cache, const void *key, const void *value
         TRACE_DEBUG(&stdtrace, "cache_store: key=NULL => esco");
         return;
     }
+    cache_store_hashed(cache, key, value, cache->hash_cb(key));
+}
 
-    uint64_t h = cache->hash_cb(key);
-    size_t index = get_bucket_index(h, cache->capacity);
+/*
+ * Come cache_store, ma con l'hash della chiave già calcolato dal chiamante
+ * (DEVE essere lo stesso che produrrebbe la callback di hash della tabella).
+ */
+void cache_store_hashed(generic_hash_table_t *cache, const void *key,
+                        const void *value, uint64_t h) {
+    if (!cache || !key) {
+        return;
+    }
 
     TRACE_DEBUG(&stdtrace,
-                "cache_store: inserisco key=%p, value=%p in bucket=%zu (hash=%llu)",
-                key, value, index, (unsigned long long)h);
-
-    /* Cerchiamo se la chiave è già presente */
-    struct hash_entry *entry = cache->buckets[index];
-    while (entry) {
-        if (cache->eq_cb(entry->key, key)) {
-            /* Chiave trovata: aggiorna il value esistente */
-            TRACE_DEBUG(&stdtrace,
-                        "cache_store: key=%p già esistente => aggiorno il value da %p a %p",
-                        key, entry->value, value);
-            entry->value = (void*) value;
-            return;
-        }
-        entry = entry->next;
+                "cache_store: inserisco key=%p, value=%p (hash=%llu)",
+                key, value, (unsigned long long)h);
+
+    cache_lock(cache);
+
+    /* Con il fattore di carico al limite raddoppiamo PRIMA di cercare lo
+     * slot: il rehashing invaliderebbe il puntatore appena trovato. */
+    if ((cache->num_entries + 1) * CACHE_MAX_LOAD_DEN >
+        cache->capacity * CACHE_MAX_LOAD_NUM) {
+        cache_grow(cache);
     }
 
-    /* Se non esiste, creiamo un nuovo entry e lo inseriamo in testa */
-    struct hash_entry *new_entry = (struct hash_entry*) malloc(sizeof(*new_entry));
-    if (!new_entry) {
-        TRACE_DEBUG(&stdtrace, "cache_store: malloc fallita per new_entry => non inserisco nulla");
+    struct hash_entry *slot = find_slot(cache, h, key);
+    if (slot->key != NULL) {
+        /* Chiave trovata: aggiorna il value esistente */
+        TRACE_DEBUG(&stdtrace,
+                    "cache_store: key=%p già esistente => aggiorno il value da %p a %p",
+                    key, slot->value, value);
+        if (cache->key_size > 0) {
+            memcpy(slot->value, value, cache->value_size);
+        } else {
+            slot->value = (void*) value;
+        }
+        cache->stores++;
+        cache->store_updates++;
+        cache_unlock(cache);
         return;
     }
-    new_entry->key   = (void*) key;
-    new_entry->value = (void*) value;
-    new_entry->next  = cache->buckets[index];
 
-    cache->buckets[index] = new_entry;
+    /* Slot libero: nuova voce */
+    slot->hash = h;
+    if (cache->key_size > 0) {
+        /* Copia chiave e valore negli slab, allo stesso indice dello slot */
+        size_t index = (size_t)(slot - cache->slots);
+        slot->key   = cache->key_slab + index * cache->key_size;
+        slot->value = cache->value_slab + index * cache->value_size;
+        memcpy(slot->key, key, cache->key_size);
+        memcpy(slot->value, value, cache->value_size);
+    } else {
+        slot->key   = (void*) key;
+        slot->value = (void*) value;
+    }
+    cache->num_entries++;
+    cache->stores++;
+    cache_unlock(cache);
     TRACE_DEBUG(&stdtrace,
-                "cache_store: key=%p, value=%p INSERITI in testa al bucket=%zu",
-                key, value, index);
+                "cache_store: key=%p, value=%p INSERITI (voci=%zu/%zu)",
+                key, value, cache->num_entries, cache->capacity);
+}
+
+/* --------------------------------------------------------------------------
+ * Introspezione: statistiche di utilizzo
+ * -------------------------------------------------------------------------- */
+
+/*
+ * Fotografa i contatori correnti in *out. Il percentile 99 della lunghezza
+ * di probing è calcolato dall'istogramma; l'ultimo bucket (code oltre
+ * CACHE_PROBE_HIST_SIZE slot) viene riportato come CACHE_PROBE_HIST_SIZE.
+ */
+void cache_get_stats(generic_hash_table_t *cache, cache_stats_t *out) {
+    if (!cache || !out) {
+        return;
+    }
+
+    cache_lock(cache);
+
+    out->num_entries = cache->num_entries;
+    out->capacity = cache->capacity;
+    out->bytes = sizeof(*cache)
+               + cache->capacity * sizeof(struct hash_entry)
+               + cache->capacity * (cache->key_size + cache->value_size);
+    out->load_factor = (double)cache->num_entries / (double)cache->capacity;
+
+    out->lookups = cache->lookups;
+    out->lookup_hits = cache->lookup_hits;
+    out->hit_rate = (cache->lookups > 0)
+                    ? (double)cache->lookup_hits / (double)cache->lookups
+                    : 0.0;
+    out->stores = cache->stores;
+    out->store_updates = cache->store_updates;
+
+    /* Media e p99 dall'istogramma delle lunghezze di probing */
+    uint64_t total = 0;
+    uint64_t weighted = 0;
+    for (size_t i = 0; i < CACHE_PROBE_HIST_SIZE; i++) {
+        total += cache->probe_hist[i];
+        weighted += cache->probe_hist[i] * (uint64_t)(i + 1);
+    }
+    out->probe_mean = (total > 0) ? (double)weighted / (double)total : 0.0;
+
+    out->probe_p99 = 0;
+    if (total > 0) {
+        uint64_t threshold = total - total / 100;  /* 99% delle probe */
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < CACHE_PROBE_HIST_SIZE; i++) {
+            cumulative += cache->probe_hist[i];
+            if (cumulative >= threshold) {
+                out->probe_p99 = i + 1;
+                break;
+            }
+        }
+    }
+
+    cache_unlock(cache);
+}
+
+/*
+ * Azzera i contatori (non il contenuto della tabella): utile per misurare
+ * una singola ricerca o un singolo job di analisi.
+ */
+void cache_reset_stats(generic_hash_table_t *cache) {
+    if (!cache) {
+        return;
+    }
+    cache_lock(cache);
+    cache->lookups = 0;
+    cache->lookup_hits = 0;
+    cache->stores = 0;
+    cache->store_updates = 0;
+    memset(cache->probe_hist, 0, sizeof(cache->probe_hist));
+    cache_unlock(cache);
+}
+
+/*
+ * Dump leggibile delle statistiche sul canale di trace standard.
+ */
+void cache_trace_stats(generic_hash_table_t *cache) {
+    if (!cache) {
+        return;
+    }
+    cache_stats_t s;
+    cache_get_stats(cache, &s);
+    TRACE_INFO(&stdtrace,
+               "cache %p: %zu/%zu voci (load %.2f, %zu byte) | "
+               "lookup %llu (hit %.1f%%) store %llu (update %llu) | "
+               "probe media %.2f p99 %zu",
+               (void*)cache, s.num_entries, s.capacity, s.load_factor,
+               s.bytes,
+               (unsigned long long)s.lookups, s.hit_rate * 100.0,
+               (unsigned long long)s.stores,
+               (unsigned long long)s.store_updates,
+               s.probe_mean, s.probe_p99);
+}
+
+/*
+ * Abilita il dump periodico: ogni `interval` lookup le statistiche vengono
+ * scritte sul trace (0 disabilita).
+ */
+void cache_set_stats_interval(generic_hash_table_t *cache, uint64_t interval) {
+    if (!cache) {
+        return;
+    }
+    cache->stats_interval = interval;
 }
 
 /* --------------------------------------------------------------------------
@@ -219,12 +629,11 @@ void cache_for_each(generic_hash_table_t *cache, cache_enum_fn fn, void *user_da
 
     TRACE_DEBUG(&stdtrace, "cache_for_each: inizio enumerazione su cache=%p", (void*)cache);
 
-    /* Iteriamo su ciascun bucket */
+    /* Iteriamo sull'array di slot saltando quelli liberi */
     for (size_t i = 0; i < cache->capacity; i++) {
-        struct hash_entry *entry = cache->buckets[i];
-        while (entry) {
-            fn(entry->key, entry->value, user_data);
-            entry = entry->next;
+        struct hash_entry *slot = &cache->slots[i];
+        if (slot->key != NULL) {
+            fn(slot->key, slot->value, user_data);
         }
     }
 
@@ -247,8 +656,7 @@ cache_iterator_t* cache_iterator_create(generic_hash_table_t *cache) {
     }
 
     it->cache = cache;
-    it->current_bucket = 0;
-    it->current_entry = NULL;
+    it->current_slot = 0;
 
     TRACE_DEBUG(&stdtrace, "cache_iterator_create: iteratore=%p creato su cache=%p",
                 (void*)it, (void*)cache);
@@ -281,33 +689,21 @@ int cache_iterator_next(cache_iterator_t *iter, const void **pkey, void **pvalue
 
     generic_hash_table_t *cache = iter->cache;
 
-    /* Se abbiamo già un current_entry, andiamo al successivo */
-    if (iter->current_entry) {
-        iter->current_entry = iter->current_entry->next;
-    }
-
-    /* Se iter->current_entry è NULL, passiamo ai successivi bucket */
-    while (!iter->current_entry) {
-        if (iter->current_bucket >= cache->capacity) {
-            TRACE_DEBUG(&stdtrace, 
-                        "cache_iterator_next: superato ultimo bucket => fine iterazione");
-            return 0; /* fine iterazione */
-        }
-        iter->current_entry = cache->buckets[iter->current_bucket];
-        iter->current_bucket++;
-        if (iter->current_entry) {
-            break;
+    /* Avanza fino al prossimo slot occupato */
+    while (iter->current_slot < cache->capacity) {
+        struct hash_entry *slot = &cache->slots[iter->current_slot];
+        iter->current_slot++;
+        if (slot->key != NULL) {
+            *pkey   = slot->key;
+            *pvalue = slot->value;
+            TRACE_DEBUG(&stdtrace,
+                        "cache_iterator_next: restituisco key=%p, value=%p [slot=%zu]",
+                        *pkey, *pvalue, iter->current_slot - 1);
+            return 1;
         }
     }
 
-    if (iter->current_entry) {
-        *pkey   = iter->current_entry->key;
-        *pvalue = iter->current_entry->value;
-        TRACE_DEBUG(&stdtrace,
-                    "cache_iterator_next: restituisco key=%p, value=%p [bucket=%zu]",
-                    *pkey, *pvalue, iter->current_bucket-1);
-        return 1;
-    }
-
-    return 0; 
+    TRACE_DEBUG(&stdtrace,
+                "cache_iterator_next: superato ultimo slot => fine iterazione");
+    return 0;
 }
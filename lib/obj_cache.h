@@ -2,14 +2,19 @@
  * @file
  * @brief Interfaccia per una cache generica basata su tabella hash.
  *
- * ##VERSION## "obj_cache.h 1.1"
+ * ##VERSION## "obj_cache.h 1.6"
  *
  * Fornisce una struttura hash generica (\ref generic_hash_table_t) che permette
  * di memorizzare e recuperare coppie (chiave, valore). L'hash e la funzione di
  * confronto per le chiavi sono definiti tramite callback fornite dall'utente.
  *
+ * La tabella usa indirizzamento aperto (linear probing) su un array contiguo
+ * di slot e raddoppia da sola quando il fattore di carico supera il 75%:
+ * il costo di lookup e store resta O(1) ammortizzato anche dopo milioni di
+ * inserimenti, senza catene di collisione da scorrere.
+ *
  * La struttura è volutamente opaca: l'utente non conosce i dettagli implementativi
- * (bucket, liste di collisione, ecc.).
+ * (slot, sequenze di probing, ecc.).
  */
 
 #ifndef OBJ_CACHE_H
@@ -20,8 +25,15 @@
 #include <stdint.h>  /* per uint64_t */
 #include <stdlib.h>  /* per size_t */
 
+/** Capacity iniziale della tabella: deve essere una potenza di due
+ *  (l'indice è calcolato con una maschera sui bit bassi dell'hash). */
 #define INITIAL_CAPACITY 1024
 
+/** Numero di bucket dell'istogramma delle lunghezze di probing: il bucket
+ *  i conta le ricerche che hanno toccato i+1 slot, l'ultimo raccoglie le
+ *  code più lunghe. */
+#define CACHE_PROBE_HIST_SIZE 32
+
 /* --------------------------------------------------------------------------
  * Funzioni di hash e di confronto
  * -------------------------------------------------------------------------- */
@@ -78,6 +90,28 @@ typedef struct generic_hash_table generic_hash_table_t;
  */
 generic_hash_table_t* cache_create(hash_func_t hash_cb, equals_func_t eq_cb);
 
+/**
+ * @brief Crea una tabella hash che memorizza chiavi e valori PER COPIA.
+ *
+ * @param[in] hash_cb    Callback per calcolare l'hash di una chiave (obbligatoria).
+ * @param[in] eq_cb      Callback per confrontare due chiavi (obbligatoria).
+ * @param[in] key_size   Dimensione fissa in byte di una chiave (0 = modalità
+ *                       per riferimento, identica a \ref cache_create).
+ * @param[in] value_size Dimensione fissa in byte di un valore (obbligatoria
+ *                       se \p key_size > 0).
+ * @return generic_hash_table_t* Tabella creata, oppure NULL in caso di errore.
+ *
+ * In questa modalità \ref cache_store copia i byte di chiave e valore in
+ * slab contigui interni alla tabella: il chiamante può passare variabili
+ * di stack o buffer riutilizzati senza vincoli sul loro ciclo di vita, e
+ * non avviene alcuna allocazione per singolo store. \ref cache_lookup
+ * restituisce un puntatore alla copia interna del valore, stabile fino al
+ * prossimo \ref cache_store (che può far crescere la tabella); il valore
+ * puntato è modificabile in place.
+ */
+generic_hash_table_t* cache_create_ex(hash_func_t hash_cb, equals_func_t eq_cb,
+                                      size_t key_size, size_t value_size);
+
 /**
  * @brief Distrugge la tabella hash, liberando tutta la memoria utilizzata.
  *
@@ -91,6 +125,29 @@ generic_hash_table_t* cache_create(hash_func_t hash_cb, equals_func_t eq_cb);
  */
 void cache_destroy(generic_hash_table_t *cache);
 
+/**
+ * @brief Abilita o disabilita l'accesso thread-safe alla tabella hash.
+ *
+ * @param[in] cache   Puntatore alla tabella hash.
+ * @param[in] enable  1 per serializzare \ref cache_lookup e \ref cache_store
+ *                    con un mutex interno, 0 per disabilitare la protezione.
+ *
+ * Da abilitare quando la cache è condivisa tra più thread di ricerca
+ * (ad es. con \c get_best_move_parallel). In modalità single-thread la
+ * protezione può rimanere disabilitata per evitare l'overhead del mutex.
+ *
+ * @note Il mutex protegge la RICERCA dello slot, non il puntatore
+ *       restituito: in modalità by-value un lettore concorrente deve usare
+ *       \ref cache_lookup_copy, che copia il valore dentro la sezione
+ *       protetta (uno store concorrente può riallocare lo slab o
+ *       sovrascrivere lo slot sotto un puntatore appena restituito).
+ *
+ * @note Le funzioni di enumerazione (\ref cache_for_each e l'iteratore
+ *       esplicito) NON sono protette: vanno usate solo quando nessun altro
+ *       thread sta modificando la cache.
+ */
+void cache_set_thread_safe(generic_hash_table_t *cache, int enable);
+
 /* --------------------------------------------------------------------------
  * Operazioni base su (key, value)
  * -------------------------------------------------------------------------- */
@@ -121,6 +178,126 @@ void* cache_lookup(generic_hash_table_t *cache, const void *key);
  */
 void cache_store(generic_hash_table_t *cache, const void *key, const void *value);
 
+/**
+ * @brief Come \ref cache_lookup, con l'hash della chiave già calcolato.
+ *
+ * @param[in] cache Puntatore alla tabella hash.
+ * @param[in] key   Chiave da cercare.
+ * @param[in] hash  Hash di \p key, identico a quello che produrrebbe la
+ *                  callback della tabella sulla stessa chiave.
+ * @return void*    Il valore associato, oppure NULL se non trovato.
+ *
+ * Evita di rieseguire la callback di hash quando il chiamante l'ha già
+ * calcolata (o la mantiene incrementalmente): nel minimax l'hash dello
+ * stato viene calcolato una volta per nodo e riusato per lookup e store.
+ */
+void* cache_lookup_hashed(generic_hash_table_t *cache, const void *key,
+                          uint64_t hash);
+
+/**
+ * @brief Come \ref cache_store, con l'hash della chiave già calcolato.
+ *
+ * @param[in] cache Puntatore alla tabella hash.
+ * @param[in] key   Chiave da memorizzare.
+ * @param[in] value Valore associato.
+ * @param[in] hash  Hash di \p key (stessi vincoli di \ref cache_lookup_hashed).
+ */
+void cache_store_hashed(generic_hash_table_t *cache, const void *key,
+                        const void *value, uint64_t hash);
+
+/**
+ * @brief Cerca \p key e COPIA il valore nel buffer del chiamante.
+ *
+ * L'unica lettura sicura in modalità thread-safe: il puntatore restituito
+ * da \ref cache_lookup entra nello slab interno della tabella, e un
+ * \ref cache_store concorrente può riallocare lo slab (crescita) o
+ * sovrascrivere lo stesso slot mentre il chiamante sta ancora leggendo.
+ * Qui la copia avviene DENTRO la sezione protetta dal mutex interno, e il
+ * buffer del chiamante resta valido comunque evolva la tabella.
+ *
+ * @param[in]  cache      Puntatore alla tabella hash.
+ * @param[in]  key        Chiave da cercare.
+ * @param[out] out_value  Buffer del chiamante in cui copiare il valore.
+ * @param[in]  value_size Byte da copiare (in modalità by-value viene
+ *                        comunque limitato alla dimensione del valore
+ *                        dichiarata alla creazione).
+ * @return 1 se la chiave è stata trovata e il valore copiato, 0 altrimenti.
+ */
+int cache_lookup_copy(generic_hash_table_t *cache, const void *key,
+                      void *out_value, size_t value_size);
+
+/**
+ * @brief Come \ref cache_lookup_copy, con l'hash della chiave già calcolato.
+ *
+ * @param[in]  cache      Puntatore alla tabella hash.
+ * @param[in]  key        Chiave da cercare.
+ * @param[out] out_value  Buffer del chiamante in cui copiare il valore.
+ * @param[in]  value_size Byte da copiare (vedi \ref cache_lookup_copy).
+ * @param[in]  hash       Hash di \p key (stessi vincoli di
+ *                        \ref cache_lookup_hashed).
+ * @return 1 se la chiave è stata trovata e il valore copiato, 0 altrimenti.
+ */
+int cache_lookup_copy_hashed(generic_hash_table_t *cache, const void *key,
+                             void *out_value, size_t value_size, uint64_t hash);
+
+/* --------------------------------------------------------------------------
+ * Introspezione: statistiche di utilizzo
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @struct cache_stats
+ * @brief Fotografia dei contatori di utilizzo della tabella.
+ *
+ * Serve a dimensionare le tabelle per deployment e a riconoscere le
+ * regressioni di qualità dell'hash: code di probing lunghe con load factor
+ * basso indicano chiavi mal distribuite, non una tabella piena.
+ */
+typedef struct cache_stats {
+    size_t   num_entries;   /**< voci memorizzate */
+    size_t   capacity;      /**< slot allocati */
+    size_t   bytes;         /**< memoria totale della tabella (slot + slab) */
+    double   load_factor;   /**< num_entries / capacity */
+
+    uint64_t lookups;       /**< chiamate a cache_lookup */
+    uint64_t lookup_hits;   /**< lookup che hanno trovato la chiave */
+    double   hit_rate;      /**< lookup_hits / lookups (0 se nessun lookup) */
+    uint64_t stores;        /**< chiamate a cache_store riuscite */
+    uint64_t store_updates; /**< store su chiave già presente */
+
+    double   probe_mean;    /**< slot toccati in media per ricerca */
+    size_t   probe_p99;     /**< 99° percentile degli slot toccati
+                                 (saturato a \ref CACHE_PROBE_HIST_SIZE) */
+} cache_stats_t;
+
+/**
+ * @brief Copia in \p out le statistiche correnti della tabella.
+ *
+ * @param[in]  cache Tabella da interrogare.
+ * @param[out] out   Struttura da riempire.
+ */
+void cache_get_stats(generic_hash_table_t *cache, cache_stats_t *out);
+
+/**
+ * @brief Azzera i contatori statistici (il contenuto della tabella resta).
+ *
+ * Utile per misurare una singola ricerca o un singolo job di analisi.
+ */
+void cache_reset_stats(generic_hash_table_t *cache);
+
+/**
+ * @brief Scrive un riepilogo leggibile delle statistiche su \c stdtrace
+ *        (livello INFO).
+ */
+void cache_trace_stats(generic_hash_table_t *cache);
+
+/**
+ * @brief Abilita il dump periodico delle statistiche.
+ *
+ * Ogni \p interval lookup la tabella chiama \ref cache_trace_stats da sola;
+ * 0 (il default) disabilita il dump.
+ */
+void cache_set_stats_interval(generic_hash_table_t *cache, uint64_t interval);
+
 /* --------------------------------------------------------------------------
  * Modalità di navigazione 1: funzione for-each (callback-based)
  * -------------------------------------------------------------------------- */
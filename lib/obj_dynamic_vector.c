@@ -1,5 +1,5 @@
 /**
- * ##VERSION## "obj_dynamic_vector.c 1.0"
+ * ##VERSION## "obj_dynamic_vector.c 1.4"
 */
 
 #include "obj_mem.h"
@@ -19,14 +19,22 @@
 /*
  * Struttura interna del vettore dinamico.
  * Contiene:
- *   - data:     array di puntatori a void*
- *   - size:     numero di elementi attualmente memorizzati
- *   - capacity: dimensione dell'array data (numero max di elementi senza riallocare)
+ *   - data:      array di puntatori a void* (modalità "per puntatore")
+ *   - elems:     buffer contiguo di elementi copiati (modalità "per valore")
+ *   - elem_size: dimensione di un elemento; 0 = modalità per puntatore
+ *   - size:      numero di elementi attualmente memorizzati
+ *   - capacity:  numero max di elementi senza riallocare
+ *
+ * Un vettore lavora SEMPRE in una sola delle due modalità, decisa alla
+ * creazione: dv_create() => per puntatore (data), dv_create_sized() =>
+ * per valore (elems). L'altro buffer resta NULL.
  */
 struct dynamic_vector_s {
-    void   **data;    /* array di void* */
-    size_t   size;    /* quanti elementi attualmente in data */
-    size_t   capacity;/* dimensione massima di data prima della riallocazione */
+    void   **data;    /* array di void* (solo modalità per puntatore) */
+    char    *elems;   /* buffer contiguo (solo modalità per valore) */
+    size_t   elem_size;/* dimensione elemento; 0 = modalità per puntatore */
+    size_t   size;    /* quanti elementi attualmente memorizzati */
+    size_t   capacity;/* dimensione massima prima della riallocazione */
 };
 
 dynamic_vector_t* dv_create(void) {
@@ -38,6 +46,8 @@ dynamic_vector_t* dv_create(void) {
 
     dv->size = 0;
     dv->capacity = INITIAL_CAPACITY;
+    dv->elem_size = 0;
+    dv->elems = NULL;
 
     /* Alloca data con capacity iniziale */
     dv->data = (void**) malloc(dv->capacity * sizeof(void*));
@@ -49,18 +59,101 @@ dynamic_vector_t* dv_create(void) {
     return dv;
 }
 
+dynamic_vector_t* dv_create_sized(size_t elem_size, size_t initial_capacity) {
+    if (elem_size == 0) {
+        return NULL; /* per la modalità per puntatore usare dv_create() */
+    }
+
+    dynamic_vector_t *dv = (dynamic_vector_t*) malloc(sizeof(*dv));
+    if (!dv) {
+        return NULL;
+    }
+
+    dv->size = 0;
+    dv->capacity = (initial_capacity > 0) ? initial_capacity : INITIAL_CAPACITY;
+    dv->elem_size = elem_size;
+    dv->data = NULL;
+
+    /* Un solo buffer contiguo per tutti gli elementi */
+    dv->elems = (char*) malloc(dv->capacity * dv->elem_size);
+    if (!dv->elems) {
+        free(dv);
+        return NULL;
+    }
+
+    return dv;
+}
+
 void dv_free(dynamic_vector_t *dv) {
     if (!dv) return;
 
-    /* Libera l'array di puntatori */
+    /* Libera l'array di puntatori (modalità per puntatore) */
     if (dv->data) {
         free(dv->data);
     }
 
+    /* Libera il buffer contiguo (modalità per valore) */
+    if (dv->elems) {
+        free(dv->elems);
+    }
+
     /* Libera la struttura */
     free(dv);
 }
 
+size_t dv_elem_size(const dynamic_vector_t *dv) {
+    if (!dv) return 0;
+    return dv->elem_size;
+}
+
+void* dv_data(const dynamic_vector_t *dv) {
+    if (!dv) return NULL;
+    /* Modalità per valore: buffer contiguo di elementi.
+       Modalità per puntatore: array di void*. */
+    if (dv->elem_size > 0) {
+        return dv->elems;
+    }
+    return dv->data;
+}
+
+void dv_clear(dynamic_vector_t *dv) {
+    if (!dv) return;
+    /* La capacità (e il buffer) restano invariati: il vettore può essere
+       riempito di nuovo senza riallocazioni. */
+    dv->size = 0;
+}
+
+void dv_truncate(dynamic_vector_t *dv, size_t new_size) {
+    if (!dv || new_size >= dv->size) return;
+    /* Come dv_clear: si accorcia solo il numero di elementi, il buffer
+       resta invariato (utile per compattazioni in place). */
+    dv->size = new_size;
+}
+
+int dv_reserve(dynamic_vector_t *dv, size_t n) {
+    if (!dv) return -1;
+    if (n <= dv->capacity) {
+        return 0; /* capacità già sufficiente */
+    }
+
+    if (dv->elem_size > 0) {
+        char *new_elems = (char*) realloc(dv->elems, n * dv->elem_size);
+        if (!new_elems) {
+            return -1;
+        }
+        dv->elems = new_elems;
+    } else {
+        void **new_data = (void**) realloc(dv->data, n * sizeof(void*));
+        if (!new_data) {
+            return -1;
+        }
+        dv->data = new_data;
+    }
+
+    dv->capacity = n;
+    return 0;
+}
+
 size_t dv_size(const dynamic_vector_t *dv) {
     if (!dv) return 0;
     return dv->size;
@@ -70,7 +163,13 @@ void* dv_get(const dynamic_vector_t *dv, size_t index) {
     if (!dv) return NULL;
     /* Se index è fuori dal range, potrebbe causare accessi non validi */
     if (index >= dv->size) {
-        return NULL; 
+        return NULL;
+    }
+    /* In modalità per valore restituiamo un puntatore DENTRO il buffer
+       contiguo: resta valido finché il vettore non viene ridimensionato
+       o liberato. */
+    if (dv->elem_size > 0) {
+        return dv->elems + index * dv->elem_size;
     }
     return dv->data[index];
 }
@@ -78,7 +177,14 @@ void* dv_get(const dynamic_vector_t *dv, size_t index) {
 void dv_set(dynamic_vector_t *dv, size_t index, void *value) {
     if (!dv) return;
     if (index < dv->size) {
-        dv->data[index] = value;
+        if (dv->elem_size > 0) {
+            /* Modalità per valore: copia l'elemento puntato da value */
+            if (value) {
+                memcpy(dv->elems + index * dv->elem_size, value, dv->elem_size);
+            }
+        } else {
+            dv->data[index] = value;
+        }
     }
 }
 
@@ -95,14 +201,23 @@ static int dv_resize_if_needed(dynamic_vector_t *dv) {
 
     /* Aumentiamo la capacità di CAPACITY_INCREMENT */
     size_t new_capacity = dv->capacity + CAPACITY_INCREMENT;
-    void **new_data = (void**) realloc(dv->data, new_capacity * sizeof(void*));
-    if (!new_data) {
-        /* fallimento */
-        return -1;
+
+    if (dv->elem_size > 0) {
+        /* Modalità per valore: riallochiamo il buffer contiguo */
+        char *new_elems = (char*) realloc(dv->elems, new_capacity * dv->elem_size);
+        if (!new_elems) {
+            return -1;
+        }
+        dv->elems = new_elems;
+    } else {
+        void **new_data = (void**) realloc(dv->data, new_capacity * sizeof(void*));
+        if (!new_data) {
+            /* fallimento */
+            return -1;
+        }
+        dv->data = new_data;
     }
 
-    /* Aggiorniamo data e capacity */
-    dv->data = new_data;
     dv->capacity = new_capacity;
     return 0;
 }
@@ -110,6 +225,12 @@ static int dv_resize_if_needed(dynamic_vector_t *dv) {
 int dv_push_back(dynamic_vector_t *dv, void *value) {
     if (!dv) return -1;
 
+    /* Su un vettore per valore il puntatore non avrebbe dove vivere:
+       interpretiamo value come indirizzo dell'elemento da copiare. */
+    if (dv->elem_size > 0) {
+        return dv_push_back_value(dv, value);
+    }
+
     /* Verifichiamo se serve ridimensionare */
     if (dv_resize_if_needed(dv) != 0) {
         return -1; /* fallimento dell'allocazione */
@@ -121,3 +242,21 @@ int dv_push_back(dynamic_vector_t *dv, void *value) {
 
     return 0;
 }
+
+int dv_push_back_value(dynamic_vector_t *dv, const void *elem) {
+    if (!dv || !elem) return -1;
+    if (dv->elem_size == 0) {
+        return -1; /* vettore in modalità per puntatore: usare dv_push_back */
+    }
+
+    /* Verifichiamo se serve ridimensionare */
+    if (dv_resize_if_needed(dv) != 0) {
+        return -1; /* fallimento dell'allocazione */
+    }
+
+    /* Copiamo l'elemento in coda al buffer contiguo */
+    memcpy(dv->elems + dv->size * dv->elem_size, elem, dv->elem_size);
+    dv->size += 1;
+
+    return 0;
+}
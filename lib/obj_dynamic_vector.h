@@ -2,15 +2,24 @@
  * @file
  * @brief Interfaccia di un vettore dinamico generico in C.
  *
- * ##VERSION## "obj_dynamic_vector.h 1.0"
- *
- * Questo file dichiara le funzioni per creare e gestire un vettore dinamico di
- * puntatori `void*`. Il vettore può crescere automaticamente quando vengono
- * inseriti nuovi elementi (tramite \ref dv_push_back).
- * 
- * L'utente è responsabile di liberare eventualmente gli oggetti puntati dalle
- * celle del vettore, se necessario, in quanto questa libreria non conosce la
- * loro natura (allocazione dinamica, stack, ecc.).
+ * ##VERSION## "obj_dynamic_vector.h 1.4"
+ *
+ * Questo file dichiara le funzioni per creare e gestire un vettore dinamico.
+ * Il vettore supporta due modalità, scelte alla creazione:
+ *
+ *   - PER PUNTATORE (\ref dv_create): il vettore memorizza puntatori `void*`
+ *     e non conosce la natura degli oggetti puntati (allocazione dinamica,
+ *     stack, ecc.); è responsabilità dell'utente liberarli se necessario.
+ *
+ *   - PER VALORE (\ref dv_create_sized): il vettore copia gli elementi in un
+ *     UNICO buffer contiguo (\ref dv_push_back_value). Una lista di N elementi
+ *     costa una sola allocazione invece di N, e l'iterazione è sequenziale in
+ *     memoria (ottima località di cache). In questa modalità \ref dv_get
+ *     restituisce un puntatore dentro il buffer interno: resta valido finché
+ *     il vettore non viene ridimensionato o liberato.
+ *
+ * In entrambe le modalità il vettore cresce automaticamente quando vengono
+ * inseriti nuovi elementi.
  */
 
 #ifndef OBJ_DYNAMIC_VECTOR_H
@@ -40,6 +49,22 @@ typedef struct dynamic_vector_s dynamic_vector_t;
  */
 dynamic_vector_t* dv_create(void);
 
+/**
+ * @brief Crea un vettore dinamico in modalità "per valore".
+ *
+ * Gli elementi inseriti con \ref dv_push_back_value vengono copiati in un
+ * unico buffer contiguo di celle da \p elem_size byte ciascuna.
+ *
+ * @param[in] elem_size        Dimensione in byte di un elemento (deve essere > 0).
+ * @param[in] initial_capacity Capacità iniziale in elementi (0 = valore di default).
+ * @return dynamic_vector_t*   Puntatore al vettore creato, oppure NULL in caso
+ *                             di errore o se \p elem_size è 0.
+ *
+ * @note L'utente deve in seguito chiamare \ref dv_free per liberare la struttura;
+ *       gli elementi, essendo copie interne, non richiedono free individuali.
+ */
+dynamic_vector_t* dv_create_sized(size_t elem_size, size_t initial_capacity);
+
 /**
  * @brief Libera il vettore dinamico, deallocando la struttura interna.
  *
@@ -51,6 +76,81 @@ dynamic_vector_t* dv_create(void);
  */
 void dv_free(dynamic_vector_t *dv);
 
+/**
+ * @brief Restituisce la dimensione di un elemento del vettore.
+ *
+ * @param[in] dv Puntatore al vettore.
+ * @return size_t Dimensione in byte di un elemento se il vettore è in modalità
+ *                "per valore", 0 se è in modalità "per puntatore" o se \p dv è NULL.
+ */
+size_t dv_elem_size(const dynamic_vector_t *dv);
+
+/**
+ * @brief Restituisce il buffer interno del vettore per l'iterazione diretta.
+ *
+ * In modalità "per valore" il risultato è il buffer contiguo degli elementi:
+ * l'elemento i-esimo si trova a `(char*)dv_data(dv) + i * dv_elem_size(dv)`.
+ * In modalità "per puntatore" il risultato è l'array di `void*` memorizzati
+ * (castabile a `void**`). Nei cicli stretti questo evita una chiamata a
+ * funzione (con controlli NULL/range) per ogni elemento.
+ *
+ * @param[in] dv Puntatore al vettore.
+ * @return void* Buffer interno, oppure NULL se \p dv è NULL.
+ *
+ * @warning CONTRATTO DI INVALIDAZIONE: il puntatore restituito è valido solo
+ *          finché il vettore non viene ridimensionato (\ref dv_push_back,
+ *          \ref dv_push_back_value, \ref dv_reserve) né liberato/riciclato
+ *          (\ref dv_free, \ref dv_clear seguito da nuovi inserimenti).
+ *          Non memorizzarlo oltre il ciclo in cui è stato ottenuto.
+ */
+void* dv_data(const dynamic_vector_t *dv);
+
+/**
+ * @brief Svuota il vettore senza liberare la memoria.
+ *
+ * Azzera il numero di elementi lasciando invariata la capacità: il vettore
+ * può essere riutilizzato (riempito di nuovo) senza alcuna riallocazione.
+ * Utile per riciclare lo stesso vettore in cicli molto frequenti.
+ *
+ * @param[in] dv Puntatore al vettore (se NULL, la funzione non fa nulla).
+ *
+ * @note In modalità "per puntatore" gli oggetti puntati NON vengono liberati:
+ *       se necessario, l'utente deve occuparsene prima della chiamata.
+ */
+void dv_clear(dynamic_vector_t *dv);
+
+/**
+ * @brief Accorcia il vettore a \p new_size elementi senza toccare il buffer.
+ *
+ * Come \ref dv_clear ma parziale: i primi \p new_size elementi restano
+ * validi, i successivi vengono "dimenticati". Se \p new_size è maggiore o
+ * uguale alla dimensione attuale la funzione non fa nulla. Utile per
+ * compattare in place un vettore dopo un filtraggio.
+ *
+ * @param[in] dv       Puntatore al vettore (se NULL, la funzione non fa nulla).
+ * @param[in] new_size Nuovo numero di elementi (<= dimensione attuale).
+ *
+ * @note In modalità "per puntatore" gli elementi scartati NON vengono
+ *       liberati: se necessario, l'utente deve occuparsene prima.
+ */
+void dv_truncate(dynamic_vector_t *dv, size_t new_size);
+
+/**
+ * @brief Garantisce una capacità minima di \p n elementi.
+ *
+ * Se la capacità attuale è già >= \p n la funzione non fa nulla; altrimenti
+ * rialloca il buffer interno. Gli elementi esistenti vengono preservati.
+ *
+ * @param[in] dv Puntatore al vettore.
+ * @param[in] n  Capacità minima richiesta (in elementi).
+ * @return int   0 se la capacità è garantita, -1 in caso di errore
+ *               (\p dv NULL o allocazione fallita).
+ *
+ * @note Dopo una riallocazione i puntatori restituiti in precedenza da
+ *       \ref dv_get su un vettore "per valore" non sono più validi.
+ */
+int dv_reserve(dynamic_vector_t *dv, size_t n);
+
 /**
  * @brief Restituisce il numero di elementi attualmente contenuti nel vettore.
  *
@@ -66,8 +166,10 @@ size_t dv_size(const dynamic_vector_t *dv);
  * @param[in] index Posizione dell'elemento (deve essere < \ref dv_size(dv)).
  * @return void* Puntatore generico all'elemento, oppure NULL se \p dv è NULL o \p index è fuori range.
  *
- * @note La funzione non effettua alcuna copia dell'oggetto, si limita a restituire
- *       il puntatore memorizzato internamente.
+ * @note La funzione non effettua alcuna copia dell'oggetto. In modalità "per
+ *       puntatore" restituisce il puntatore memorizzato; in modalità "per
+ *       valore" restituisce un puntatore DENTRO il buffer contiguo interno,
+ *       valido finché il vettore non viene ridimensionato o liberato.
  */
 void* dv_get(const dynamic_vector_t *dv, size_t index);
 
@@ -95,7 +197,25 @@ void dv_set(dynamic_vector_t *dv, size_t index, void *value);
  *
  * @note Il tempo medio di inserimento è O(1) (amortizzato),
  *       poiché eventuali riallocazioni avvengono in modo esponenziale.
+ * @note Su un vettore creato con \ref dv_create_sized la funzione delega a
+ *       \ref dv_push_back_value, interpretando \p value come indirizzo
+ *       dell'elemento da copiare.
  */
 int dv_push_back(dynamic_vector_t *dv, void *value);
 
+/**
+ * @brief Copia (in coda) un nuovo elemento nel buffer contiguo del vettore.
+ *
+ * Valida solo per vettori creati con \ref dv_create_sized: l'elemento puntato
+ * da \p elem viene copiato (memcpy di elem_size byte) in coda al buffer
+ * interno. Se necessario, il vettore viene ridimensionato automaticamente.
+ *
+ * @param[in] dv   Puntatore al vettore (modalità "per valore").
+ * @param[in] elem Indirizzo dell'elemento da copiare (non NULL).
+ * @return int     0 se l'inserimento ha avuto successo, -1 in caso di errore
+ *                 (allocazione fallita, \p elem NULL o vettore in modalità
+ *                 "per puntatore").
+ */
+int dv_push_back_value(dynamic_vector_t *dv, const void *elem);
+
 #endif /* OBJ_DYNAMIC_VECTOR_H */
@@ -1,5 +1,5 @@
 /**
- * ##VERSION## "obj_mem.c 1.0"
+ * ##VERSION## "obj_mem.c 1.3"
 */
 
 #define OBJ_MEM_C  /* Sono in OBJ_MEM_C */
@@ -280,3 +280,425 @@ void dump_allocated_memory_hex(void) {
 }
 
 #endif /* OBJ_MEM_DEBUG_ON */
+
+/* --------------------------------------------------------------------------
+ * Pool di blocchi a dimensione fissa
+ * --------------------------------------------------------------------------
+ * I blocchi vengono preallocati a chunk; quelli liberati finiscono in una
+ * free-list intrusiva (il puntatore al prossimo blocco libero vive nei primi
+ * byte del blocco stesso, per questo block_size >= sizeof(void*)).
+ */
+
+#define OBJ_MEM_POOL_DEFAULT_BLOCKS 256   /* blocchi per chunk se non specificato */
+#define OBJ_MEM_ARENA_DEFAULT_BYTES (64 * 1024) /* primo chunk arena di default */
+
+/* Un chunk è un'unica allocazione che contiene blocks_per_chunk blocchi */
+typedef struct obj_mem_pool_chunk_s {
+    struct obj_mem_pool_chunk_s *next;
+    /* i blocchi seguono in memoria */
+} obj_mem_pool_chunk_t;
+
+struct obj_mem_pool_s {
+    size_t block_size;            /* dimensione (allineata) di un blocco */
+    size_t blocks_per_chunk;      /* blocchi preallocati per chunk */
+    void *free_list;              /* primo blocco libero (lista intrusiva) */
+    obj_mem_pool_chunk_t *chunks; /* lista dei chunk allocati */
+};
+
+obj_mem_pool_t* obj_mem_pool_create(size_t block_size, size_t blocks_per_chunk) {
+    obj_mem_pool_t *pool = (obj_mem_pool_t*)malloc(sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    /* Il blocco deve poter ospitare il puntatore della free-list e
+       restare allineato per qualunque oggetto */
+    if (block_size < sizeof(void*)) {
+        block_size = sizeof(void*);
+    }
+    size_t align = sizeof(void*);
+    block_size = (block_size + align - 1) & ~(align - 1);
+
+    pool->block_size = block_size;
+    pool->blocks_per_chunk = (blocks_per_chunk > 0) ? blocks_per_chunk
+                                                    : OBJ_MEM_POOL_DEFAULT_BLOCKS;
+    pool->free_list = NULL;
+    pool->chunks = NULL;
+    return pool;
+}
+
+/* Alloca un nuovo chunk e ne incatena i blocchi nella free-list */
+static int obj_mem_pool_grow(obj_mem_pool_t *pool) {
+    size_t chunk_bytes = sizeof(obj_mem_pool_chunk_t) +
+                         pool->blocks_per_chunk * pool->block_size;
+    obj_mem_pool_chunk_t *chunk = (obj_mem_pool_chunk_t*)malloc(chunk_bytes);
+    if (!chunk) {
+        TRACE_ERROR(&stdtrace, "obj_mem_pool_grow: malloc(%zu) fallita", chunk_bytes);
+        return -1;
+    }
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    char *blocks = (char*)(chunk + 1);
+    for (size_t i = 0; i < pool->blocks_per_chunk; i++) {
+        void *block = blocks + i * pool->block_size;
+        *(void**)block = pool->free_list;
+        pool->free_list = block;
+    }
+    return 0;
+}
+
+void* obj_mem_pool_alloc(obj_mem_pool_t *pool) {
+    if (!pool) return NULL;
+    if (!pool->free_list && obj_mem_pool_grow(pool) != 0) {
+        return NULL;
+    }
+    void *block = pool->free_list;
+    pool->free_list = *(void**)block;
+    return block;
+}
+
+void obj_mem_pool_free(obj_mem_pool_t *pool, void *ptr) {
+    if (!pool || !ptr) return;
+    *(void**)ptr = pool->free_list;
+    pool->free_list = ptr;
+}
+
+void obj_mem_pool_destroy(obj_mem_pool_t *pool) {
+    if (!pool) return;
+    obj_mem_pool_chunk_t *chunk = pool->chunks;
+    while (chunk) {
+        obj_mem_pool_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(pool);
+}
+
+/* --------------------------------------------------------------------------
+ * Arena (allocazione a epoche con reset O(1))
+ * --------------------------------------------------------------------------
+ * L'arena avanza un offset dentro il chunk corrente; quando il chunk è pieno
+ * ne alloca un altro (almeno grande quanto il primo). Il reset riporta
+ * l'offset a zero sul primo chunk: i chunk restano posseduti e vengono
+ * riutilizzati, quindi dopo il riscaldamento non si tocca più malloc.
+ */
+
+typedef struct obj_mem_arena_chunk_s {
+    struct obj_mem_arena_chunk_s *next;
+    size_t capacity;   /* byte utili del chunk */
+    size_t used;       /* byte già consegnati */
+    /* i dati seguono in memoria */
+} obj_mem_arena_chunk_t;
+
+struct obj_mem_arena_s {
+    obj_mem_arena_chunk_t *chunks;  /* lista dei chunk (il primo è la testa) */
+    obj_mem_arena_chunk_t *current; /* chunk da cui si sta allocando */
+    size_t chunk_bytes;             /* dimensione di un nuovo chunk */
+};
+
+static obj_mem_arena_chunk_t* obj_mem_arena_new_chunk(size_t capacity) {
+    obj_mem_arena_chunk_t *chunk =
+        (obj_mem_arena_chunk_t*)malloc(sizeof(*chunk) + capacity);
+    if (!chunk) {
+        TRACE_ERROR(&stdtrace, "obj_mem_arena_new_chunk: malloc(%zu) fallita",
+                    sizeof(*chunk) + capacity);
+        return NULL;
+    }
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    return chunk;
+}
+
+obj_mem_arena_t* obj_mem_arena_create(size_t bytes) {
+    obj_mem_arena_t *arena = (obj_mem_arena_t*)malloc(sizeof(*arena));
+    if (!arena) {
+        return NULL;
+    }
+    arena->chunk_bytes = (bytes > 0) ? bytes : OBJ_MEM_ARENA_DEFAULT_BYTES;
+    arena->chunks = obj_mem_arena_new_chunk(arena->chunk_bytes);
+    if (!arena->chunks) {
+        free(arena);
+        return NULL;
+    }
+    arena->current = arena->chunks;
+    return arena;
+}
+
+void* obj_mem_arena_alloc(obj_mem_arena_t *arena, size_t size) {
+    if (!arena || size == 0) return NULL;
+
+    /* Allineamento a max_align_t per qualunque tipo di oggetto */
+    size_t align = _Alignof(max_align_t);
+    size = (size + align - 1) & ~(align - 1);
+
+    obj_mem_arena_chunk_t *chunk = arena->current;
+    while (chunk && chunk->capacity - chunk->used < size) {
+        /* Prova i chunk già posseduti (riutilizzo dopo un reset) */
+        if (chunk->next) {
+            chunk = chunk->next;
+            arena->current = chunk;
+            continue;
+        }
+        /* Serve un chunk nuovo, almeno grande quanto la richiesta */
+        size_t cap = (size > arena->chunk_bytes) ? size : arena->chunk_bytes;
+        obj_mem_arena_chunk_t *fresh = obj_mem_arena_new_chunk(cap);
+        if (!fresh) {
+            return NULL;
+        }
+        chunk->next = fresh;
+        chunk = fresh;
+        arena->current = chunk;
+    }
+    if (!chunk) {
+        return NULL;
+    }
+
+    void *ptr = (char*)(chunk + 1) + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+void obj_mem_arena_reset(obj_mem_arena_t *arena) {
+    if (!arena) return;
+    /* O(1) sul percorso caldo: azzeriamo l'offset di ogni chunk posseduto
+       (la lista è tipicamente di 1-2 elementi) e ripartiamo dal primo */
+    for (obj_mem_arena_chunk_t *c = arena->chunks; c; c = c->next) {
+        c->used = 0;
+    }
+    arena->current = arena->chunks;
+}
+
+void obj_mem_arena_destroy(obj_mem_arena_t *arena) {
+    if (!arena) return;
+    obj_mem_arena_chunk_t *chunk = arena->chunks;
+    while (chunk) {
+        obj_mem_arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
+
+/* --------------------------------------------------------------------------
+ * Free-list a dimensione fissa (cache di blocchi malloc)
+ * --------------------------------------------------------------------------
+ * Il puntatore al prossimo blocco libero vive nei primi byte del blocco
+ * stesso, quindi block_size deve essere almeno sizeof(void*): vale per
+ * tutti gli stati di gioco della libreria.
+ */
+
+void* obj_mem_freelist_alloc(obj_mem_freelist_t *fl) {
+    if (!fl || fl->block_size < sizeof(void*)) return NULL;
+    if (fl->head) {
+        void *block = fl->head;
+        fl->head = *(void**)block;
+        fl->count--;
+        return block;
+    }
+    return malloc(fl->block_size);
+}
+
+void obj_mem_freelist_free(obj_mem_freelist_t *fl, void *ptr) {
+    if (!ptr) return;
+    if (!fl || fl->count >= fl->max_count) {
+        free(ptr);
+        return;
+    }
+    *(void**)ptr = fl->head;
+    fl->head = ptr;
+    fl->count++;
+}
+
+void obj_mem_freelist_drain(obj_mem_freelist_t *fl) {
+    if (!fl) return;
+    while (fl->head) {
+        void *next = *(void**)fl->head;
+        free(fl->head);
+        fl->head = next;
+    }
+    fl->count = 0;
+}
+
+/* --------------------------------------------------------------------------
+ * Campionamento delle allocazioni (profiling di produzione)
+ * --------------------------------------------------------------------------
+ * Ogni blocco porta un piccolo header con magic, indice del callsite e
+ * dimensione; solo 1 allocazione su N viene registrata nella tabella dei
+ * callsite, quindi il percorso caldo paga un header e un decremento di un
+ * contatore per-thread. Il mutex viene preso solo sulle allocazioni
+ * campionate (1 su N) e nelle free dei soli blocchi campionati.
+ */
+
+#if defined(OBJ_MEM_SAMPLING_ON)
+
+#include <stdint.h>
+#include <pthread.h>
+
+#define OBJ_MEM_SAMPLE_RATE_DEFAULT 1024 /* 1 allocazione registrata ogni 1024 */
+#define OBJ_MEM_SAMPLE_SITES        256  /* callsite distinti tracciabili */
+
+#define OBJ_MEM_SAMPLE_MAGIC 0x53414D50u /* "SAMP": blocco campionato */
+#define OBJ_MEM_PLAIN_MAGIC  0x504C414Eu /* "PLAN": blocco non campionato */
+
+/* Header premesso a ogni blocco in modalità campionamento (16 byte) */
+typedef struct obj_mem_sample_hdr_s {
+    uint32_t magic;  /* SAMPLE o PLAIN */
+    int32_t  site;   /* indice del callsite nella tabella (-1 = nessuno) */
+    size_t   size;   /* dimensione richiesta dal chiamante */
+} obj_mem_sample_hdr_t;
+
+/* Contatori vivi per callsite (byte/blocchi dei soli blocchi campionati) */
+typedef struct obj_mem_sample_site_s {
+    const char *file;       /* NULL = slot libero */
+    int line;
+    size_t live_bytes;      /* byte vivi campionati */
+    size_t live_blocks;     /* blocchi vivi campionati */
+    size_t sampled_allocs;  /* allocazioni campionate totali */
+} obj_mem_sample_site_t;
+
+static obj_mem_sample_site_t g_sample_sites[OBJ_MEM_SAMPLE_SITES];
+static pthread_mutex_t g_sample_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned g_sample_rate = OBJ_MEM_SAMPLE_RATE_DEFAULT;
+static __thread unsigned tl_sample_countdown = 0;
+
+/* Trova (o rivendica) lo slot del callsite; chiamare con il mutex preso.
+   Ritorna -1 se la tabella è piena. La chiave usa il puntatore a __FILE__,
+   costante per ogni unità di traduzione. */
+static int sample_site_index(const char *file, int line) {
+    size_t h = ((uintptr_t)file * 31u + (unsigned)line) % OBJ_MEM_SAMPLE_SITES;
+    for (size_t probe = 0; probe < OBJ_MEM_SAMPLE_SITES; probe++) {
+        size_t idx = (h + probe) % OBJ_MEM_SAMPLE_SITES;
+        obj_mem_sample_site_t *site = &g_sample_sites[idx];
+        if (site->file == NULL) {
+            site->file = file;
+            site->line = line;
+            return (int)idx;
+        }
+        if (site->file == file && site->line == line) {
+            return (int)idx;
+        }
+    }
+    return -1; /* tabella piena: l'allocazione resta non campionata */
+}
+
+void* obj_mem_malloc_sampled(size_t size, const char *file, int line) {
+    obj_mem_sample_hdr_t *hdr =
+        (obj_mem_sample_hdr_t*)malloc(sizeof(*hdr) + size);
+    if (!hdr) {
+        return NULL;
+    }
+    hdr->magic = OBJ_MEM_PLAIN_MAGIC;
+    hdr->site = -1;
+    hdr->size = size;
+
+    unsigned rate = g_sample_rate;
+    if (rate > 0) {
+        if (tl_sample_countdown == 0) {
+            tl_sample_countdown = rate;
+            pthread_mutex_lock(&g_sample_mutex);
+            int site = sample_site_index(file, line);
+            if (site >= 0) {
+                g_sample_sites[site].live_bytes += size;
+                g_sample_sites[site].live_blocks++;
+                g_sample_sites[site].sampled_allocs++;
+                hdr->magic = OBJ_MEM_SAMPLE_MAGIC;
+                hdr->site = site;
+            }
+            pthread_mutex_unlock(&g_sample_mutex);
+        }
+        tl_sample_countdown--;
+    }
+    return (void*)(hdr + 1);
+}
+
+void* obj_mem_calloc_sampled(size_t nmemb, size_t size, const char *file, int line) {
+    size_t total = nmemb * size;
+    void *ptr = obj_mem_malloc_sampled(total, file, line);
+    if (ptr) {
+        memset(ptr, 0, total);
+    }
+    return ptr;
+}
+
+void obj_mem_free_sampled(void *ptr) {
+    if (!ptr) return;
+    obj_mem_sample_hdr_t *hdr = (obj_mem_sample_hdr_t*)ptr - 1;
+
+    if (hdr->magic == OBJ_MEM_SAMPLE_MAGIC) {
+        pthread_mutex_lock(&g_sample_mutex);
+        obj_mem_sample_site_t *site = &g_sample_sites[hdr->site];
+        site->live_bytes -= hdr->size;
+        site->live_blocks--;
+        pthread_mutex_unlock(&g_sample_mutex);
+        hdr->magic = 0; /* contro i double-free dei contatori */
+        free(hdr);
+        return;
+    }
+    if (hdr->magic == OBJ_MEM_PLAIN_MAGIC) {
+        hdr->magic = 0;
+        free(hdr);
+        return;
+    }
+
+    /* Blocco senza header: allocato da codice compilato senza
+       OBJ_MEM_SAMPLING_ON. Liberiamo il puntatore così com'è. */
+    TRACE_ERROR(&stdtrace,
+                "obj_mem_free_sampled: blocco 0x%p senza header di campionamento",
+                ptr);
+    free(ptr);
+}
+
+void* obj_mem_realloc_sampled(void *ptr, size_t new_size, const char *file, int line) {
+    if (!ptr) {
+        return obj_mem_malloc_sampled(new_size, file, line);
+    }
+    if (new_size == 0) {
+        obj_mem_free_sampled(ptr);
+        return NULL;
+    }
+
+    obj_mem_sample_hdr_t *hdr = (obj_mem_sample_hdr_t*)ptr - 1;
+    size_t old_size = hdr->size;
+
+    obj_mem_sample_hdr_t *new_hdr =
+        (obj_mem_sample_hdr_t*)realloc(hdr, sizeof(*new_hdr) + new_size);
+    if (!new_hdr) {
+        return NULL;
+    }
+    new_hdr->size = new_size;
+
+    if (new_hdr->magic == OBJ_MEM_SAMPLE_MAGIC) {
+        pthread_mutex_lock(&g_sample_mutex);
+        obj_mem_sample_site_t *site = &g_sample_sites[new_hdr->site];
+        site->live_bytes -= old_size;
+        site->live_bytes += new_size;
+        pthread_mutex_unlock(&g_sample_mutex);
+    }
+    return (void*)(new_hdr + 1);
+}
+
+void obj_mem_set_sample_rate(unsigned n) {
+    g_sample_rate = n;
+}
+
+void obj_mem_dump_samples(void) {
+    pthread_mutex_lock(&g_sample_mutex);
+    TRACE_INFO(&stdtrace, "==== CONTATORI VIVI PER CALLSITE (1 su %u) ====",
+               g_sample_rate);
+    for (size_t i = 0; i < OBJ_MEM_SAMPLE_SITES; i++) {
+        const obj_mem_sample_site_t *site = &g_sample_sites[i];
+        if (site->file == NULL || site->sampled_allocs == 0) {
+            continue;
+        }
+        TRACE_INFO(&stdtrace,
+                   "%s:%d  vivi=%zu byte (%zu blocchi)  campionate=%zu",
+                   site->file, site->line,
+                   site->live_bytes, site->live_blocks, site->sampled_allocs);
+    }
+    TRACE_INFO(&stdtrace, "==== FINE CONTATORI (stima: byte x passo) ====");
+    pthread_mutex_unlock(&g_sample_mutex);
+}
+
+#endif /* OBJ_MEM_SAMPLING_ON */
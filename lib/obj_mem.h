@@ -2,7 +2,7 @@
  * @file obj_mem.h
  * @brief Gestione della memoria con debug opzionale.
  *
- * ##VERSION## "obj_mem.h 1.1"
+ * ##VERSION## "obj_mem.h 1.4"
  *
  * Questo header fornisce meccanismi avanzati per la gestione della memoria,
  * inclusa una modalità di debug opzionale attivabile tramite la macro `OBJ_MEM_DEBUG_ON`.
@@ -137,6 +137,89 @@ void dump_allocated_memory_hex(void);
 
 #endif /* OBJ_MEM_DEBUG_ON */
 
+/* --------------------------------------------------------------------------
+ * Sezione Campionamento delle Allocazioni (profiling di produzione)
+ * --------------------------------------------------------------------------
+ *
+ * Il tracciamento completo (OBJ_MEM_DEBUG_ON) registra ogni allocazione in
+ * una lista: troppo lento per un server di gioco in produzione. La modalità
+ * campionata (OBJ_MEM_SAMPLING_ON) registra solo 1 allocazione su N con il
+ * callsite file/linea (già catturato dagli hook) e mantiene per ciascun
+ * callsite contatori di byte/blocchi vivi leggibili a runtime: telemetria
+ * continua dei leak a costo quasi nullo. I contatori sono una stima da
+ * moltiplicare per il passo di campionamento.
+ *
+ * Le due modalità sono mutuamente esclusive.
+ */
+
+#if defined(OBJ_MEM_DEBUG_ON) && defined(OBJ_MEM_SAMPLING_ON)
+#error "OBJ_MEM_DEBUG_ON e OBJ_MEM_SAMPLING_ON sono mutuamente esclusive"
+#endif
+
+// #define OBJ_MEM_SAMPLING_ON 1  // Decommentare per abilitare il campionamento
+
+#if defined(OBJ_MEM_SAMPLING_ON)
+
+/**
+ * @brief Alloca memoria registrando (1 su N) il callsite (sostituisce `malloc`).
+ *
+ * @param[in] size  Dimensione della memoria da allocare in byte.
+ * @param[in] file  Nome del file sorgente chiamante (usare `__FILE__`).
+ * @param[in] line  Numero di linea chiamante (usare `__LINE__`).
+ * @return Puntatore alla memoria allocata, oppure `NULL` in caso di fallimento.
+ */
+void* obj_mem_malloc_sampled(size_t size, const char *file, int line);
+
+/**
+ * @brief Variante campionata di `calloc` (area azzerata).
+ *
+ * @param[in] nmemb Numero di elementi.
+ * @param[in] size  Dimensione di ciascun elemento in byte.
+ * @param[in] file  Nome del file sorgente chiamante (usare `__FILE__`).
+ * @param[in] line  Numero di linea chiamante (usare `__LINE__`).
+ * @return Puntatore alla memoria allocata, oppure `NULL` in caso di fallimento.
+ */
+void* obj_mem_calloc_sampled(size_t nmemb, size_t size, const char *file, int line);
+
+/**
+ * @brief Variante campionata di `realloc` (aggiorna i contatori del callsite).
+ *
+ * @param[in] ptr       Blocco precedente (può essere `NULL`).
+ * @param[in] new_size  Nuova dimensione richiesta in byte.
+ * @param[in] file      Nome del file sorgente chiamante (usare `__FILE__`).
+ * @param[in] line      Numero di linea chiamante (usare `__LINE__`).
+ * @return Puntatore al nuovo blocco, oppure `NULL` in caso di errore.
+ */
+void* obj_mem_realloc_sampled(void *ptr, size_t new_size, const char *file, int line);
+
+/**
+ * @brief Libera un blocco allocato in modalità campionata (sostituisce `free`).
+ *
+ * Se il blocco era stato campionato, i contatori di byte/blocchi vivi del
+ * suo callsite vengono decrementati.
+ *
+ * @param[in] ptr Puntatore alla memoria da liberare.
+ */
+void obj_mem_free_sampled(void *ptr);
+
+/**
+ * @brief Imposta il passo di campionamento: 1 allocazione registrata ogni \p n.
+ *
+ * @param[in] n Passo di campionamento (0 = campionamento disattivato;
+ *              default \c OBJ_MEM_SAMPLE_RATE_DEFAULT).
+ */
+void obj_mem_set_sample_rate(unsigned n);
+
+/**
+ * @brief Stampa (via TRACE_INFO) i contatori vivi per callsite.
+ *
+ * I byte riportati sono quelli dei soli blocchi campionati: per la stima
+ * dei byte vivi reali moltiplicare per il passo di campionamento.
+ */
+void obj_mem_dump_samples(void);
+
+#endif /* OBJ_MEM_SAMPLING_ON */
+
 /* --------------------------------------------------------------------------
  * Ridefinizione di malloc, free, realloc e calloc in modalità Debug
  * --------------------------------------------------------------------------
@@ -171,6 +254,58 @@ void dump_allocated_memory_hex(void);
 
 #endif /* !OBJ_MEM_C && OBJ_MEM_DEBUG_ON */
 
+/* --------------------------------------------------------------------------
+ * Ridefinizione di malloc, free, realloc e calloc in modalità Campionamento
+ * --------------------------------------------------------------------------
+ *
+ * Come per la modalità debug, ma verso le varianti campionate: l'intera
+ * libreria va compilata con la stessa impostazione, perché i blocchi portano
+ * un piccolo header riconosciuto solo dalle funzioni campionate.
+ */
+
+#if !defined(OBJ_MEM_C) && defined(OBJ_MEM_SAMPLING_ON)
+
+/**
+ * @brief Ridefinisce \c malloc per utilizzare \c obj_mem_malloc_sampled.
+ */
+#define malloc(SZ) obj_mem_malloc_sampled((SZ), __FILE__, __LINE__)
+
+/**
+ * @brief Ridefinisce \c free per utilizzare \c obj_mem_free_sampled.
+ */
+#define free(PTR) obj_mem_free_sampled((PTR))
+
+/**
+ * @brief Ridefinisce \c realloc per utilizzare \c obj_mem_realloc_sampled.
+ */
+#define realloc(PTR, SZ) obj_mem_realloc_sampled((PTR), (SZ), __FILE__, __LINE__)
+
+/**
+ * @brief Ridefinisce \c calloc per utilizzare \c obj_mem_calloc_sampled.
+ */
+#define calloc(NM, SZ) obj_mem_calloc_sampled((NM), (SZ), __FILE__, __LINE__)
+
+#endif /* !OBJ_MEM_C && OBJ_MEM_SAMPLING_ON */
+
+/* --------------------------------------------------------------------------
+ * Disabilitazione delle funzioni di campionamento in modalità non-sampling
+ * --------------------------------------------------------------------------
+ */
+
+#if !defined(OBJ_MEM_SAMPLING_ON) && !defined(OBJ_MEM_C)
+
+/**
+ * @brief Disabilita \c obj_mem_set_sample_rate quando il campionamento è spento.
+ */
+#define obj_mem_set_sample_rate(N) do {} while (0)
+
+/**
+ * @brief Disabilita \c obj_mem_dump_samples quando il campionamento è spento.
+ */
+#define obj_mem_dump_samples() do {} while (0)
+
+#endif /* !OBJ_MEM_SAMPLING_ON && !OBJ_MEM_C */
+
 /* --------------------------------------------------------------------------
  * Disabilitazione delle funzioni di dump in modalità non-debug
  * --------------------------------------------------------------------------
@@ -193,4 +328,182 @@ void dump_allocated_memory_hex(void);
 
 #endif /* !OBJ_MEM_DEBUG_ON && !OBJ_MEM_C */
 
+/* --------------------------------------------------------------------------
+ * Sezione Pool di blocchi a dimensione fissa
+ * --------------------------------------------------------------------------
+ *
+ * Un pool alloca blocchi tutti della stessa dimensione e ricicla quelli
+ * liberati tramite una free-list interna: dopo il riscaldamento, alloc e
+ * free sono O(1) e non toccano più l'allocatore globale. È il rimedio
+ * classico per i pattern "milioni di malloc/free dello stesso oggetto"
+ * tipici della ricerca (copie di stato, copie di mossa).
+ *
+ * Il pool NON è thread-safe: usare un'istanza per thread (ad es. __thread),
+ * come fanno le strutture per-thread della ricerca in minimax.c.
+ */
+
+/**
+ * @struct obj_mem_pool_s
+ * @brief Struttura opaca del pool di blocchi a dimensione fissa.
+ */
+typedef struct obj_mem_pool_s obj_mem_pool_t;
+
+/**
+ * @brief Crea un pool di blocchi a dimensione fissa.
+ *
+ * @param[in] block_size       Dimensione in byte di ogni blocco (minimo sizeof(void*)).
+ * @param[in] blocks_per_chunk Blocchi preallocati per ogni chunk (0 = default).
+ * @return obj_mem_pool_t* Puntatore al pool, oppure NULL in caso di errore.
+ */
+obj_mem_pool_t* obj_mem_pool_create(size_t block_size, size_t blocks_per_chunk);
+
+/**
+ * @brief Preleva un blocco dal pool (dalla free-list, o da un nuovo chunk).
+ *
+ * @param[in] pool Puntatore al pool.
+ * @return void* Blocco di block_size byte (non azzerato), oppure NULL in caso di errore.
+ */
+void* obj_mem_pool_alloc(obj_mem_pool_t *pool);
+
+/**
+ * @brief Restituisce un blocco al pool per il riutilizzo.
+ *
+ * @param[in] pool Puntatore al pool da cui il blocco proviene.
+ * @param[in] ptr  Blocco ottenuto da \ref obj_mem_pool_alloc (NULL = no-op).
+ */
+void obj_mem_pool_free(obj_mem_pool_t *pool, void *ptr);
+
+/**
+ * @brief Distrugge il pool liberando tutti i chunk.
+ *
+ * @param[in] pool Puntatore al pool (NULL = no-op).
+ *
+ * @warning Tutti i blocchi prelevati dal pool diventano invalidi.
+ */
+void obj_mem_pool_destroy(obj_mem_pool_t *pool);
+
+/* --------------------------------------------------------------------------
+ * Sezione Arena (allocazione a epoche con reset O(1))
+ * --------------------------------------------------------------------------
+ *
+ * Un'arena soddisfa allocazioni di dimensione variabile avanzando un puntatore
+ * in un buffer preallocato; non esiste free per singolo oggetto, ma
+ * \ref obj_mem_arena_reset riporta l'arena vuota in O(1). Adatta agli oggetti
+ * che vivono tutti quanto una stessa "epoca" (ad es. una ricerca su una mossa
+ * di radice): milioni di free individuali diventano un'assegnazione.
+ *
+ * Come il pool, l'arena non è thread-safe: un'istanza per thread.
+ */
+
+/**
+ * @struct obj_mem_arena_s
+ * @brief Struttura opaca dell'arena.
+ */
+typedef struct obj_mem_arena_s obj_mem_arena_t;
+
+/**
+ * @brief Crea un'arena con un buffer iniziale di \p bytes byte.
+ *
+ * @param[in] bytes Dimensione del primo chunk (0 = default).
+ * @return obj_mem_arena_t* Puntatore all'arena, oppure NULL in caso di errore.
+ */
+obj_mem_arena_t* obj_mem_arena_create(size_t bytes);
+
+/**
+ * @brief Alloca \p size byte dall'arena (allineati a max_align_t).
+ *
+ * Se il chunk corrente è esaurito ne viene allocato uno nuovo; i chunk
+ * restano di proprietà dell'arena fino a \ref obj_mem_arena_destroy.
+ *
+ * @param[in] arena Puntatore all'arena.
+ * @param[in] size  Dimensione richiesta in byte.
+ * @return void* Memoria allocata (non azzerata), oppure NULL in caso di errore.
+ *
+ * @note Non esiste una free per singola allocazione: la memoria torna
+ *       disponibile solo con \ref obj_mem_arena_reset.
+ */
+void* obj_mem_arena_alloc(obj_mem_arena_t *arena, size_t size);
+
+/**
+ * @brief Svuota l'arena in O(1), senza restituire i chunk al sistema.
+ *
+ * Tutte le allocazioni fatte dall'ultimo reset diventano invalide; i chunk
+ * già posseduti vengono riutilizzati dalle allocazioni successive.
+ *
+ * @param[in] arena Puntatore all'arena (NULL = no-op).
+ */
+void obj_mem_arena_reset(obj_mem_arena_t *arena);
+
+/**
+ * @brief Distrugge l'arena liberando tutti i chunk.
+ *
+ * @param[in] arena Puntatore all'arena (NULL = no-op).
+ */
+void obj_mem_arena_destroy(obj_mem_arena_t *arena);
+
+/* --------------------------------------------------------------------------
+ * Sezione Free-list a dimensione fissa (cache di blocchi malloc)
+ * --------------------------------------------------------------------------
+ *
+ * A differenza del pool (che prealloca chunk indivisibili), la free-list
+ * ricicla blocchi allocati individualmente con malloc: un blocco liberato
+ * viene trattenuto (fino a max_count) e riconsegnato alla prossima alloc
+ * senza toccare l'allocatore globale. Poiché ogni blocco è una malloc a sé,
+ * un blocco può essere allocato da una lista e liberato in un'altra (ad es.
+ * tra thread diversi) senza problemi di proprietà dei chunk.
+ *
+ * La struttura è pensata per essere dichiarata direttamente dall'utente,
+ * tipicamente come variabile __thread inizializzata con
+ * \ref OBJ_MEM_FREELIST_INIT: niente create/destroy, la cache vive quanto
+ * il thread.
+ */
+
+/**
+ * @struct obj_mem_freelist_s
+ * @brief Free-list di blocchi a dimensione fissa.
+ *
+ * I campi sono pubblici solo per consentire l'inizializzazione statica con
+ * \ref OBJ_MEM_FREELIST_INIT; manipolarli direttamente non è supportato.
+ */
+typedef struct obj_mem_freelist_s {
+    void  *head;        /**< primo blocco libero (lista intrusiva)          */
+    size_t block_size;  /**< dimensione in byte dei blocchi (>= sizeof(void*)) */
+    size_t count;       /**< blocchi attualmente trattenuti in lista        */
+    size_t max_count;   /**< massimo numero di blocchi trattenuti           */
+} obj_mem_freelist_t;
+
+/**
+ * @def OBJ_MEM_FREELIST_INIT
+ * @brief Inizializzatore statico per una \ref obj_mem_freelist_t.
+ *
+ * @param[in] BLOCK_SIZE Dimensione in byte dei blocchi.
+ * @param[in] MAX_COUNT  Massimo numero di blocchi trattenuti in cache.
+ */
+#define OBJ_MEM_FREELIST_INIT(BLOCK_SIZE, MAX_COUNT) \
+    { NULL, (BLOCK_SIZE), 0, (MAX_COUNT) }
+
+/**
+ * @brief Preleva un blocco dalla free-list (o da malloc se la lista è vuota).
+ *
+ * @param[in] fl Puntatore alla free-list.
+ * @return void* Blocco di block_size byte (non azzerato), oppure NULL in caso di errore.
+ */
+void* obj_mem_freelist_alloc(obj_mem_freelist_t *fl);
+
+/**
+ * @brief Restituisce un blocco alla free-list (o a free se la cache è piena).
+ *
+ * @param[in] fl  Puntatore alla free-list.
+ * @param[in] ptr Blocco di block_size byte allocato con malloc o con
+ *                \ref obj_mem_freelist_alloc (NULL = no-op).
+ */
+void obj_mem_freelist_free(obj_mem_freelist_t *fl, void *ptr);
+
+/**
+ * @brief Svuota la cache restituendo tutti i blocchi trattenuti a free.
+ *
+ * @param[in] fl Puntatore alla free-list (NULL = no-op).
+ */
+void obj_mem_freelist_drain(obj_mem_freelist_t *fl);
+
 #endif /* OBJ_MEM_H */
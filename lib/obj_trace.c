@@ -1,11 +1,12 @@
 /**
- * ##VERSION## "obj_trace.c 1.0"
+ * ##VERSION## "obj_trace.c 1.2"
 */
 
 #include "obj_trace.h"
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 /* Canale standard di default */
 trace_channel_t stdtrace = {
@@ -13,9 +14,42 @@ trace_channel_t stdtrace = {
     .output = NULL,
     .level = TRACE_LEVEL_DEBUG,
     .enabled = true,
-    .own_output = false
+    .own_output = false,
+    .async = NULL
 };
 
+/* --------------------------------------------------------------------------
+ * Ring buffer asincrono
+ * --------------------------------------------------------------------------
+ * Coda circolare a dimensione fissa con numero di sequenza per slot
+ * (schema di Vyukov): più produttori accodano con una CAS sull'indice di
+ * testa, il solo thread di svuotamento consuma dalla coda. Nessun lock sul
+ * percorso del chiamante; a ring pieno il messaggio viene scartato e
+ * conteggiato invece di bloccare.
+ */
+
+#define TRACE_ASYNC_RING_SIZE 1024  /* slot nel ring, potenza di 2 */
+#define TRACE_ASYNC_MSG_MAX   200   /* byte del messaggio formattato per slot */
+
+typedef struct trace_async_slot_s {
+    size_t seq;                    /* sequenza dello slot (atomico) */
+    trace_level_t level;
+    const char *file;              /* puntatore a __FILE__ (costante) */
+    int line;
+    time_t when;                   /* istante della chiamata, non dell'I/O */
+    char msg[TRACE_ASYNC_MSG_MAX]; /* messaggio già formattato (troncato) */
+} trace_async_slot_t;
+
+typedef struct trace_async_state_s {
+    trace_async_slot_t ring[TRACE_ASYNC_RING_SIZE];
+    size_t head;        /* prossimo slot da scrivere (produttori, atomico) */
+    size_t tail;        /* prossimo slot da leggere (solo flusher) */
+    uint64_t dropped;   /* messaggi scartati per ring pieno (atomico) */
+    pthread_t flusher;
+    int running;        /* 0 = al flusher è stato chiesto di uscire (atomico) */
+    trace_channel_t *channel;
+} trace_async_state_t;
+
 /* Funzione per cambiare l'output di un canale */
 void trace_set_channel_output(trace_channel_t *channel, FILE *output) {
     if (channel) {
@@ -60,26 +94,136 @@ static const char* trace_level_to_str(trace_level_t level) {
     }
 }
 
+/* Accoda un messaggio nel ring asincrono. Il chiamante paga solo la
+   vsnprintf nello slot: intestazione e I/O sono rinviati al flusher.
+   A ring pieno il messaggio viene scartato e conteggiato. */
+static void trace_async_enqueue(trace_async_state_t *as,
+                                trace_level_t level,
+                                const char *file,
+                                int line,
+                                const char *fmt,
+                                va_list args)
+{
+    size_t pos = __atomic_load_n(&as->head, __ATOMIC_RELAXED);
+    trace_async_slot_t *slot;
+
+    for (;;) {
+        slot = &as->ring[pos & (TRACE_ASYNC_RING_SIZE - 1)];
+        size_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            /* Slot libero: prova a rivendicarlo */
+            if (__atomic_compare_exchange_n(&as->head, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            /* CAS fallita: pos è stato aggiornato, riprova */
+        } else if (diff < 0) {
+            /* Ring pieno: scarta senza bloccare */
+            __atomic_fetch_add(&as->dropped, 1, __ATOMIC_RELAXED);
+            return;
+        } else {
+            pos = __atomic_load_n(&as->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->level = level;
+    slot->file = file;
+    slot->line = line;
+    slot->when = time(NULL);
+    vsnprintf(slot->msg, sizeof(slot->msg), fmt, args);
+
+    /* Pubblica lo slot: il flusher lo vede quando seq == pos + 1 */
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+/* Scrive sul canale un singolo slot del ring (solo thread flusher).
+   Ritorna false se il ring è vuoto. */
+static bool trace_async_drain_one(trace_async_state_t *as) {
+    size_t pos = as->tail;
+    trace_async_slot_t *slot = &as->ring[pos & (TRACE_ASYNC_RING_SIZE - 1)];
+    size_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+    if (seq != pos + 1) {
+        return false; /* slot non ancora pubblicato */
+    }
+
+    trace_channel_t *channel = as->channel;
+    FILE *out = channel->output ? channel->output : stderr;
+    char timestamp[64];
+    struct tm tm_info;
+    localtime_r(&slot->when, &tm_info);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm_info);
+
+    fprintf(out, "[%s] [%s] [%s] (%s:%d): %s\n",
+            timestamp,
+            channel->name,
+            trace_level_to_str(slot->level),
+            slot->file,
+            slot->line,
+            slot->msg);
+
+    /* Libera lo slot per il giro successivo dei produttori */
+    __atomic_store_n(&slot->seq, pos + TRACE_ASYNC_RING_SIZE, __ATOMIC_RELEASE);
+    as->tail = pos + 1;
+    return true;
+}
+
+/* Thread di svuotamento: scarica il ring e dorme brevemente quando vuoto.
+   All'uscita scarica i messaggi residui. */
+static void* trace_async_flusher(void *arg) {
+    trace_async_state_t *as = (trace_async_state_t*)arg;
+
+    while (__atomic_load_n(&as->running, __ATOMIC_ACQUIRE)) {
+        bool wrote = false;
+        while (trace_async_drain_one(as)) {
+            wrote = true;
+        }
+        if (wrote) {
+            FILE *out = as->channel->output ? as->channel->output : stderr;
+            fflush(out);
+        } else {
+            struct timespec ts = { 0, 1000000 }; /* 1 ms */
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    while (trace_async_drain_one(as)) { }
+    {
+        FILE *out = as->channel->output ? as->channel->output : stderr;
+        fflush(out);
+    }
+    return NULL;
+}
+
 /* Funzione di logging con file e linea inclusi */
-void trace_log(trace_channel_t *channel, 
-               trace_level_t level, 
-               const char *file, 
-               int line, 
-               const char *fmt, ...) 
+void trace_log(trace_channel_t *channel,
+               trace_level_t level,
+               const char *file,
+               int line,
+               const char *fmt, ...)
 {
     if (!channel || !channel->enabled || level < channel->level) {
         return;
     }
 
-    FILE *out = channel->output ? channel->output : stderr;
     va_list args;
     va_start(args, fmt);
 
-    fprintf(out, "[%s] [%s] [%s] (%s:%d): ", 
-            trace_get_timestamp(), 
-            channel->name, 
-            trace_level_to_str(level), 
-            file, 
+    if (channel->async) {
+        trace_async_enqueue(channel->async, level, file, line, fmt, args);
+        va_end(args);
+        return;
+    }
+
+    FILE *out = channel->output ? channel->output : stderr;
+
+    fprintf(out, "[%s] [%s] [%s] (%s:%d): ",
+            trace_get_timestamp(),
+            channel->name,
+            trace_level_to_str(level),
+            file,
             line);
     vfprintf(out, fmt, args);
     fprintf(out, "\n");
@@ -88,6 +232,176 @@ void trace_log(trace_channel_t *channel,
     fflush(out);
 }
 
+/* Attiva la modalità asincrona: alloca il ring e avvia il flusher */
+bool trace_channel_start_async(trace_channel_t *channel) {
+    if (!channel || channel->async) {
+        return channel && channel->async; /* già attiva = successo */
+    }
+
+    trace_async_state_t *as =
+        (trace_async_state_t*)malloc(sizeof(trace_async_state_t));
+    if (!as) {
+        return false;
+    }
+
+    for (size_t i = 0; i < TRACE_ASYNC_RING_SIZE; i++) {
+        as->ring[i].seq = i;
+    }
+    as->head = 0;
+    as->tail = 0;
+    as->dropped = 0;
+    as->running = 1;
+    as->channel = channel;
+
+    if (pthread_create(&as->flusher, NULL, trace_async_flusher, as) != 0) {
+        free(as);
+        return false;
+    }
+
+    channel->async = as;
+    return true;
+}
+
+/* Disattiva la modalità asincrona: ferma il flusher e svuota il ring */
+void trace_channel_stop_async(trace_channel_t *channel) {
+    if (!channel || !channel->async) {
+        return;
+    }
+
+    trace_async_state_t *as = channel->async;
+    /* Prima stacca il canale: i logger tornano sincroni, il flusher
+       scarica quel che resta nel ring prima di uscire */
+    channel->async = NULL;
+    __atomic_store_n(&as->running, 0, __ATOMIC_RELEASE);
+    pthread_join(as->flusher, NULL);
+
+    uint64_t dropped = as->dropped;
+    if (dropped > 0) {
+        FILE *out = channel->output ? channel->output : stderr;
+        fprintf(out, "[%s] [%s] [WARN] (%s:%d): tracing asincrono: %llu messaggi scartati per ring pieno\n",
+                trace_get_timestamp(), channel->name, __FILE__, __LINE__,
+                (unsigned long long)dropped);
+        fflush(out);
+    }
+    free(as);
+}
+
+/* --------------------------------------------------------------------------
+ * Span temporizzati
+ * --------------------------------------------------------------------------
+ * Gli accumulatori vivono nei siti di misura (TRACE_SPAN_DEFINE, __thread);
+ * qui c'è solo il registro per-thread che li incatena al primo campione e
+ * il report che li converte in nanosecondi.
+ */
+
+static __thread trace_span_t *span_registry = NULL;
+
+void trace_span_record(trace_span_t *span, uint64_t begin_ticks) {
+    uint64_t now = trace_span_now();
+    /* Il TSC può fare un piccolo salto indietro migrando di core: meglio
+       uno zero che un underflow da 2^64 tick */
+    uint64_t d = (now > begin_ticks) ? now - begin_ticks : 0;
+
+    if (!span->registered) {
+        span->registered = 1;
+        span->next = span_registry;
+        span_registry = span;
+    }
+
+    span->count++;
+    span->total += d;
+    if (d < span->min_ticks) span->min_ticks = d;
+    if (d > span->max_ticks) span->max_ticks = d;
+
+    int bucket = 63 - __builtin_clzll(d | 1);
+    if (bucket >= TRACE_SPAN_BUCKETS) {
+        bucket = TRACE_SPAN_BUCKETS - 1;
+    }
+    span->hist[bucket]++;
+}
+
+/* Tick del cronometro per nanosecondo: 1.0 con CLOCK_MONOTONIC, calibrato
+   una volta per processo contro l'orologio di sistema con il TSC (che sulle
+   CPU correnti è a frequenza costante) */
+static double trace_span_ticks_per_ns(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    static double cached = 0.0;
+    if (cached == 0.0) {
+        struct timespec t0, t1;
+        struct timespec pause = { 0, 10000000 }; /* 10 ms */
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        uint64_t c0 = trace_span_now();
+        nanosleep(&pause, NULL);
+        uint64_t c1 = trace_span_now();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double ns = (double)(t1.tv_sec - t0.tv_sec) * 1e9
+                  + (double)(t1.tv_nsec - t0.tv_nsec);
+        cached = (ns > 0.0) ? (double)(c1 - c0) / ns : 1.0;
+    }
+    return cached;
+#else
+    return 1.0;
+#endif
+}
+
+/* Stima del p99: limite superiore del bucket che contiene il campione al
+   99-esimo percentile (l'istogramma è log2, la stima è per eccesso) */
+static uint64_t trace_span_p99_ticks(const trace_span_t *span) {
+    uint64_t rank = (span->count * 99 + 99) / 100; /* ceil(count * 0.99) */
+    uint64_t seen = 0;
+    for (int b = 0; b < TRACE_SPAN_BUCKETS; b++) {
+        seen += span->hist[b];
+        if (seen >= rank) {
+            return (b + 1 < 64) ? (2ull << b) : UINT64_MAX;
+        }
+    }
+    return span->max_ticks;
+}
+
+void trace_span_report(trace_channel_t *channel) {
+    if (!channel || !channel->enabled) {
+        return;
+    }
+    FILE *out = channel->output ? channel->output : stderr;
+    double tpn = trace_span_ticks_per_ns();
+
+    for (trace_span_t *span = span_registry; span; span = span->next) {
+        if (span->count == 0) {
+            continue;
+        }
+        double avg_ns = (double)span->total / (double)span->count / tpn;
+        fprintf(out, "[%s] [%s] [SPAN] %-22s n=%11llu  tot=%9.1f ms  medio=%8.0f ns  min=%7.0f  max=%11.0f  p99<=%9.0f ns\n",
+                trace_get_timestamp(),
+                channel->name,
+                span->name,
+                (unsigned long long)span->count,
+                (double)span->total / tpn / 1e6,
+                avg_ns,
+                (double)span->min_ticks / tpn,
+                (double)span->max_ticks / tpn,
+                (double)trace_span_p99_ticks(span) / tpn);
+    }
+    fflush(out);
+}
+
+void trace_span_reset(void) {
+    for (trace_span_t *span = span_registry; span; span = span->next) {
+        span->count = 0;
+        span->total = 0;
+        span->min_ticks = UINT64_MAX;
+        span->max_ticks = 0;
+        memset(span->hist, 0, sizeof(span->hist));
+    }
+}
+
+/* Messaggi scartati per ring pieno (0 se il canale non è asincrono) */
+uint64_t trace_channel_dropped(const trace_channel_t *channel) {
+    if (!channel || !channel->async) {
+        return 0;
+    }
+    return __atomic_load_n(&channel->async->dropped, __ATOMIC_RELAXED);
+}
+
 /* Inizializza un canale di trace per un file. 
    Se successso, ritorna true. Altrimenti false.
    Il canale è già allocato dal chiamante. */
@@ -118,6 +432,7 @@ bool trace_open_file_channel(trace_channel_t *channel,
 /* Chiude il canale se possiede l'output */
 void trace_close_channel(trace_channel_t *channel) {
     if (!channel) return;
+    trace_channel_stop_async(channel); /* svuota e ferma l'eventuale flusher */
     if (channel->own_output && channel->output && channel->output != stderr && channel->output != stdout) {
         fclose(channel->output);
         channel->output = NULL;
@@ -2,7 +2,7 @@
  * @file obj_trace.h
  * @brief Libreria C per il tracing/logging in programmi.
  *
- * ##VERSION## "obj_trace.h 1.0"
+ * ##VERSION## "obj_trace.h 1.2"
  *
  * Questa libreria fornisce un sistema di logging semplice ma estensibile. È possibile
  * definire uno o più "canali di tracing" (ad es. stdtrace, filetrace), ognuno con un proprio
@@ -55,6 +55,8 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
 
 /**
  * @def OPTIMIZE_DEBUG
@@ -96,6 +98,7 @@ typedef struct trace_channel_s {
     trace_level_t level;    /**< Livello corrente del canale. */
     bool enabled;           /**< \c true se il canale è abilitato, \c false altrimenti. */
     bool own_output;        /**< \c true se il canale possiede l'output (aperto da \c trace_open_file_channel). */
+    struct trace_async_state_s *async; /**< Stato asincrono (NULL = canale sincrono, vedi \ref trace_channel_start_async). */
 } trace_channel_t;
 
 /**
@@ -184,6 +187,220 @@ bool trace_open_file_channel(trace_channel_t *channel, const char *name, const c
  */
 void trace_close_channel(trace_channel_t *channel);
 
+/* --------------------------------------------------------------------------
+ * Modalità asincrona (ring buffer lock-free + thread di svuotamento)
+ * --------------------------------------------------------------------------
+ *
+ * In modalità sincrona ogni TRACE_* formatta e scrive (con fflush) sullo
+ * stream del canale: dentro i cicli caldi della ricerca questo costa ordini
+ * di grandezza più del nodo stesso. La modalità asincrona fa pagare al
+ * chiamante solo la formattazione del messaggio in uno slot di un ring
+ * buffer lock-free a dimensione fissa; timestamp, intestazione e I/O sono
+ * svolti da un thread di svuotamento in background. Se il ring è pieno il
+ * messaggio viene scartato e conteggiato (vedi \ref trace_channel_dropped):
+ * il tracing non blocca mai la ricerca.
+ */
+
+/**
+ * @brief Attiva la modalità asincrona su un canale.
+ *
+ * Alloca il ring buffer e avvia il thread di svuotamento. Da quel momento
+ * le macro \c TRACE_* sul canale accodano nel ring invece di scrivere
+ * direttamente. I messaggi più lunghi dello slot vengono troncati.
+ *
+ * @param channel Canale da rendere asincrono (già configurato).
+ * @return \c true se la modalità è attiva, \c false su errore di
+ *         allocazione/avvio thread (il canale resta sincrono).
+ *
+ * @warning Non chiamare mentre altri thread stanno loggando sul canale:
+ *          attivare la modalità prima di avviare la ricerca.
+ */
+bool trace_channel_start_async(trace_channel_t *channel);
+
+/**
+ * @brief Disattiva la modalità asincrona su un canale.
+ *
+ * Chiede al thread di svuotamento di uscire, attende che scarichi i
+ * messaggi residui e libera il ring. Il canale torna sincrono. Se dei
+ * messaggi sono stati scartati per ring pieno, ne stampa il totale.
+ *
+ * @param channel Canale da riportare in modalità sincrona.
+ */
+void trace_channel_stop_async(trace_channel_t *channel);
+
+/**
+ * @brief Numero di messaggi scartati per ring pieno dall'attivazione.
+ *
+ * @param channel Canale (anche non asincrono: in quel caso ritorna 0).
+ * @return Totale dei messaggi persi per overflow del ring.
+ */
+uint64_t trace_channel_dropped(const trace_channel_t *channel);
+
+/* --------------------------------------------------------------------------
+ * Span temporizzati con aggregazione (count / totale / min / max / p99)
+ * --------------------------------------------------------------------------
+ *
+ * Le righe di log dicono COSA è successo, non DOVE va il tempo: per
+ * attribuire il tempo di ricerca a generazione mosse, valutazione, cache o
+ * applicazione delle mosse senza un profiler esterno, uno span misura una
+ * regione di codice e ne aggrega le durate in un accumulatore per sito di
+ * chiamata (conteggio, totale, minimo, massimo e istogramma logaritmico da
+ * cui si stima il p99). Il report si scarica a richiesta sul canale di
+ * trace con \ref trace_span_report.
+ *
+ * Il cronometro usa il TSC (rdtsc) su x86 e CLOCK_MONOTONIC altrove; gli
+ * accumulatori sono per-thread (come le statistiche di ricerca di minimax):
+ * niente atomiche sul percorso caldo, ma il report copre solo il thread
+ * chiamante. Gli span sono INCLUSIVI: uno span dentro un altro conta in
+ * entrambi, e le funzioni ricorsive non vanno misurate con uno span.
+ *
+ * Anche così, due letture del TSC per chiamata pesano sulle funzioni da
+ * poche centinaia di nanosecondi (make_move, probe della TT): come per
+ * OBJ_MEM_DEBUG_ON, la strumentazione si attiva solo compilando con
+ * -DTRACE_SPANS_ON e altrimenti sparisce dal codice.
+ *
+ * Uso tipico (make build TARGET=chess_bench CFLAGS="-O2 -Wall -MMD -MP -DTRACE_SPANS_ON"):
+ * \code{.c}
+ *   TRACE_SPAN_DEFINE(span_movegen, "chess_generate_moves");
+ *
+ *   int chess_generate_moves(...) {
+ *       TRACE_SPAN_SCOPE(span_movegen);   // chiude da solo a ogni return
+ *       ...
+ *   }
+ *
+ *   // a fine run, ad esempio in un benchmark:
+ *   trace_span_report(&stdtrace);
+ * \endcode
+ */
+
+/** Bucket dell'istogramma: il bucket b raccoglie le durate in [2^b, 2^(b+1)) tick */
+#define TRACE_SPAN_BUCKETS 40
+
+/**
+ * @struct trace_span_s
+ * @brief Accumulatore per-thread delle durate di una regione di codice.
+ *
+ * Da definire con \ref TRACE_SPAN_DEFINE; i campi si leggono solo attraverso
+ * \ref trace_span_report. Le durate sono in tick del cronometro (vedi
+ * \ref trace_span_now); la conversione in nanosecondi avviene nel report.
+ */
+typedef struct trace_span_s {
+    const char *name;              /**< Etichetta nel report. */
+    struct trace_span_s *next;     /**< Catena del registro per-thread. */
+    int      registered;           /**< 1 dopo l'aggancio al registro. */
+    uint64_t count;                /**< Campioni registrati. */
+    uint64_t total;                /**< Somma delle durate (tick). */
+    uint64_t min_ticks;            /**< Durata minima osservata. */
+    uint64_t max_ticks;            /**< Durata massima osservata. */
+    uint64_t hist[TRACE_SPAN_BUCKETS]; /**< Istogramma log2 delle durate. */
+} trace_span_t;
+
+/** Inizializzatore di uno span (usato da \ref TRACE_SPAN_DEFINE) */
+#define TRACE_SPAN_INIT(NAME) { (NAME), NULL, 0, 0, 0, UINT64_MAX, 0, {0} }
+
+/**
+ * @brief Legge il cronometro degli span: TSC su x86, CLOCK_MONOTONIC altrove.
+ *
+ * @return Istante corrente in tick (unità convertita in ns solo nel report).
+ */
+static inline uint64_t trace_span_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Registra nello span la durata trascorsa da \p begin_ticks.
+ *
+ * Al primo campione lo span si aggancia da solo al registro del thread.
+ * Normalmente non si chiama direttamente: usare le macro TRACE_SPAN_*.
+ *
+ * @param[in,out] span        Accumulatore del sito di chiamata.
+ * @param[in]     begin_ticks Valore di \ref trace_span_now all'ingresso.
+ */
+void trace_span_record(trace_span_t *span, uint64_t begin_ticks);
+
+/**
+ * @brief Scarica sul canale gli span del thread chiamante.
+ *
+ * Una riga [SPAN] per accumulatore con campioni: conteggio, totale, media,
+ * minimo, massimo e stima del p99 (limite superiore del bucket che contiene
+ * il 99-esimo percentile). Le durate sono in nanosecondi; su x86 la
+ * frequenza del TSC viene calibrata alla prima chiamata. Scrive
+ * direttamente sull'output del canale, senza filtro di livello (il report
+ * è esplicitamente "a richiesta").
+ *
+ * @param[in] channel Canale su cui scrivere (ignorato se disabilitato).
+ */
+void trace_span_report(trace_channel_t *channel);
+
+/**
+ * @brief Azzera tutti gli span del thread chiamante.
+ *
+ * Gli span restano registrati: utile tra una misura e l'altra (ad esempio
+ * tra le posizioni di un benchmark).
+ */
+void trace_span_reset(void);
+
+/** Coppia span + istante d'ingresso per lo span a scope (interno) */
+typedef struct {
+    trace_span_t *span;
+    uint64_t begin;
+} trace_span_scope_t;
+
+/** Chiusura automatica dello span a scope (interno, via cleanup) */
+static inline void trace_span_scope_leave(trace_span_scope_t *scope) {
+    trace_span_record(scope->span, scope->begin);
+}
+
+/**
+ * @def TRACE_SPAN_DEFINE
+ * @brief Definisce l'accumulatore per-thread di uno span.
+ *
+ * @param VAR  Nome della variabile (file-static, una per sito di misura).
+ * @param NAME Etichetta mostrata nel report.
+ */
+
+/**
+ * @def TRACE_SPAN_SCOPE
+ * @brief Misura il blocco corrente: chiude da solo a ogni uscita (return inclusi).
+ *
+ * Da preferire a BEGIN/END nelle funzioni con più return. Richiede
+ * l'attributo cleanup di GCC/Clang (già richiesto dal resto della libreria).
+ *
+ * @param VAR Span definito con \ref TRACE_SPAN_DEFINE.
+ */
+
+/**
+ * @def TRACE_SPAN_BEGIN
+ * @brief Apre una misura esplicita sullo span \p VAR (da chiudere con \ref TRACE_SPAN_END).
+ */
+
+/**
+ * @def TRACE_SPAN_END
+ * @brief Chiude la misura aperta da \ref TRACE_SPAN_BEGIN nello stesso scope.
+ */
+
+#if defined(TRACE_SPANS_ON)
+#define TRACE_SPAN_DEFINE(VAR, NAME) \
+    static __thread trace_span_t VAR = TRACE_SPAN_INIT(NAME)
+#define TRACE_SPAN_SCOPE(VAR) \
+    __attribute__((cleanup(trace_span_scope_leave))) \
+    trace_span_scope_t trace_span_scope_##VAR = { &(VAR), trace_span_now() }
+#define TRACE_SPAN_BEGIN(VAR) uint64_t trace_span_begin_##VAR = trace_span_now()
+#define TRACE_SPAN_END(VAR)   trace_span_record(&(VAR), trace_span_begin_##VAR)
+#else
+#define TRACE_SPAN_DEFINE(VAR, NAME) \
+    static __thread trace_span_t VAR __attribute__((unused)) = TRACE_SPAN_INIT(NAME)
+#define TRACE_SPAN_SCOPE(VAR) do { } while (0)
+#define TRACE_SPAN_BEGIN(VAR) do { } while (0)
+#define TRACE_SPAN_END(VAR)   do { } while (0)
+#endif
+
 /**
  * @def TRACE_DEBUG
  * @brief Logga un messaggio di livello \c DEBUG sul canale specificato.
@@ -0,0 +1,146 @@
+/**
+ * ##VERSION## "perft_bench.c 1.3"
+*/
+
+/******************************************************************************
+ * File: perft_bench.c
+ *
+ * Benchmark canonico del generatore di mosse: esegue perft sulle posizioni
+ * standard (posizione iniziale, "Kiwipete", finale di torri) confrontando i
+ * conteggi con i valori noti in letteratura e riportando i nodi al secondo.
+ *
+ * Uso:
+ *   make build TARGET=perft_bench
+ *   ./perft_bench [max_depth]        (default: 5)
+ *
+ * Qualsiasi discrepanza nei conteggi indica una regressione nella catena
+ * chess_get_moves + chess_make_move/chess_unmake_move.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "chess_state.h"
+#include "chess_perft.h"
+#include "chess_fen.h"
+#include "obj_trace.h"
+
+/* --------------------------------------------------------------------------
+ * POSIZIONI DI RIFERIMENTO
+ *
+ * Le posizioni diverse da quella iniziale sono date in FEN e caricate con
+ * chess_fen_parse: i conteggi perft noti in letteratura validano quindi
+ * anche il parser, oltre alla catena di generazione.
+ * -------------------------------------------------------------------------- */
+
+/*
+ * "Kiwipete" (Peterson): posizione ricca di casi speciali — arrocchi su
+ * entrambi i lati, en passant, promozioni, scacchi e pezzi inchiodati.
+ */
+static const char *fen_kiwipete =
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -";
+
+/*
+ * Finale di torri e pedoni ("posizione 3" della suite classica): pochi pezzi
+ * ma molte inchiodature e scacchi a distanza.
+ */
+static const char *fen_endgame = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -";
+
+/* Conteggi attesi (0 = profondità non verificata) */
+static const uint64_t expected_startpos[] = { 1, 20, 400, 8902, 197281, 4865609, 119060324 };
+static const uint64_t expected_kiwipete[] = { 1, 48, 2039, 97862, 4085603, 193690690 };
+static const uint64_t expected_endgame[]  = { 1, 14, 191, 2812, 43238, 674624, 11030083 };
+
+static long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/*
+ * Esegue perft 1..max_depth sulla posizione, confronta con i valori attesi
+ * e riporta i nodi al secondo. Ritorna il numero di discrepanze trovate.
+ */
+static int run_position(const char *name,
+                        bitboard_state_t *state,
+                        const uint64_t *expected,
+                        int num_expected,
+                        int max_depth) {
+    int failures = 0;
+
+    printf("--- %s ---\n", name);
+    for (int depth = 1; depth <= max_depth; depth++) {
+        long t0 = monotonic_ms();
+        uint64_t nodes = chess_perft(state, depth);
+        long elapsed = monotonic_ms() - t0;
+
+        double nps = (elapsed > 0) ? (double)nodes * 1000.0 / (double)elapsed : 0.0;
+
+        uint64_t want = (depth < num_expected) ? expected[depth] : 0;
+        const char *verdict = "        ";
+        if (want != 0) {
+            verdict = (nodes == want) ? "OK      " : "*FAIL*  ";
+            if (nodes != want) failures++;
+        }
+
+        printf("perft(%d) = %12llu  %s %6ld ms", depth,
+               (unsigned long long)nodes, verdict, elapsed);
+        if (nps > 0.0) {
+            printf("  %10.0f nodi/s", nps);
+        }
+        if (want != 0 && nodes != want) {
+            printf("  (atteso %llu)", (unsigned long long)want);
+        }
+        printf("\n");
+    }
+    printf("\n");
+    return failures;
+}
+
+int main(int argc, char *argv[]) {
+    int max_depth = 5;
+    if (argc > 1) {
+        max_depth = atoi(argv[1]);
+        if (max_depth < 1) max_depth = 1;
+    }
+
+    // Il benchmark misura il movegen: niente trace di debug nel ciclo caldo
+    trace_set_channel_level(&stdtrace, TRACE_LEVEL_ERROR);
+
+    printf("=== perft_bench: validazione e throughput del movegen ===\n\n");
+
+    int failures = 0;
+    bitboard_state_t state;
+
+    initialize_board(&state);
+    failures += run_position("Posizione iniziale", &state,
+                             expected_startpos,
+                             (int)(sizeof(expected_startpos) / sizeof(expected_startpos[0])),
+                             max_depth);
+
+    if (!chess_fen_parse(fen_kiwipete, &state)) {
+        printf("FEN Kiwipete non interpretabile\n");
+        return 1;
+    }
+    failures += run_position("Kiwipete", &state,
+                             expected_kiwipete,
+                             (int)(sizeof(expected_kiwipete) / sizeof(expected_kiwipete[0])),
+                             max_depth);
+
+    if (!chess_fen_parse(fen_endgame, &state)) {
+        printf("FEN finale non interpretabile\n");
+        return 1;
+    }
+    failures += run_position("Finale torri e pedoni", &state,
+                             expected_endgame,
+                             (int)(sizeof(expected_endgame) / sizeof(expected_endgame[0])),
+                             max_depth);
+
+    if (failures > 0) {
+        printf("=== %d CONTEGGI ERRATI: regressione nel movegen ===\n", failures);
+        return 1;
+    }
+    printf("=== Tutti i conteggi corretti ===\n");
+    return 0;
+}
@@ -211,6 +211,11 @@ int main(void)
         chess_move_t     *pMove   = &g_test_moves[i];
         bitboard_state_t *pExpect = &g_test_expected[i];
 
+        // Gli stati del vettore sono costruiti a mano: le occupazioni
+        // aggregate vanno riallineate prima di usarli
+        chess_refresh_occupancy(pInit);
+        chess_refresh_occupancy(pExpect);
+
         // 1) Stampa stato iniziale (forma grafica + debug in hex)
         printf("[Stato iniziale]\n");
         print_board(pInit);
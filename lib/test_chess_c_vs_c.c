@@ -4,6 +4,7 @@
 #include "chess_state.h"             // per bitboard_state_t, print_board, initialize_board, ...
 #include "chess_game_descriptor.h"    // per initialize_chess_game_descriptor()
 #include "chess_game_dynamics.h"      // per chess_is_terminal, chess_apply_move, ...
+#include "chess_hash.h"               // per chess_hash_state (storia ripetizioni)
 #include "minimax.h"                  // per get_best_move
 #include "obj_trace.h"                // per stdtrace e trace_open_file_channel
 #include "obj_cache.h"                // per cache_create, cache_lookup, cache_store, ecc.
@@ -28,6 +29,11 @@ int main(void)
     }
     initialize_board(current_state);
 
+    // 2b) Semina la storia delle ripetizioni con la posizione di partenza:
+    //      le posizioni successive entrano da sole via chess_apply_move
+    chess_repetition_reset();
+    chess_repetition_push(chess_hash_state(current_state));
+
     // 3) Inizializza il descrittore di gioco scacchistico (con callback minimax)
     game_descriptor_t *gd = initialize_chess_game_descriptor();
     if (!gd) {
@@ -37,9 +43,9 @@ int main(void)
     }
 
     // 4) Creiamo la cache per memorizzare gli stati già analizzati dal minimax
-    //    Usiamo le callback gd->hash_state e gd->equals_state come parametri di hash/ugualianza.
+    //    (by-value: la tabella copia gli stati-chiave, vedi minimax_cache_create).
     TRACE_DEBUG(&stdtrace, "[MAIN] Creo la cache per il minimax...");
-    generic_hash_table_t *my_cache = cache_create(gd->hash_state, gd->equals_state);
+    generic_hash_table_t *my_cache = minimax_cache_create(gd);
     if (!my_cache) {
         TRACE_FATAL(&stdtrace, "Errore: impossibile creare la cache hash.");
         // Libera le risorse e termina
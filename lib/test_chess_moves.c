@@ -3,7 +3,7 @@
  * @brief Programma di test per la funzione generate_black_pawn_moves,
  *        con stampa dello stato iniziale della scacchiera.
  *
- * ##VERSION## "test_black_pawn_moves.c 1.0"
+ * ##VERSION## "test_black_pawn_moves.c 1.2"
  *
  * Questo programma testa specificamente la funzione generate_black_pawn_moves
  * con diversi scenari. Ogni scenario è definito da:
@@ -395,6 +395,9 @@ void parse_fen(const char *fen, bitboard_state_t *state) {
             state->fullmove_number = (uint8_t)val;
         }
     }
+
+    // 9) Occupazioni aggregate coerenti con i bitboard appena impostati
+    chess_refresh_occupancy(state);
 }
 
 
@@ -518,7 +521,7 @@ void test_generate_black_pawn_moves() {
         print_board_simple(&state);
 
         // 2) Genera mosse
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_black_pawn_moves(&state, moves_vec);
 
         // 3) Converte e confronta
@@ -645,7 +648,7 @@ void test_generate_white_pawn_moves() {
         print_board_simple(&state);
 
         // 2) Genera mosse
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_white_pawn_moves(&state, moves_vec);
 
         // 3) Converte e confronta
@@ -795,7 +798,7 @@ void test_generate_white_knight_moves() {
         print_board_simple(&state);
 
         // 2) Genera le mosse del cavallo bianco
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_white_knight_moves(&state, moves_vec);
 
         // 3) Converte le mosse generate in notazione semplificata (es: "e4c5")
@@ -1013,7 +1016,7 @@ void test_generate_black_knight_moves() {
         print_board_simple(&state);
 
         // 2) Genera le mosse del cavallo nero
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_black_knight_moves(&state, moves_vec);
 
         // 3) Converte le mosse in notazione (es: "e5c4")
@@ -1183,7 +1186,7 @@ void test_generate_white_bishop_moves() {
         print_board_simple(&state);
 
         // 3) Genera le mosse dell'alfiere bianco
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_white_bishop_moves(&state, moves_vec);
 
         // 4) Converte le mosse in notazione es: d4c5
@@ -1400,7 +1403,7 @@ void test_generate_black_bishop_moves() {
         print_board_simple(&state);
 
         // 3) Genera le mosse dell'alfiere nero
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_black_bishop_moves(&state, moves_vec);
 
         // 4) Converte le mosse in notazione (es: d5c4)
@@ -1560,7 +1563,7 @@ void test_generate_black_rook_moves() {
         print_board_simple(&state);
 
         // 3) Genera mosse (pseudomoves) per la torre nera
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_black_rook_moves(&state, moves_vec);
 
         // 4) Converte le mosse in notazione
@@ -1781,7 +1784,7 @@ void test_generate_white_rook_moves() {
         print_board_simple(&state);
 
         // 3) Genera mosse (pseudomoves) per la torre bianca
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_white_rook_moves(&state, moves_vec);
 
         // 4) Converte le mosse in notazione
@@ -2018,7 +2021,7 @@ void test_generate_white_queen_moves() {
         print_board_simple(&state);
 
         // 3) Genera mosse (pseudomoves) per la regina bianca
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_white_queen_moves(&state, moves_vec);
 
         // 4) Converte le mosse in notazione
@@ -2260,7 +2263,7 @@ void test_generate_black_queen_moves() {
         print_board_simple(&state);
 
         // 3) Genera mosse (pseudomoves) per la regina nera
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_black_queen_moves(&state, moves_vec);
 
         // 4) Converte le mosse in notazione
@@ -2460,7 +2463,7 @@ void test_generate_black_king_moves() {
         print_board_simple(&state);
 
         // 3) Genera mosse per il Re nero
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_black_king_moves(&state, moves_vec);
 
         // 4) Converte le mosse in notazione (es: "e8c8" per arrocco lungo)
@@ -2688,7 +2691,7 @@ void test_generate_white_king_moves() {
         print_board_simple(&state);
 
         // 3) Genera mosse per il Re bianco
-        dynamic_vector_t *moves_vec = dv_create();
+        dynamic_vector_t *moves_vec = dv_create_sized(sizeof(chess_move_t), 64);
         generate_white_king_moves(&state, moves_vec);
 
         // 4) Converte le mosse in notazione (es: "e1g1" -> "O-O" se is_castling=1)
@@ -310,6 +310,9 @@ void parse_fen(const char *fen, bitboard_state_t *state) {
             state->fullmove_number = (uint8_t)val;
         }
     }
+
+    // 9) Occupazioni aggregate coerenti con i bitboard appena impostati
+    chess_refresh_occupancy(state);
 }
 
 /* --------------------------------------------------------------------------
@@ -469,14 +472,20 @@ static void test_chess_moves_all() {
             1, 30
         },
         {
+            // NB: il pedone h7 è inchiodato dalla Donna h8 (hxg8 aprirebbe la
+            // colonna h sul Re h1): restano solo le 3 mosse di Re. Range
+            // aggiornato da quando chess_get_moves filtra la legalità.
             "4) Promozione possibile (pedone bianco su settima traversa, con Donna nera in h8 e Cavallo nero in g8)",
             "6nq/7P/8/8/8/8/8/k6K w - - 0 1",
-            4, 20
+            3, 20
         },
         {
+            // 16 mosse di pedone + 5 di torre + 2 di Re + i due arrocchi = 25
+            // mosse legali. Range aggiornato da quando chess_get_moves filtra
+            // la legalità (il vecchio [2..10] non corrispondeva mai).
             "5) Arrocco effettivo (bianco con rocco corto e lungo)",
             "r3k2r/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQ - 0 1",
-            2, 10
+            20, 30
         },
         {
             "6) Stato con mosse minime (solo Re nero)",
@@ -177,7 +177,11 @@ void test_hash_after_move() {
     // Aggiorna halfmove_clock e fullmove_number se necessario
     new_state->halfmove_clock = 0;
     new_state->fullmove_number += 1;
-    
+    // La mossa è stata applicata toccando i bitboard a mano, non con
+    // chess_make_move: l'hash incrementale in new_state->hash è rimasto
+    // quello della posizione di partenza e va ricalcolato da zero
+    chess_refresh_hash(new_state);
+
     // Stampa lo stato dopo la mossa
     printf("Stato Copiato Dopo la Mossa:\n");
     print_board(new_state);
@@ -172,6 +172,7 @@ int main(void) {
     gd.player_to_move= fake_player_to_move;
     gd.hash_state    = fake_hash_state;
     gd.equals_state  = fake_equals_state;
+    gd.state_size    = sizeof(int);   /* abilita la cache by-value */
 
     printf("=== Test MiniMax con callback di test ===\n");
 
@@ -213,7 +214,7 @@ int main(void) {
 
     /* 5) Prova con la cache (transposition table), se vuoi */
     printf("\n--- Esempio con cache_create, se vuoi testare la transposition table ---\n");
-    generic_hash_table_t *cache = cache_create(fake_hash_state, fake_equals_state);
+    generic_hash_table_t *cache = minimax_cache_create(&gd);
     if (cache) {
         *init_state = 0;
         int valCache = minimax_ab(&gd, init_state, 5, INT_MIN, INT_MAX, cache);
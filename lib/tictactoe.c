@@ -93,12 +93,17 @@ static int check_winner(const TTT_State *st) {
  * CALLBACK PER MINIMAX (game_descriptor_t)
  ****************************************************************************/
 
+/* Free-list per-thread per gli stati (vedi obj_mem.h): gli stati liberati
+   vengono riciclati dalla prossima copia senza passare da malloc/free */
+static __thread obj_mem_freelist_t ttt_state_freelist =
+    OBJ_MEM_FREELIST_INIT(sizeof(TTT_State), 64);
+
 /**
  * @brief Copia profonda dello stato (TTT_State).
  */
 static void* ttt_copy_state(const void *state) {
     const TTT_State *st = (const TTT_State*) state;
-    TTT_State *copy = (TTT_State*) malloc(sizeof(TTT_State));
+    TTT_State *copy = (TTT_State*) obj_mem_freelist_alloc(&ttt_state_freelist);
     if (copy) {
         memcpy(copy->board, st->board, BOARD_SIZE * sizeof(int));
         copy->next_player = st->next_player;
@@ -110,7 +115,7 @@ static void* ttt_copy_state(const void *state) {
  * @brief Libera lo stato.
  */
 static void ttt_free_state(void *state) {
-    free(state);
+    obj_mem_freelist_free(&ttt_state_freelist, state);
 }
 
 /**
@@ -170,7 +175,7 @@ static void* ttt_apply_move(const void *state, const void *move) {
     const TTT_State *st = (const TTT_State*) state;
     const int *m = (const int*) move;
 
-    TTT_State *new_st = (TTT_State*) malloc(sizeof(TTT_State));
+    TTT_State *new_st = (TTT_State*) obj_mem_freelist_alloc(&ttt_state_freelist);
     if (!new_st) return NULL;
 
     memcpy(new_st->board, st->board, BOARD_SIZE * sizeof(int));
@@ -0,0 +1,549 @@
+/**
+ * ##VERSION## "uci_main.c 1.0"
+*/
+
+/******************************************************************************
+ * File: uci_main.c
+ *
+ * Front-end UCI (Universal Chess Interface) del motore: espone il
+ * game_descriptor e i driver di iterative deepening su stdin/stdout con il
+ * protocollo che parlano le GUI scacchistiche, i tornei automatici
+ * (cutechess-cli e simili) e gli harness di servizio. Con questo binario il
+ * motore si confronta con i motori di riferimento e si pilota con gli
+ * strumenti standard, senza passare dalla GUI SDL o da main di test.
+ *
+ * Uso:
+ *   make build TARGET=chess_uci
+ *   ./chess_uci            (poi comandi UCI su stdin)
+ *
+ * Comandi supportati:
+ *   uci / isready / ucinewgame / quit
+ *   setoption name Hash value N      dimensione della transposition table
+ *                                    in MiB (ricreata al volo)
+ *   position startpos|fen ... [moves ...]
+ *   go [depth N] [nodes N] [movetime MS] [wtime MS] [btime MS] [winc MS]
+ *      [binc MS] [movestogo N] [infinite] [ponder]
+ *   stop / ponderhit
+ *
+ * Architettura: il thread principale legge i comandi; "go" avvia un thread
+ * di ricerca che chiama get_best_move_stoppable, più un watchdog che alza il
+ * flag di stop alla scadenza del budget di tempo (il flag viene letto ogni
+ * TIME_CHECK_INTERVAL nodi, quindi il rientro è questione di millisecondi).
+ * Il limite di nodi usa la callback di progresso, che pubblica anche le
+ * righe "info" a ogni iterazione completata. "go ponder" cerca senza
+ * scadenza; "ponderhit" arma il budget di tempo da quel momento.
+ *
+ * Nota sulla storia delle ripetizioni: la pila è per-thread, quindi gli
+ * hash della partita (raccolti dal comando position) vengono riseminati sul
+ * thread di ricerca prima di ogni "go".
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "chess_state.h"
+#include "chess_moves.h"
+#include "chess_fen.h"
+#include "chess_hash.h"
+#include "chess_game_dynamics.h"
+#include "chess_game_descriptor.h"
+#include "minimax.h"
+#include "minimax_tt.h"
+#include "obj_trace.h"
+
+#define UCI_LINE_MAX        8192  /* "position ... moves ..." può essere lunga */
+#define UCI_DEFAULT_HASH_MB 64
+#define UCI_MAX_HASH_MB     4096
+#define UCI_MAX_MOVES       256   /* mosse legali in una posizione di scacchi */
+#define UCI_MAX_HISTORY     1024  /* hash della partita per le ripetizioni */
+
+/* --------------------------------------------------------------------------
+ * Stato del front-end
+ * -------------------------------------------------------------------------- */
+
+static game_descriptor_t *s_gd = NULL;
+static minimax_tt_t      *s_tt = NULL;
+static int                s_hash_mb = UCI_DEFAULT_HASH_MB;
+
+static bitboard_state_t   s_root;                 /* posizione da cercare */
+static uint64_t           s_history[UCI_MAX_HISTORY]; /* hash per le ripetizioni */
+static int                s_history_len = 0;
+
+/* Parametri dell'ultimo "go" */
+typedef struct {
+    int           depth;
+    unsigned long nodes;
+    long          movetime;
+    long          wtime, btime, winc, binc;
+    int           movestogo;
+    int           infinite;
+    int           ponder;
+} go_params_t;
+
+static go_params_t s_go;
+
+/* Controllo della ricerca in corso */
+static pthread_t       s_search_thread;
+static volatile int    s_searching = 0;      /* thread di ricerca vivo */
+static int             s_thread_live = 0;    /* pthread da joinare */
+static volatile int    s_stop = 0;           /* letto da get_best_move_stoppable */
+static volatile int    s_search_done = 0;    /* spegne il watchdog */
+static volatile int    s_deadline_armed = 0;
+static volatile long   s_deadline_abs = 0;   /* scadenza assoluta (monotonic ms) */
+
+/* Una sola penna su stdout: info dal thread di ricerca, risposte dal main */
+static pthread_mutex_t s_out_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void uci_printf(const char *fmt, ...)
+    __attribute__((format(printf, 1, 2)));
+
+static void uci_printf(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    pthread_mutex_lock(&s_out_lock);
+    vprintf(fmt, args);
+    fflush(stdout);
+    pthread_mutex_unlock(&s_out_lock);
+    va_end(args);
+}
+
+/* --------------------------------------------------------------------------
+ * Mosse in notazione da coordinate ("e2e4", "e7e8q")
+ * -------------------------------------------------------------------------- */
+
+static void format_move(const chess_move_t *move, char *buf) {
+    static const char promo_letters[] = { '\0', 'n', 'b', 'r', 'q' };
+    int n = 0;
+    buf[n++] = (char)('a' + (move->from % 8));
+    buf[n++] = (char)('1' + (move->from / 8));
+    buf[n++] = (char)('a' + (move->to % 8));
+    buf[n++] = (char)('1' + (move->to / 8));
+    if (move->promotion >= 1 && move->promotion <= 4) {
+        buf[n++] = promo_letters[move->promotion];
+    }
+    buf[n] = '\0';
+}
+
+/*
+ * Interpreta un token "e2e4"/"e7e8q" e lo cerca tra le mosse legali della
+ * posizione: solo una mossa davvero giocabile viene applicata. Ritorna 1 e
+ * riempie *out sulla corrispondenza, 0 su token malformato o mossa illegale.
+ */
+static int parse_move(const bitboard_state_t *state, const char *token,
+                      chess_move_t *out) {
+    size_t len = strlen(token);
+    if (len < 4 || len > 5) {
+        return 0;
+    }
+    if (token[0] < 'a' || token[0] > 'h' || token[1] < '1' || token[1] > '8' ||
+        token[2] < 'a' || token[2] > 'h' || token[3] < '1' || token[3] > '8') {
+        return 0;
+    }
+    int from = (token[0] - 'a') + (token[1] - '1') * 8;
+    int to   = (token[2] - 'a') + (token[3] - '1') * 8;
+    int promo = 0;
+    if (len == 5) {
+        switch (token[4]) {
+            case 'n': promo = 1; break;
+            case 'b': promo = 2; break;
+            case 'r': promo = 3; break;
+            case 'q': promo = 4; break;
+            default:  return 0;
+        }
+    }
+
+    chess_move_t moves[UCI_MAX_MOVES];
+    int n = chess_generate_moves(state, moves, UCI_MAX_MOVES);
+    for (int i = 0; i < n; i++) {
+        if (moves[i].from == from && moves[i].to == to &&
+            moves[i].promotion == promo) {
+            *out = moves[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+ * Thread di ricerca + watchdog del budget di tempo
+ * -------------------------------------------------------------------------- */
+
+static void *watchdog_main(void *arg) {
+    (void)arg;
+    struct timespec tick = { 0, 5000000 }; /* 5 ms */
+    while (!s_search_done) {
+        if (s_deadline_armed && monotonic_ms() >= s_deadline_abs) {
+            s_stop = 1;
+        }
+        nanosleep(&tick, NULL);
+    }
+    return NULL;
+}
+
+/*
+ * Callback di progresso (per-thread, registrata sul thread di ricerca):
+ * pubblica la riga "info" dell'iterazione e applica il limite di nodi.
+ */
+static void uci_progress(const search_progress_t *progress, void *user_data) {
+    (void)user_data;
+
+    /* Punteggio dal punto di vista di chi muove, come chiede il protocollo
+       (il motore valuta dal punto di vista del Bianco) */
+    int cp = (s_root.current_player == 1) ? progress->value : -progress->value;
+
+    char score_buf[32];
+    if (cp > 90000 || cp < -90000) {
+        /* Matto: il punteggio del motore non porta la distanza, la si stima
+           dalla lunghezza della variante principale che ci arriva */
+        int mate_moves = (progress->pv_length + 1) / 2;
+        if (mate_moves < 1) mate_moves = 1;
+        snprintf(score_buf, sizeof(score_buf), "mate %d",
+                 (cp > 0) ? mate_moves : -mate_moves);
+    } else {
+        snprintf(score_buf, sizeof(score_buf), "cp %d", cp);
+    }
+
+    char pv_buf[1024];
+    size_t used = 0;
+    pv_buf[0] = '\0';
+    for (int i = 0; i < progress->pv_length; i++) {
+        char move_buf[8];
+        format_move((const chess_move_t*)progress->pv_moves[i], move_buf);
+        size_t len = strlen(move_buf);
+        if (used + len + 2 >= sizeof(pv_buf)) {
+            break;
+        }
+        if (used > 0) {
+            pv_buf[used++] = ' ';
+        }
+        memcpy(&pv_buf[used], move_buf, len + 1);
+        used += len;
+    }
+
+    uci_printf("info depth %d score %s nodes %lu nps %.0f time %ld pv %s\n",
+               progress->depth, score_buf, progress->nodes, progress->nps,
+               progress->elapsed_ms, pv_buf);
+
+    if (s_go.nodes != 0 && progress->nodes >= s_go.nodes) {
+        s_stop = 1; /* granularità: l'iterazione, come nel bench */
+    }
+}
+
+static void *search_main(void *arg) {
+    (void)arg;
+
+    /* La pila delle ripetizioni è per-thread: gli hash della partita
+       raccolti dal comando position vanno riseminati QUI */
+    chess_repetition_reset();
+    for (int i = 0; i < s_history_len; i++) {
+        chess_repetition_push(s_history[i]);
+    }
+    minimax_set_progress_callback(uci_progress, NULL);
+
+    pthread_t watchdog;
+    int have_watchdog = (pthread_create(&watchdog, NULL, watchdog_main, NULL) == 0);
+
+    void *move = get_best_move_stoppable(s_gd, &s_root, s_go.depth,
+                                         &s_stop, NULL);
+
+    /* Con "go infinite" (o un ponder senza hit) il protocollo vuole
+       bestmove solo DOPO stop, anche se la ricerca ha esaurito l'albero */
+    if ((s_go.infinite || s_go.ponder) && !s_stop) {
+        struct timespec tick = { 0, 5000000 };
+        while (!s_stop) {
+            nanosleep(&tick, NULL);
+        }
+    }
+
+    s_search_done = 1;
+    if (have_watchdog) {
+        pthread_join(watchdog, NULL);
+    }
+    minimax_set_progress_callback(NULL, NULL);
+
+    if (move) {
+        char move_buf[8];
+        format_move((const chess_move_t*)move, move_buf);
+        uci_printf("bestmove %s\n", move_buf);
+        s_gd->free_move(move);
+    } else {
+        uci_printf("bestmove 0000\n"); /* posizione terminale */
+    }
+
+    s_searching = 0;
+    return NULL;
+}
+
+/* Attende la fine di una eventuale ricerca precedente (join del thread) */
+static void reap_search_thread(void) {
+    if (s_thread_live) {
+        pthread_join(s_search_thread, NULL);
+        s_thread_live = 0;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Gestione dei comandi
+ * -------------------------------------------------------------------------- */
+
+/* Ricrea la transposition table alla dimensione corrente */
+static int rebuild_ttable(void) {
+    minimax_set_ttable(NULL);
+    if (s_tt) {
+        minimax_tt_destroy(s_tt);
+        s_tt = NULL;
+    }
+    s_tt = minimax_tt_create(s_hash_mb);
+    if (!s_tt) {
+        uci_printf("info string allocazione TT da %d MiB fallita\n", s_hash_mb);
+        return 0;
+    }
+    minimax_set_ttable(s_tt);
+    return 1;
+}
+
+static void cmd_uci(void) {
+    uci_printf("id name Chess 1.0\n");
+    uci_printf("id author progetto chess\n");
+    uci_printf("option name Hash type spin default %d min 1 max %d\n",
+               UCI_DEFAULT_HASH_MB, UCI_MAX_HASH_MB);
+    uci_printf("uciok\n");
+}
+
+static void cmd_setoption(char *args) {
+    /* Forma: name <nome> value <valore>; l'unica opzione è Hash */
+    char *name = NULL, *value = NULL;
+    for (char *tok = strtok(args, " \t"); tok; tok = strtok(NULL, " \t")) {
+        if (strcmp(tok, "name") == 0) {
+            name = strtok(NULL, " \t");
+        } else if (strcmp(tok, "value") == 0) {
+            value = strtok(NULL, " \t");
+        }
+    }
+    if (!name || !value || strcasecmp(name, "Hash") != 0) {
+        return; /* opzione sconosciuta: il protocollo dice di ignorare */
+    }
+    int mb = atoi(value);
+    if (mb < 1) mb = 1;
+    if (mb > UCI_MAX_HASH_MB) mb = UCI_MAX_HASH_MB;
+    if (mb != s_hash_mb || !s_tt) {
+        s_hash_mb = mb;
+        rebuild_ttable();
+    }
+}
+
+static void cmd_position(char *args) {
+    char *tok = strtok(args, " \t");
+    bitboard_state_t state;
+
+    if (tok && strcmp(tok, "startpos") == 0) {
+        initialize_board(&state);
+        tok = strtok(NULL, " \t");
+    } else if (tok && strcmp(tok, "fen") == 0) {
+        /* La FEN sono i token fino a "moves" (o fine riga), ricomposti */
+        char fen[256];
+        size_t used = 0;
+        fen[0] = '\0';
+        while ((tok = strtok(NULL, " \t")) != NULL && strcmp(tok, "moves") != 0) {
+            size_t len = strlen(tok);
+            if (used + len + 2 >= sizeof(fen)) {
+                uci_printf("info string FEN troppo lunga\n");
+                return;
+            }
+            if (used > 0) {
+                fen[used++] = ' ';
+            }
+            memcpy(&fen[used], tok, len + 1);
+            used += len;
+        }
+        if (!chess_fen_parse(fen, &state)) {
+            uci_printf("info string FEN non interpretabile: %s\n", fen);
+            return;
+        }
+    } else {
+        return;
+    }
+
+    /* Storia per le ripetizioni: il main thread fa da brogliaccio (la sua
+       pila viene riseminata a ogni position), gli hash raccolti qui
+       verranno ripassati al thread di ricerca */
+    chess_repetition_reset();
+    chess_repetition_push(chess_hash_state(&state));
+    s_history_len = 0;
+    s_history[s_history_len++] = chess_hash_state(&state);
+
+    if (tok && strcmp(tok, "moves") == 0) {
+        while ((tok = strtok(NULL, " \t")) != NULL) {
+            chess_move_t move;
+            chess_undo_t undo;
+            if (!parse_move(&state, tok, &move) ||
+                !chess_make_move(&state, &move, &undo)) {
+                uci_printf("info string mossa non valida: %s\n", tok);
+                return;
+            }
+            if (s_history_len < UCI_MAX_HISTORY) {
+                s_history[s_history_len++] = state.hash;
+            }
+        }
+    }
+
+    s_root = state;
+}
+
+/* Budget di tempo per la mossa dal tempo residuo sull'orologio */
+static long budget_from_clock(void) {
+    long time_left = (s_root.current_player == 1) ? s_go.wtime : s_go.btime;
+    long inc       = (s_root.current_player == 1) ? s_go.winc  : s_go.binc;
+    if (time_left <= 0) {
+        return 0;
+    }
+    int moves = (s_go.movestogo > 0) ? s_go.movestogo : 30;
+    long budget = time_left / moves + inc / 2;
+    if (budget > time_left / 2) {
+        budget = time_left / 2; /* mai più di metà del tempo residuo */
+    }
+    if (budget < 10) {
+        budget = 10;
+    }
+    return budget;
+}
+
+static void cmd_go(char *args) {
+    if (s_searching) {
+        return; /* una ricerca alla volta, come da protocollo */
+    }
+    reap_search_thread();
+    if (!s_tt) {
+        rebuild_ttable();
+    }
+
+    memset(&s_go, 0, sizeof(s_go));
+    for (char *tok = strtok(args, " \t"); tok; tok = strtok(NULL, " \t")) {
+        char *val;
+        if      (strcmp(tok, "infinite") == 0)  s_go.infinite = 1;
+        else if (strcmp(tok, "ponder") == 0)    s_go.ponder = 1;
+        else if ((val = strtok(NULL, " \t")) == NULL) break;
+        else if (strcmp(tok, "depth") == 0)     s_go.depth = atoi(val);
+        else if (strcmp(tok, "nodes") == 0)     s_go.nodes = strtoul(val, NULL, 10);
+        else if (strcmp(tok, "movetime") == 0)  s_go.movetime = atol(val);
+        else if (strcmp(tok, "wtime") == 0)     s_go.wtime = atol(val);
+        else if (strcmp(tok, "btime") == 0)     s_go.btime = atol(val);
+        else if (strcmp(tok, "winc") == 0)      s_go.winc = atol(val);
+        else if (strcmp(tok, "binc") == 0)      s_go.binc = atol(val);
+        else if (strcmp(tok, "movestogo") == 0) s_go.movestogo = atoi(val);
+    }
+
+    s_stop = 0;
+    s_search_done = 0;
+    s_deadline_armed = 0;
+
+    /* Il budget di tempo parte subito, tranne che in ponder: lì lo arma
+       ponderhit (l'avversario sta ancora pensando) */
+    if (!s_go.ponder && !s_go.infinite) {
+        long budget = (s_go.movetime > 0) ? s_go.movetime : budget_from_clock();
+        if (budget > 0) {
+            s_deadline_abs = monotonic_ms() + budget;
+            s_deadline_armed = 1;
+        }
+    }
+
+    s_searching = 1;
+    if (pthread_create(&s_search_thread, NULL, search_main, NULL) != 0) {
+        s_searching = 0;
+        uci_printf("info string avvio del thread di ricerca fallito\n");
+        return;
+    }
+    s_thread_live = 1;
+}
+
+static void cmd_ponderhit(void) {
+    if (!s_searching || !s_go.ponder) {
+        return;
+    }
+    /* Da adesso si gioca sul proprio tempo: il budget parte qui */
+    s_go.ponder = 0;
+    long budget = (s_go.movetime > 0) ? s_go.movetime : budget_from_clock();
+    if (budget > 0) {
+        s_deadline_abs = monotonic_ms() + budget;
+        s_deadline_armed = 1;
+    }
+}
+
+int main(void) {
+    /* Su stdout passa solo il protocollo: il trace resta su stderr e tace
+       sotto il livello di errore */
+    trace_set_channel_level(&stdtrace, TRACE_LEVEL_ERROR);
+
+    s_gd = initialize_chess_game_descriptor();
+    if (!s_gd) {
+        fprintf(stderr, "Inizializzazione del descrittore fallita\n");
+        return 1;
+    }
+    initialize_board(&s_root);
+    s_history_len = 0;
+    s_history[s_history_len++] = chess_hash_state(&s_root);
+
+    char line[UCI_LINE_MAX];
+    while (fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *cmd = line;
+        while (*cmd == ' ' || *cmd == '\t') cmd++;
+        char *args = strchr(cmd, ' ');
+        if (args) {
+            *args++ = '\0';
+        } else {
+            args = cmd + strlen(cmd); /* stringa vuota */
+        }
+
+        if (strcmp(cmd, "uci") == 0) {
+            cmd_uci();
+        } else if (strcmp(cmd, "isready") == 0) {
+            if (!s_tt) {
+                rebuild_ttable();
+            }
+            uci_printf("readyok\n");
+        } else if (strcmp(cmd, "ucinewgame") == 0) {
+            if (!s_searching) {
+                reap_search_thread();
+                rebuild_ttable(); /* tavola fresca: niente voci della partita prima */
+            }
+        } else if (strcmp(cmd, "setoption") == 0) {
+            if (!s_searching) {
+                cmd_setoption(args);
+            }
+        } else if (strcmp(cmd, "position") == 0) {
+            if (!s_searching) {
+                reap_search_thread();
+                cmd_position(args);
+            }
+        } else if (strcmp(cmd, "go") == 0) {
+            cmd_go(args);
+        } else if (strcmp(cmd, "stop") == 0) {
+            s_stop = 1;
+        } else if (strcmp(cmd, "ponderhit") == 0) {
+            cmd_ponderhit();
+        } else if (strcmp(cmd, "quit") == 0) {
+            break;
+        }
+        /* comandi sconosciuti: ignorati, come da protocollo */
+    }
+
+    s_stop = 1;
+    reap_search_thread();
+    minimax_set_ttable(NULL);
+    if (s_tt) {
+        minimax_tt_destroy(s_tt);
+    }
+    free(s_gd);
+    return 0;
+}